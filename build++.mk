@@ -26,7 +26,7 @@ CXXFLAGS= -std=c++1y -frtti -g -Wall -O3 -Wextra -Wno-unknown-pragmas \
 #-Wdeprecated
 
 LDFLAGS= -lboost_serialization -lboost_program_options -lboost_system -lboost_filesystem \
-	-lpthread -ldl -rdynamic -latomic
+	-lpthread -ldl -rdynamic -latomic -lz
 
 INCLUDES= -Isrc/framework -Isrc/framework/common -Isrc/lib -Isrc/${TARGET}
 
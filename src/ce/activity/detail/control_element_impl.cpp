@@ -94,6 +94,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "router/route.hpp"
 #include "router/address.hpp"
 #include "router/address_info.hpp"
+#include "router/neighbor_info.hpp"
 #include "protocol/openflow/flow.hpp"
 #include "router/flow_query.hpp"
 #include "router/arp_packet.hpp"
@@ -325,6 +326,13 @@ void ControlElement::ControlElementImpl::load_interfaces(const pugi::xml_node& r
 
         external_interfaces_.add(index, name, node, port);
 
+        auto element = tnt::find_if(elements_, [&] (const auto& e) { return e->display_name() == node; });
+
+        if (element != std::end(elements_))
+        {
+            (*element)->add_port(index, port);
+        }
+
         auto addresses = iface.child("addresses");
 
         for (const auto& address : addresses.children("address"))
@@ -448,18 +456,40 @@ void ControlElement::ControlElementImpl::add_routes(const std::vector<std::share
     {
         tnt::visit<service::Forwarding>(service, [&] (const auto& s)
         {
+            std::vector<RouteInfo> routes;
+            routes.reserve(routes_.size());
+
             for (const auto& route : routes_)
             {
                 tnt::Log::info(colors::blue, "Adding route: ", *route);
+                routes.push_back(static_cast<const RouteInfo>(*route));
+            }
 
-                try
-                {
-                    s->add(static_cast<const RouteInfo>(*route));
-                }
-                catch (std::exception& ex)
-                {
-                    tnt::Log::error("ControlElement::ControlElementImpl error sending a message to a SE: ", ex.what());
-                }
+            try
+            {
+                s->add_batch(routes);
+            }
+            catch (std::exception& ex)
+            {
+                tnt::Log::error("ControlElement::ControlElementImpl error sending a message to a SE: ", ex.what());
+            }
+        });
+    }
+}
+
+void ControlElement::ControlElementImpl::neighbor_added(const NeighborInfo& neighbor)
+{
+    for (const auto& element : for_each_element())
+    {
+        tnt::visit_any_of<service::Forwarding>(element->services(), [&] (const auto& s)
+        {
+            try
+            {
+                s->neighbor_added(neighbor);
+            }
+            catch (std::exception& ex)
+            {
+                tnt::Log::error("ControlElement::ControlElementImpl error sending a message to a SE: ", ex.what());
             }
         });
     }
@@ -845,7 +875,7 @@ void ControlElement::ControlElementImpl::leave_multicast_group(uint16_t iface, c
 
 void ControlElement::ControlElementImpl::start_http_server()
 {
-    activities_.push_back(tnt::async([] ()
+    activities_.push_back(tnt::async_activity([] ()
     {
         tnt::activity::HttpServer server;
         server(factory::create_io_end_point("httpd"), "html");
@@ -863,7 +893,7 @@ void ControlElement::ControlElementImpl::start_lcp()
 
         if (all_connected)
         {
-            activities_.push_back(tnt::async([] ()
+            activities_.push_back(tnt::async_activity([] ()
             {
                 activity::ControlElementLCP lcp;
                 lcp();
@@ -960,12 +990,12 @@ void ControlElement::ControlElementImpl::operator()()
 
     configure_network();
 
-    activities_.push_back(tnt::async([] ()
+    activities_.push_back(tnt::async_activity([] ()
     {
         activity::DiscoverServiceElements()();
     }));
 
-    activities_.push_back(tnt::async([] ()
+    activities_.push_back(tnt::async_activity([] ()
     {
         activity::DiscoverOpenflowElements()();
     }));
@@ -975,6 +1005,9 @@ void ControlElement::ControlElementImpl::operator()()
 
 	register_listeners();
 
+	// Fills the neighbor table, it is then kept up to date by the netlink notifications.
+	kernel_->send(std::make_unique<message::GetNeighbors>());
+
 	tnt::for_all(addresses_, [&] (const auto& address)
 	{
 		const auto& ai = static_cast<const AddressInfo>(*address);
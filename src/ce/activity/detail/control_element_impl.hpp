@@ -91,6 +91,9 @@ class LocalPortDeleted;
 class RouteList;
 class LocalRouteAdded;
 class LocalRouteRemoved;
+class NeighborList;
+class LocalNeighborAdded;
+class LocalNeighborRemoved;
 class LocalAddressAdded;
 class LocalAddressRemoved;
 class LocalPortAdminUp;
@@ -122,6 +125,7 @@ class Flow;
 
 struct RouteInfo;
 struct AddressInfo;
+struct NeighborInfo;
 struct PortInfo;
 struct Protocol;
 struct ArpPacket;
@@ -165,6 +169,7 @@ private:
     void add(const AddressInfo& address);
 
     void add_routes(const std::vector<std::shared_ptr<Service>>& services);
+    void neighbor_added(const NeighborInfo& neighbor);
 
     void remove(const RouteInfo& route);
     void remove(const AddressInfo& address);
@@ -210,7 +215,7 @@ private:
 
     void port_status_change(const event::PortStatusChange& event);
 
-	void packet_in(const std::shared_ptr<event::PacketIn>& event);
+	void packet_in(const event::PacketIn& event);
 	void port_stats_request(const std::shared_ptr<event::PortStatsRequest>& event);
 	void port_stats_reply(const std::shared_ptr<event::PortStatsReply>& event);
 	void arp_request(const std::shared_ptr<event::ArpRequest>& event);
@@ -224,6 +229,9 @@ private:
     void local_routes_list(const event::RouteList& event);
 	void local_route_added(const event::LocalRouteAdded& event);
 	void local_route_removed(const event::LocalRouteRemoved& event);
+    void local_neighbors_list(const event::NeighborList& event);
+	void local_neighbor_added(const event::LocalNeighborAdded& event);
+	void local_neighbor_removed(const event::LocalNeighborRemoved& event);
 	void local_address_added(const event::LocalAddressAdded& event);
 	void local_address_removed(const event::LocalAddressRemoved& event);
     void local_port_admin_up(const event::LocalPortAdminUp& event);
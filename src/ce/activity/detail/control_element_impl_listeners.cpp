@@ -46,6 +46,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "event/network/service_element_disconnected.hpp"
 #include "event/network/connection_reset.hpp"
 #include "event/network/route_events.hpp"
+#include "event/network/neighbor_events.hpp"
 #include "event/network/packet_in.hpp"
 #include "event/network/port_events.hpp"
 #include "event/network/address_events.hpp"
@@ -69,6 +70,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "router/address.hpp"
 #include "router/route.hpp"
+#include "router/neighbor_info.hpp"
 #include "router/interface.hpp"
 #include "protocol/openflow/flow.hpp"
 #include "router/flow_query.hpp"
@@ -183,6 +185,26 @@ void ControlElement::ControlElementImpl::register_listeners()
         local_route_removed(event);
     });
 
+    register_handler([this] (const event::NeighborList& event)
+    {
+        local_neighbors_list(event);
+    });
+
+    register_handler([this] (const event::LocalNeighborAdded& event)
+    {
+        local_neighbor_added(event);
+    });
+
+    register_handler([this] (const event::LocalNeighborRemoved& event)
+    {
+        local_neighbor_removed(event);
+    });
+
+    register_handler([this] (const event::ResolveNeighbor& event)
+    {
+        kernel_->send(std::make_unique<message::ResolveNeighbor>(event.address(), event.port_index()));
+    });
+
     register_handler([this] (const event::LocalAddressAdded& event)
     {
         local_address_added(event);
@@ -213,12 +235,12 @@ void ControlElement::ControlElementImpl::register_listeners()
 		//ospf_multicast_change(event);
     });
 
-    /*register_handler([this] (const event::PacketIn& event)
+    register_handler([this] (const event::PacketIn& event)
     {
 		packet_in(event);
     });
 
-    register_handler([this] (const event::PortStatsRequest& event)
+    /*register_handler([this] (const event::PortStatsRequest& event)
     {
 		port_stats_request(event);
     });
@@ -281,8 +303,12 @@ void ControlElement::ControlElementImpl::port_status_change(const event::PortSta
     }
 }
 
-void ControlElement::ControlElementImpl::packet_in(const std::shared_ptr<event::PacketIn>& /*event*/)
+void ControlElement::ControlElementImpl::packet_in(const event::PacketIn& event)
 {
+    const auto& flow = event.flow();
+
+    tnt::Log::debug(colors::cyan, "Packet-in on port ", flow.match().in_port, ", buffer ", flow.flags().buffer, ", ", event.buffer().size(), " bytes");
+
 	/*assert(event->protocol);
 
     const auto& flow = event->flow();
@@ -406,6 +432,28 @@ void ControlElement::ControlElementImpl::local_route_removed(const event::LocalR
 	//remove(event->route());
 }
 
+void ControlElement::ControlElementImpl::local_neighbors_list(const event::NeighborList& event)
+{
+    tnt::Log::info(colors::cyan, "Local neighbors list: #", event.neighbors().size(), " neighbors");
+
+    for (const auto& n : event.neighbors())
+    {
+        neighbor_added(n);
+    }
+}
+
+void ControlElement::ControlElementImpl::local_neighbor_added(const event::LocalNeighborAdded& event)
+{
+    tnt::Log::info(colors::blue, "Added local neighbor: ", event.neighbor());
+
+    neighbor_added(event.neighbor());
+}
+
+void ControlElement::ControlElementImpl::local_neighbor_removed(const event::LocalNeighborRemoved& event)
+{
+    tnt::Log::info(colors::blue, "Removed local neighbor: ", event.neighbor());
+}
+
 void ControlElement::ControlElementImpl::local_address_added(const event::LocalAddressAdded& event)
 {
     tnt::Log::info(colors::blue, "Added local address: ", event.address());
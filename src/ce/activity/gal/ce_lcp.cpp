@@ -78,6 +78,9 @@ namespace drop {
 namespace activity {
 namespace {
 
+const tnt::ConfigKey<int> polling_interval("data.elements.polling.interval", 1);
+const tnt::ConfigKey<int> history_size("data.history.size", 100);
+
 gal::ReturnCode read_sensor(const boost::circular_buffer<gal::SensorHistory>& history, gal::EntitySensorStatus& status, gal::EntitySensorValue& value, gal::EntitySensorTimeStamp& ts)
 {
     status = gal::EntitySensorStatus::unavailable;
@@ -145,7 +148,7 @@ void read_history(std::mutex& guard, const std::map<std::string, boost::circular
 
 template <class T> void sleep(const T& prev)
 {
-    static auto interval = tnt::Configuration::get("data.elements.polling.interval", 1);
+    auto interval = polling_interval.get();
 
     if (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - prev).count() < interval)
     {
@@ -233,7 +236,7 @@ void fill_sensor_resources(gal::SensorResourceContainer* resources, const std::u
 
 } // namespace
 
-ControlElementLCP::ControlElementLCP() : history_size_(tnt::Configuration::get("data.history.size", 100)), lcp_task_(factory::create_lcp_process()), device_traffic_(history_size_)
+ControlElementLCP::ControlElementLCP() : history_size_(history_size.get()), lcp_task_(factory::create_lcp_process()), device_traffic_(history_size_)
 {
     config();
 }
@@ -59,9 +59,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "protocol/protocol.hpp"
 #include "protocol/http/http_response.hpp"
 #include "protocol/openflow/flow.hpp"
-#include "protocol/openflow/flow_flags.hpp"
-#include "protocol/openflow/flow_filters.hpp"
-#include "protocol/openflow/flow_actions.hpp"
 
 #include "router/interface.hpp"
 #include "router/route.hpp"
@@ -260,148 +257,128 @@ std::string ip_string(const tnt::ip::Address& ip, int prefix)
     return ss.str();
 }
 
-tnt::JsonObject get_filter(protocol::FlowFilter* filter)
+template <class T> void add_filter(tnt::JsonArray& filters, const std::string& name, const T& value)
 {
-    tnt::JsonObject obj;
+    filters.add(tnt::JsonObject().add(name, value));
+}
+
+tnt::JsonArray flow_filters_to_json(const protocol::Flow& flow)
+{
+    using protocol::FlowMatch;
+
+    const auto& match = flow.match();
+
+    tnt::JsonArray filters;
 
-    if (tnt::visit<protocol::FromPort>(filter, [&] (auto f) { obj.add("IN_PORT", f->port()); }))
+    if (match.has(FlowMatch::InPort))
     {
-        return obj;
+        add_filter(filters, "IN_PORT", match.in_port);
     }
 
-    if (tnt::visit<protocol::FromVlan>(filter, [&] (auto f) { obj.add("VLAN", f->tag()); }))
+    if (match.has(FlowMatch::Vlan))
     {
-        return obj;
+        add_filter(filters, "VLAN", match.vlan);
     }
 
-    if (tnt::visit<protocol::FromL2Proto>(filter, [&] (auto f) { obj.add("L2_TYPE", static_cast<int>(f->proto())); }))
+    if (match.has(FlowMatch::EthType))
     {
-        return obj;
+        add_filter(filters, "L2_TYPE", static_cast<int>(match.eth_type));
     }
-       
-    if (tnt::visit<protocol::FromL3Proto>(filter, [&] (auto f) { obj.add("IP_PROTO", static_cast<int>(f->proto())); }))
+
+    if (match.has(FlowMatch::IpProto))
     {
-        return obj;
+        add_filter(filters, "IP_PROTO", static_cast<int>(match.ip_proto));
     }
-       
-    if (tnt::visit<protocol::FromHwSrc>(filter, [&] (auto f) { obj.add("L2_SRC", f->mac().to_string()); }))
+
+    if (match.has(FlowMatch::HwSrc))
     {
-        return obj;
+        add_filter(filters, "L2_SRC", tnt::MacAddress(match.hw_src).to_string());
     }
-       
-    if (tnt::visit<protocol::FromHwDst>(filter, [&] (auto f) { obj.add("L2_DST", f->mac().to_string()); }))
+
+    if (match.has(FlowMatch::HwDst))
     {
-        return obj;
+        add_filter(filters, "L2_DST", tnt::MacAddress(match.hw_dst).to_string());
     }
-       
-    if (tnt::visit<protocol::FromIpSrc>(filter, [&] (auto f) { obj.add("IP_SRC", ip_string(f->ip(), f->prefix())); }))
+
+    if (match.has(FlowMatch::IpSrc))
     {
-        return obj;
+        add_filter(filters, "IP_SRC", ip_string(tnt::ip::Address::from_net_order_ulong(match.ip_src), match.ip_src_prefix));
     }
-       
-    if (tnt::visit<protocol::FromIpDst>(filter, [&] (auto f) { obj.add("IP_DST", ip_string(f->ip(), f->prefix())); }))
+
+    if (match.has(FlowMatch::IpDst))
     {
-        return obj;
+        add_filter(filters, "IP_DST", ip_string(tnt::ip::Address::from_net_order_ulong(match.ip_dst), match.ip_dst_prefix));
     }
-       
-    if (tnt::visit<protocol::FromTransportPortSrc>(filter, [&] (auto f) { obj.add("TP_SRC", /*f->proto(),*/ f->port()); }))
+
+    if (match.has(FlowMatch::TpSrc))
     {
-        return obj;
+        add_filter(filters, "TP_SRC", match.tp_src);
     }
-       
-    if (tnt::visit<protocol::FromTransportPortDst>(filter, [&] (auto f) { obj.add("TP_DST", /*f->proto(),*/ f->port()); }))
+
+    if (match.has(FlowMatch::TpDst))
     {
-        return obj;
+        add_filter(filters, "TP_DST", match.tp_dst);
     }
 
-    return obj;
+    return filters;
 }
 
-tnt::JsonArray flow_filters_to_json(const protocol::Flow& flow)
+tnt::JsonArray flow_actions_to_json(const protocol::Flow& flow)
 {
-    tnt::JsonArray filters;
+    using protocol::FlowActions;
 
-    for (const auto& f : flow.filters())
-    {
-        filters.add(get_filter(f.get()));
-    }
+    const auto& a = flow.actions();
 
-    return filters;
-}
+    tnt::JsonArray actions;
 
-void get_action(protocol::FlowAction* action, tnt::JsonArray& actions)
-{
-    if (tnt::visit<protocol::ToController>(action, [&] (auto /*a*/)
+    if (a.has(FlowActions::StripVlan))
     {
-        actions.add(tnt::JsonObject().add("OUTPUT", "CONTROLLER"));
-    }))
-    {
-        return;
+        actions.add(tnt::JsonObject().add("STRIP_VLAN", ""));
     }
 
-    if (tnt::visit<protocol::ToPorts>(action, [&] (auto a)
-    {
-        for (auto a : a->ports())
-        {
-            actions.add(tnt::JsonObject().add("OUTPUT", a));
-        }
-    }))
+    if (a.has(FlowActions::SetVlan))
     {
-        return;
+        actions.add(tnt::JsonObject().add("MOD_VLAN", a.vlan));
     }
 
-    if (tnt::visit<protocol::Loop>(action, [&] (auto /*a*/)
-    {
-        actions.add(tnt::JsonObject().add("OUTPUT", "IN_PORT"));
-    }))
+    if (a.has(FlowActions::SetHwSrc))
     {
-        return;
+        actions.add(tnt::JsonObject().add("MOD_HW_SRC", tnt::MacAddress(a.hw_src).to_string()));
     }
 
-    if (tnt::visit<protocol::Flood>(action, [&] (auto /*a*/)
+    if (a.has(FlowActions::SetHwDst))
     {
-        actions.add(tnt::JsonObject().add("OUTPUT", "FLOOD"));
-    }))
-    {
-        return;
+        actions.add(tnt::JsonObject().add("MOD_HW_DST", tnt::MacAddress(a.hw_dst).to_string()));
     }
 
-    if (tnt::visit<protocol::SetHwSrc>(action, [&] (auto a)
-    {
-        actions.add(tnt::JsonObject().add("MOD_HW_SRC", a->mac().to_string()));
-    }))
+    if (a.has(FlowActions::SetIpSrc))
     {
-        return;
+        actions.add(tnt::JsonObject().add("MOD_IP_SRC", tnt::ip::Address::from_net_order_ulong(a.ip_src).to_string()));
     }
 
-    tnt::visit<protocol::SetHwDst>(action, [&] (auto a)
+    if (a.has(FlowActions::SetIpDst))
     {
-        actions.add(tnt::JsonObject().add("MOD_HW_DST", a->mac().to_string()));
-    });
+        actions.add(tnt::JsonObject().add("MOD_IP_DST", tnt::ip::Address::from_net_order_ulong(a.ip_dst).to_string()));
+    }
 
-    if (tnt::visit<protocol::SetVlan>(action, [&] (auto a)
+    for (size_t i = 0; i < a.port_count; ++i)
     {
-        actions.add(tnt::JsonObject().add("MOD_VLAN", a->tag()));
-    }))
-    {
-        return;
+        actions.add(tnt::JsonObject().add("OUTPUT", a.ports[i]));
     }
 
-    if (tnt::is<protocol::StripVlan>(action))
+    if (a.has(FlowActions::Loop))
     {
-        actions.add(tnt::JsonObject().add("STRIP_VLAN", ""));
-
-        return;
+        actions.add(tnt::JsonObject().add("OUTPUT", "IN_PORT"));
     }
-}
 
-tnt::JsonArray flow_actions_to_json(const protocol::Flow& flow)
-{
-    tnt::JsonArray actions;
+    if (a.has(FlowActions::Flood))
+    {
+        actions.add(tnt::JsonObject().add("OUTPUT", "FLOOD"));
+    }
 
-    for (const auto& f : flow.actions())
+    if (a.has(FlowActions::Controller))
     {
-        get_action(f.get(), actions);
+        actions.add(tnt::JsonObject().add("OUTPUT", "CONTROLLER"));
     }
 
     return actions;
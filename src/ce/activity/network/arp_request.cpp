@@ -37,7 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "router/route.hpp"
 
-#include "util/arp_cache.hpp"
+#include "util/neighbor_table.hpp"
 
 #include "ip_address.hpp"
 #include "mac_address.hpp"
@@ -60,7 +60,13 @@ void ArpRequest::operator()()
 		{
 			if (r->destination() == dst)
 			{
-				auto mac = tnt::hw_from_arp(r->gateway().to_string());
+				tnt::MacAddress mac;
+
+				if (NeighborTable::instance().lookup(r->gateway().to_net_order_ulong(), mac) != NeighborTable::Lookup::Resolved)
+				{
+					throw std::invalid_argument("Error: The ip address is not resolved.");
+				}
+
 				tnt::Log::info(colors::blue, "Got an ARP request for ip ", dst, " => ", r->gateway(), " (", mac, ")");
 				proto->send(std::make_unique<message::ArpReply>(event_->ip(), mac));
 
@@ -70,7 +76,7 @@ void ArpRequest::operator()()
 	}
 	catch (const std::invalid_argument&)
 	{
-		// The IP is not in the ARP cache
+		// The IP is not in the neighbor table
 		// TODO: Send an ARP request for the IP event->ip() and send back the reply.
 
 		if (!proto.unique())
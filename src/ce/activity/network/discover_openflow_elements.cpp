@@ -74,7 +74,7 @@ void DiscoverOpenflowElements::operator()()
                 break;
             }
 
-            tnt::async([io] ()
+            tnt::async_activity([io] ()
             {
                 SetupServiceElement(std::make_shared<protocol::Openflow>(io))();
             });
@@ -73,7 +73,7 @@ void DiscoverServiceElements::operator()()
                 break;
             }
 
-            tnt::async([io] ()
+            tnt::async_activity([io] ()
             {
                 SetupServiceElement(factory::create_drop_protocol(io))();
             });
@@ -28,6 +28,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DROP_ACTIVITY_REMOVE_FLOW_HPP_
 #define DROP_ACTIVITY_REMOVE_FLOW_HPP_
 
+#include <memory>
+
 #include "protocol/openflow/flow.hpp"
 
 namespace tnt {
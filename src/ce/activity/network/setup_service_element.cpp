@@ -45,6 +45,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace drop {
 namespace activity {
 
+namespace {
+
+const tnt::ConfigKey<int> connection_timeout("connection.timeout");
+
+} // namespace
+
 SetupServiceElement::SetupServiceElement(const std::shared_ptr<tnt::Protocol>& proto): proto_(proto) {}
 
 void SetupServiceElement::operator()()
@@ -56,7 +62,7 @@ void SetupServiceElement::operator()()
         tnt::Application::raise(event::ServiceElementConnected(event->name(), event->address(), event->services(), proto_));
     });
 
-    auto timeout = tnt::Configuration::get("connection.timeout").as<int>();
+    auto timeout = connection_timeout.get();
     auto success = wait_event_for(std::chrono::milliseconds(timeout));
 
     if (success)
@@ -27,6 +27,8 @@
 #include "util/path.hpp"
 #include "util/io_factory.hpp"
 
+#include "io/reactor.hpp"
+
 #include "log.hpp"
 #include "async.hpp"
 #include "application.hpp"
@@ -55,7 +57,18 @@ int main(int argc, char* argv[])
 
         tnt::Log::level(tnt::Configuration::get("log.level").as<tnt::LogLevel>());
 
-        tnt::async([] ()
+        if (tnt::Configuration::exists("log.file"))
+        {
+            tnt::Log::file(tnt::Configuration::get("log.file").as<std::string>());
+        }
+
+        // The protocols run on a pool of epoll loops instead of two threads each, 0 loops for the default pool.
+        if (tnt::Configuration::exists("io.reactor_loops"))
+        {
+            tnt::io::Reactor::enable(tnt::Configuration::get("io.reactor_loops").as<size_t>());
+        }
+
+        tnt::async_activity([] ()
         {
             drop::parser::CeParser parser(std::cin, std::cout);
             parser();
@@ -63,7 +76,7 @@ int main(int argc, char* argv[])
 
         std::vector<std::future<void>> activities;
 
-        activities.push_back(tnt::async([] ()
+        activities.push_back(tnt::async_activity([] ()
         {
             drop::activity::ControlElement ce;
             ce();
@@ -0,0 +1,81 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DROP_EVENT_NEIGHBOR_EVENTS_HPP_
+#define DROP_EVENT_NEIGHBOR_EVENTS_HPP_
+
+#include <vector>
+#include <cstdint>
+
+#include "router/neighbor_info.hpp"
+
+namespace drop {
+namespace event {
+
+class NeighborList
+{
+public:
+    explicit NeighborList(const std::vector<NeighborInfo>& neighbors): neighbors_{ neighbors } { }
+    const std::vector<NeighborInfo>& neighbors() const { return neighbors_; }
+private:
+    std::vector<NeighborInfo> neighbors_;
+};
+
+class LocalNeighborAdded
+{
+public:
+    explicit LocalNeighborAdded(const NeighborInfo& neighbor): neighbor_{ neighbor } { }
+    const NeighborInfo& neighbor() const { return neighbor_; }
+private:
+    NeighborInfo neighbor_;
+};
+
+class LocalNeighborRemoved
+{
+public:
+    explicit LocalNeighborRemoved(const NeighborInfo& neighbor): neighbor_{ neighbor } { }
+    const NeighborInfo& neighbor() const { return neighbor_; }
+private:
+    NeighborInfo neighbor_;
+};
+
+class ResolveNeighbor
+{
+public:
+    ResolveNeighbor(uint32_t address, uint32_t port_index): address_{ address }, port_index_{ port_index } { }
+
+    uint32_t address() const { return address_; }
+    uint32_t port_index() const { return port_index_; }
+private:
+    uint32_t address_;
+    uint32_t port_index_;
+};
+
+} // namespace event
+} // namespace drop
+
+#endif
@@ -97,6 +97,25 @@ void ServiceElement::send(std::unique_ptr<tnt::Message>&& message)
     }
 }
 
+void ServiceElement::add_port(uint32_t index, uint32_t port)
+{
+    ports_[index] = port;
+}
+
+bool ServiceElement::port(uint32_t index, uint32_t& port) const
+{
+    auto it = ports_.find(index);
+
+    if (it == std::end(ports_))
+    {
+        return false;
+    }
+
+    port = it->second;
+
+    return true;
+}
+
 void ServiceElement::set_services(const std::vector<std::string>& services)
 {
     services_.reserve(services.size());
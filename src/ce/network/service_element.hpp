@@ -31,7 +31,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <memory>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <iosfwd>
+#include <cstdint>
 
 namespace tnt {
 
@@ -63,6 +65,11 @@ public:
     bool connected() const;
 
     void send(std::unique_ptr<tnt::Message>&& message);
+
+    // The CE interface with index is the port of this element, as in network.xml.
+    void add_port(uint32_t index, uint32_t port);
+    // The port of this element for the CE interface with index, false if the interface is on another element.
+    bool port(uint32_t index, uint32_t& port) const;
 private:
     void set_services(const std::vector<std::string>& services);
 private:
@@ -73,6 +80,7 @@ private:
     bool force_connected_;
 
     std::shared_ptr<tnt::Protocol> proto_;
+    std::unordered_map<uint32_t, uint32_t> ports_; // By CE interface index.
 };
 
 std::ostream& operator<<(std::ostream& os, const ServiceElement& element);
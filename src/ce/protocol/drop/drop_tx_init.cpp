@@ -73,6 +73,11 @@ void Drop::register_messages()
         write(create_packet(DropMessage::AddUserspaceRoute, message->route(), message->mac()));
     });
 
+    register_message<message::AddUserspaceRoutes>([this] (auto message)
+    {
+        write(create_packet(DropMessage::AddUserspaceRoutes, message->routes()));
+    });
+
     register_message<message::DelRoute>([this] (auto message)
     {
         write(create_packet(DropMessage::DelRoute, message->route()));
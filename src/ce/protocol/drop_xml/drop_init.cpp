@@ -57,6 +57,7 @@ void DropXml::register_messages()
 	register_out_message<message::ArpReply>();
     register_out_message<message::AddKernelRoute>();
     register_out_message<message::AddUserspaceRoute>();
+    register_out_message<message::AddUserspaceRoutes>();
     register_out_message<message::DelRoute>();
     register_out_message<message::PortStatsRequest>();
 }
@@ -89,6 +89,11 @@ std::string create_packet(const message::AddUserspaceRoute*  /*message*/)
     return "";
 }
 
+std::string create_packet(const message::AddUserspaceRoutes*  /*message*/)
+{
+    return "";
+}
+
 std::string create_packet(const message::DelRoute*  /*message*/)
 {
     return "";
@@ -42,6 +42,7 @@ class InterfaceList;
 class ArpReply;
 class AddKernelRoute;
 class AddUserspaceRoute;
+class AddUserspaceRoutes;
 class DelRoute;
 class PortStatsRequest;
 
@@ -58,6 +59,7 @@ std::string create_packet(const message::InterfaceList* message);
 std::string create_packet(const message::ArpReply* message);
 std::string create_packet(const message::AddKernelRoute* message);
 std::string create_packet(const message::AddUserspaceRoute* message);
+std::string create_packet(const message::AddUserspaceRoutes* message);
 std::string create_packet(const message::DelRoute* message);
 std::string create_packet(const message::PortStatsRequest* message);
 
@@ -33,16 +33,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <poll.h>
 
 #include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
 #include <sys/socket.h> // for sa_family_t
 #include <net/if_arp.h>
 
 #include "protocol/netlink/netlink_utils.hpp"
 
 #include "router/port_info.hpp"
+#include "router/neighbor_info.hpp"
 
 #include "event/network/address_events.hpp"
 #include "event/network/port_events.hpp"
 #include "event/network/route_events.hpp"
+#include "event/network/neighbor_events.hpp"
 
 #include "demangle.hpp"
 #include "mac_address.hpp"
@@ -146,6 +149,23 @@ int KernelNetlinkProtocol::send_and_parse(const std::string& data)
                         tnt::Application::raise(event::RouteList(parse_multi<RouteInfo>(messages, route_parser)), this);
                         break;
 
+                    case RTM_NEWNEIGH:
+                        {
+                            std::vector<NeighborInfo> learnt;
+
+                            for (const auto& n : parse_multi<NeighborInfo>(messages, neighbor_parser))
+                            {
+                                if (learn(n))
+                                {
+                                    learnt.push_back(n);
+                                }
+                            }
+
+                            tnt::Application::raise(event::NeighborList(learnt), this);
+                        }
+
+                        break;
+
                     default:
                         break;
                     }
@@ -514,6 +534,36 @@ std::string KernelNetlinkProtocol::build_route(NetlinkRouteOpType type, const Ro
     return std::string(reinterpret_cast<char*>(&req), req.nl_hdr.nlmsg_len);
 }
 
+std::string KernelNetlinkProtocol::build_resolve_neighbor(uint32_t address, uint32_t port_index)
+{
+    struct
+    {
+        nlmsghdr nl_hdr;
+        ndmsg nd_msg;
+        char buf[64];
+    } req;
+
+    memset(&req, 0, sizeof(req));
+
+    req.nl_hdr.nlmsg_len = NLMSG_LENGTH(sizeof(req.nd_msg));
+    req.nl_hdr.nlmsg_type = RTM_NEWNEIGH;
+    req.nl_hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | NLM_F_CREATE | NLM_F_REPLACE;
+    req.nl_hdr.nlmsg_pid = cmd_local_addr_.nl_pid;
+    req.nl_hdr.nlmsg_seq = ++seq_num;
+
+    // Same as "ip neigh replace ... use": the kernel starts the resolution as for an outgoing packet,
+    // the state of an existing entry is left alone.
+    req.nd_msg.ndm_family = AF_INET;
+    req.nd_msg.ndm_ifindex = port_index;
+    req.nd_msg.ndm_state = NUD_NONE;
+    req.nd_msg.ndm_flags = NTF_USE;
+
+    addattr_32(&req.nl_hdr, sizeof(req), NDA_DST, address);
+    assert(req.nl_hdr.nlmsg_len > 0);
+
+    return std::string(reinterpret_cast<char*>(&req), req.nl_hdr.nlmsg_len);
+}
+
 } // namespace protocol
 } // namespace drop
 
@@ -37,6 +37,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "protocol/netlink/values.hpp"
 
 namespace drop {
+
+struct NeighborInfo;
+
 namespace protocol {
 
 class KernelNetlinkProtocol: public NetlinkProtocol
@@ -45,7 +48,8 @@ class KernelNetlinkProtocol: public NetlinkProtocol
     {
         Links = RTM_GETLINK,
         Routes = RTM_GETROUTE,
-        Addresses = RTM_GETADDR
+        Addresses = RTM_GETADDR,
+        Neighbors = RTM_GETNEIGH
     };
 
     enum class NetlinkPortOpType: uint8_t
@@ -73,6 +77,10 @@ private:
     std::string build_vlan(uint16_t vlan_id, uint16_t link, const std::string& name);
     std::string build_address(NetlinkAddrOpType type, const AddressInfo& addr);
     std::string build_route(NetlinkRouteOpType type, const RouteInfo& route);
+    std::string build_resolve_neighbor(uint32_t address, uint32_t port_index);
+
+    // Copies a resolved neighbor in the NeighborTable, returns true if it is new or changed.
+    bool learn(const NeighborInfo& neighbor);
 private:
     static int seq_num;
 
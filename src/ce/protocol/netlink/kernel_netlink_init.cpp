@@ -27,14 +27,21 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "kernel_netlink.hpp"
 
+#include <linux/neighbour.h>
+
 #include "event/network/address_events.hpp"
 #include "event/network/port_events.hpp"
 #include "event/network/route_events.hpp"
+#include "event/network/neighbor_events.hpp"
 
 #include "message/network/management.hpp"
 
 #include "protocol/netlink/netlink_utils.hpp"
 
+#include "router/neighbor_info.hpp"
+
+#include "util/neighbor_table.hpp"
+
 #include "log.hpp"
 #include "application.hpp"
 
@@ -107,7 +114,7 @@ void KernelNetlinkProtocol::setup_sockets()
     sockaddr_nl addr = sockaddr_nl();
     addr.nl_pid = getpid() + 1;
     addr.nl_family = AF_NETLINK;
-    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_ROUTE | RTMGRP_IPV4_IFADDR; // | RTMGRP_NOTIFY;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_ROUTE | RTMGRP_IPV4_IFADDR | RTMGRP_NEIGH; // | RTMGRP_NOTIFY;
 
     if (bind(rx_sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
     {
@@ -187,6 +194,33 @@ void KernelNetlinkProtocol::register_netlink_handlers()
 
         tnt::Application::raise(event::LocalRouteRemoved(route_parser(nlh, true, netlink_debug)), this);
     });
+
+    event_dispatcher_.register_listener(RTM_NEWNEIGH, [this] (const nlmsghdr* nlh)
+    {
+        auto neighbor = neighbor_parser(nlh, true, netlink_debug);
+
+        if (learn(neighbor))
+        {
+            tnt::Application::raise(event::LocalNeighborAdded(neighbor), this);
+        }
+        else if (neighbor.state & NUD_FAILED)
+        {
+            NeighborTable::instance().remove(neighbor.address);
+        }
+    });
+
+    event_dispatcher_.register_listener(RTM_DELNEIGH, [this] (const nlmsghdr* nlh)
+    {
+        auto neighbor = neighbor_parser(nlh, true, netlink_debug);
+
+        NeighborTable::instance().remove(neighbor.address);
+        tnt::Application::raise(event::LocalNeighborRemoved(neighbor), this);
+    });
+}
+
+bool KernelNetlinkProtocol::learn(const NeighborInfo& neighbor)
+{
+    return resolved(neighbor) && NeighborTable::instance().update(neighbor.address, neighbor.mac);
 }
 
 void KernelNetlinkProtocol::register_message_handlers()
@@ -206,6 +240,22 @@ void KernelNetlinkProtocol::register_message_handlers()
             tnt::Log::error("GetRoutes Failed");
         }
     });
+
+    message_dispatcher_.register_listener<message::GetNeighbors>([this] (message::GetNeighbors* /*message*/)
+    {
+        if (send_and_parse(build_dump(NetlinkDumpType::Neighbors, protocol::NetlinkFamily::Inet)))
+        {
+            tnt::Log::error("GetNeighbors Failed");
+        }
+    });
+
+    message_dispatcher_.register_listener<message::ResolveNeighbor>([this] (message::ResolveNeighbor* message)
+    {
+        if (send_and_parse(build_resolve_neighbor(message->address(), message->port_index())))
+        {
+            tnt::Log::error("ResolveNeighbor Failed");
+        }
+    });
 }
 
 } // namespace protocol
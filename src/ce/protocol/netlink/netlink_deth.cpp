@@ -60,7 +60,7 @@ enum message_type
 
 NetlinkDethProtocol::NetlinkDethProtocol(const std::shared_ptr<tnt::IO>& io): AsyncProtocol(io) {}
 
-void NetlinkDethProtocol::invoke_message(const std::string& message)
+void NetlinkDethProtocol::invoke_message(tnt::BufferView message)
 {
     size_t len = message.size();
 
@@ -86,12 +86,12 @@ void NetlinkDethProtocol::invoke_message(const std::string& message)
     }
 }
 
-std::vector<std::string> NetlinkDethProtocol::parse(std::string& raw_input)
+size_t NetlinkDethProtocol::parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages)
 {
-    std::vector<std::string> messages{ raw_input };
-    raw_input.clear();
+    // Each read is a whole netlink datagram.
+    messages.push_back(input);
 
-    return messages;
+    return input.size();
 }
 
 void NetlinkDethProtocol::register_messages()
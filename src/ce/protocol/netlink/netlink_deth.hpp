@@ -51,8 +51,8 @@ class NetlinkDethProtocol: public tnt::protocol::AsyncProtocol
 public:
     explicit NetlinkDethProtocol(const std::shared_ptr<tnt::IO>& io);
 private:
-    virtual std::vector<std::string> parse(std::string& raw_input) override; //! raw_input is passed by non const reference, so parse function can modify it.
-    virtual void invoke_message(const std::string& data) override;
+    virtual size_t parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages) override;
+    virtual void invoke_message(tnt::BufferView data) override;
     virtual void register_messages() override;
 
 	// Messages handlers
@@ -32,8 +32,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 
 #include "event/network/service_element_data.hpp"
+#include "event/network/packet_in.hpp"
 
 #include "protocol/openflow/openflow_version.hpp"
+#include "protocol/openflow/flow_factory.hpp"
 
 #include "application.hpp"
 
@@ -45,6 +47,16 @@ void Openflow::set_features(uint64_t datapath_id)
     tnt::Application::raise(std::make_shared<event::ServiceElementData>(std::to_string(datapath_id), "", std::vector<std::string>{ "Interconnection", "OpenflowManagement", "PortStatusNotification" }), this);
 
     protocol_->remove_all();
+    start_stats_poller();
+}
+
+void Openflow::packet_in(uint32_t buffer_id, uint16_t in_port, const char* frame, size_t size)
+{
+    // The buffer id goes with the flow, so that a flow-mod in answer releases the buffered packet.
+    Flow flow;
+    flow.add(from_port(in_port)).add(buffer(buffer_id));
+
+    tnt::Application::raise(event::PacketIn(flow, std::string(frame, size)), this);
 }
 
 } // namespace protocol
@@ -39,12 +39,12 @@ void Openflow::register_messages()
 {
     register_message<message::AddFlow>([this] (auto message)
     {
-        add(message->flow());
+        add(message->flow(), std::move(message->confirmation()));
     });
 
     register_message<message::RemoveFlow>([this] (auto message)
     {
-        remove(message->flow());
+        remove(message->flow(), std::move(message->confirmation()));
     });
 
     register_message<message::ModifyPort>([this] (auto /*message*/)
@@ -28,11 +28,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DROP_SERVICE_FORWARDING_HPP_
 #define DROP_SERVICE_FORWARDING_HPP_
 
+#include <vector>
+
 #include "service/service.hpp"
 
+#include "router/route_info.hpp"
+
 namespace drop {
 
-struct RouteInfo;
+struct NeighborInfo;
 
 namespace service {
 
@@ -40,6 +44,19 @@ struct Forwarding: public virtual Service
 {
     virtual void add(const RouteInfo& route) = 0;
     virtual void remove(const RouteInfo& route) = 0;
+
+    // Used to program a whole table in one message, e.g. when a new element connects. The
+    // routes are applied one by one, the forwarding threads may see a part of them.
+    virtual void add_batch(const std::vector<RouteInfo>& routes)
+    {
+        for (const auto& r : routes)
+        {
+            add(r);
+        }
+    }
+
+    // Called when the kernel resolves a neighbor or its MAC changes, e.g. the gateway of routes waiting for it.
+    virtual void neighbor_added(const NeighborInfo& /*neighbor*/) {}
 };
 
 } // namespace service
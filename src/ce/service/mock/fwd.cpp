@@ -27,14 +27,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "fwd.hpp"
 
+#include "event/network/neighbor_events.hpp"
+
 #include "network/service_element.hpp"
 
 #include "router/route_info.hpp"
 
-#include "util/arp_cache.hpp"
+#include "util/neighbor_table.hpp"
 
 #include "ip_address.hpp"
 #include "mac_address.hpp"
+#include "application.hpp"
 #include "log.hpp"
 
 namespace drop {
@@ -76,7 +79,22 @@ void MockForwarding::add(const RouteInfo& route)
         return;
     }
 
-    table_.add(route.destination, route.prefix, tnt::hw_from_arp(ip.to_string()));
+    tnt::MacAddress mac;
+    auto state = NeighborTable::instance().lookup(route.gateway, mac);
+
+    if (state != NeighborTable::Lookup::Resolved)
+    {
+        tnt::Log::info(colors::red, "Gateway ", ip, " not resolved, route ", on_link_route(route), " not added");
+
+        if (state == NeighborTable::Lookup::Unresolved)
+        {
+            tnt::Application::raise(event::ResolveNeighbor(route.gateway, route.port_index));
+        }
+
+        return;
+    }
+
+    table_.add(route.destination, route.prefix, mac, 0);
 }
 
 void MockForwarding::remove(const RouteInfo& route)
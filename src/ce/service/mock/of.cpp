@@ -31,12 +31,23 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "network/service_element.hpp"
 
-#include "containers.hpp"
 #include "memory.hpp"
 #include "log.hpp"
 
 namespace drop {
 namespace service {
+namespace {
+
+// No switch behind the mock, every flow-mod is confirmed right away.
+std::future<void> confirmed()
+{
+    std::promise<void> promise;
+    promise.set_value();
+
+    return promise.get_future();
+}
+
+} // namespace
 
 MockOpenflowManagement::MockOpenflowManagement(ce::ServiceElement* /*parent*/) {}
 
@@ -47,22 +58,23 @@ std::ostream& MockOpenflowManagement::print(std::ostream& os) const
     return os;
 }
 
-void MockOpenflowManagement::add(const protocol::Flow& flow)
+std::future<void> MockOpenflowManagement::add(const protocol::Flow& flow)
 {
-    if (!tnt::contains(flows_, flow))
-    {
-        flows_.push_back(flow);
-    }
+    flows_.add(flow);
+
+    return confirmed();
 }
 
-void MockOpenflowManagement::remove(const protocol::Flow& flow)
+std::future<void> MockOpenflowManagement::remove(const protocol::Flow& flow)
 {
-    flows_.erase(std::remove(std::begin(flows_), std::end(flows_), flow), std::end(flows_));
+    flows_.remove(flow);
+
+    return confirmed();
 }
 
 const std::vector<protocol::Flow>& MockOpenflowManagement::flows() const
 {
-    return flows_;
+    return flows_.flows();
 }
 
 } // namespace service
@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 
 #include "protocol/openflow/flow.hpp"
+#include "protocol/openflow/flow_table.hpp"
 
 #include "service/service.hpp"
 #include "service/openflow.hpp"
@@ -48,12 +49,12 @@ public:
 
     virtual std::ostream& print(std::ostream& os) const override;
 
-    virtual void add(const protocol::Flow& flow) override;
-    virtual void remove(const protocol::Flow& flow) override;
+    virtual std::future<void> add(const protocol::Flow& flow) override;
+    virtual std::future<void> remove(const protocol::Flow& flow) override;
 
     virtual const std::vector<protocol::Flow>& flows() const override;
 private:
-    std::vector<protocol::Flow> flows_;
+    protocol::FlowTable flows_;
 };
 
 } // namespace service
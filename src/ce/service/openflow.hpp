@@ -28,6 +28,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DROP_SERVICE_OPENFLOW_HPP_
 #define DROP_SERVICE_OPENFLOW_HPP_
 
+#include <future>
+
 #include "service/service.hpp"
 
 #include "protocol/openflow/flow.hpp"
@@ -38,8 +40,9 @@ namespace service {
 struct Openflow: public virtual Service
 {
     virtual ~Openflow() = default;
-    virtual void add(const protocol::Flow& flow) = 0;
-    virtual void remove(const protocol::Flow& flow) = 0;
+    // The futures are ready when the switch confirms the flow-mod, or hold the error it replied with.
+    virtual std::future<void> add(const protocol::Flow& flow) = 0;
+    virtual std::future<void> remove(const protocol::Flow& flow) = 0;
     virtual const std::vector<protocol::Flow>& flows() const = 0;
 };
 
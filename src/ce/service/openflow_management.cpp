@@ -33,8 +33,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "network/service_element.hpp"
 
-#include "containers.hpp"
-
 namespace drop {
 namespace service {
 
@@ -47,25 +45,32 @@ std::ostream& OpenflowManagement::print(std::ostream& os) const
     return os;
 }
 
-void OpenflowManagement::add(const protocol::Flow& flow)
+std::future<void> OpenflowManagement::add(const protocol::Flow& flow)
 {
-	parent_->send(std::make_unique<message::AddFlow>(flow));
+    auto message = std::make_unique<message::AddFlow>(flow);
+    auto confirmed = message->confirmed();
+
+	parent_->send(std::move(message));
     
-    if (!tnt::contains(flows_, flow))
-    {
-        flows_.push_back(flow);
-    }
+    flows_.add(flow);
+
+    return confirmed;
 }
 
-void OpenflowManagement::remove(const protocol::Flow& flow)
+std::future<void> OpenflowManagement::remove(const protocol::Flow& flow)
 {
-    parent_->send(std::make_unique<message::RemoveFlow>(flow));
-    flows_.erase(std::remove(std::begin(flows_), std::end(flows_), flow), std::end(flows_));
+    auto message = std::make_unique<message::RemoveFlow>(flow);
+    auto confirmed = message->confirmed();
+
+    parent_->send(std::move(message));
+    flows_.remove(flow);
+
+    return confirmed;
 }
 
 const std::vector<protocol::Flow>& OpenflowManagement::flows() const
 {
-    return flows_;
+    return flows_.flows();
 }
 
 } // namespace service
@@ -34,6 +34,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "service/service.hpp"
 #include "service/openflow.hpp"
 
+#include "protocol/openflow/flow_table.hpp"
+
 namespace drop {
 namespace service {
 
@@ -47,13 +49,13 @@ public:
 
     virtual std::ostream& print(std::ostream& os) const override;
 
-    virtual void add(const protocol::Flow& flow) override;
-    virtual void remove(const protocol::Flow& flow) override;
+    virtual std::future<void> add(const protocol::Flow& flow) override;
+    virtual std::future<void> remove(const protocol::Flow& flow) override;
 
     virtual const std::vector<protocol::Flow>& flows() const override;
 private:
     ce::ServiceElement* parent_;
-    std::vector<protocol::Flow> flows_;
+    protocol::FlowTable flows_;
 };
 
 } // namespace service
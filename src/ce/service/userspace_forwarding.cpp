@@ -28,26 +28,35 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "userspace_forwarding.hpp"
 
 #include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "event/network/neighbor_events.hpp"
 
 #include "message/network/management.hpp"
 
 #include "network/service_element.hpp"
 
-#include "util/arp_cache.hpp"
+#include "router/neighbor_info.hpp"
+
+#include "util/neighbor_table.hpp"
 
-#include "ip_address.hpp"
 #include "mac_address.hpp"
+#include "application.hpp"
+#include "lock.hpp"
 #include "log.hpp"
 
 namespace drop {
 namespace service {
 namespace {
 
-RouteInfo on_link_route(const RouteInfo& route)
+// With the port of the SE in port_index.
+RouteInfo on_link_route(const RouteInfo& route, uint32_t port)
 {
     RouteInfo ri;
     ri.origin = RouteOrigin::Kernel;
-    ri.port_index = route.port_index;
+    ri.port_index = port;
     ri.prefix = route.prefix;
     ri.destination = route.destination;
     ri.gateway = 0;
@@ -69,21 +78,135 @@ std::ostream& UserspaceForwarding::print(std::ostream& os) const
 
 void UserspaceForwarding::add(const RouteInfo& route)
 {
-    auto ip = tnt::ip::Address::from_net_order_ulong(route.gateway);
+    std::vector<std::pair<RouteInfo, tnt::MacAddress>> batch;
+    resolve(route, batch);
+
+    if (batch.empty())
+    {
+        return;
+    }
+
+    parent_->send(std::make_unique<message::AddUserspaceRoute>(batch.front().first, batch.front().second));
+}
+
+void UserspaceForwarding::add_batch(const std::vector<RouteInfo>& routes)
+{
+    std::vector<std::pair<RouteInfo, tnt::MacAddress>> batch;
+    batch.reserve(routes.size());
 
-    if (ip.is_any())
+    for (const auto& route : routes)
+    {
+        resolve(route, batch);
+    }
+
+    if (batch.empty())
     {
         return;
     }
 
-    auto mac = tnt::hw_from_arp(ip.to_string());
-    parent_->send(std::make_unique<message::AddUserspaceRoute>(on_link_route(route), mac));
+    parent_->send(std::make_unique<message::AddUserspaceRoutes>(batch));
 }
 
 void UserspaceForwarding::remove(const RouteInfo& route)
 {
+    tnt::lock(mutex_, [&] ()
+    {
+        auto range = routes_.equal_range(route.gateway);
+
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second.destination == route.destination && it->second.prefix == route.prefix)
+            {
+                routes_.erase(it);
+
+                break;
+            }
+        }
+    });
+
     parent_->send(std::make_unique<message::DelRoute>(route));
 }
 
+void UserspaceForwarding::neighbor_added(const NeighborInfo& neighbor)
+{
+    std::vector<std::pair<RouteInfo, tnt::MacAddress>> batch;
+
+    tnt::lock(mutex_, [&] ()
+    {
+        auto range = routes_.equal_range(neighbor.address);
+
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            uint32_t port;
+
+            if (se_port(it->second, port))
+            {
+                batch.emplace_back(on_link_route(it->second, port), neighbor.mac);
+            }
+        }
+    });
+
+    if (batch.empty())
+    {
+        return;
+    }
+
+    tnt::Log::info(colors::cyan, "Neighbor ", neighbor, " resolved, installing ", batch.size(), " routes");
+
+    parent_->send(std::make_unique<message::AddUserspaceRoutes>(batch));
+}
+
+bool UserspaceForwarding::se_port(const RouteInfo& route, uint32_t& port) const
+{
+    // The SE does not know the CE interfaces: a route is sent with the SE port of its interface.
+    if (!parent_->port(route.port_index, port))
+    {
+        tnt::Log::debug("UserspaceForwarding: interface ", route.port_index, " of route ", route, " is not a port of ", parent_->display_name(), ", route not sent.");
+
+        return false;
+    }
+
+    return true;
+}
+
+void UserspaceForwarding::resolve(const RouteInfo& route, std::vector<std::pair<RouteInfo, tnt::MacAddress>>& batch)
+{
+    uint32_t port;
+
+    if (route.gateway == 0 || !se_port(route, port))
+    {
+        return;
+    }
+
+    tnt::lock(mutex_, [&] ()
+    {
+        auto range = routes_.equal_range(route.gateway);
+
+        if (std::none_of(range.first, range.second, [&] (const auto& r) { return r.second.destination == route.destination && r.second.prefix == route.prefix; }))
+        {
+            routes_.emplace(route.gateway, route);
+        }
+    });
+
+    tnt::MacAddress mac;
+
+    switch (NeighborTable::instance().lookup(route.gateway, mac))
+    {
+    case NeighborTable::Lookup::Resolved:
+        batch.emplace_back(on_link_route(route, port), mac);
+        break;
+
+    case NeighborTable::Lookup::Unresolved:
+        tnt::Application::raise(event::ResolveNeighbor(route.gateway, route.port_index));
+        break;
+
+    case NeighborTable::Lookup::Resolving:
+        break;
+
+    default:
+        break;
+    }
+}
+
 } // namespace service
 } // namespace drop
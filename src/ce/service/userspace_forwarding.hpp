@@ -28,13 +28,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DROP_SERVICE_NETMAP_FORWARDING_HPP_
 #define DROP_SERVICE_NETMAP_FORWARDING_HPP_
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <mutex>
+
 #include "service/service.hpp"
 #include "service/forwarding.hpp"
 
-namespace drop {
+#include "router/route_info.hpp"
 
-struct RouteInfo;
+#include "mac_address.hpp"
 
+namespace drop {
 namespace service {
 
 constexpr const char nfn[] = "UserspaceForwarding";
@@ -47,9 +53,19 @@ public:
     virtual std::ostream& print(std::ostream& os) const override;
 
     virtual void add(const RouteInfo& route) override;
+    virtual void add_batch(const std::vector<RouteInfo>& routes) override;
     virtual void remove(const RouteInfo& route) override;
+    virtual void neighbor_added(const NeighborInfo& neighbor) override;
+private:
+    // Appends the route to batch if its gateway is resolved, otherwise the route waits for it.
+    void resolve(const RouteInfo& route, std::vector<std::pair<RouteInfo, tnt::MacAddress>>& batch);
+    // The port of the SE for the interface of the route, false if the SE does not have it.
+    bool se_port(const RouteInfo& route, uint32_t& port) const;
 private:
     ce::ServiceElement* parent_;
+
+    std::mutex mutex_;
+    std::unordered_multimap<uint32_t, RouteInfo> routes_; // By gateway, sent again when its MAC changes.
 };
 
 } // namespace service
@@ -43,12 +43,32 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "application.hpp"
 #include "log.hpp"
 #include "function_pointer_traits.hpp"
-#include "thread_safe_fifo.hpp"
+#include "mpsc_queue.hpp"
+#include "memory_pool.hpp"
 
 namespace tnt {
 
 class ConcurrentActivity
 {
+    // A handler bound to its event, allocated from the pool.
+    struct HandlerObject: PoolAllocated
+    {
+        virtual ~HandlerObject() {}
+        virtual void call() = 0;
+    };
+
+    template <class F, class E> struct Handler: HandlerObject
+    {
+        Handler(const F& f, const E& e) : func(f), event(e) {}
+
+        virtual void call() override
+        {
+            func(event);
+        }
+
+        F func;
+        E event;
+    };
 public:
     ConcurrentActivity() = default;
     ~ConcurrentActivity();
@@ -56,16 +76,16 @@ protected:
     void wait_event()
     {
         auto handler = handlers_.pop();
-        handler();
+        handler->call();
     }
 
     template <class D> bool wait_event_for(D duration)
     {
-        std::function<void()> handler;
+        std::unique_ptr<HandlerObject> handler;
 
         if (handlers_.pop_for(handler, duration))
         {
-            handler();
+            handler->call();
 
             return true;
         }
@@ -102,16 +122,13 @@ private:
     {
         tokens_.push_back(tnt::Application::subscribe([=] (E event)
         {
-            handlers_.push([=] ()
-            {
-                func(event);
-            });
+            handlers_.push(std::make_unique<Handler<std::decay_t<F>, std::decay_t<E>>>(func, event));
         },
         src));
     }
 private:
     std::vector<tnt::Application::Token> tokens_;
-    tnt::ThreadSafeFIFO<std::function<void()>> handlers_;
+    tnt::MPSCQueue<std::unique_ptr<HandlerObject>> handlers_;
 };
 
 } // namespace tnt
@@ -0,0 +1,369 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "asset_cache.hpp"
+
+#include <fstream>
+#include <thread>
+#include <cstdio>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include <zlib.h>
+
+#include <boost/filesystem.hpp>
+
+#include "log.hpp"
+
+namespace tnt {
+namespace activity {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// Larger files are read from disk on every request.
+const uintmax_t max_asset_size = 8 * 1024 * 1024;
+
+const uint32_t watch_mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+bool compressible(const std::string& type)
+{
+    return type.compare(0, 5, "text/") == 0 || type == "application/x-javascript" || type == "application/json" || type == "image/svg+xml";
+}
+
+std::shared_ptr<const std::string> gzip(const std::string& data)
+{
+    z_stream stream{};
+
+    // 16 more window bits write the gzip header and trailer.
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return nullptr;
+    }
+
+    std::string out(deflateBound(&stream, data.size()), '\0');
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    auto result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return result == Z_STREAM_END ? std::make_shared<const std::string>(std::move(out)) : nullptr;
+}
+
+std::string etag(const std::string& data)
+{
+    char tag[32];
+    auto crc = ::crc32(0, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size()));
+
+    std::snprintf(tag, sizeof(tag), "\"%08lx-%zx\"", static_cast<unsigned long>(crc), data.size());
+
+    return tag;
+}
+
+std::shared_ptr<const Asset> load(const std::string& path)
+{
+    boost::system::error_code ec;
+
+    if (!fs::is_regular_file(path, ec) || fs::file_size(path, ec) > max_asset_size || ec)
+    {
+        return nullptr;
+    }
+
+    std::ifstream is(path, std::ifstream::binary);
+
+    if (!is)
+    {
+        return nullptr;
+    }
+
+    is.seekg(0, is.end);
+    auto length = is.tellg();
+    is.seekg(0, is.beg);
+
+    auto body = std::string(static_cast<size_t>(length), '\0');
+
+    if (!is.read(&body[0], length))
+    {
+        return nullptr;
+    }
+
+    auto asset = std::make_shared<Asset>();
+
+    asset->content_type = content_type(path);
+    asset->etag = etag(body);
+
+    if (compressible(asset->content_type))
+    {
+        auto compressed = gzip(body);
+
+        // Kept if it saves a tenth at least.
+        if (compressed && compressed->size() < body.size() - body.size() / 10)
+        {
+            asset->gzip = compressed;
+            asset->gzip_etag = asset->etag.substr(0, asset->etag.size() - 1) + "-gz\"";
+        }
+    }
+
+    asset->body = std::make_shared<const std::string>(std::move(body));
+
+    return asset;
+}
+
+} // namespace
+
+std::string content_type(const std::string& path)
+{
+    const auto& ext = fs::extension(path);
+
+    if (ext == ".html" || ext == ".htm")
+        return "text/html";
+    if (ext == ".xml")
+        return "text/xml";
+    if (ext == ".jpe" || ext == ".jpeg" || ext == ".jpg")
+        return "image/jpeg";
+    if (ext == ".png")
+        return "image/png";
+    if (ext == ".gif")
+        return "image/gif";
+    if (ext == ".svg")
+        return "image/svg+xml";
+    if (ext == ".js")
+        return "application/x-javascript";
+    if (ext == ".json")
+        return "application/json";
+    if (ext == ".css")
+        return "text/css";
+
+    return "application/octet-stream";
+}
+
+AssetCache::AssetCache(): changes_{ 0 }, inotify_(::inotify_init1(IN_CLOEXEC))
+{
+    if (inotify_ < 0)
+    {
+        Log::error("AssetCache: inotify_init1 error ", errno, ", the files are read on every request");
+
+        return;
+    }
+
+    std::thread([this] () { run(); }).detach();
+}
+
+AssetCache& AssetCache::instance()
+{
+    // Never destroyed: its thread waits on inotify until the exit.
+    static auto cache = new AssetCache();
+
+    return *cache;
+}
+
+std::shared_ptr<const Asset> AssetCache::get(const std::string& root, const std::string& path)
+{
+    uint64_t seen = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+
+        if (inotify_ < 0)
+        {
+            return nullptr;
+        }
+
+        if (roots_.insert(root).second)
+        {
+            load_root(root);
+        }
+
+        auto it = assets_.find(path);
+
+        if (it != std::end(assets_))
+        {
+            return it->second;
+        }
+
+        seen = changes_;
+    }
+
+    // Created after the root was loaded, or changed since.
+    auto asset = load(path);
+
+    if (asset)
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+
+        if (inotify_ >= 0 && changes_ == seen)
+        {
+            assets_.emplace(path, asset);
+        }
+    }
+
+    return asset;
+}
+
+void AssetCache::load_root(const std::string& root)
+{
+    boost::system::error_code ec;
+
+    if (!fs::is_directory(root, ec))
+    {
+        return;
+    }
+
+    watch(root);
+
+    size_t size = 0;
+    fs::recursive_directory_iterator end;
+
+    for (fs::recursive_directory_iterator it(root, ec); it != end && !ec; it.increment(ec))
+    {
+        auto path = it->path().string();
+
+        if (auto asset = load(path))
+        {
+            size += asset->body->size() + (asset->gzip ? asset->gzip->size() : 0);
+            assets_.emplace(path, asset);
+        }
+    }
+
+    Log::debug("AssetCache: ", root, " loaded, ", assets_.size(), " files in ", size, " bytes");
+}
+
+void AssetCache::watch(const std::string& dir)
+{
+    auto wd = ::inotify_add_watch(inotify_, dir.c_str(), watch_mask);
+
+    if (wd < 0)
+    {
+        Log::error("AssetCache: inotify_add_watch error ", errno, " on ", dir);
+
+        return;
+    }
+
+    dirs_[wd] = dir;
+
+    boost::system::error_code ec;
+    fs::directory_iterator end;
+
+    for (fs::directory_iterator it(dir, ec); it != end && !ec; it.increment(ec))
+    {
+        if (fs::is_directory(it->status()))
+        {
+            watch(it->path().string());
+        }
+    }
+}
+
+void AssetCache::invalidate(const std::string& path)
+{
+    ++changes_;
+    assets_.erase(path);
+
+    // The files of a directory moved or deleted.
+    auto prefix = path + "/";
+
+    for (auto it = std::begin(assets_); it != std::end(assets_);)
+    {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? assets_.erase(it) : std::next(it);
+    }
+}
+
+void AssetCache::run()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (true)
+    {
+        auto length = ::read(inotify_, buffer, sizeof(buffer));
+
+        if (length < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(guard_);
+
+        if (length <= 0)
+        {
+            // Without the events the copies may go stale, they are given up.
+            Log::error("AssetCache: inotify read error ", errno, ", the files are read on every request");
+
+            assets_.clear();
+            ::close(inotify_);
+            inotify_ = -1;
+
+            return;
+        }
+
+        for (auto p = buffer; p < buffer + length;)
+        {
+            auto event = static_cast<const inotify_event*>(static_cast<const void*>(p));
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                ++changes_;
+                assets_.clear();
+
+                continue;
+            }
+
+            auto dir = dirs_.find(event->wd);
+
+            if (dir == std::end(dirs_))
+            {
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED)
+            {
+                dirs_.erase(dir);
+
+                continue;
+            }
+
+            auto path = event->len > 0 ? (fs::path(dir->second) / event->name).string() : dir->second;
+
+            invalidate(path);
+
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+            {
+                watch(path);
+            }
+        }
+    }
+}
+
+} // namespace activity
+} // namespace tnt
@@ -0,0 +1,84 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_ACTIVITY_HTTP_ASSET_CACHE_HPP_
+#define TNT_ACTIVITY_HTTP_ASSET_CACHE_HPP_
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <cstdint>
+
+namespace tnt {
+namespace activity {
+
+std::string content_type(const std::string& path);
+
+//! A file in memory, with its gzip copy when it compresses.
+struct Asset
+{
+    std::shared_ptr<const std::string> body;
+    std::shared_ptr<const std::string> gzip; // Null if not worth it.
+    std::string content_type;
+    std::string etag; // Quoted, of body; the one of gzip ends with "-gz".
+    std::string gzip_etag;
+};
+
+//! The files under the roots served by WebController, in memory. A root is loaded whole on its
+//! first request and followed with inotify: a file written, moved or deleted leaves the cache
+//! and is loaded again on its next request.
+class AssetCache
+{
+public:
+    static AssetCache& instance();
+
+    //! The asset of the regular file at path under root, null if there is none or it is too
+    //! large to keep.
+    std::shared_ptr<const Asset> get(const std::string& root, const std::string& path);
+private:
+    AssetCache();
+
+    void load_root(const std::string& root);
+    void watch(const std::string& dir);
+    void invalidate(const std::string& path);
+    void run();
+private:
+    std::mutex guard_;
+    std::unordered_map<std::string, std::shared_ptr<const Asset>> assets_;
+    std::unordered_set<std::string> roots_;
+    std::unordered_map<int, std::string> dirs_; // By inotify watch.
+    std::atomic<uint64_t> changes_; // Invalidations, an asset read across one is not kept.
+    int inotify_;
+};
+
+} // namespace activity
+} // namespace tnt
+
+#endif
@@ -63,7 +63,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace tnt {
 namespace activity {
 
-HttpConnection::HttpConnection(const std::shared_ptr<protocol::HttpProtocol>& proto, const std::string& base_path) : running_{ false }, proto_(proto), base_path_(base_path)
+HttpConnection::HttpConnection(const std::shared_ptr<protocol::HttpProtocol>& proto, const std::string& base_path, std::chrono::milliseconds idle_timeout) :
+    running_{ false }, proto_(proto), base_path_(base_path), idle_timeout_(idle_timeout), close_(false)
 {
     assert(proto_);
 }
@@ -97,7 +98,12 @@ void HttpConnection::operator()()
 
     while (running_)
     {
-        wait_event();
+        // An idle keep-alive connection would hold a slot of the server forever.
+        if (!wait_event_for(idle_timeout_))
+        {
+            tnt::Log::debug(colors::green, "HttpConnection idle for ", idle_timeout_.count(), " ms, closed.");
+            stop();
+        }
     }
 }
 
@@ -204,9 +210,35 @@ void HttpConnection::ok(const protocol::HttpHeaders& headers, const std::string&
     }
 }
 
+void HttpConnection::ok(const protocol::HttpHeaders& headers, const std::shared_ptr<const std::string>& body, const std::string& content_type)
+{
+    auto hdr = protocol::HttpHeaders({ { "Connection", protocol::get_connection(close_) }, { "Content-Type", content_type }, { "Content-Length", std::to_string(body->size()) } });
+
+    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse(protocol::HttpStatusCode::OK, hdr + headers, body)));
+    
+    if (close_)
+    {
+        f.get();
+        stop();
+    }
+}
+
+void HttpConnection::not_modified(const protocol::HttpHeaders& headers)
+{
+    auto hdr = protocol::HttpHeaders({ { "Connection", protocol::get_connection(close_) } });
+
+    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse(protocol::HttpStatusCode::NotModified, hdr + headers)));
+    
+    if (close_)
+    {
+        f.get();
+        stop();
+    }
+}
+
 void HttpConnection::bad_request()
 {
-    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::bad_request()));
+    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::bad_request(close_)));
     
     if (close_)
     {
@@ -217,7 +249,7 @@ void HttpConnection::bad_request()
 
 void HttpConnection::not_found()
 {
-    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::not_found()));
+    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::not_found(close_)));
     
     if (close_)
     {
@@ -228,14 +260,14 @@ void HttpConnection::not_found()
 
 void HttpConnection::internal_error()
 {
-    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::internal_error()));
+    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::internal_error(true)));
     f.get();
     stop();
 }
 
 void HttpConnection::not_implemented()
 {
-    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::not_implemented()));
+    auto f = proto_->send(std::make_unique<message::HttpResponse>(protocol::HttpResponse::not_implemented(close_)));
     
     if (close_)
     {
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 #include <memory>
 #include <atomic>
+#include <chrono>
 
 #include "event/http/http_server_request.hpp"
 
@@ -73,7 +74,8 @@ namespace activity {
 class HttpConnection: public ConcurrentActivity
 {
 public:
-    HttpConnection(const std::shared_ptr<protocol::HttpProtocol>& proto, const std::string& base_path);
+    //! The connection is closed when no request comes for idle_timeout.
+    HttpConnection(const std::shared_ptr<protocol::HttpProtocol>& proto, const std::string& base_path, std::chrono::milliseconds idle_timeout);
     ~HttpConnection();
 
     void operator()();
@@ -82,6 +84,8 @@ public:
     void ok(const protocol::HttpHeaders& headers);
     void ok(const std::string& body, const std::string& content_type);
     void ok(const protocol::HttpHeaders& headers, const std::string& body, const std::string& content_type);
+    void ok(const protocol::HttpHeaders& headers, const std::shared_ptr<const std::string>& body, const std::string& content_type);
+    void not_modified(const protocol::HttpHeaders& headers);
     void bad_request();
     void not_found();
     void internal_error();
@@ -100,6 +104,7 @@ private:
     std::atomic_bool running_;
     std::shared_ptr<protocol::HttpProtocol> proto_;
     std::string base_path_;
+    std::chrono::milliseconds idle_timeout_;
     std::shared_ptr<event::HttpRequest> request_;
     bool close_;
 };
@@ -29,6 +29,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <future>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <chrono>
+#include <cassert>
 
 #include "activity/http/http_connection.hpp"
 
@@ -42,11 +47,81 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "application.hpp"
 #include "memory.hpp"
 #include "async.hpp"
+#include "lock.hpp"
 #include "log.hpp"
 #include "demangle.hpp"
 
 namespace tnt {
 namespace activity {
+namespace {
+
+struct Slots
+{
+    std::mutex guard;
+    std::condition_variable freed;
+    size_t open = 0;
+};
+
+// Frees the slot of a connection however its activity ends.
+struct Slot
+{
+    explicit Slot(Slots& slots): slots(slots) {}
+
+    ~Slot()
+    {
+        {
+            std::lock_guard<std::mutex> lock(slots.guard);
+            --slots.open;
+        }
+
+        slots.freed.notify_one();
+    }
+
+    Slots& slots;
+};
+
+void join(std::future<void>& activity)
+{
+    try
+    {
+        activity.get();
+    }
+    catch (std::exception& ex)
+    {
+        tnt::Log::error("HttpServer::run error: ", ex.what(), " (", tnt::get_name(ex), ")");
+    }
+    catch (...)
+    {
+        tnt::Log::error("HttpServer::run: Unknown exception");
+    }
+}
+
+// Joins the activities of the connections already closed.
+void prune(std::vector<std::future<void>>& activities)
+{
+    auto it = std::begin(activities);
+
+    while (it != std::end(activities))
+    {
+        if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            join(*it);
+            it = activities.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+} // namespace
+
+HttpServer::HttpServer(size_t max_connections, std::chrono::milliseconds keep_alive): max_connections_(max_connections), keep_alive_(keep_alive)
+{
+    assert(max_connections_ > 0);
+    assert(keep_alive_.count() > 0);
+}
 
 HttpServer::~HttpServer()
 {
@@ -58,10 +133,16 @@ void HttpServer::operator()(const std::shared_ptr<IOEndPoint>& ep, const std::st
     assert(ep);
 
     std::atomic_bool running{ true };
+    Slots slots;
     
-    Application::subscribe([&] (const event::Quit& /*event*/)
+    auto quit = Application::subscribe([&] (const event::Quit& /*event*/)
     {
-        running = false;
+        {
+            std::lock_guard<std::mutex> lock(slots.guard);
+            running = false;
+        }
+
+        slots.freed.notify_all();
         ep->reset();
     });
 
@@ -71,6 +152,13 @@ void HttpServer::operator()(const std::shared_ptr<IOEndPoint>& ep, const std::st
     {
         try
         {
+            {
+                std::unique_lock<std::mutex> lock(slots.guard);
+                slots.freed.wait(lock, [&] () { return slots.open < max_connections_ || !running; });
+            }
+
+            prune(activities);
+
             auto io = ep->get();
 
             if (!running)
@@ -78,9 +166,14 @@ void HttpServer::operator()(const std::shared_ptr<IOEndPoint>& ep, const std::st
                 break;
             }
 
-            activities.push_back(tnt::async([=] ()
+            tnt::lock(slots.guard, [&] () { ++slots.open; });
+
+            auto keep_alive = keep_alive_;
+
+            activities.push_back(tnt::async_activity([io, base_path, keep_alive, &slots] ()
             {
-                HttpConnection(std::make_shared<protocol::HttpProtocol>(io), base_path)();
+                Slot slot(slots);
+                HttpConnection(std::make_shared<protocol::HttpProtocol>(io), base_path, keep_alive)();
             }));
         }
         catch (AcceptSocketException& ex)
@@ -102,19 +195,10 @@ void HttpServer::operator()(const std::shared_ptr<IOEndPoint>& ep, const std::st
 
     for (auto& a : activities)
     {
-        try
-        {
-            a.get();
-        }
-        catch (std::exception& ex)
-        {
-            tnt::Log::error("HttpServer::run error: ", ex.what(), " (", tnt::get_name(ex), ")");
-        }
-        catch (...)
-        {
-            tnt::Log::error("HttpServer::run: Unknown exception");
-        }
+        join(a);
     }
+
+    Application::unsubscribe(quit);
 }
 
 } // namespace activity
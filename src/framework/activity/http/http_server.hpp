@@ -30,6 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <memory>
 #include <string>
+#include <chrono>
+#include <cstddef>
 
 namespace tnt {
 
@@ -37,10 +39,17 @@ struct IOEndPoint;
 
 namespace activity {
 
+//! Serves every connection with its own HttpConnection, up to max_connections at once: at the
+//! limit the next connection waits in the listen backlog until one of them closes. A connection
+//! without requests for keep_alive is closed, so idle clients cannot hold all the slots.
 struct HttpServer
 {
+    explicit HttpServer(size_t max_connections = 64, std::chrono::milliseconds keep_alive = std::chrono::seconds(15));
     ~HttpServer();
     void operator()(const std::shared_ptr<IOEndPoint>& ep, const std::string& base_path);
+private:
+    size_t max_connections_;
+    std::chrono::milliseconds keep_alive_;
 };
 
 } // namespace activity
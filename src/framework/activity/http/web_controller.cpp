@@ -39,6 +39,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/algorithm/string.hpp>
 
 #include "activity/http/http_connection.hpp"
+#include "activity/http/asset_cache.hpp"
 
 #include "exception/exception.hpp"
 
@@ -64,26 +65,56 @@ namespace fs = boost::filesystem;
 
 namespace {
 
-std::string content_type(const std::string& path)
+// Pages are checked on every load, the scripts, styles and images are reused for an hour.
+std::string cache_control(const std::string& content_type)
 {
-    const auto& ext = fs::extension(path);
-
-    if (ext == ".html" || ext == ".htm")
-        return "text/html";
-    if (ext == ".xml")
-        return "text/xml";
-    if (ext == ".jpe" || ext == ".jpeg" || ext == ".jpg")
-        return "image/jpeg";
-    if (ext == ".png")
-        return "image/png";
-    if (ext == ".gif")
-        return "image/gif";
-    if (ext == ".js")
-        return "application/x-javascript";
-    if (ext == ".css")
-        return "text/css";
-
-    return "application/octet-stream";
+    return content_type == "text/html" ? "no-cache" : "max-age=3600";
+}
+
+bool accepts_gzip(const std::string& accept_encoding)
+{
+    std::vector<std::string> codings;
+    boost::split(codings, accept_encoding, boost::is_any_of(","));
+
+    return tnt::contains_if(codings, [] (const std::string& coding)
+    {
+        std::vector<std::string> params;
+        boost::split(params, coding, boost::is_any_of(";"));
+
+        auto name = boost::trim_copy(params[0]);
+
+        if (!boost::iequals(name, "gzip") && name != "*")
+        {
+            return false;
+        }
+
+        // "gzip;q=0" refuses it.
+        return !tnt::contains_if(params, [] (const std::string& param)
+        {
+            auto p = boost::erase_all_copy(param, " ");
+
+            return p == "q=0" || p == "q=0." || p == "q=0.0" || p == "q=0.00" || p == "q=0.000";
+        });
+    });
+}
+
+bool matches(const std::string& if_none_match, const std::string& etag)
+{
+    std::vector<std::string> tags;
+    boost::split(tags, if_none_match, boost::is_any_of(","));
+
+    return tnt::contains_if(tags, [&] (const std::string& tag)
+    {
+        auto t = boost::trim_copy(tag);
+
+        // If-None-Match compares weakly.
+        if (boost::starts_with(t, "W/"))
+        {
+            t.erase(0, 2);
+        }
+
+        return t == etag || t == "*";
+    });
 }
 
 } // namespace
@@ -121,9 +152,18 @@ void WebController::handle_get()
 {
     const auto& uri = connection_->uri();
 
-    auto file_path = fs::initial_path<fs::path>() / base_path_;
+    auto root = fs::initial_path<fs::path>() / base_path_;
+    auto file_path = root;
     auto path = web::http::uri::split_path(uri.path());
 
+    // Nothing outside the root, the cache follows only the files under it.
+    if (tnt::contains_if(path, [] (const auto& p) { return p == "." || p == ".."; }))
+    {
+        connection_->not_found();
+
+        return;
+    }
+
     if (path.empty())
     {
         file_path = file_path / "Home" / "Index.html";
@@ -156,6 +196,13 @@ void WebController::handle_get()
         }
     }
 
+    if (auto asset = AssetCache::instance().get(root.string(), file_path.string()))
+    {
+        send(*asset);
+
+        return;
+    }
+
     if (!fs::exists(file_path))
     {
         connection_->not_found();
@@ -186,6 +233,33 @@ void WebController::handle_delete()
     connection_->not_implemented();
 }*/
 
+void WebController::send(const Asset& asset)
+{
+    auto gzip = asset.gzip && connection_->headers().contains("Accept-Encoding") && accepts_gzip(connection_->header("Accept-Encoding"));
+    const auto& etag = gzip ? asset.gzip_etag : asset.etag;
+
+    auto headers = protocol::HttpHeaders({ { "ETag", etag }, { "Cache-Control", cache_control(asset.content_type) } });
+
+    if (asset.gzip)
+    {
+        headers.insert({ "Vary", "Accept-Encoding" });
+    }
+
+    if (connection_->headers().contains("If-None-Match") && matches(connection_->header("If-None-Match"), etag))
+    {
+        connection_->not_modified(headers);
+
+        return;
+    }
+
+    if (gzip)
+    {
+        headers.insert({ "Content-Encoding", "gzip" });
+    }
+
+    connection_->ok(headers, gzip ? asset.gzip : asset.body, asset.content_type);
+}
+
 void WebController::get_file(const std::string& path)
 {
     try
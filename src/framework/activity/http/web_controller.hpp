@@ -45,6 +45,7 @@ namespace tnt {
 namespace activity {
 
 class HttpConnection;
+struct Asset;
 
 class WebController: public Controller
 {
@@ -57,6 +58,7 @@ private:
     void handle_put();
     void handle_delete();*/
 
+    void send(const Asset& asset);
     void get_file(const std::string& path);
 private:
     HttpConnection* connection_;
@@ -28,9 +28,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "active_object.hpp"
 
 #include <iostream>
+#include <vector>
 #include <cassert>
 
 namespace tnt {
+namespace {
+
+// Functions run per wake up of the thread.
+const size_t function_batch = 64;
+
+} // namespace
 
 ActiveObject::ActiveObject(): running_{ true }, run_thread_([this] () { run(); }) {}
 
@@ -55,17 +62,24 @@ void ActiveObject::stop() const
 
 void ActiveObject::run() const
 {
+    std::vector<std::unique_ptr<FunctionObject>> batch;
+
 	while (running_)
 	{
-		auto f = functions_.pop();
-        assert(f);
+        batch.clear();
+        functions_.pop_some(batch, function_batch);
+
+        for (auto& f : batch)
+        {
+            assert(f);
 
-		if (!running_)
-		{
-			break;
-		}
+            if (!running_)
+            {
+                break;
+            }
 
-		f->exec();
+            f->exec();
+        }
 	}
 }
 
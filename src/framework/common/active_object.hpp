@@ -33,7 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <atomic>
 
 #include "thread.hpp"
-#include "thread_safe_fifo.hpp"
+#include "mpsc_queue.hpp"
 
 namespace tnt {
 
@@ -104,7 +104,7 @@ private:
 private:
 	mutable std::atomic_bool running_;
 	mutable tnt::Thread run_thread_;
-	mutable ThreadSafeFIFO<std::unique_ptr<FunctionObject>> functions_;
+	mutable MPSCQueue<std::unique_ptr<FunctionObject>> functions_;
 };
 
 } // namespace tnt
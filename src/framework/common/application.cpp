@@ -27,6 +27,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "application.hpp"
 
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+
 #include <signal.h>
 
 #include "activity/activity_from_event.hpp"
@@ -35,7 +39,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "util/system.hpp"
 
-#include "range.hpp"
 #include "demangle.hpp"
 #include "containers.hpp"
 #include "async.hpp"
@@ -45,11 +48,44 @@ namespace {
 
 std::once_flag init_instance_flag_;
 
+const size_t event_batch = 64;
+
+std::atomic<size_t> dispatchers_count{ 0 };
+
+size_t dispatchers()
+{
+    auto count = dispatchers_count.load();
+
+    if (count == 0)
+    {
+        count = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), 4);
+    }
+
+    return count;
 }
 
+// The subscriber whose handler runs on this dispatcher, it may unsubscribe itself.
+thread_local const void* delivering = nullptr;
+
+} // namespace
+
 std::unique_ptr<Application> Application::impl_;
 
-Application::Application() : running_{ true } {}
+Application::Application() :
+    running_{ true },
+    readers_(static_cast<int>(dispatchers())),
+    subscribers_{ nullptr },
+    table_(std::make_unique<SubscriberTable>())
+{
+    auto count = dispatchers();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        queues_.push_back(std::make_unique<EventQueue>());
+    }
+
+    subscribers_.store(table_.get());
+}
 
 Application& Application::instance()
 {
@@ -61,6 +97,12 @@ Application& Application::instance()
     return *impl_;
 }
 
+void Application::set_dispatchers(size_t count)
+{
+    assert(!impl_);
+    dispatchers_count = count;
+}
+
 void Application::run()
 {
     instance().do_run();
@@ -84,6 +126,48 @@ void Application::unsubscribe(const Token& token)
 void Application::stop()
 {
     running_ = false;
+
+    // Wakes the dispatchers waiting for events.
+    for (auto& q : queues_)
+    {
+        q->push(std::make_pair(std::unique_ptr<EventObject>(), nullptr));
+    }
+}
+
+Application::EventQueue& Application::queue(std::type_index type, void* src)
+{
+    uint64_t key = src ? reinterpret_cast<uintptr_t>(src) : type.hash_code();
+
+    // The low bits of a pointer are the same for every source.
+    return *queues_[((key * 0x9e3779b97f4a7c15ull) >> 32) % queues_.size()];
+}
+
+template <class F> void Application::update_subscribers(F func)
+{
+    std::lock_guard<std::mutex> lock(subscribers_guard_);
+
+    auto table = std::make_unique<SubscriberTable>(*table_);
+    func(*table);
+
+    subscribers_.store(table.get(), std::memory_order_release);
+    retired_.emplace_back(readers_.advance(), std::move(table_));
+    table_ = std::move(table);
+
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(), [this] (const auto& r)
+    {
+        return readers_.passed(r.first);
+    }),
+    retired_.end());
+}
+
+Application::Token Application::add_subscriber(Token&& subscriber)
+{
+    update_subscribers([&] (SubscriberTable& table)
+    {
+        table[subscriber->type].push_back(subscriber);
+    });
+
+    return std::move(subscriber);
 }
 
 void Application::do_run()
@@ -100,55 +184,145 @@ void Application::do_run()
         raise(event::Quit());
     });
 
+    for (size_t i = 1; i < queues_.size(); ++i)
+    {
+        std::thread([this, i] ()
+        {
+            dispatch_loop(i);
+        })
+        .detach();
+    }
+
+    dispatch_loop(0);
+}
+
+void Application::dispatch_loop(size_t dispatcher)
+{
+    // Drains the events raised meanwhile at every wake up, up to a batch.
+    std::vector<std::pair<std::unique_ptr<EventObject>, void*>> batch;
+    batch.reserve(event_batch);
+
+    auto& events = *queues_[dispatcher];
+    auto reader = static_cast<int>(dispatcher);
+
     while (running_)
     {
-        auto e = events_.pop();
-        const auto& event = e.first;
-        const auto src = e.second;
+        batch.clear();
+        events.pop_some(batch, event_batch);
 
-        auto delivered = false;
+        readers_.online(reader);
 
-        tnt::lock_unique(subscribers_guard_, [&]()
+        for (auto& e : batch)
         {
-            for (const auto& it : tnt::equal_range(subscribers_, event->type()))
+            if (!running_)
             {
-                auto& p = it.second;
-                assert(p);
+                break;
+            }
 
-                if (p->push(event->get(), src))
-                {
-                    delivered = true;
-                }
+            if (e.first)
+            {
+                dispatch(e.first, e.second);
             }
-        });
 
-        if (!delivered)
+            readers_.quiescent(reader);
+        }
+
+        readers_.offline(reader);
+    }
+}
+
+void Application::dispatch(const std::unique_ptr<EventObject>& event, void* src)
+{
+    struct Call
+    {
+        explicit Call(SubscriberObject& s): subscriber(s), previous(delivering)
         {
-            try
-            {
-                auto m = tnt::ActivityFromEvent::create(event->type(), event->get());
+            subscriber.calls.fetch_add(1);
+            delivering = &subscriber;
+        }
 
-                tnt::async([m] ()
-                {
-                    m()->run();
-                });
-            }
-            catch (std::exception& ex)
+        ~Call()
+        {
+            delivering = previous;
+            subscriber.calls.fetch_sub(1);
+        }
+
+        SubscriberObject& subscriber;
+        const void* previous;
+    };
+
+    auto delivered = false;
+    auto table = subscribers_.load(std::memory_order_acquire);
+    auto it = table->find(event->type());
+
+    if (it != table->end())
+    {
+        for (const auto& p : it->second)
+        {
+            assert(p);
+            Call call(*p);
+
+            if (p->alive.load() && p->push(event->get(), src))
             {
-                tnt::Log::error(ex.what());
+                delivered = true;
             }
         }
     }
+
+    if (!delivered)
+    {
+        try
+        {
+            // The activity copies the event here: the pooled event is freed once dispatched.
+            std::shared_ptr<AutoActivity> activity = tnt::ActivityFromEvent::create(event->type(), event->get())();
+
+            // Activities may block or loop, e.g. reconnecting until Quit: each gets a thread
+            // of its own instead of a worker of the work-stealing pool.
+            tnt::async_activity([activity] ()
+            {
+                activity->run();
+            });
+        }
+        catch (std::exception& ex)
+        {
+            tnt::Log::error(ex.what());
+        }
+    }
 }
 
 void Application::do_unsubscribe(const Token& token)
 {
-    if (running_)
+    if (!running_ || !token)
+    {
+        return;
+    }
+
+    token->alive = false;
+
+    update_subscribers([&] (SubscriberTable& table)
     {
-	    lock_unique(subscribers_guard_, [&] ()
+        auto it = table.find(token->type);
+
+        if (it == table.end())
+        {
+            return;
+        }
+
+        auto& list = it->second;
+        list.erase(std::remove(list.begin(), list.end(), token), list.end());
+
+        if (list.empty())
         {
-            subscribers_.erase(token);
-        });
+            table.erase(it);
+        }
+    });
+
+    // A dispatcher that read alive before it was cleared may still be in the handler.
+    auto own = delivering == token.get() ? 1 : 0;
+
+    while (token->calls.load() > own)
+    {
+        std::this_thread::yield();
     }
 }
 
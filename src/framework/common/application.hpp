@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <memory>
 #include <mutex>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <typeindex>
 #include <functional>
@@ -46,23 +47,38 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "lock.hpp"
 #include "log.hpp"
 #include "demangle.hpp"
-#include "thread_safe_fifo.hpp"
+#include "mpsc_queue.hpp"
+#include "quiescent_state.hpp"
+#include "memory_pool.hpp"
 #include "function_pointer_traits.hpp"
 
 namespace tnt {
 
+// Events are dispatched by a small pool of threads, each with its own queue. The events
+// raised with a source go to the queue of the source and are delivered in the order they
+// were raised, the events without a source go to the queue of their type. A subscriber
+// without a source can be called by several dispatchers at once.
+//
+// The subscribers are in a copy-on-write table: subscribe and unsubscribe publish a new
+// copy, the dispatchers read it without locks and the old copies are freed once every
+// dispatcher has gone through a quiescent state.
 class Application
 {
     struct SubscriberObject
     {
+        explicit SubscriberObject(std::type_index t): type(t) {}
         virtual ~SubscriberObject() = default;
         virtual bool push(void* event, void* src) = 0;
+
+        const std::type_index type;
+        std::atomic_bool alive{ true };
+        std::atomic<int> calls{ 0 }; // Dispatchers in push, unsubscribe waits for them.
     };
 
     template <class T> class Subscriber: public SubscriberObject
     {
     public:
-        Subscriber(std::function<void(T)> func, void* src) : func_(func), src_(src) {}
+        Subscriber(std::function<void(T)> func, void* src) : SubscriberObject(typeid(T)), func_(func), src_(src) {}
 
         virtual bool push(void* event, void* src) override
         {
@@ -80,7 +96,7 @@ class Application
         void* src_;
     };
 
-    struct EventObject
+    struct EventObject: PoolAllocated
     {
         virtual ~EventObject() = default;
         virtual std::type_index type() = 0;
@@ -105,9 +121,10 @@ class Application
         E event_;
     };
 
-    using SubscriberTable = std::multimap<std::type_index, std::unique_ptr<SubscriberObject>>;
+    using SubscriberTable = std::unordered_map<std::type_index, std::vector<std::shared_ptr<SubscriberObject>>>;
+    using EventQueue = MPSCQueue<std::pair<std::unique_ptr<EventObject>, void*>>;
 public:
-    using Token = SubscriberTable::iterator;
+    using Token = std::shared_ptr<SubscriberObject>;
 
     template <class F> static auto subscribe(F&& func, void* src = nullptr)
     {
@@ -119,7 +136,10 @@ public:
         instance().do_raise(event, src);
     }
 
+    // When the handler of the subscription is running on another dispatcher, waits for it.
     static void unsubscribe(const Token& token);
+    // The dispatcher threads, before the first subscribe or raise. By default one per core, up to 4.
+    static void set_dispatchers(size_t count);
     static void run();
     static void run_async();
 private:
@@ -134,45 +154,52 @@ private:
 
     template <class E> void do_raise(E&& event, void* src)
     {
+        using T = typename std::decay<E>::type;
+
         if (running_)
         {
-            events_.push(std::make_pair(std::make_unique<Event<typename std::decay<E>::type>>(event), src));
+            queue(std::type_index(typeid(T)), src).push(std::make_pair(std::make_unique<Event<T>>(event), src));
         }
     }
 
-    template <class F> auto do_subscribe(std::true_type, F&& func, void* src)
+    template <class F> Token do_subscribe(std::true_type, F&& func, void* src)
     {
         using E = typename FunctionParamTraits<F>::type;
 
-        return tnt::lock_unique(subscribers_guard_, [&]()
-        {
-            return subscribers_.emplace(std::type_index(typeid(E)), std::make_unique<Subscriber<typename std::decay<E>::type>>(func, src));
-        });
+        return add_subscriber(std::make_shared<Subscriber<typename std::decay<E>::type>>(func, src));
     }
 
-    template <class F> auto do_subscribe(std::false_type, F&& func, void* src)
+    template <class F> Token do_subscribe(std::false_type, F&& func, void* src)
     {
         using E = typename MemberFunctionParamTraits<F>::type;
 
-        return tnt::lock_unique(subscribers_guard_, [&]()
-        {
-            return subscribers_.emplace(std::type_index(typeid(E)), std::make_unique<Subscriber<typename std::decay<E>::type>>(func, src));
-        });
+        return add_subscriber(std::make_shared<Subscriber<typename std::decay<E>::type>>(func, src));
     }
 
+    EventQueue& queue(std::type_index type, void* src);
+    Token add_subscriber(Token&& subscriber);
+    template <class F> void update_subscribers(F func);
+
     void stop();
 
     void do_run();
+    void dispatch_loop(size_t dispatcher);
+    void dispatch(const std::unique_ptr<EventObject>& event, void* src);
     void do_unsubscribe(const Token& token);
 private:
     static std::unique_ptr<Application> impl_;
 
     std::atomic_bool running_;
 
-    std::mutex subscribers_guard_;
-    SubscriberTable subscribers_;
+    std::vector<std::unique_ptr<EventQueue>> queues_;
+    QuiescentState readers_;
 
-    tnt::ThreadSafeFIFO<std::pair<std::unique_ptr<EventObject>, void*>> events_;
+    std::atomic<const SubscriberTable*> subscribers_;
+
+    // Writer side of the table.
+    std::mutex subscribers_guard_;
+    std::unique_ptr<const SubscriberTable> table_;
+    std::vector<std::pair<uint64_t, std::unique_ptr<const SubscriberTable>>> retired_;
 };
 
 } // namespace tnt
@@ -29,22 +29,59 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define TNT_ASYNC_HPP_
 
 #include <future>
-#include <thread>
+#include <tuple>
+#include <type_traits>
+
+#include "executor.hpp"
+#include "unpack_tuple.hpp"
 
 namespace tnt {
 
-template <class Function, class... Args> auto async(Function&& func, Args&&... args)
+namespace detail {
+
+// The task with copies of its arguments, moved into the call as std::thread does.
+template <class R, class... Params> struct BoundTask
 {
-    using R = typename std::result_of<Function(Args...)>::type;
+    std::packaged_task<R(Params...)> task;
+    std::tuple<Params...> params;
 
-    std::packaged_task<R(Args...)> task(func);
-    auto f = task.get_future();
+    void operator()()
+    {
+        call(typename gens<sizeof...(Params)>::type());
+    }
+private:
+    template <int... S> void call(seq<S...>)
+    {
+        task(std::get<S>(std::move(params))...);
+    }
+};
 
-    std::thread(std::move(task), std::forward<Args>(args)...).detach();
+template <class Executor, class Function, class... Args> auto post(Executor& executor, Function&& func, Args&&... args)
+{
+    using R = typename std::result_of<std::decay_t<Function>(std::decay_t<Args>...)>::type;
+
+    BoundTask<R, std::decay_t<Args>...> bound{ std::packaged_task<R(std::decay_t<Args>...)>(std::forward<Function>(func)), std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...) };
+    auto f = bound.task.get_future();
+
+    executor.post(std::move(bound));
 
     return f;
 }
 
+} // namespace detail
+
+// Runs a short task on the work-stealing pool.
+template <class Function, class... Args> auto async(Function&& func, Args&&... args)
+{
+    return detail::post(Executor::instance(), std::forward<Function>(func), std::forward<Args>(args)...);
+}
+
+// Runs a task that blocks or lasts long, e.g. an activity looping until Quit, on a thread of its own.
+template <class Function, class... Args> auto async_activity(Function&& func, Args&&... args)
+{
+    return detail::post(ElasticExecutor::instance(), std::forward<Function>(func), std::forward<Args>(args)...);
+}
+
 } // namespace tnt
 
 #endif
@@ -304,10 +304,15 @@ public:
     }
 
     ssize_t send(const std::string& buf, int flags = 0)
+    {
+        return send(buf.data(), buf.size(), flags);
+    }
+
+    ssize_t send(const char* buf, size_t size, int flags = 0)
     {
         static_assert(Proto == SocketProtocol::Tcp, "This member function is available only on TCP sockets.");
 
-        auto ret = ::send(sock_, buf.data(), buf.size(), flags);
+        auto ret = ::send(sock_, buf, size, flags);
 
         if (ret == Invalid)
         {
@@ -367,10 +372,15 @@ public:
     }
 
     size_t receive(std::string& buf, int flags = 0)
+    {
+        return receive(&buf[0], buf.size(), flags);
+    }
+
+    size_t receive(char* buf, size_t size, int flags = 0)
     {
         static_assert(Proto == SocketProtocol::Tcp, "This member function is available only on TCP sockets.");
 
-        auto ret = ::recv(sock_, &buf[0], buf.size(), flags);
+        auto ret = ::recv(sock_, buf, size, flags);
 
         if (ret == Invalid)
         {
@@ -413,6 +423,62 @@ public:
 
         return false;
     }
+
+    // Does not wait even if the socket is blocking, returns false when no data is ready.
+    bool try_receive(char* buf, size_t size, size_t& length, int flags = 0)
+    {
+        static_assert(Proto == SocketProtocol::Tcp, "This member function is available only on TCP sockets.");
+
+#if defined(TNT_PLATFORM_LINUX)
+        auto ret = ::recv(sock_, buf, size, flags | MSG_DONTWAIT);
+
+        if (ret == Invalid)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return false;
+            }
+
+            throw ReceiveException();
+        }
+
+        length = ret;
+
+        return true;
+#else
+        //TODO:
+#endif
+
+        return false;
+    }
+
+    // Does not wait even if the socket is blocking, returns false when the send buffer is full.
+    bool try_send(const char* buf, size_t size, size_t& sent, int flags = 0)
+    {
+        static_assert(Proto == SocketProtocol::Tcp, "This member function is available only on TCP sockets.");
+
+#if defined(TNT_PLATFORM_LINUX)
+        auto ret = ::send(sock_, buf, size, flags | MSG_DONTWAIT);
+
+        if (ret == Invalid)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return false;
+            }
+
+            throw SendException();
+        }
+
+        sent = ret;
+
+        return true;
+#else
+        //TODO:
+#endif
+
+        return false;
+    }
 private:
     explicit BasicSocket(socket_type sock): sock_{ sock } {}
 
@@ -0,0 +1,101 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_BUFFER_VIEW_HPP_
+#define TNT_BUFFER_VIEW_HPP_
+
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <cassert>
+
+namespace tnt {
+
+// Non owning view of a range of bytes, in the spirit of std::string_view.
+// It is valid as long as the memory it refers to.
+class BufferView
+{
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    BufferView(): data_(nullptr), size_(0) {}
+    BufferView(const char* data, size_t size): data_(data), size_(size) {}
+    BufferView(const std::string& str): data_(str.data()), size_(str.size()) {}
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+
+    char operator[](size_t pos) const
+    {
+        assert(pos < size_);
+
+        return data_[pos];
+    }
+
+    BufferView substr(size_t pos, size_t n = npos) const
+    {
+        assert(pos <= size_);
+
+        return BufferView(data_ + pos, std::min(n, size_ - pos));
+    }
+
+    size_t find(const char* str, size_t pos = 0) const
+    {
+        if (pos > size_)
+        {
+            return npos;
+        }
+
+        auto it = std::search(begin() + pos, end(), str, str + std::strlen(str));
+
+        return it == end() ? npos : static_cast<size_t>(it - begin());
+    }
+
+    bool starts_with(const char* str) const
+    {
+        auto len = std::strlen(str);
+
+        return size_ >= len && std::memcmp(data_, str, len) == 0;
+    }
+
+    std::string str() const
+    {
+        return std::string(data_, size_);
+    }
+private:
+    const char* data_;
+    size_t size_;
+};
+
+} // namespace tnt
+
+#endif
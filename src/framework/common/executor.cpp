@@ -0,0 +1,312 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "executor.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace tnt {
+
+namespace {
+
+const auto elastic_keep_alive = std::chrono::seconds(10);
+const size_t min_workers = 4;
+
+// The executor and the index of the worker running on this thread, if any.
+thread_local const Executor* current_executor = nullptr;
+thread_local size_t current_worker = 0;
+
+} // namespace
+
+namespace detail {
+
+void Task::operator()()
+{
+    try
+    {
+        callable_->call();
+    }
+    catch (std::exception& ex)
+    {
+        Log::error("Task exception: ", ex.what());
+    }
+    catch (...)
+    {
+        Log::error("Task exception");
+    }
+}
+
+} // namespace detail
+
+Executor::Executor(size_t workers): next_(0), pending_(0), sleeping_(0), running_(true)
+{
+    workers = std::max<size_t>(workers, 1);
+
+    for (size_t i = 0; i < workers; ++i)
+    {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+
+    for (size_t i = 0; i < workers; ++i)
+    {
+        threads_.emplace_back([this, i] ()
+        {
+            run(i);
+        });
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(idle_guard_);
+        running_ = false;
+    }
+
+    idle_.notify_all();
+
+    for (auto& t : threads_)
+    {
+        t.join();
+    }
+}
+
+size_t Executor::workers() const
+{
+    return workers_.size();
+}
+
+Executor& Executor::instance()
+{
+    // Never destroyed: at exit its workers may still be running tasks.
+    static auto executor = new Executor(std::max<size_t>(std::thread::hardware_concurrency(), min_workers));
+
+    return *executor;
+}
+
+void Executor::push(detail::Task&& task)
+{
+    auto target = current_executor == this ? current_worker : next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->guard);
+        workers_[target]->tasks.push_back(std::move(task));
+    }
+
+    // Paired with the sleeping worker, which counts itself before it checks pending_.
+    pending_.fetch_add(1);
+
+    if (sleeping_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(idle_guard_);
+        idle_.notify_one();
+    }
+}
+
+bool Executor::pop(size_t self, detail::Task& task)
+{
+    {
+        auto& own = *workers_[self];
+        std::lock_guard<std::mutex> lock(own.guard);
+
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending_.fetch_sub(1);
+
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < workers_.size(); ++i)
+    {
+        auto& victim = *workers_[(self + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.guard);
+
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending_.fetch_sub(1);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Executor::run(size_t self)
+{
+    current_executor = this;
+    current_worker = self;
+
+    for (;;)
+    {
+        detail::Task task;
+
+        if (pop(self, task))
+        {
+            task();
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_guard_);
+
+        if (!running_)
+        {
+            break;
+        }
+
+        sleeping_.fetch_add(1);
+
+        idle_.wait(lock, [this] ()
+        {
+            return pending_.load() > 0 || !running_;
+        });
+
+        sleeping_.fetch_sub(1);
+    }
+}
+
+ElasticExecutor::ElasticExecutor(std::chrono::milliseconds keep_alive): keep_alive_(keep_alive), threads_(0), idle_(0), created_(0), running_(true)
+{
+}
+
+ElasticExecutor::~ElasticExecutor()
+{
+    std::unique_lock<std::mutex> lock(guard_);
+    running_ = false;
+    ready_.notify_all();
+
+    exited_.wait(lock, [this] ()
+    {
+        return threads_ == 0;
+    });
+}
+
+size_t ElasticExecutor::threads() const
+{
+    std::lock_guard<std::mutex> lock(guard_);
+
+    return threads_;
+}
+
+size_t ElasticExecutor::created() const
+{
+    std::lock_guard<std::mutex> lock(guard_);
+
+    return created_;
+}
+
+ElasticExecutor& ElasticExecutor::instance()
+{
+    // Never destroyed: at exit its threads may still be running activities.
+    static auto executor = new ElasticExecutor(elastic_keep_alive);
+
+    return *executor;
+}
+
+void ElasticExecutor::push(detail::Task&& task)
+{
+    std::lock_guard<std::mutex> lock(guard_);
+    tasks_.push_back(std::move(task));
+
+    if (idle_ >= tasks_.size())
+    {
+        ready_.notify_one();
+
+        return;
+    }
+
+    try
+    {
+        std::thread([this] ()
+        {
+            run();
+        }).detach();
+    }
+    catch (...)
+    {
+        tasks_.pop_back();
+        throw;
+    }
+
+    ++threads_;
+    ++created_;
+}
+
+void ElasticExecutor::run()
+{
+    std::unique_lock<std::mutex> lock(guard_);
+
+    for (;;)
+    {
+        if (!tasks_.empty())
+        {
+            {
+                auto task = std::move(tasks_.front());
+                tasks_.pop_front();
+
+                lock.unlock();
+                task();
+            }
+
+            lock.lock();
+
+            continue;
+        }
+
+        if (!running_)
+        {
+            break;
+        }
+
+        ++idle_;
+
+        auto woken = ready_.wait_for(lock, keep_alive_, [this] ()
+        {
+            return !tasks_.empty() || !running_;
+        });
+
+        --idle_;
+
+        if (!woken)
+        {
+            break;
+        }
+    }
+
+    --threads_;
+    exited_.notify_all();
+}
+
+} // namespace tnt
@@ -0,0 +1,172 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_EXECUTOR_HPP_
+#define TNT_EXECUTOR_HPP_
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <utility>
+#include <type_traits>
+
+#include "memory_pool.hpp"
+
+namespace tnt {
+
+namespace detail {
+
+// A move-only callable, so that a std::packaged_task can be queued.
+class Task
+{
+    struct Callable: PoolAllocated
+    {
+        virtual ~Callable() {}
+        virtual void call() = 0;
+    };
+
+    template <class F> struct CallableImpl: Callable
+    {
+        explicit CallableImpl(F&& f) : func(std::move(f)) {}
+
+        virtual void call() override
+        {
+            func();
+        }
+
+        F func;
+    };
+public:
+    Task() = default;
+
+    template <class F, class = std::enable_if_t<!std::is_same<std::decay_t<F>, Task>::value>> explicit Task(F&& func) :
+        callable_(std::make_unique<CallableImpl<std::decay_t<F>>>(std::decay_t<F>(std::forward<F>(func)))) {}
+
+    explicit operator bool() const
+    {
+        return callable_ != nullptr;
+    }
+
+    // Exceptions escaping the task are logged and discarded.
+    void operator()();
+private:
+    std::unique_ptr<Callable> callable_;
+};
+
+} // namespace detail
+
+// Work-stealing pool for short tasks.
+//
+// Every worker has its own deque: it pushes and pops the tasks it posts at the back,
+// while the other workers steal from the front when theirs is empty. Tasks posted from
+// outside the pool are dealt round robin. Tasks must not block for long: a worker busy
+// on a blocked task holds back the tasks in its deque until another worker steals them.
+class Executor
+{
+public:
+    explicit Executor(size_t workers);
+    Executor(const Executor&) = delete;
+    ~Executor();
+
+    Executor& operator=(const Executor&) = delete;
+
+    template <class F> void post(F&& func)
+    {
+        push(detail::Task(std::forward<F>(func)));
+    }
+
+    size_t workers() const;
+
+    // The pool of tnt::async, sized to the hardware concurrency.
+    static Executor& instance();
+private:
+    struct Worker
+    {
+        std::mutex guard;
+        std::deque<detail::Task> tasks;
+    };
+
+    void push(detail::Task&& task);
+    bool pop(size_t self, detail::Task& task);
+    void run(size_t self);
+private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_;
+    std::atomic<size_t> pending_;
+    std::atomic<size_t> sleeping_;
+    std::atomic_bool running_;
+    std::mutex idle_guard_;
+    std::condition_variable idle_;
+};
+
+// Elastic pool for long-running activities.
+//
+// Every task gets a thread as soon as it is posted: an idle thread if there is one,
+// otherwise a new thread. A thread that stays idle for keep_alive exits.
+class ElasticExecutor
+{
+public:
+    explicit ElasticExecutor(std::chrono::milliseconds keep_alive);
+    ElasticExecutor(const ElasticExecutor&) = delete;
+    ~ElasticExecutor();
+
+    ElasticExecutor& operator=(const ElasticExecutor&) = delete;
+
+    template <class F> void post(F&& func)
+    {
+        push(detail::Task(std::forward<F>(func)));
+    }
+
+    size_t threads() const;
+    size_t created() const;
+
+    // The pool of tnt::async_activity.
+    static ElasticExecutor& instance();
+private:
+    void push(detail::Task&& task);
+    void run();
+private:
+    std::chrono::milliseconds keep_alive_;
+    mutable std::mutex guard_;
+    std::condition_variable ready_;
+    std::condition_variable exited_;
+    std::deque<detail::Task> tasks_;
+    size_t threads_;
+    size_t idle_;
+    size_t created_;
+    bool running_;
+};
+
+} // namespace tnt
+
+#endif
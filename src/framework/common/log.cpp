@@ -28,6 +28,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "log.hpp"
 
 #include <fstream>
+#include <chrono>
+#include <stdexcept>
 #include <cstdlib>
 
 namespace tnt {
@@ -35,11 +37,232 @@ namespace {
 
 std::once_flag init_instance_flag_;
 
+const size_t ring_capacity = 64 * 1024;
+const auto writer_idle = std::chrono::milliseconds(1);
+
+// Marks the ring of the thread orphaned when it exits, the writer drops it once drained.
+struct RingHolder
+{
+    ~RingHolder()
+    {
+        if (ring)
+        {
+            ring->orphaned = true;
+        }
+    }
+
+    std::shared_ptr<detail::LogRing> ring;
+};
+
+thread_local RingHolder this_thread_ring_holder;
+
 } // namespace
 
+namespace detail {
+
+constexpr size_t LogRing::record_align;
+
+LogRing::LogRing(size_t capacity): dropped(0), orphaned(false), buffer_(new char[capacity]), mask_(capacity - 1), padding_(0), head_(0), tail_(0)
+{
+    assert((capacity & (capacity - 1)) == 0);
+}
+
+char* LogRing::reserve(size_t size)
+{
+    auto head = head_.load(std::memory_order_relaxed);
+    auto tail = tail_.load(std::memory_order_acquire);
+    auto offset = head & mask_;
+    auto contiguous = mask_ + 1 - offset;
+
+    // A record does not wrap: the end of the buffer is skipped if it does not fit there.
+    padding_ = contiguous < size ? contiguous : 0;
+
+    if (mask_ + 1 - (head - tail) < padding_ + size)
+    {
+        return nullptr;
+    }
+
+    if (padding_ > 0)
+    {
+        auto record = reinterpret_cast<LogRecord*>(buffer_.get() + offset);
+        record->format = nullptr;
+        record->size = static_cast<uint32_t>(padding_);
+        offset = 0;
+    }
+
+    return buffer_.get() + offset;
+}
+
+void LogRing::commit(size_t size)
+{
+    head_.store(head_.load(std::memory_order_relaxed) + padding_ + size, std::memory_order_release);
+}
+
+} // namespace detail
+
 std::atomic_bool Log::valid_;
 std::unique_ptr<Log::LogImpl> Log::instance_; 
 LogLevel Log::level_ = LogLevel::All;
+std::atomic<LogBackend> Log::backend_{ LogBackend::Asynchronous };
+
+Log::LogImpl::LogImpl(): out_(&std::cerr), flush_requested_(0), flushed_(0), running_(true)
+{
+    writer_ = std::thread([this] ()
+    {
+        write_loop();
+    });
+}
+
+Log::LogImpl::~LogImpl()
+{
+    {
+        std::lock_guard<std::mutex> lock(flush_guard_);
+        running_ = false;
+    }
+
+    flush_condition_.notify_all();
+    writer_.join();
+
+    Log::valid_ = false;
+}
+
+void Log::LogImpl::file(const std::string& path)
+{
+    auto f = std::make_unique<std::ofstream>(path, std::ios::app);
+
+    if (!*f)
+    {
+        throw std::runtime_error("Cannot open log file " + path);
+    }
+
+    flush();
+
+    std::lock_guard<std::mutex> lock(guard_);
+    out_->flush();
+    file_ = std::move(f);
+    out_ = file_.get();
+}
+
+void Log::LogImpl::flush()
+{
+    std::unique_lock<std::mutex> lock(flush_guard_);
+    auto target = ++flush_requested_;
+    flush_condition_.notify_all();
+
+    flush_condition_.wait(lock, [this, target] ()
+    {
+        return flushed_ >= target || !running_;
+    });
+}
+
+detail::LogRing* Log::LogImpl::this_thread_ring()
+{
+    auto& holder = this_thread_ring_holder;
+
+    if (!holder.ring)
+    {
+        holder.ring = std::make_shared<detail::LogRing>(ring_capacity);
+
+        std::lock_guard<std::mutex> lock(rings_guard_);
+        rings_.push_back(holder.ring);
+    }
+
+    return holder.ring.get();
+}
+
+bool Log::LogImpl::drain(std::ostream& os)
+{
+    std::vector<std::shared_ptr<detail::LogRing>> rings;
+
+    {
+        std::lock_guard<std::mutex> lock(rings_guard_);
+
+        // Orphaned before they are drained, so nothing more comes after.
+        for (auto it = rings_.begin(); it != rings_.end();)
+        {
+            rings.push_back(*it);
+            it = (*it)->orphaned ? rings_.erase(it) : it + 1;
+        }
+    }
+
+    auto written = false;
+
+    for (auto& ring : rings)
+    {
+        ring->consume([&os, &written] (const detail::LogRecord& record, const char* payload)
+        {
+            record.format(os, payload);
+            os << colors::def;
+
+            if (record.line)
+            {
+                os << '\n';
+            }
+
+            written = true;
+        });
+
+        if (auto dropped = ring->dropped.exchange(0, std::memory_order_relaxed))
+        {
+            os << colors::red << "Log: " << dropped << " records dropped, the ring of the thread was full." << colors::def << '\n';
+            written = true;
+        }
+    }
+
+    return written;
+}
+
+void Log::LogImpl::write_loop()
+{
+    std::ostringstream os;
+    auto idle = false;
+
+    for (;;)
+    {
+        uint64_t requested;
+        bool running;
+
+        {
+            std::unique_lock<std::mutex> lock(flush_guard_);
+
+            // Sleeps only after a pass found nothing to write.
+            if (idle)
+            {
+                flush_condition_.wait_for(lock, writer_idle, [this] ()
+                {
+                    return flush_requested_ > flushed_ || !running_;
+                });
+            }
+
+            requested = flush_requested_;
+            running = running_;
+        }
+
+        idle = !drain(os);
+
+        if (!idle)
+        {
+            auto batch = os.str();
+            os.str(std::string());
+
+            std::lock_guard<std::mutex> lock(guard_);
+            out_->write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            out_->flush();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(flush_guard_);
+            flushed_ = requested;
+        }
+
+        flush_condition_.notify_all();
+
+        if (!running)
+        {
+            break;
+        }
+    }
+}
 
 LogLevel parse_log_level(const std::string& level)
 {
@@ -76,6 +299,24 @@ void Log::level(LogLevel level)
     level_ = level;
 }
 
+void Log::backend(LogBackend backend)
+{
+    if (backend_.exchange(backend) == LogBackend::Asynchronous)
+    {
+        flush();
+    }
+}
+
+void Log::file(const std::string& path)
+{
+    instance()->file(path);
+}
+
+void Log::flush()
+{
+    instance()->flush();
+}
+
 Log::LogImpl* Log::instance()
 {
     std::call_once(init_instance_flag_, [&] ()
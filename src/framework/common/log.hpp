@@ -32,9 +32,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iosfwd>
 #include <memory>
 #include <cstdint>
+#include <cstring>
 #include <cassert>
 #include <string>
+#include <sstream>
 #include <iostream>
+#include <vector>
+#include <thread>
+#include <condition_variable>
 #include <atomic>
 #include <type_traits>
 
@@ -42,6 +47,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "manip.hpp"
 #include "lock.hpp"
 
+// Calls above this level are compiled out, e.g. 3 leaves out Log::debug.
+#if !defined(TNT_LOG_MAX_LEVEL)
+#define TNT_LOG_MAX_LEVEL 5
+#endif
+
 namespace tnt {
 
 enum class LogLevel
@@ -54,144 +64,348 @@ enum class LogLevel
     All // This should be the last
 };
 
+enum class LogBackend
+{
+    Synchronous, // Every line written to the stream under a lock, as it is logged.
+    Asynchronous // Records in per-thread rings, written in batches by a thread.
+};
+
 LogLevel parse_log_level(const std::string& level);
 
-class Log
+namespace detail {
+
+template <class T> void log_print(std::ostream& os, T value, std::true_type /*is_enum*/)
 {
-    class LogImpl
+    using U = std::underlying_type_t<T>;
+
+    if (sizeof(T) == 1)
     {
-    public:
-        LogImpl() = default;
+        os << (std::is_signed<U>::value ? static_cast<unsigned short>(value) : static_cast<short>(value));
+    }
+    else
+    {
+        os << static_cast<U>(value);
+    }
+}
+
+template <class T> void log_print(std::ostream& os, const T& value, std::false_type /*is_enum*/)
+{
+    os << value;
+}
+
+template <class T> void log_print(std::ostream& os, const T& value)
+{
+    log_print(os, value, std::integral_constant<bool, std::is_enum<T>::value>());
+}
+
+// Numbers, enums and manipulators are copied into the records as they are, text is
+// copied byte by byte and anything else is formatted when it is logged.
+template <class T> using LoggedByValue = std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+    std::is_function<std::remove_pointer_t<T>>::value>;
+
+struct LogText
+{
+    const char* data;
+    uint32_t size;
+};
+
+inline LogText log_convert(const char* s)
+{
+    return s ? LogText{ s, static_cast<uint32_t>(std::strlen(s)) } : LogText{ "(null)", 6 };
+}
+
+inline LogText log_convert(const std::string& s)
+{
+    return LogText{ s.data(), static_cast<uint32_t>(s.size()) };
+}
+
+template <class T> std::enable_if_t<LoggedByValue<T>::value, T> log_convert(T value)
+{
+    return value;
+}
+
+template <class T> std::enable_if_t<!LoggedByValue<T>::value, std::string> log_convert(const T& value)
+{
+    std::ostringstream os;
+    log_print(os, value);
+
+    return os.str();
+}
+
+template <class T> struct LogCodec
+{
+    static size_t size(const T& /*value*/)
+    {
+        return sizeof(T);
+    }
+
+    static char* write(char* p, const T& value)
+    {
+        std::memcpy(p, &value, sizeof(T));
+
+        return p + sizeof(T);
+    }
+
+    static const char* print(std::ostream& os, const char* p)
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        log_print(os, value);
+
+        return p + sizeof(T);
+    }
+};
+
+template <> struct LogCodec<LogText>
+{
+    static size_t size(const LogText& text)
+    {
+        return sizeof(uint32_t) + text.size;
+    }
+
+    static char* write(char* p, const LogText& text)
+    {
+        std::memcpy(p, &text.size, sizeof(uint32_t));
+        std::memcpy(p + sizeof(uint32_t), text.data, text.size);
+
+        return p + sizeof(uint32_t) + text.size;
+    }
+
+    static const char* print(std::ostream& os, const char* p)
+    {
+        uint32_t size;
+        std::memcpy(&size, p, sizeof(uint32_t));
+        os.write(p + sizeof(uint32_t), size);
+
+        return p + sizeof(uint32_t) + size;
+    }
+};
 
-        ~LogImpl()
+template <> struct LogCodec<std::string>
+{
+    static size_t size(const std::string& s)
+    {
+        return LogCodec<LogText>::size(log_convert(s));
+    }
+
+    static char* write(char* p, const std::string& s)
+    {
+        return LogCodec<LogText>::write(p, log_convert(s));
+    }
+
+    static const char* print(std::ostream& os, const char* p)
+    {
+        return LogCodec<LogText>::print(os, p);
+    }
+};
+
+template <class... C> void log_format(std::ostream& os, const char* p)
+{
+    using expand = int[];
+    (void)expand{ 0, (p = LogCodec<C>::print(os, p), 0)... };
+}
+
+struct LogRecord
+{
+    void (*format)(std::ostream&, const char*); // Null for the padding before the ring wraps.
+    uint32_t size;
+    uint32_t line;
+};
+
+// Single-producer single-consumer ring of records, one per logging thread.
+class LogRing
+{
+public:
+    static constexpr size_t record_align = 16;
+
+    explicit LogRing(size_t capacity);
+
+    // Returns nullptr if the record does not fit, the size must be a multiple of record_align.
+    char* reserve(size_t size);
+    void commit(size_t size);
+
+    // Calls f(record, payload) for every committed record.
+    template <class F> void consume(F f)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_acquire);
+
+        while (tail != head)
         {
-            Log::valid_ = false;
+            auto record = reinterpret_cast<const LogRecord*>(buffer_.get() + (tail & mask_));
+
+            if (record->format)
+            {
+                f(*record, reinterpret_cast<const char*>(record) + sizeof(LogRecord));
+            }
+
+            tail += record->size;
         }
 
+        tail_.store(tail, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> dropped;
+    std::atomic_bool orphaned;
+private:
+    std::unique_ptr<char[]> buffer_;
+    size_t mask_;
+    size_t padding_;
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+};
+
+static_assert(sizeof(LogRecord) <= LogRing::record_align, "log record header");
+
+} // namespace detail
+
+class Log
+{
+    class LogImpl
+    {
+    public:
+        LogImpl();
+        ~LogImpl();
+
         template <class... T> void log_line(T&& ... args)
         {
-            if (Log::valid_)
+            if (Log::valid_ && Log::backend_ == LogBackend::Asynchronous)
+            {
+                enqueue(true, detail::log_convert(std::forward<T>(args))...);
+            }
+            else if (Log::valid_)
             {
                 // Not using tnt::lock due to a GCC bug.
                 {
                     std::unique_lock<std::mutex> lock(guard_);
-                    do_log(std::forward<T>(args)...);
-                    std::cerr << colors::def << std::endl;
+                    do_log(*out_, std::forward<T>(args)...);
+                    *out_ << colors::def << std::endl;
                 }
             }
             else
             {
-                do_log(std::forward<T>(args)...);
+                do_log(std::cerr, std::forward<T>(args)...);
                 std::cerr << colors::def << std::endl;
             }
         }
 
         template <class... T> void log(T&&... args)
         {
-            if (Log::valid_)
+            if (Log::valid_ && Log::backend_ == LogBackend::Asynchronous)
+            {
+                enqueue(false, detail::log_convert(std::forward<T>(args))...);
+            }
+            else if (Log::valid_)
             {
                 // Not using tnt::lock due to a GCC bug.
                 {
                     std::unique_lock<std::mutex> lock(guard_);
-                    do_log(std::forward<T>(args)...);
-                    std::cerr << colors::def << std::endl;
+                    do_log(*out_, std::forward<T>(args)...);
+                    *out_ << colors::def << std::endl;
                 }
             }
             else
             {
-                do_log(std::forward<T>(args)...);
+                do_log(std::cerr, std::forward<T>(args)...);
                 std::cerr << colors::def << std::flush;
             }
         }
+
+        void file(const std::string& path);
+        void flush();
     private:
-        template <class T, class... R> void do_log(T&& arg, R&& ... rest)
+        template <class... C> void enqueue(bool line, const C&... values)
         {
-            print(std::forward<T>(arg));
-            do_log(std::forward<R>(rest)...);
-        }
+            size_t sizes[] = { sizeof(detail::LogRecord), detail::LogCodec<C>::size(values)... };
+            size_t size = 0;
 
-        template <class T> void do_log(T&& arg)
-        {
-            print(std::forward<T>(arg));
-        }
+            for (auto s : sizes)
+            {
+                size += s;
+            }
 
-        template <class T> void print(T&& arg)
-        {
-            do_print(is_enum<T>(), std::forward<T>(arg));
-        }
+            size = (size + detail::LogRing::record_align - 1) & ~(detail::LogRing::record_align - 1);
 
-        template <class T> void do_print_enum_8_bit(std::true_type /*is_signed*/, T value)
-        {
-            using U = typename std::underlying_type_t<T>;
-            std::cerr << static_cast<unsigned short>(value);
-        }
+            auto ring = this_thread_ring();
+            auto p = ring->reserve(size);
 
-        template <class T> void do_print_enum_8_bit(std::false_type /*is_signed*/, T value)
-        {
-            using U = typename std::underlying_type_t<T>;
-            std::cerr << static_cast<short>(value);
-        }
+            if (!p)
+            {
+                ring->dropped.fetch_add(1, std::memory_order_relaxed);
 
-        template <class T> void do_print_enum(std::true_type /*is_8_bit*/, T value)
-        {
-            using U = typename std::underlying_type_t<T>;
-            do_print_enum_8_bit(is_signed<U>(), value);
-        }
+                return;
+            }
 
-        template <class T> void do_print_enum(std::false_type /*is_8_bit*/, T value)
-        {
-            using U = typename std::underlying_type_t<T>;
-            std::cerr << static_cast<U>(value);
-        }
+            auto record = reinterpret_cast<detail::LogRecord*>(p);
+            record->format = &detail::log_format<C...>;
+            record->size = static_cast<uint32_t>(size);
+            record->line = line;
 
-        template <class T> void do_print(std::true_type /*is_enum*/, T value)
-        {
-            do_print_enum(is_8_bit<T>(), value);
-        }
+            p += sizeof(detail::LogRecord);
 
-        template <class T> void do_print(std::false_type /*is_enum*/, T value)
-        {
-            std::cerr << value;
+            using expand = int[];
+            (void)expand{ 0, (p = detail::LogCodec<C>::write(p, values), 0)... };
+
+            ring->commit(size);
         }
 
-        template <class T> constexpr auto is_enum()
+        template <class T, class... R> void do_log(std::ostream& os, T&& arg, R&& ... rest)
         {
-            return std::integral_constant<bool, std::is_enum<T>::value>();
-        };
+            detail::log_print(os, arg);
+            do_log(os, std::forward<R>(rest)...);
+        }
 
-        template <class T> constexpr auto is_8_bit()
+        template <class T> void do_log(std::ostream& os, T&& arg)
         {
-            return std::integral_constant<bool, sizeof(T) == 1>();
-        };
+            detail::log_print(os, arg);
+        }
 
-        template <class T> constexpr auto is_signed()
-        {
-            return std::integral_constant<bool, std::is_signed<T>::value>();
-        };
+        detail::LogRing* this_thread_ring();
+        void write_loop();
+        bool drain(std::ostream& os);
     private:
         std::mutex guard_;
+        std::ostream* out_;
+        std::unique_ptr<std::ostream> file_;
+
+        std::mutex rings_guard_;
+        std::vector<std::shared_ptr<detail::LogRing>> rings_;
+
+        std::mutex flush_guard_;
+        std::condition_variable flush_condition_;
+        uint64_t flush_requested_;
+        uint64_t flushed_;
+        bool running_;
+        std::thread writer_;
     };
 public:
     static void level(LogLevel level);
+    static void backend(LogBackend backend);
+
+    // Writes to the file instead of stderr.
+    static void file(const std::string& path);
+
+    // Waits until the records logged so far are written.
+    static void flush();
 
     template <class... T> static void debug(T&& ... args)
     {
-        log(LogLevel::Debug, std::forward<T>(args)...);
+        log<LogLevel::Debug>(std::forward<T>(args)...);
     }
 
     template <class... T> static void info(T&& ... args)
     {
-        log(LogLevel::Info, std::forward<T>(args)...);
+        log<LogLevel::Info>(std::forward<T>(args)...);
     }
 
     template <class... T> static void warning(T&& ... args)
     {
-        log(LogLevel::Warning, std::forward<T>(args)...);
+        log<LogLevel::Warning>(std::forward<T>(args)...);
     }
 
     template <class... T> static void error(T&& ... args)
     {
-        log(LogLevel::Error, colors::red, std::forward<T>(args)...);
+        log<LogLevel::Error>(colors::red, std::forward<T>(args)...);
     }
 
     template <class... T> static void output(T&& ... args)
@@ -205,9 +419,9 @@ private:
 
     static LogImpl* instance();
 
-    template <class... T> static void log(LogLevel level, T&& ... args)
+    template <LogLevel L, class... T> static void log(T&& ... args)
     {
-        if (level_ >= level)
+        if (static_cast<int>(L) <= TNT_LOG_MAX_LEVEL && level_ >= L)
         {
             try { instance()->log_line(std::forward<T>(args)...); } catch (...) {}
         }
@@ -216,6 +430,7 @@ private:
     static std::atomic_bool valid_;
     static std::unique_ptr<LogImpl> instance_;
     static LogLevel level_;
+    static std::atomic<LogBackend> backend_;
 };
 
 std::istream& operator>>(std::istream& is, LogLevel& level);
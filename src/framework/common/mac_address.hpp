@@ -113,6 +113,11 @@ public:
         return std::string(reinterpret_cast<const char*>(raw_.data()), S);
     }
 
+    const std::array<uint8_t, S>& bytes() const
+    {
+        return raw_;
+    }
+
     std::string to_string(const std::string& sep = ":", int base = 16) const
     {
         std::ostringstream ss;
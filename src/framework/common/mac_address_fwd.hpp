@@ -28,6 +28,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TNT_MAC_ADDRESS_FWD_HPP_
 #define TNT_MAC_ADDRESS_FWD_HPP_
 
+#include <cstddef>
+
 namespace tnt {
 
 template <size_t S> class BasicMacAddress;
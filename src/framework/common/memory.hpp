@@ -29,9 +29,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define TNT_MAKE_UNIQUE_HPP_
 
 #include <memory>
+#include <new>
+#include <algorithm>
+#include <cstdlib>
 
 #include "platform.hpp"
 
+#if defined(TNT_PLATFORM_WIN)
+
+#include <malloc.h>
+
+#endif
+
 namespace tnt {
 
 #if defined(TNT_CPP14)
@@ -71,6 +80,77 @@ template<class T, class... Args> typename Unique_if_<T>::Known_bound_ make_uniqu
 
 #endif
 
+namespace detail {
+
+inline void* aligned_malloc(size_t alignment, size_t size)
+{
+#if defined(TNT_PLATFORM_WIN)
+    return _aligned_malloc(size, alignment);
+#else
+    void* p = nullptr;
+
+    return posix_memalign(&p, std::max(alignment, sizeof(void*)), size) == 0 ? p : nullptr;
+#endif
+}
+
+inline void aligned_free(void* p)
+{
+#if defined(TNT_PLATFORM_WIN)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace detail
+
+template <class T> struct AlignedArrayDelete
+{
+    size_t size;
+
+    void operator()(T* array) const
+    {
+        for (auto i = size; i > 0; --i)
+        {
+            array[i - 1].~T();
+        }
+
+        detail::aligned_free(array);
+    }
+};
+
+template <class T> using AlignedArray = std::unique_ptr<T[], AlignedArrayDelete<T>>;
+
+// An array of n value-initialized T aligned as T requires: new ignores an alignment larger
+// than the one of std::max_align_t before C++17, e.g. alignas(64) for a cache line.
+template <class T> AlignedArray<T> make_aligned_array(size_t n)
+{
+    auto array = static_cast<T*>(detail::aligned_malloc(alignof(T), n * sizeof(T)));
+
+    if (array == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    size_t i = 0;
+
+    try
+    {
+        for (; i < n; ++i)
+        {
+            new (array + i) T();
+        }
+    }
+    catch (...)
+    {
+        AlignedArrayDelete<T>{ i }(array);
+
+        throw;
+    }
+
+    return AlignedArray<T>(array, AlignedArrayDelete<T>{ n });
+}
+
 } // namespace tnt
 
 #endif
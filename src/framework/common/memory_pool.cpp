@@ -0,0 +1,361 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "memory_pool.hpp"
+
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+
+namespace tnt {
+
+namespace {
+
+// 16 byte steps up to 256 bytes, then 64 byte steps up to max_size.
+const std::size_t small_step = 16;
+const std::size_t small_max = 256;
+const std::size_t large_step = 64;
+const std::size_t classes = small_max / small_step + (MemoryPool::max_size - small_max) / large_step;
+
+const std::size_t chunk_size = 64 * 1024;
+const std::size_t batch_bytes = 8 * 1024;
+
+struct Block
+{
+    Block* next;
+    Block* next_batch;
+};
+
+// The free blocks of a size class shared by all the threads: full batches, blocks given
+// back one at a time by exiting threads and the rest of the chunk being carved.
+struct Central
+{
+    std::mutex guard;
+    Block* batches = nullptr;
+    Block* loose = nullptr;
+    std::size_t loose_count = 0;
+    char* chunk = nullptr;
+    std::size_t chunk_left = 0;
+};
+
+// Trivial, so that it needs no initialisation on access and can still be used after the
+// thread cache is released at thread exit.
+struct ThreadCache
+{
+    Block* head[classes];
+    std::uint32_t count[classes];
+    bool registered;
+    bool exiting;
+};
+
+thread_local ThreadCache cache;
+
+struct CacheReaper
+{
+    ~CacheReaper()
+    {
+        MemoryPool::release_thread_cache();
+        cache.exiting = true;
+    }
+};
+
+std::size_t class_of(std::size_t size)
+{
+    size = std::max<std::size_t>(size, 1);
+
+    if (size <= small_max)
+    {
+        return (size - 1) / small_step;
+    }
+
+    return small_max / small_step + (size - small_max - 1) / large_step;
+}
+
+std::size_t class_size(std::size_t c)
+{
+    if (c < small_max / small_step)
+    {
+        return (c + 1) * small_step;
+    }
+
+    return small_max + (c + 1 - small_max / small_step) * large_step;
+}
+
+std::size_t batch_of(std::size_t c)
+{
+    return std::min<std::size_t>(std::max<std::size_t>(batch_bytes / class_size(c), 4), 64);
+}
+
+Central& central(std::size_t c)
+{
+    // Never destroyed: the threads still running at exit keep using it.
+    static auto centrals = new Central[classes];
+
+    return centrals[c];
+}
+
+void register_thread()
+{
+    thread_local CacheReaper reaper;
+    (void)reaper;
+
+    cache.registered = true;
+}
+
+// Called with the lock of the class held.
+void give_back_loose(Central& pool, std::size_t c, Block* b)
+{
+    b->next = pool.loose;
+    pool.loose = b;
+
+    if (++pool.loose_count == batch_of(c))
+    {
+        pool.loose->next_batch = pool.batches;
+        pool.batches = pool.loose;
+        pool.loose = nullptr;
+        pool.loose_count = 0;
+    }
+}
+
+void refill(std::size_t c)
+{
+    auto& pool = central(c);
+    auto batch = batch_of(c);
+
+    std::lock_guard<std::mutex> lock(pool.guard);
+
+    if (pool.batches)
+    {
+        cache.head[c] = pool.batches;
+        cache.count[c] = static_cast<std::uint32_t>(batch);
+        pool.batches = pool.batches->next_batch;
+
+        return;
+    }
+
+    if (pool.loose)
+    {
+        cache.head[c] = pool.loose;
+        cache.count[c] = static_cast<std::uint32_t>(pool.loose_count);
+        pool.loose = nullptr;
+        pool.loose_count = 0;
+
+        return;
+    }
+
+    auto size = class_size(c);
+
+    if (pool.chunk_left < size * batch)
+    {
+        // The rest of the old chunk is lost, at most a batch.
+        pool.chunk_left = std::max(chunk_size, size * batch);
+        pool.chunk = static_cast<char*>(::operator new(pool.chunk_left));
+    }
+
+    Block* head = nullptr;
+
+    for (std::size_t i = 0; i < batch; ++i)
+    {
+        auto b = reinterpret_cast<Block*>(pool.chunk + (batch - 1 - i) * size);
+        b->next = head;
+        head = b;
+    }
+
+    pool.chunk += size * batch;
+    pool.chunk_left -= size * batch;
+
+    cache.head[c] = head;
+    cache.count[c] = static_cast<std::uint32_t>(batch);
+}
+
+// Gives the first batch of the free list of the thread back to the global pool.
+void flush(std::size_t c)
+{
+    auto batch = batch_of(c);
+    auto first = cache.head[c];
+    auto last = first;
+
+    for (std::size_t i = 1; i < batch; ++i)
+    {
+        last = last->next;
+    }
+
+    cache.head[c] = last->next;
+    cache.count[c] -= static_cast<std::uint32_t>(batch);
+    last->next = nullptr;
+
+    auto& pool = central(c);
+    std::lock_guard<std::mutex> lock(pool.guard);
+
+    first->next_batch = pool.batches;
+    pool.batches = first;
+}
+
+} // namespace
+
+constexpr std::size_t MemoryPool::alignment;
+constexpr std::size_t MemoryPool::max_size;
+
+void* MemoryPool::allocate(std::size_t size)
+{
+    if (size > max_size)
+    {
+        return ::operator new(size);
+    }
+
+    auto c = class_of(size);
+
+    if (cache.exiting)
+    {
+        // A block like the others, it joins the pool when freed.
+        return ::operator new(class_size(c));
+    }
+
+    if (!cache.head[c])
+    {
+        if (!cache.registered)
+        {
+            register_thread();
+        }
+
+        refill(c);
+    }
+
+    auto b = cache.head[c];
+    cache.head[c] = b->next;
+    --cache.count[c];
+
+    return b;
+}
+
+void MemoryPool::deallocate(void* p, std::size_t size) noexcept
+{
+    if (!p)
+    {
+        return;
+    }
+
+    if (size > max_size)
+    {
+        ::operator delete(p);
+
+        return;
+    }
+
+    auto c = class_of(size);
+    auto b = static_cast<Block*>(p);
+
+    if (cache.exiting)
+    {
+        auto& pool = central(c);
+        std::lock_guard<std::mutex> lock(pool.guard);
+        give_back_loose(pool, c, b);
+
+        return;
+    }
+
+    if (!cache.registered)
+    {
+        register_thread();
+    }
+
+    b->next = cache.head[c];
+    cache.head[c] = b;
+
+    if (++cache.count[c] >= 2 * batch_of(c))
+    {
+        flush(c);
+    }
+}
+
+void MemoryPool::release_thread_cache() noexcept
+{
+    for (std::size_t c = 0; c < classes; ++c)
+    {
+        while (cache.count[c] >= batch_of(c))
+        {
+            flush(c);
+        }
+
+        if (!cache.head[c])
+        {
+            continue;
+        }
+
+        auto& pool = central(c);
+        std::lock_guard<std::mutex> lock(pool.guard);
+
+        while (cache.head[c])
+        {
+            auto b = cache.head[c];
+            cache.head[c] = b->next;
+            give_back_loose(pool, c, b);
+        }
+
+        cache.count[c] = 0;
+    }
+}
+
+#if defined(TNT_HAS_MEMORY_RESOURCE)
+
+PoolResource* PoolResource::instance() noexcept
+{
+    static PoolResource resource;
+
+    return &resource;
+}
+
+void* PoolResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (alignment > MemoryPool::alignment)
+    {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    return MemoryPool::allocate(bytes);
+}
+
+void PoolResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    if (alignment > MemoryPool::alignment)
+    {
+        ::operator delete(p, std::align_val_t(alignment));
+
+        return;
+    }
+
+    MemoryPool::deallocate(p, bytes);
+}
+
+bool PoolResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+#endif
+
+} // namespace tnt
@@ -28,10 +28,107 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TNT_MEMORY_POOL_HPP_
 #define TNT_MEMORY_POOL_HPP_
 
-#include <array>
+#include <cstddef>
+#include <new>
+#include <limits>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define TNT_HAS_MEMORY_RESOURCE
+#endif
+#endif
 
 namespace tnt {
 
+// Size-class allocator for the small objects allocated and freed at a high rate:
+// events, handlers, promise states.
+//
+// Every thread keeps a free list per size class and takes blocks from the global pool,
+// or gives them back, a batch at a time under the lock of the class. A block freed by
+// another thread than the one which allocated it goes to the free list of the freeing
+// thread. The blocks cached by a thread go back to the global pool when it exits. The
+// memory is never returned to the system; larger sizes go to ::operator new.
+class MemoryPool
+{
+public:
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t max_size = 1024;
+
+    static void* allocate(std::size_t size);
+    static void deallocate(void* p, std::size_t size) noexcept;
+
+    // Gives the blocks cached by the calling thread back to the global pool.
+    static void release_thread_cache() noexcept;
+};
+
+// Allocator for the standard containers, std::allocate_shared and std::promise.
+template <class T> class PoolAllocator
+{
+    static_assert(alignof(T) <= MemoryPool::alignment, "over-aligned type");
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+
+    template <class U> PoolAllocator(const PoolAllocator<U>& /*other*/) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        {
+            throw std::bad_alloc();
+        }
+
+        return static_cast<T*>(MemoryPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        MemoryPool::deallocate(p, n * sizeof(T));
+    }
+};
+
+template <class T, class U> bool operator==(const PoolAllocator<T>& /*a*/, const PoolAllocator<U>& /*b*/) noexcept
+{
+    return true;
+}
+
+template <class T, class U> bool operator!=(const PoolAllocator<T>& /*a*/, const PoolAllocator<U>& /*b*/) noexcept
+{
+    return false;
+}
+
+// Base of the classes allocated from the pool with new. With a virtual destructor,
+// delete through a base pointer gives back the size of the derived object.
+struct PoolAllocated
+{
+    static void* operator new(std::size_t size)
+    {
+        return MemoryPool::allocate(size);
+    }
+
+    static void operator delete(void* p, std::size_t size) noexcept
+    {
+        MemoryPool::deallocate(p, size);
+    }
+};
+
+#if defined(TNT_HAS_MEMORY_RESOURCE)
+
+// The pool as a std::pmr::memory_resource, for the std::pmr containers.
+class PoolResource: public std::pmr::memory_resource
+{
+public:
+    static PoolResource* instance() noexcept;
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+#endif
+
 } // namespace tnt
 
 #endif
@@ -0,0 +1,418 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_MPSC_QUEUE_HPP_
+#define TNT_MPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+#include "platform.hpp"
+
+#if defined(TNT_PLATFORM_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#else
+#include <condition_variable>
+#endif
+
+namespace tnt {
+namespace detail {
+
+// Where the consumer of an MPSCQueue sleeps when the queue is empty. The producers only
+// make a syscall when the consumer is parked.
+class Parking
+{
+public:
+    // Parks until wake() or the timeout, unless ready() is already true once the
+    // consumer is visible as parked.
+    template <class F> void park(F ready, std::chrono::nanoseconds timeout)
+    {
+        parked_.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!ready())
+        {
+            wait(timeout);
+        }
+
+        parked_.store(0, std::memory_order_relaxed);
+    }
+
+    void wake()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (parked_.load(std::memory_order_relaxed) != 0 && parked_.exchange(0) != 0)
+        {
+            notify();
+        }
+    }
+private:
+#if defined(TNT_PLATFORM_LINUX)
+    void wait(std::chrono::nanoseconds timeout)
+    {
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        timespec ts{ static_cast<time_t>(secs.count()), static_cast<long>((timeout - secs).count()) };
+
+        syscall(SYS_futex, reinterpret_cast<int*>(&parked_), FUTEX_WAIT_PRIVATE, 1, timeout == timeout.max() ? nullptr : &ts, nullptr, 0);
+    }
+
+    void notify()
+    {
+        syscall(SYS_futex, reinterpret_cast<int*>(&parked_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+#else
+    void wait(std::chrono::nanoseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(guard_);
+        auto woken = [this] () { return parked_.load() == 0; };
+
+        if (timeout == timeout.max())
+        {
+            cv_.wait(lock, woken);
+        }
+        else
+        {
+            cv_.wait_for(lock, timeout, woken);
+        }
+    }
+
+    void notify()
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        cv_.notify_one();
+    }
+
+    std::mutex guard_;
+    std::condition_variable cv_;
+#endif
+private:
+    std::atomic<int> parked_{ 0 };
+};
+
+// A counter on a cache line of its own, padded rather than aligned: the queues are
+// members of objects allocated by new.
+struct PaddedCounter
+{
+    std::atomic<size_t> value{ 0 };
+    char pad[64];
+};
+
+} // namespace detail
+
+// Multi-producer single-consumer FIFO. The producers claim a slot of a bounded ring with
+// a compare-and-swap and publish it with its sequence number, no lock and no syscall while
+// the consumer is awake. The consumer parks only when the queue is empty.
+//
+// A full ring does not block the producers: the consumers of the framework push to their
+// own queues too (an event handler raising events, a message sent from the tx loop) and
+// would wait for themselves. Pushes then go to a locked overflow list until the consumer
+// has drained it, which keeps the order of the elements of every producer.
+template <class T> class MPSCQueue
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+public:
+    using value_type = T;
+    using size_type = size_t;
+
+    static constexpr size_type default_capacity = 1024;
+
+    // The capacity is rounded up to a power of two.
+    explicit MPSCQueue(size_type capacity = default_capacity)
+    {
+        size_type size = 2;
+
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+
+        for (size_type i = 0; i < size; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    ~MPSCQueue()
+    {
+        while (take([] (T&& /*value*/) {})) {}
+    }
+
+    size_type capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    // Approximate while the producers push.
+    size_type size() const
+    {
+        auto ring = tail_.value.load(std::memory_order_acquire) - head_.value.load(std::memory_order_acquire);
+
+        if (!overflowing_.load(std::memory_order_acquire))
+        {
+            return ring;
+        }
+
+        std::lock_guard<std::mutex> lock(overflow_guard_);
+
+        return ring + overflow_.size();
+    }
+
+    bool empty() const
+    {
+        return tail_.value.load(std::memory_order_acquire) == head_.value.load(std::memory_order_acquire) && !overflowing_.load(std::memory_order_acquire);
+    }
+
+    template <class ... Args> void emplace(Args&& ... args)
+    {
+        if (overflowing_.load(std::memory_order_acquire) || !try_emplace(std::forward<Args>(args)...))
+        {
+            std::lock_guard<std::mutex> lock(overflow_guard_);
+            overflow_.emplace_back(std::forward<Args>(args)...);
+            overflowing_.store(true, std::memory_order_release);
+        }
+
+        parking_.wake();
+    }
+
+    void push(const T& elem)
+    {
+        emplace(elem);
+    }
+
+    void push(T&& elem)
+    {
+        emplace(std::move(elem));
+    }
+
+    // Consumer only.
+    value_type pop()
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        while (!take([&storage] (T&& value) { new (&storage) T(std::move(value)); }))
+        {
+            park(std::chrono::nanoseconds::max());
+        }
+
+        auto ptr = reinterpret_cast<T*>(&storage);
+        value_type elem(std::move(*ptr));
+        ptr->~T();
+
+        return elem;
+    }
+
+    // Consumer only.
+    template <class D> bool pop_for(value_type& elem, D rel_time)
+    {
+        auto deadline = std::chrono::steady_clock::now() + rel_time;
+
+        while (!try_pop(elem))
+        {
+            auto left = deadline - std::chrono::steady_clock::now();
+
+            if (left <= left.zero())
+            {
+                return false;
+            }
+
+            park(std::chrono::duration_cast<std::chrono::nanoseconds>(left));
+        }
+
+        return true;
+    }
+
+    // Consumer only. Waits for an element, then moves up to max of them to the back of elems.
+    size_type pop_some(std::vector<value_type>& elems, size_type max)
+    {
+        size_type count = 0;
+
+        while (count == 0)
+        {
+            while (empty())
+            {
+                park(std::chrono::nanoseconds::max());
+            }
+
+            while (count < max && try_pop_to(elems))
+            {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    // Consumer only. Moves up to max elements to the back of elems without waiting.
+    size_type try_pop_some(std::vector<value_type>& elems, size_type max)
+    {
+        size_type count = 0;
+
+        while (count < max && try_pop_to(elems))
+        {
+            ++count;
+        }
+
+        return count;
+    }
+private:
+    template <class ... Args> bool try_emplace(Args&& ... args)
+    {
+        auto pos = tail_.value.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (tail_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Full.
+            }
+            else
+            {
+                pos = tail_.value.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&cell->storage) T(std::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool try_pop(value_type& elem)
+    {
+        return take([&elem] (T&& value) { elem = std::move(value); });
+    }
+
+    bool try_pop_to(std::vector<value_type>& elems)
+    {
+        return take([&elems] (T&& value) { elems.push_back(std::move(value)); });
+    }
+
+    template <class F> bool take(F func)
+    {
+        auto head = head_.value.load(std::memory_order_relaxed);
+
+        while (head != tail_.value.load(std::memory_order_acquire))
+        {
+            auto& cell = cells_[head & mask_];
+
+            if (cell.sequence.load(std::memory_order_acquire) != head + 1)
+            {
+                // Claimed but not written yet: the ring is not empty, the overflow has to wait.
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto ptr = reinterpret_cast<T*>(&cell.storage);
+            func(std::move(*ptr));
+            ptr->~T();
+
+            cell.sequence.store(head + mask_ + 1, std::memory_order_release);
+            head_.value.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        if (!overflowing_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(overflow_guard_);
+
+        if (overflow_.empty())
+        {
+            overflowing_.store(false, std::memory_order_release);
+
+            return false;
+        }
+
+        func(std::move(overflow_.front()));
+        overflow_.pop_front();
+
+        if (overflow_.empty())
+        {
+            overflowing_.store(false, std::memory_order_release);
+        }
+
+        return true;
+    }
+
+    void park(std::chrono::nanoseconds timeout)
+    {
+        parking_.park([this] () { return !empty(); }, timeout);
+    }
+private:
+    std::unique_ptr<Cell[]> cells_;
+    size_type mask_;
+
+    detail::PaddedCounter tail_;
+    detail::PaddedCounter head_;
+
+    std::atomic<bool> overflowing_{ false };
+    mutable std::mutex overflow_guard_;
+    std::deque<T> overflow_;
+
+    detail::Parking parking_;
+};
+
+} // namespace tnt
+
+#endif
@@ -0,0 +1,102 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "quiescent_state.hpp"
+
+#include <thread>
+#include <cassert>
+
+namespace tnt {
+
+QuiescentState::QuiescentState(int max_readers): epoch_(1), max_readers_(max_readers), readers_(make_aligned_array<Reader>(max_readers))
+{
+    for (auto i = 0; i < max_readers_; ++i)
+    {
+        readers_[i].epoch.store(0, std::memory_order_relaxed);
+    }
+}
+
+void QuiescentState::online(int reader)
+{
+    assert(reader >= 0 && reader < max_readers_);
+
+    readers_[reader].epoch.store(epoch_.load());
+
+    // The reads of the shared data must not be moved before the reader is online.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void QuiescentState::offline(int reader)
+{
+    assert(reader >= 0 && reader < max_readers_);
+
+    readers_[reader].epoch.store(0, std::memory_order_release);
+}
+
+void QuiescentState::quiescent(int reader)
+{
+    assert(reader >= 0 && reader < max_readers_);
+
+    readers_[reader].epoch.store(epoch_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+int QuiescentState::max_readers() const
+{
+    return max_readers_;
+}
+
+uint64_t QuiescentState::advance()
+{
+    return epoch_.fetch_add(1) + 1;
+}
+
+bool QuiescentState::passed(uint64_t epoch) const
+{
+    for (auto i = 0; i < max_readers_; ++i)
+    {
+        auto e = readers_[i].epoch.load(std::memory_order_acquire);
+
+        if (e != 0 && e < epoch)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void QuiescentState::synchronize()
+{
+    auto epoch = advance();
+
+    while (!passed(epoch))
+    {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace tnt
@@ -0,0 +1,77 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_QUIESCENT_STATE_HPP_
+#define TNT_QUIESCENT_STATE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "memory.hpp"
+
+namespace tnt {
+
+// Quiescent state based reclamation (QSBR): the readers announce when they hold no
+// reference to the shared data, the writer frees the unpublished memory only when
+// every online reader has gone through a quiescent point since it was unpublished.
+// The read side costs a store per quiescent point, and nothing per access.
+class QuiescentState
+{
+    // Each on its own cache line, written by its reader.
+    struct alignas(64) Reader
+    {
+        std::atomic<uint64_t> epoch; // 0 if the reader is offline.
+    };
+public:
+    explicit QuiescentState(int max_readers);
+
+    QuiescentState(const QuiescentState&) = delete;
+    QuiescentState& operator=(const QuiescentState&) = delete;
+
+    // Reader side.
+    void online(int reader);
+    void offline(int reader);
+    void quiescent(int reader);
+
+    // The reader ids go from 0 to max_readers() - 1.
+    int max_readers() const;
+
+    // Writer side.
+    uint64_t advance();
+    bool passed(uint64_t epoch) const;
+    void synchronize();
+private:
+    std::atomic<uint64_t> epoch_;
+
+    int max_readers_;
+    AlignedArray<Reader> readers_;
+};
+
+} // namespace tnt
+
+#endif
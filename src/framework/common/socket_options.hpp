@@ -42,6 +42,7 @@ using SocketLen = int;
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 
 using SocketLen = socklen_t;
 
@@ -204,6 +205,8 @@ private:
 using ReuseAddress = BooleanOption<SOL_SOCKET, SO_REUSEADDR>;
 using Broadcast = BooleanOption<SOL_SOCKET, SO_BROADCAST>;
 
+using NoDelay = BooleanOption<IPPROTO_TCP, TCP_NODELAY>;
+
 using SendBuffer = IntOption<SOL_SOCKET, SO_SNDBUF>;
 using ReceiveBuffer = IntOption<SOL_SOCKET, SO_RCVBUF>;
 
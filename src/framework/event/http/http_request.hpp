@@ -65,9 +65,15 @@ public:
 		return method_;
 	}
 
+    //! HTTP/1.1 connections persist unless the client asks to close, HTTP/1.0 ones only if it asks to keep them.
     bool connection_close() const
     {
-        return !headers_.contains("Connection") || to_lower(header("Connection")) != "keep-alive";
+        if (!headers_.contains("Connection"))
+        {
+            return version_ != "HTTP/1.1";
+        }
+
+        return to_lower(header("Connection")) != "keep-alive";
     }
 
 	const protocol::HttpHeaders& headers() const
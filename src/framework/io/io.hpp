@@ -30,6 +30,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string>
 #include <memory>
+#include <cstring>
+#include <cstddef>
+
+#include "exception/exception.hpp"
 
 namespace tnt {
 
@@ -40,6 +44,59 @@ struct IO
     virtual std::string read() = 0;
     virtual bool try_read(std::string& data) = 0;
     virtual void write(const std::string& data) = 0;
+
+    // Reads in a buffer owned by the caller. The datagram IOs copy the result of read(),
+    // the stream ones receive directly in the buffer.
+    virtual size_t read_some(char* data, size_t size)
+    {
+        auto buf = read();
+
+        if (buf.size() > size)
+        {
+            throw IOReset("Read buffer too small");
+        }
+
+        std::memcpy(data, buf.data(), buf.size());
+
+        return buf.size();
+    }
+
+    // The descriptor a Reactor can poll for this IO, -1 if it can only be read by a thread
+    // blocking in read().
+    virtual int native_handle()
+    {
+        return -1;
+    }
+
+    // Non-blocking read_some for the reactor, returns false when no data is ready.
+    virtual bool try_read_some(char* data, size_t size, size_t& length)
+    {
+        std::string buf;
+
+        if (!try_read(buf))
+        {
+            return false;
+        }
+
+        if (buf.size() > size)
+        {
+            throw IOReset("Read buffer too small");
+        }
+
+        std::memcpy(data, buf.data(), buf.size());
+        length = buf.size();
+
+        return true;
+    }
+
+    // Non-blocking write for the reactor, returns the bytes taken, the caller sends the rest
+    // when the IO becomes writable. The datagram IOs take everything.
+    virtual size_t try_write_some(const char* data, size_t size)
+    {
+        write(std::string(data, size));
+
+        return size;
+    }
 };
 
 struct IOEndPoint
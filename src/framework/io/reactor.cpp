@@ -0,0 +1,416 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "reactor.hpp"
+
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "exception/exception.hpp"
+
+#include "lock.hpp"
+#include "log.hpp"
+
+namespace tnt {
+namespace io {
+namespace {
+
+// Events taken by one epoll_wait.
+const int max_events = 256;
+
+// The eventfd waking a loop, the ids of the handlers start from 1.
+const Reactor::Id wakeup_id = 0;
+
+const uint32_t read_events = EPOLLIN | EPOLLRDHUP;
+
+std::atomic_bool reactor_enabled{ false };
+std::atomic<size_t> loops_count{ 0 };
+
+// The loop whose io thread, or notification thread, is this one. Each holds its guard
+// while it calls the handlers.
+thread_local const void* current_loop = nullptr;
+thread_local const void* current_notifications = nullptr;
+
+size_t default_loops()
+{
+    return std::max<size_t>(std::thread::hardware_concurrency() / 2, 2);
+}
+
+void control(int epoll, int op, int fd, uint32_t events, Reactor::Id id)
+{
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+
+    if (::epoll_ctl(epoll, op, fd, &event) == -1)
+    {
+        throw OperationError();
+    }
+}
+
+template <class F> void call(const char* what, F func)
+{
+    try
+    {
+        func();
+    }
+    catch (std::exception& ex)
+    {
+        Log::error("Reactor::", what, ": ", ex.what());
+    }
+    catch (...)
+    {
+        Log::error("Reactor::", what, ": unknown error.");
+    }
+}
+
+} // namespace
+
+struct Reactor::Loop
+{
+    ~Loop()
+    {
+        if (wakeup != -1)
+        {
+            ::close(wakeup);
+        }
+
+        if (epoll != -1)
+        {
+            ::close(epoll);
+        }
+    }
+
+    void wake()
+    {
+        uint64_t one = 1;
+        auto ret = ::write(wakeup, &one, sizeof(one));
+        (void)ret; // Fails only if the counter is full, then the loop is awake anyway.
+    }
+
+    int epoll = -1;
+    int wakeup = -1;
+
+    // Held by the io thread while it calls the handlers, and by add and remove from other threads.
+    std::mutex guard;
+    std::unordered_map<Id, Handler*> handlers;
+
+    // Held by the notification thread while it calls the handlers, and by remove.
+    std::mutex notifications_guard;
+    std::mutex notices_guard;
+    std::condition_variable notices_ready;
+    std::vector<Handler*> notices;
+
+    std::thread io_thread;
+    std::thread notification_thread;
+};
+
+Reactor::Reactor(size_t loops): next_{ 1 }, running_{ true }
+{
+    assert(loops > 0);
+
+    for (size_t i = 0; i < loops; ++i)
+    {
+        auto loop = std::make_unique<Loop>();
+
+        loop->epoll = ::epoll_create1(EPOLL_CLOEXEC);
+
+        if (loop->epoll == -1)
+        {
+            throw OperationError();
+        }
+
+        loop->wakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (loop->wakeup == -1)
+        {
+            throw OperationError();
+        }
+
+        control(loop->epoll, EPOLL_CTL_ADD, loop->wakeup, EPOLLIN, wakeup_id);
+
+        loops_.push_back(std::move(loop));
+    }
+
+    for (auto& loop : loops_)
+    {
+        auto l = loop.get();
+        loop->io_thread = std::thread([this, l] () { run(*l); });
+        loop->notification_thread = std::thread([this, l] () { run_notifications(*l); });
+    }
+}
+
+Reactor::~Reactor()
+{
+    running_ = false;
+
+    for (auto& loop : loops_)
+    {
+        loop->wake();
+        tnt::lock(loop->notices_guard, [&] () { loop->notices_ready.notify_all(); });
+    }
+
+    for (auto& loop : loops_)
+    {
+        loop->io_thread.join();
+        loop->notification_thread.join();
+    }
+}
+
+void Reactor::add(int fd, Handler& handler)
+{
+    assert(fd != -1);
+    assert(!handler.registered());
+
+    auto id = next_.fetch_add(1, std::memory_order_relaxed);
+    auto& loop = *loops_[id % loops_.size()];
+
+    std::unique_lock<std::mutex> lock(loop.guard, std::defer_lock);
+
+    if (current_loop != &loop)
+    {
+        lock.lock();
+    }
+
+    loop.handlers.emplace(id, &handler);
+
+    handler.fd_ = fd;
+    handler.loop_ = &loop;
+    handler.id_ = id;
+
+    try
+    {
+        control(loop.epoll, EPOLL_CTL_ADD, fd, read_events, id);
+    }
+    catch (...)
+    {
+        handler.id_ = 0;
+        loop.handlers.erase(id);
+        throw;
+    }
+}
+
+void Reactor::remove(Handler& handler)
+{
+    // Still waits for the loop if the handler removed itself, its notified() may be running.
+    if (handler.loop_ == nullptr)
+    {
+        return;
+    }
+
+    auto& loop = *handler.loop_;
+    assert(current_notifications != &loop);
+
+    std::unique_lock<std::mutex> lock(loop.guard, std::defer_lock);
+    std::unique_lock<std::mutex> notifications_lock(loop.notifications_guard, std::defer_lock);
+
+    // The io thread does not wait for the notification thread, which may be waiting for it.
+    if (current_loop != &loop)
+    {
+        lock.lock();
+        notifications_lock.lock();
+    }
+
+    auto id = handler.id_.exchange(0);
+
+    // Removed by the handler itself, or by another thread while this one waited for the loop.
+    if (id == 0)
+    {
+        return;
+    }
+
+    ::epoll_ctl(loop.epoll, EPOLL_CTL_DEL, handler.fd_, nullptr);
+    loop.handlers.erase(id);
+
+    tnt::lock(loop.notices_guard, [&] ()
+    {
+        loop.notices.erase(std::remove(loop.notices.begin(), loop.notices.end(), &handler), loop.notices.end());
+    });
+}
+
+void Reactor::notify(Handler& handler)
+{
+    if (!handler.registered())
+    {
+        return;
+    }
+
+    auto& loop = *handler.loop_;
+
+    tnt::lock(loop.notices_guard, [&] ()
+    {
+        loop.notices.push_back(&handler);
+
+        if (loop.notices.size() == 1)
+        {
+            loop.notices_ready.notify_one();
+        }
+    });
+}
+
+void Reactor::want_write(Handler& handler, bool enable)
+{
+    auto id = handler.id_.load();
+
+    if (id == 0)
+    {
+        return;
+    }
+
+    control(handler.loop_->epoll, EPOLL_CTL_MOD, handler.fd_, enable ? read_events | EPOLLOUT : read_events, id);
+}
+
+size_t Reactor::loops() const
+{
+    return loops_.size();
+}
+
+void Reactor::enable(size_t loops)
+{
+    loops_count = loops;
+    reactor_enabled = true;
+}
+
+bool Reactor::enabled()
+{
+    return reactor_enabled.load(std::memory_order_relaxed);
+}
+
+Reactor& Reactor::instance()
+{
+    // Never destroyed: at exit its loops may still be serving protocols.
+    static auto reactor = new Reactor(loops_count != 0 ? loops_count.load() : default_loops());
+
+    return *reactor;
+}
+
+void Reactor::run(Loop& loop)
+{
+    current_loop = &loop;
+
+    epoll_event events[max_events];
+
+    while (running_)
+    {
+        auto count = ::epoll_wait(loop.epoll, events, max_events, -1);
+
+        if (count == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            Log::error("Reactor: epoll_wait failed: ", std::strerror(errno));
+
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(loop.guard);
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto id = events[i].data.u64;
+
+            if (id == wakeup_id)
+            {
+                uint64_t value;
+                auto ret = ::read(loop.wakeup, &value, sizeof(value));
+                (void)ret;
+
+                continue;
+            }
+
+            auto flags = events[i].events;
+
+            // Looked up again for every call, an earlier one may have removed the handler.
+            if ((flags & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) != 0)
+            {
+                auto it = loop.handlers.find(id);
+
+                if (it != loop.handlers.end())
+                {
+                    call("readable", [&] () { it->second->readable(); });
+                }
+            }
+
+            if ((flags & EPOLLOUT) != 0)
+            {
+                auto it = loop.handlers.find(id);
+
+                if (it != loop.handlers.end())
+                {
+                    call("writable", [&] () { it->second->writable(); });
+                }
+            }
+        }
+    }
+}
+
+void Reactor::run_notifications(Loop& loop)
+{
+    current_notifications = &loop;
+
+    std::vector<Handler*> notices;
+
+    while (running_)
+    {
+        {
+            std::unique_lock<std::mutex> lock(loop.notices_guard);
+            loop.notices_ready.wait(lock, [&] () { return !loop.notices.empty() || !running_; });
+        }
+
+        // Taken before the notices: remove waits for the batch, or purges the handler from it.
+        std::lock_guard<std::mutex> lock(loop.notifications_guard);
+
+        notices.clear();
+        tnt::lock(loop.notices_guard, [&] () { notices.swap(loop.notices); });
+
+        for (auto handler : notices)
+        {
+            // Removed by its own io thread, which does not wait for this one.
+            if (handler->registered())
+            {
+                call("notified", [&] () { handler->notified(); });
+            }
+        }
+    }
+}
+
+} // namespace io
+} // namespace tnt
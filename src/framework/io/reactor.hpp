@@ -0,0 +1,117 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_IO_REACTOR_HPP_
+#define TNT_IO_REACTOR_HPP_
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace tnt {
+namespace io {
+
+// Pool of epoll loops serving the IOs of the protocols in reactor mode.
+//
+// Every registered descriptor is served by one loop, chosen round robin. The io thread of
+// the loop calls the handler when the descriptor can be read or written: these calls must
+// not block, a handler waiting there holds back all the IOs of its loop. The notified()
+// calls run on a second thread of the loop, where a handler can wait for something its
+// own readable() call delivers, at the price of delaying the other notifications.
+class Reactor
+{
+    struct Loop;
+public:
+    using Id = uint64_t;
+
+    class Handler
+    {
+        friend class Reactor;
+    public:
+        virtual ~Handler() {}
+
+        // Also called on errors and hang-ups, so that the read reports them.
+        virtual void readable() = 0;
+        virtual void writable() = 0;
+        virtual void notified() = 0;
+
+        bool registered() const
+        {
+            return id_ != 0;
+        }
+    private:
+        // Set before the descriptor is polled, 0 when the handler is not registered.
+        std::atomic<Id> id_{ 0 };
+        int fd_ = -1;
+        Loop* loop_ = nullptr;
+    };
+
+    explicit Reactor(size_t loops);
+    Reactor(const Reactor&) = delete;
+    ~Reactor();
+
+    Reactor& operator=(const Reactor&) = delete;
+
+    // The handler waits for readable until it is removed.
+    void add(int fd, Handler& handler);
+
+    // Must be called before the descriptor is closed, not from notified(). When it returns
+    // no call to the handler is running or will run; called from readable() or writable()
+    // a notified() call may still be running.
+    void remove(Handler& handler);
+
+    // From any thread, calls notified() on the notification thread of the loop. The
+    // notifications sent while it is busy are delivered in its next pass.
+    void notify(Handler& handler);
+
+    // From any thread, whether the handler waits for writable too. The callers serialize
+    // the calls for a handler.
+    void want_write(Handler& handler, bool enable);
+
+    size_t loops() const;
+
+    // Turns on the reactor mode for the protocols started afterwards, with the given number
+    // of loops, 0 for the default.
+    static void enable(size_t loops = 0);
+    static bool enabled();
+
+    static Reactor& instance();
+private:
+    void run(Loop& loop);
+    void run_notifications(Loop& loop);
+private:
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::atomic<Id> next_;
+    std::atomic_bool running_;
+};
+
+} // namespace io
+} // namespace tnt
+
+#endif
@@ -0,0 +1,88 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "receive_buffer.hpp"
+
+#include <cstring>
+#include <cassert>
+
+namespace tnt {
+
+ReceiveBuffer::ReceiveBuffer(size_t size): buffer_(size), begin_(0), end_(0) {}
+
+char* ReceiveBuffer::prepare(size_t min_space)
+{
+    if (begin_ == end_)
+    {
+        begin_ = end_ = 0;
+    }
+    else if (buffer_.size() - end_ < min_space && begin_ > 0)
+    {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+
+        end_ -= begin_;
+        begin_ = 0;
+    }
+
+    if (buffer_.size() - end_ < min_space)
+    {
+        buffer_.resize(end_ + min_space);
+    }
+
+    return buffer_.data() + end_;
+}
+
+size_t ReceiveBuffer::space() const
+{
+    return buffer_.size() - end_;
+}
+
+void ReceiveBuffer::commit(size_t n)
+{
+    assert(n <= space());
+
+    end_ += n;
+}
+
+BufferView ReceiveBuffer::data() const
+{
+    return BufferView(buffer_.data() + begin_, end_ - begin_);
+}
+
+void ReceiveBuffer::consume(size_t n)
+{
+    assert(n <= end_ - begin_);
+
+    begin_ += n;
+}
+
+void ReceiveBuffer::clear()
+{
+    begin_ = end_ = 0;
+}
+
+} // namespace tnt
@@ -0,0 +1,63 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_IO_RECEIVE_BUFFER_HPP_
+#define TNT_IO_RECEIVE_BUFFER_HPP_
+
+#include <vector>
+#include <cstddef>
+
+#include "buffer_view.hpp"
+
+namespace tnt {
+
+// Receive buffer of a stream protocol: the IO reads at its end, the protocol parses the
+// messages in place and consumes them from its front. The bytes left unparsed (at most a
+// partial message) are moved to the front only when the free space at the end is not
+// enough for the next read, so each read costs at most one compaction.
+class ReceiveBuffer
+{
+public:
+    explicit ReceiveBuffer(size_t size);
+
+    // Returns the end of the data, with room for at least min_space bytes.
+    char* prepare(size_t min_space);
+    size_t space() const;
+    void commit(size_t n);
+
+    BufferView data() const;
+    void consume(size_t n);
+    void clear();
+private:
+    std::vector<char> buffer_;
+    size_t begin_;
+    size_t end_;
+};
+
+} // namespace tnt
+
+#endif
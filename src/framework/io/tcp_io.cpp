@@ -39,7 +39,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace tnt {
 namespace io {
 
-TcpIO::TcpIO(ip::tcp::Socket&& sock): sock_(std::move(sock)), buffer_size_(get_buffer_size()) {}
+TcpIO::TcpIO(ip::tcp::Socket&& sock): sock_(std::move(sock)), buffer_size_(get_buffer_size())
+{
+    // The protocols coalesce their writes, what is written has to go out now.
+    sock_.set_option(ip::NoDelay(true));
+}
 
 void TcpIO::reset()
 {
@@ -93,6 +97,61 @@ bool TcpIO::try_read(std::string& data)
     return false;
 }
 
+size_t TcpIO::read_some(char* data, size_t size)
+{
+    if (!sock_)
+    {
+        throw IOReset("Socket closed");
+    }
+
+    auto length = sock_.receive(data, size);
+
+    if (length == 0)
+    {
+        throw IOReset("Socket closed.");
+    }
+
+    return length;
+}
+
+int TcpIO::native_handle()
+{
+    return sock_.get();
+}
+
+bool TcpIO::try_read_some(char* data, size_t size, size_t& length)
+{
+    if (!sock_)
+    {
+        throw IOReset("Socket closed");
+    }
+
+    if (!sock_.try_receive(data, size, length))
+    {
+        return false;
+    }
+
+    if (length == 0)
+    {
+        throw IOReset("Socket closed.");
+    }
+
+    return true;
+}
+
+size_t TcpIO::try_write_some(const char* data, size_t size)
+{
+    if (!sock_)
+    {
+        throw IOReset("Socket closed");
+    }
+
+    size_t sent = 0;
+    sock_.try_send(data, size, sent);
+
+    return sent;
+}
+
 void TcpIO::write(const std::string& data)
 {
     if (!sock_)
@@ -100,7 +159,13 @@ void TcpIO::write(const std::string& data)
         throw IOReset("Socket closed");
     }
 
-    sock_.send(data);
+    size_t sent = 0;
+
+    // A batch of messages can be larger than what a single send takes.
+    while (sent < data.size())
+    {
+        sent += sock_.send(data.data() + sent, data.size() - sent);
+    }
 }
 
 unsigned int TcpIO::get_buffer_size()
@@ -115,7 +180,9 @@ TcpIOServer::TcpIOServer(const ip::SocketAddress& ep)
 {
     sock_.set_option(ip::ReuseAddress(true));
     sock_.bind(ep);
-    sock_.listen(4);
+
+    // Room for a burst of connections, e.g. switches reconnecting after a restart.
+    sock_.listen(SOMAXCONN);
 }
 
 TcpIOServer::~TcpIOServer()
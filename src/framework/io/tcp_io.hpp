@@ -50,6 +50,10 @@ public:
     virtual std::string read() override;
     virtual bool try_read(std::string& data) override;
     virtual void write(const std::string& data) override;
+    virtual size_t read_some(char* data, size_t size) override;
+    virtual int native_handle() override;
+    virtual bool try_read_some(char* data, size_t size, size_t& length) override;
+    virtual size_t try_write_some(const char* data, size_t size) override;
 private:
     unsigned int get_buffer_size();
 private:
@@ -103,6 +103,11 @@ void UdpIO::write(const std::string& data)
     }
 }
 
+int UdpIO::native_handle()
+{
+    return sock_.get();
+}
+
 unsigned int UdpIO::get_buffer_size()
 {
     ip::ReceiveBuffer opt;
@@ -48,6 +48,7 @@ public:
     virtual std::string read() override;
     virtual bool try_read(std::string& data) override;
     virtual void write(const std::string& data) override;
+    virtual int native_handle() override;
 private:
     unsigned int get_buffer_size();
 private:
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "message/message.hpp"
 
 #include "io/io.hpp"
+#include "io/receive_buffer.hpp"
 
 #include "exception/exception.hpp"
 
@@ -41,15 +42,55 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "event/quit.hpp"
 
 #include "demangle.hpp"
+#include "lock.hpp"
 #include "log.hpp"
 #include "containers.hpp"
+#include "memory_pool.hpp"
 #include "application.hpp"
 #include "dynamic_pointer_visitor.hpp"
 
 namespace tnt {
 namespace protocol {
+namespace {
 
-AsyncProtocol::AsyncProtocol(const std::shared_ptr<IO>& io): running_{ false }, io_(io)
+// Free space offered to each read, also the largest datagram a datagram IO can deliver.
+const size_t rx_chunk = 64 * 1024;
+
+// Pending bytes after which a batch is sent even if more messages are queued.
+const size_t tx_flush_size = 64 * 1024;
+
+// Messages taken from the queue at once by the tx loop.
+const size_t tx_batch = 64;
+
+// Unsent bytes above which the reactor leaves the messages in the queue until the socket drains.
+const size_t tx_high_water = 1024 * 1024;
+
+// Unsent bytes above which the writes fail on the reactor: the peer is not reading.
+const size_t tx_max_unsent = 64 * 1024 * 1024;
+
+// The protocol whose rx or tx loop runs on this thread while it goes through a batch,
+// its writes are left in the send buffer until the batch ends.
+thread_local const AsyncProtocol* corked = nullptr;
+
+class Cork
+{
+public:
+    explicit Cork(const AsyncProtocol* protocol): previous_(corked)
+    {
+        corked = protocol;
+    }
+
+    ~Cork()
+    {
+        corked = previous_;
+    }
+private:
+    const AsyncProtocol* previous_;
+};
+
+} // namespace
+
+AsyncProtocol::AsyncProtocol(const std::shared_ptr<IO>& io): running_{ false }, io_(io), tx_sent_{ 0 }, reactor_(false), tx_notified_{ false }, tx_blocked_(false)
 {
     assert(io_);
 }
@@ -66,6 +107,8 @@ void AsyncProtocol::start()
         return;
     }
 
+    // Chosen before running_ is set, the senders read it after they see it.
+    reactor_ = io::Reactor::enabled() && io_->native_handle() != -1;
     running_ = true;
 
     Application::subscribe([&] (const event::Quit& /*event*/)
@@ -75,8 +118,16 @@ void AsyncProtocol::start()
 
     register_messages();
 
-    rx_thread_.start([this] () { rx_loop(); });
-    tx_thread_.start([this] () { tx_loop(); });
+    if (reactor_)
+    {
+        rx_buffer_ = std::make_unique<ReceiveBuffer>(4 * rx_chunk);
+        io::Reactor::instance().add(io_->native_handle(), *this);
+    }
+    else
+    {
+        rx_thread_.start([this] () { rx_loop(); });
+        tx_thread_.start([this] () { tx_loop(); });
+    }
 }
 
 void AsyncProtocol::stop()
@@ -85,7 +136,17 @@ void AsyncProtocol::stop()
     {
         running_ = false;
 
-        if (messages_.empty())
+        if (reactor_)
+        {
+            // Before the reset, which closes the descriptor.
+            io::Reactor::instance().remove(*this);
+
+            tnt::lock(flush_guard_, [&] ()
+            {
+                fail_unsent(std::make_exception_ptr(ProtocolException(tnt::get_name(*this) + " stopped before the message was sent.")));
+            });
+        }
+        else if (messages_.empty())
         {
             messages_.push(MessageNode(std::make_unique<message::StopMessage>()));
         }
@@ -100,16 +161,25 @@ void AsyncProtocol::stop()
 
 std::future<void> AsyncProtocol::send(std::unique_ptr<Message>&& message)
 {
-    std::promise<void> promise;
+    std::promise<void> promise(std::allocator_arg, PoolAllocator<char>());
     auto future = promise.get_future();
 
-    if (running_)
+    if (!running_)
     {
-        messages_.push(MessageNode(std::move(message), std::move(promise)));
+        promise.set_exception(std::make_exception_ptr(ProtocolException(tnt::get_name(*this) + " is not running.")));
+    }
+    else if (reactor_ && !registered())
+    {
+        promise.set_exception(std::make_exception_ptr(ProtocolException(tnt::get_name(*this) + " connection reset.")));
     }
     else
     {
-        promise.set_exception(std::make_exception_ptr(ProtocolException(tnt::get_name(*this) + " is not running.")));
+        messages_.push(MessageNode(std::move(message), std::move(promise)));
+
+        if (reactor_)
+        {
+            notify_tx();
+        }
     }
 
     return future;
@@ -117,58 +187,157 @@ std::future<void> AsyncProtocol::send(std::unique_ptr<Message>&& message)
 
 void AsyncProtocol::tx_loop()
 {
+    Cork cork(this);
+    std::vector<MessageNode> batch;
+    batch.reserve(tx_batch);
+
     while (running_)
     {
-        auto node = messages_.pop();
-        auto& promise = node.promise;
+        batch.clear();
+        messages_.pop_some(batch, tx_batch);
 
-        try
+        for (size_t i = 0; i < batch.size(); ++i)
         {
-            auto& message = node.message;
-            assert(message);
+            send_node(batch[i], i + 1 == batch.size());
+        }
+    }
+}
 
-            if (!running_)
-            {
-                throw ProtocolException(tnt::get_name(*this) + " is not running.");
-            }
+void AsyncProtocol::send_node(MessageNode& node, bool last)
+{
+    auto& promise = node.promise;
 
-            if (!tx_dispatcher_.inject_object(std::move(message)))
-            {
-                throw ProtocolException(std::string("Unable to dispatch unknown message ") + get_name(message));
-            }
+    try
+    {
+        auto& message = node.message;
+        assert(message);
+
+        if (!running_)
+        {
+            throw ProtocolException(tnt::get_name(*this) + " is not running.");
+        }
+
+        if (!tx_dispatcher_.inject_object(std::move(message)))
+        {
+            throw ProtocolException(std::string("Unable to dispatch unknown message ") + get_name(message));
+        }
+
+        // Coalesce the writes of the queued messages, the framing keeps them apart on the other side.
+        auto idle = last && messages_.empty();
+
+        if (idle)
+        {
+            end_batch();
+        }
+
+        if (idle || tnt::lock(tx_buffer_guard_, [&] () { return tx_buffer_.size() >= tx_flush_size; }))
+        {
+            flush();
+        }
 
-            promise.set_value();
+        if (reactor_)
+        {
+            wait_sent(std::move(promise));
         }
-        catch (...)
+        else
         {
-            promise.set_exception(std::current_exception());
+            promise.set_value(); // io_->write returned, the bytes were sent.
         }
     }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+
+        try
+        {
+            flush(); // Sends what the previous messages left in the buffer.
+        }
+        catch (...) {}
+    }
 }
 
 void AsyncProtocol::write(const std::string& data)
+{
+    write(data.data(), data.size());
+}
+
+void AsyncProtocol::write(const char* data, size_t size)
 {
     if (!running_)
     {
-        Log::error(tnt::get_name(*this), "::write: Error writing a message (", data.size(), " bytes) while not running");
+        Log::error(tnt::get_name(*this), "::write: Error writing a message (", size, " bytes) while not running");
+
+        return;
+    }
+
+    auto pending = tnt::lock(tx_buffer_guard_, [&] ()
+    {
+        if (reactor_ && tx_written_ - tx_sent_ + size > tx_max_unsent)
+        {
+            throw ProtocolException(tnt::get_name(*this) + "::write: " + std::to_string(tx_written_ - tx_sent_) + " bytes not read by the peer, message dropped.");
+        }
+
+        tx_buffer_.append(data, size);
+        tx_written_ += size;
+
+        return tx_buffer_.size();
+    });
+
+    if (corked != this || pending >= tx_flush_size)
+    {
+        flush();
+    }
+}
+
+void AsyncProtocol::flush()
+{
+    // Taken before the swap, so batches go out in the order they were written.
+    std::lock_guard<std::mutex> lock(flush_guard_);
+
+    if (reactor_)
+    {
+        send_some();
 
         return;
     }
 
-    io_->write(data);
+    tnt::lock(tx_buffer_guard_, [&] () { tx_flushing_.swap(tx_buffer_); });
+
+    if (tx_flushing_.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        io_->write(tx_flushing_);
+    }
+    catch (...)
+    {
+        tx_sent_ += tx_flushing_.size();
+        tx_flushing_.clear();
+        throw;
+    }
+
+    tx_sent_ += tx_flushing_.size();
+    tx_flushing_.clear();
 }
 
 void AsyncProtocol::rx_loop()
 {
+    Cork cork(this);
+
     try
     {
-        std::string raw_input;
+        ReceiveBuffer buffer(4 * rx_chunk);
+        std::vector<BufferView> messages;
 
         while (running_)
         {
             try
             {
-                raw_input.append(io_->read());
+                auto data = buffer.prepare(rx_chunk);
+                buffer.commit(io_->read_some(data, buffer.space()));
                 
                 if (!running_)
                 {
@@ -188,7 +357,7 @@ void AsyncProtocol::rx_loop()
             }
             catch (...)
             {
-                raw_input.clear();
+                buffer.clear();
             }
 
             if (!running_)
@@ -196,37 +365,239 @@ void AsyncProtocol::rx_loop()
                 break;
             }
 
-            if (raw_input.empty())
-            {
-                continue;
-            }
+            process(buffer, messages);
+        }
+    }
+    catch (std::exception& ex)
+    {
+        tnt::Log::error(ex.what());
+        assert(false);
+    }
+    catch (...)
+    {
+        assert(false);
+    }
+}
 
-            const auto& messages = parse(raw_input);
+void AsyncProtocol::process(ReceiveBuffer& buffer, std::vector<BufferView>& messages)
+{
+    auto input = buffer.data();
 
-            for_all(messages, [this] (const auto& message)
-            {
-                assert(!message.empty());
+    if (input.empty())
+    {
+        return;
+    }
 
-                try
-                {
-                    invoke_message(message);  
-                }
-                catch (std::exception& ex)
-                {
-                    tnt::Log::error(ex.what());
-                }
-            });
+    messages.clear();
+    auto consumed = parse(input, messages);
+
+    for_all(messages, [this] (const auto& message)
+    {
+        assert(!message.empty());
+
+        try
+        {
+            invoke_message(message);  
         }
+        catch (std::exception& ex)
+        {
+            tnt::Log::error(ex.what());
+        }
+    });
+
+    try
+    {
+        flush();
     }
     catch (std::exception& ex)
     {
         tnt::Log::error(ex.what());
-        assert(false);
+    }
+
+    buffer.consume(consumed);
+}
+
+void AsyncProtocol::readable()
+{
+    Cork cork(this);
+
+    // One read per call: the loop calls again while data is left, after the other IOs.
+    try
+    {
+        size_t length = 0;
+        auto data = rx_buffer_->prepare(rx_chunk);
+
+        if (!io_->try_read_some(data, rx_buffer_->space(), length))
+        {
+            return;
+        }
+
+        rx_buffer_->commit(length);
+    }
+    catch (std::exception& ex)
+    {
+        // Not retried as by the rx thread: the descriptor would be reported again at once.
+        io::Reactor::instance().remove(*this);
+
+        tnt::lock(flush_guard_, [&] ()
+        {
+            fail_unsent(std::make_exception_ptr(ProtocolException(tnt::get_name(*this) + " connection reset before the message was sent.")));
+        });
+
+        if (running_)
+        {
+            if (dynamic_cast<IOReset*>(&ex) == nullptr)
+            {
+                Log::error(tnt::get_name(*this), "::rx error: ", ex.what());
+            }
+
+            Application::raise(tnt::event::ConnectionReset(this), this);
+        }
+
+        return;
+    }
+
+    process(*rx_buffer_, rx_messages_);
+}
+
+void AsyncProtocol::writable()
+{
+    flush();
+
+    // The queue was left alone while the socket was behind, resume it.
+    if (!above_high_water() && !messages_.empty())
+    {
+        notify_tx();
+    }
+}
+
+void AsyncProtocol::notified()
+{
+    Cork cork(this);
+
+    // Cleared before the queue is drained, a message pushed meanwhile notifies again.
+    tx_notified_ = false;
+
+    // The peer is slower than the senders: the messages wait in the queue, writable resumes it.
+    if (above_high_water())
+    {
+        return;
+    }
+
+    tx_pending_.clear();
+    messages_.try_pop_some(tx_pending_, tx_batch);
+
+    for (size_t i = 0; i < tx_pending_.size(); ++i)
+    {
+        send_node(tx_pending_[i], i + 1 == tx_pending_.size());
+    }
+
+    // A batch per call, so that the other protocols of the loop get their turn.
+    if (!messages_.empty() && !above_high_water())
+    {
+        notify_tx();
+    }
+}
+
+void AsyncProtocol::notify_tx()
+{
+    if (!tx_notified_.exchange(true))
+    {
+        io::Reactor::instance().notify(*this);
+    }
+}
+
+// Called with flush_guard_ held. Sends what the socket takes without waiting, the reactor
+// calls writable() when it can take the rest.
+void AsyncProtocol::send_some()
+{
+    tnt::lock(tx_buffer_guard_, [&] ()
+    {
+        if (tx_flushing_.empty())
+        {
+            tx_flushing_.swap(tx_buffer_);
+        }
+        else
+        {
+            tx_flushing_.append(tx_buffer_);
+            tx_buffer_.clear();
+        }
+    });
+
+    size_t sent = 0;
+
+    try
+    {
+        while (sent < tx_flushing_.size())
+        {
+            auto n = io_->try_write_some(tx_flushing_.data() + sent, tx_flushing_.size() - sent);
+
+            if (n == 0)
+            {
+                break;
+            }
+
+            sent += n;
+        }
     }
     catch (...)
     {
-        assert(false);
+        tx_sent_ += tx_flushing_.size();
+        tx_flushing_.clear();
+        fail_unsent(std::current_exception());
+        throw;
+    }
+
+    tx_flushing_.erase(0, sent);
+    tx_sent_ += sent;
+
+    while (!tx_unsent_.empty() && tx_unsent_.front().first <= tx_sent_)
+    {
+        tx_unsent_.front().second.set_value();
+        tx_unsent_.pop_front();
+    }
+
+    auto blocked = !tx_flushing_.empty();
+
+    if (blocked != tx_blocked_)
+    {
+        io::Reactor::instance().want_write(*this, blocked);
+        tx_blocked_ = blocked;
+    }
+}
+
+bool AsyncProtocol::above_high_water()
+{
+    return tnt::lock(tx_buffer_guard_, [&] () { return tx_written_ - tx_sent_ > tx_high_water; });
+}
+
+// The promise of a message is set once the IO took all the bytes written so far, its
+// own included: until then they may still be lost with the connection.
+void AsyncProtocol::wait_sent(std::promise<void>&& promise)
+{
+    auto end = tnt::lock(tx_buffer_guard_, [&] () { return tx_written_; });
+
+    std::lock_guard<std::mutex> lock(flush_guard_);
+
+    if (tx_sent_ >= end)
+    {
+        promise.set_value();
     }
+    else
+    {
+        tx_unsent_.emplace_back(end, std::move(promise));
+    }
+}
+
+// Called with flush_guard_ held.
+void AsyncProtocol::fail_unsent(std::exception_ptr error)
+{
+    for (auto& unsent : tx_unsent_)
+    {
+        unsent.second.set_exception(error);
+    }
+
+    tx_unsent_.clear();
 }
 
 } // namespace protocol
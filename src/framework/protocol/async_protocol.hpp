@@ -32,8 +32,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <thread>
 #include <unordered_map>
 #include <vector>
+#include <deque>
 #include <string>
 #include <atomic>
+#include <mutex>
 #include <stdexcept>
 #include <cstdint>
 
@@ -41,20 +43,28 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "event/event_from_message.hpp"
 
+#include "io/reactor.hpp"
+
+#include "buffer_view.hpp"
 #include "thread.hpp"
 #include "log.hpp"
 #include "dispatch.hpp"
-#include "thread_safe_fifo.hpp"
+#include "mpsc_queue.hpp"
 #include "unpack_tuple.hpp"
 
 namespace tnt {
 
 struct IO;
 struct Message;
+class ReceiveBuffer;
 
 namespace protocol {
 
-class AsyncProtocol: public virtual Protocol
+// By default a protocol has an rx thread blocking on the reads of its IO and a tx thread
+// sending the queued messages. When the io::Reactor is enabled and the IO has a descriptor,
+// the reads and the writes run on a reactor loop instead and the queued messages are sent
+// from its notification thread.
+class AsyncProtocol: public virtual Protocol, private io::Reactor::Handler
 {
     struct MessageNode
     {
@@ -72,9 +82,13 @@ public:
     virtual void start() override;
     virtual std::future<void> send(std::unique_ptr<Message>&& message) override;
 protected:
-    virtual std::vector<std::string> parse(std::string& raw_input) = 0; //! raw_input is passed by non const reference, so parse function can modify it.
-    virtual void invoke_message(const std::string& data) = 0;
+    //! Appends to messages the complete messages at the front of input and returns the bytes they take.
+    //! The views point in the receive buffer and are valid until invoke_message returns.
+    virtual size_t parse(BufferView input, std::vector<BufferView>& messages) = 0;
+    virtual void invoke_message(BufferView data) = 0;
     virtual void register_messages() = 0;
+    //! Called by the tx loop when its queue is empty, before sending the buffered writes.
+    virtual void end_batch() {}
 
     template<class U, class F> void register_message(F func)
     {
@@ -98,15 +112,32 @@ protected:
         }
     }
 
+    //! Queues data in the send buffer of the connection. The buffer is sent at once when the
+    //! rx or tx loop ends its batch of messages, or right away when written by another thread.
+    //! On the reactor, throws ProtocolException if the peer left too many bytes unread.
     void write(const std::string& data);
+    void write(const char* data, size_t size);
+    void flush();
 private:
     void stop();
 
     // Rx members
     void rx_loop();
+    void process(ReceiveBuffer& buffer, std::vector<BufferView>& messages);
     
     // Tx members
     void tx_loop();
+    void send_node(MessageNode& node, bool last);
+
+    // Reactor members
+    virtual void readable() override;
+    virtual void writable() override;
+    virtual void notified() override;
+    void notify_tx();
+    void send_some();
+    bool above_high_water();
+    void wait_sent(std::promise<void>&& promise);
+    void fail_unsent(std::exception_ptr error);
 private:
     // Shared members
     std::atomic_bool running_;
@@ -116,10 +147,26 @@ private:
     tnt::Thread rx_thread_;
 
     // Tx members
-    ThreadSafeFIFO<MessageNode> messages_;
+    MPSCQueue<MessageNode> messages_;
 
     tnt::Thread tx_thread_;
     TypeDispatch<void, std::unique_ptr<Message>> tx_dispatcher_;
+
+    std::mutex tx_buffer_guard_;
+    std::string tx_buffer_;
+    uint64_t tx_written_ = 0; // Bytes ever appended to tx_buffer_.
+    std::mutex flush_guard_;
+    std::string tx_flushing_;
+    std::atomic<uint64_t> tx_sent_; // Bytes ever taken by the IO, or dropped on error.
+
+    // Reactor members
+    bool reactor_;
+    std::unique_ptr<ReceiveBuffer> rx_buffer_;
+    std::vector<BufferView> rx_messages_;
+    std::vector<MessageNode> tx_pending_;
+    std::atomic_bool tx_notified_;
+    bool tx_blocked_;
+    std::deque<std::pair<uint64_t, std::promise<void>>> tx_unsent_; // Promises by the end of their bytes, under flush_guard_.
 };
 
 } // namespace protocol
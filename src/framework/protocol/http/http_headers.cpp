@@ -27,7 +27,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "http_headers.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <cctype>
 
 #include "containers.hpp"
 #include "log.hpp"
@@ -35,8 +36,21 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace tnt {
 namespace protocol {
 
+namespace {
+
 const char* end_line = "\r\n";
 
+// Header names are case-insensitive.
+bool same_name(const std::string& a, const std::string& b)
+{
+    return a.size() == b.size() && std::equal(std::begin(a), std::end(a), std::begin(b), [] (char x, char y)
+    {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+} // namespace
+
 HttpHeaders::HttpHeaders() {}
 
 HttpHeaders::HttpHeaders(std::initializer_list<value_type> init) : headers_{ init } {}
@@ -60,12 +74,12 @@ const HttpHeaders::mapped_type& HttpHeaders::operator[](const key_type& key) con
 {
     auto it = tnt::find_if(headers_, [&] (const auto& p)
     {
-        return p.first == key;
+        return same_name(p.first, key);
     });
 
     if (it == std::end(headers_))
     {
-        throw HttpHeaderNotFound(std::string("Header ") + key + "not found");
+        throw HttpHeaderNotFound(std::string("Header ") + key + " not found");
     }
     
     return it->second;
@@ -85,7 +99,7 @@ bool HttpHeaders::contains(const key_type& key) const
 {
     return tnt::contains_if(headers_, [&] (const auto& p)
     {
-        return p.first == key;
+        return same_name(p.first, key);
     });
 }
 
@@ -96,14 +110,14 @@ std::string HttpHeaders::to_string() const
 		return "";
 	}
 
-	std::ostringstream oss;
+	std::string str;
 
 	for (const auto& p : headers_)
 	{
-		oss << p.first << ": " << p.second << end_line;
+		str.append(p.first).append(": ").append(p.second).append(end_line);
 	}
 
-	return oss.str();
+	return str;
 }
 
 HttpHeaders operator+(const HttpHeaders& h0, const HttpHeaders& h1)
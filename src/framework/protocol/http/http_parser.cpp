@@ -0,0 +1,302 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "http_parser.hpp"
+
+#include <cctype>
+#include <cstring>
+
+namespace tnt {
+namespace protocol {
+namespace {
+
+// Largest head and body accepted, a larger message is refused.
+const size_t max_head_size = 64 * 1024;
+const size_t max_body_size = 16 * 1024 * 1024;
+
+const char end_head[] = "\r\n\r\n";
+
+size_t find(BufferView view, char c, size_t pos = 0)
+{
+    if (pos >= view.size())
+    {
+        return BufferView::npos;
+    }
+
+    auto p = static_cast<const char*>(std::memchr(view.data() + pos, c, view.size() - pos));
+
+    return p == nullptr ? BufferView::npos : static_cast<size_t>(p - view.data());
+}
+
+// Header names are case-insensitive, str is lower case.
+bool iequals(BufferView view, const char* str)
+{
+    auto len = std::strlen(str);
+
+    if (view.size() != len)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (std::tolower(static_cast<unsigned char>(view[i])) != str[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+BufferView trim(BufferView view)
+{
+    size_t begin = 0;
+    size_t end = view.size();
+
+    while (begin < end && (view[begin] == ' ' || view[begin] == '\t'))
+    {
+        ++begin;
+    }
+
+    while (end > begin && (view[end - 1] == ' ' || view[end - 1] == '\t'))
+    {
+        --end;
+    }
+
+    return view.substr(begin, end - begin);
+}
+
+// Calls func(name, value) for the header lines after the start line of message, returns
+// where its body starts. Lines without a colon are skipped.
+template <class F> size_t for_each_header(BufferView message, F func)
+{
+    auto pos = message.find("\r\n");
+
+    while (pos != BufferView::npos)
+    {
+        pos += 2;
+
+        auto eol = message.find("\r\n", pos);
+
+        if (eol == BufferView::npos || eol == pos)
+        {
+            return eol == BufferView::npos ? message.size() : eol + 2;
+        }
+
+        auto line = message.substr(pos, eol - pos);
+        auto colon = find(line, ':');
+
+        if (colon != BufferView::npos)
+        {
+            func(trim(line.substr(0, colon)), trim(line.substr(colon + 1)));
+        }
+
+        pos = eol;
+    }
+
+    return message.size();
+}
+
+} // namespace
+
+HttpParser::HttpParser(): scanned_(0), head_size_(0), body_size_(0), until_close_(false), failed_(false), error_(HttpStatusCode::BadRequest) {}
+
+size_t HttpParser::parse(BufferView input, std::vector<BufferView>& messages)
+{
+    size_t used = 0;
+
+    while (!failed_)
+    {
+        auto rest = input.substr(used);
+
+        if (head_size_ == 0)
+        {
+            // Empty lines before a message are ignored.
+            if (scanned_ == 0 && rest.starts_with("\r\n"))
+            {
+                used += 2;
+                continue;
+            }
+
+            // The end of the head may straddle the bytes already searched.
+            auto end = rest.find(end_head, scanned_ > 3 ? scanned_ - 3 : 0);
+
+            if (end == BufferView::npos)
+            {
+                scanned_ = rest.size();
+
+                if (scanned_ > max_head_size)
+                {
+                    fail(HttpStatusCode::BadRequest);
+                }
+
+                break;
+            }
+
+            head_size_ = end + 4;
+
+            if (head_size_ > max_head_size)
+            {
+                fail(HttpStatusCode::BadRequest);
+                break;
+            }
+
+            if (!read_head(rest.substr(0, head_size_)))
+            {
+                break;
+            }
+        }
+
+        // A response without a length ends with the connection, what has arrived is taken as it is.
+        auto size = until_close_ ? rest.size() : head_size_ + body_size_;
+
+        if (rest.size() < size)
+        {
+            break;
+        }
+
+        messages.push_back(rest.substr(0, size));
+        used += size;
+
+        scanned_ = head_size_ = body_size_ = 0;
+        until_close_ = false;
+    }
+
+    return used;
+}
+
+bool HttpParser::failed() const
+{
+    return failed_;
+}
+
+HttpStatusCode HttpParser::error() const
+{
+    return error_;
+}
+
+bool HttpParser::read_head(BufferView head)
+{
+    auto valid = true;
+    auto has_length = false;
+    auto chunked = false;
+    size_t length = 0;
+
+    for_each_header(head, [&] (BufferView name, BufferView value)
+    {
+        if (iequals(name, "content-length"))
+        {
+            size_t n = 0;
+
+            for (auto c : value)
+            {
+                if (!std::isdigit(static_cast<unsigned char>(c)) || n > max_body_size)
+                {
+                    valid = false;
+                    break;
+                }
+
+                n = n * 10 + static_cast<size_t>(c - '0');
+            }
+
+            valid &= !value.empty() && (!has_length || n == length);
+            has_length = true;
+            length = n;
+        }
+        else if (iequals(name, "transfer-encoding"))
+        {
+            chunked = true;
+        }
+    });
+
+    if (!valid || length > max_body_size)
+    {
+        return fail(HttpStatusCode::BadRequest);
+    }
+
+    if (chunked)
+    {
+        return fail(HttpStatusCode::NotImplemented);
+    }
+
+    body_size_ = length;
+
+    if (!has_length && head.starts_with("HTTP/"))
+    {
+        // "HTTP/1.1 204 ...": 1xx, 204 and 304 responses have no body.
+        auto code = head.substr(9, 3);
+        until_close_ = !(code.starts_with("1") || code.starts_with("204") || code.starts_with("304"));
+    }
+
+    return true;
+}
+
+bool HttpParser::fail(HttpStatusCode code)
+{
+    failed_ = true;
+    error_ = code;
+
+    return false;
+}
+
+HttpMessageView::HttpMessageView(BufferView message)
+{
+    auto eol = message.find("\r\n");
+    auto line = message.substr(0, eol);
+
+    // The reason phrase of a response may contain spaces, the last part takes the rest of the line.
+    auto first = find(line, ' ');
+    auto second = first == BufferView::npos ? BufferView::npos : find(line, ' ', first + 1);
+
+    start[0] = line.substr(0, first);
+
+    if (first != BufferView::npos)
+    {
+        start[1] = line.substr(first + 1, second == BufferView::npos ? BufferView::npos : second - first - 1);
+    }
+
+    if (second != BufferView::npos)
+    {
+        start[2] = line.substr(second + 1);
+    }
+
+    auto body_start = for_each_header(message, [this] (BufferView name, BufferView value)
+    {
+        headers.emplace_back(name, value);
+    });
+
+    body = message.substr(body_start);
+}
+
+bool HttpMessageView::is_request() const
+{
+    return !start[0].starts_with("HTTP/");
+}
+
+} // namespace protocol
+} // namespace tnt
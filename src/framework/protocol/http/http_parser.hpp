@@ -0,0 +1,88 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TNT_PROTOCOL_HTTP_PARSER_HPP_
+#define TNT_PROTOCOL_HTTP_PARSER_HPP_
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+#include "protocol/http/http_status_code.hpp"
+
+#include "buffer_view.hpp"
+
+namespace tnt {
+namespace protocol {
+
+// Frames the HTTP/1.1 messages of a connection in its receive buffer.
+//
+// The head of a message is searched for its end only in the bytes that arrived since the
+// previous call, its length is read once, when the head is complete, and every complete
+// message in the input is returned, so pipelined requests are not lost.
+class HttpParser
+{
+public:
+    HttpParser();
+
+    // Appends to messages the complete messages at the front of input and returns the bytes
+    // they take. The input must start with the bytes the previous call did not take. On a
+    // malformed or too large message it stops there and failed() is true from then on.
+    size_t parse(BufferView input, std::vector<BufferView>& messages);
+
+    bool failed() const;
+    // The status to answer a failed message with.
+    HttpStatusCode error() const;
+private:
+    bool read_head(BufferView head);
+    bool fail(HttpStatusCode code);
+private:
+    size_t scanned_;
+    size_t head_size_;
+    size_t body_size_;
+    bool until_close_;
+    bool failed_;
+    HttpStatusCode error_;
+};
+
+// The parts of a complete message framed by HttpParser, views in its buffer.
+struct HttpMessageView
+{
+    explicit HttpMessageView(BufferView message);
+
+    bool is_request() const;
+
+    // Request: method, target and version. Response: version, code and reason.
+    BufferView start[3];
+    std::vector<std::pair<BufferView, BufferView>> headers;
+    BufferView body;
+};
+
+} // namespace protocol
+} // namespace tnt
+
+#endif
@@ -27,13 +27,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "http_protocol.hpp"
 
-#include <sstream>
-#include <cassert>
 #include <string>
 
 #include "event/http/http_request.hpp"
 #include "event/http/http_response.hpp"
 #include "event/event_from_message.hpp"
+#include "event/network/connection_reset.hpp"
 
 #include "message/http/http_request.hpp"
 #include "message/http/http_response.hpp"
@@ -50,39 +49,18 @@ namespace tnt {
 namespace protocol {
 namespace {
 
-protocol::HttpHeaders get_headers(std::istringstream& stm)
-{
-    protocol::HttpHeaders hdr;
-    std::string line;
-
-    while (std::getline(stm, line, '\r'))
-	{
-		if (line == "\n")
-		{
-			continue;
-		}
-
-		auto pos = line.find(": ");
-		assert(pos != std::string::npos);
-
-        auto s_pos = 0;
-        auto e_pos = pos;
-
-        if (line[0] == '\n')
-        {
-            s_pos = 1;
-            --e_pos;
-        }
+const std::string end_line = "\r\n";
 
-		hdr.insert(std::make_pair(line.substr(s_pos, e_pos), line.substr(pos + 2)));
-	}
+void append_headers(std::string& out, const HttpHeaders& headers)
+{
+    for (const auto& p : headers)
+    {
+        out.append(p.first).append(": ").append(p.second).append(end_line);
+    }
 
-    return hdr;
+    out.append(end_line);
 }
 
-const std::string end_line = "\r\n";
-const std::string end_headers = "\r\n\r\n";
-
 } // namespace
 
 std::string get_connection(bool close)
@@ -90,43 +68,29 @@ std::string get_connection(bool close)
     return close ? "Close" : "Keep-Alive";
 }
 
-HttpProtocol::HttpProtocol(const std::shared_ptr<IO>& io) : AsyncProtocol(io) {}
+HttpProtocol::HttpProtocol(const std::shared_ptr<IO>& io) : AsyncProtocol(io), broken_(false) {}
 
-void HttpProtocol::invoke_message(const std::string& message)
+void HttpProtocol::invoke_message(BufferView message)
 {
 	try
 	{
-        auto pos = message.find(end_headers);
-		auto headers = message.substr(0, pos);
-		auto body = message.substr(pos + end_headers.size());
-
-		std::istringstream stm(headers);
-		std::string line;
-		std::getline(stm, line);
-
-        auto is_request = line.find("HTTP/") != 0;
+        HttpMessageView view(message);
+        HttpHeaders headers;
 
-        if (is_request)
+        for (const auto& p : view.headers)
         {
-            std::istringstream iss(line);
-		    std::string method;
-		    std::string uri;
-		    std::string version;
-
-		    iss >> method >> uri >> version;
+            headers.insert(std::make_pair(p.first.str(), p.second.str()));
+        }
 
-            Application::raise(std::make_shared<event::HttpRequest>(web::http::uri(uri), version, method_from_string(method), get_headers(stm), body), this);
+        if (view.is_request())
+        {
+            Application::raise(std::make_shared<event::HttpRequest>(web::http::uri(view.start[1].str()), view.start[2].str(), method_from_string(view.start[0].str()), headers, view.body.str()), this);
         }
         else // Response
         {
-            std::istringstream iss(line);
-		    std::string version;
-            HttpStatusCode code;
-            std::string code_msg;
-
-		    iss >> version >> code >> code_msg;
+            auto code = static_cast<HttpStatusCode>(tnt::stoi(view.start[1].str()));
 
-            Application::raise(event::HttpResponse(version, code, code_msg, get_headers(stm), body));
+            Application::raise(event::HttpResponse(view.start[0].str(), code, view.start[2].str(), headers, view.body.str()));
         }
 	}
 	catch (...)
@@ -135,41 +99,33 @@ void HttpProtocol::invoke_message(const std::string& message)
 	}
 }
 
-std::vector<std::string> HttpProtocol::parse(std::string& raw_input)
+size_t HttpProtocol::parse(BufferView input, std::vector<BufferView>& messages)
 {
-    auto pos = raw_input.find(end_headers);
-
-    if (pos == std::string::npos)
+    // After a malformed message the framing of the stream is lost, what follows is dropped
+    // until the peer closes the connection.
+    if (broken_)
     {
-        return {};
+        return input.size();
     }
 
-	auto headers = raw_input.substr(0, pos);
-    auto body = raw_input.substr(pos + end_headers.size());
-
-    auto s_pos = headers.find("Content-Length: ");
+    auto used = parser_.parse(input, messages);
 
-    if (s_pos == std::string::npos)
+    if (!parser_.failed())
     {
-        auto message = raw_input;
-	    raw_input.clear();
-
-	    return { message };
+        return used;
     }
 
-    s_pos += 15;
-    auto e_pos = headers.find(end_line, s_pos);
-    decltype(body.size()) len = std::stoi(headers.substr(s_pos, e_pos - s_pos));
+    // The requests before the malformed one are dropped with it: the error goes out now and the
+    // connection is given up as if reset by the peer, its activity stops and closes it.
+    messages.clear();
+    broken_ = true;
 
-    if (body.size() == len)
-    {
-        auto message = raw_input;
-	    raw_input.clear();
+    send(parser_.error() == HttpStatusCode::NotImplemented ? HttpResponse::not_implemented(true) : HttpResponse::bad_request(true));
+    flush();
 
-	    return { message };
-    }
+    Application::raise(event::ConnectionReset(this), this);
 
-    return {};
+    return input.size();
 }
 
 void HttpProtocol::register_messages()
@@ -187,32 +143,29 @@ void HttpProtocol::register_messages()
 
 void HttpProtocol::send(const HttpResponse& response)
 {
-	std::ostringstream oss;
+    auto out = response.version();
 
-	oss << response.version() << " " << static_cast<int>(response.code()) << " " << code_to_string(response.code()) << end_line;
-	oss << response.headers().to_string() << end_line;
+    out.append(" ").append(std::to_string(static_cast<int>(response.code()))).append(" ").append(code_to_string(response.code())).append(end_line);
+    append_headers(out, response.headers());
 
-	if (!response.body().empty())
-	{
-		oss << response.body();
-	}
+	write(out);
 
-	write(oss.str());
+    // Straight from the response, which may share it with a cache.
+    if (!response.body().empty())
+    {
+        write(response.body());
+    }
 }
 
 void HttpProtocol::send(const HttpRequest& request)
 {
-	std::ostringstream oss;
-
-	oss << method_to_string(request.method()) << " " << request.uri().to_string() << " " << request.version() << end_line;
-	oss << request.headers().to_string() << end_line;
+    auto out = method_to_string(request.method());
 
-	if (!request.body().empty())
-	{
-		oss << request.body();
-	}
+    out.append(" ").append(request.uri().to_string()).append(" ").append(request.version()).append(end_line);
+    append_headers(out, request.headers());
+    out.append(request.body());
 
-	write(oss.str());
+	write(out);
 }
 
 } // namespace protocol
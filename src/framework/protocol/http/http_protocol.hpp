@@ -29,6 +29,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define TNT_PROTOCOL_HTTP_PROTOCOL_HPP_
 
 #include "protocol/async_protocol.hpp"
+#include "protocol/http/http_parser.hpp"
 
 namespace tnt {
 namespace protocol {
@@ -45,12 +46,15 @@ public:
 
     using AsyncProtocol::send;
 private:
-    virtual std::vector<std::string> parse(std::string& raw_input) override; //! raw_input is passed by non const reference, so parse function can modify it.
-    virtual void invoke_message(const std::string& data) override;
+    virtual size_t parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages) override;
+    virtual void invoke_message(tnt::BufferView data) override;
     virtual void register_messages() override;
 
 	void send(const HttpResponse& response);
     void send(const HttpRequest& request);
+
+    HttpParser parser_;
+    bool broken_;
 };
 
 } // namespace protocol
@@ -27,6 +27,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "http_response.hpp"
 
+#include <cassert>
+
 #include "protocol/http/http_protocol.hpp"
 
 #include "util/string.hpp"
@@ -34,12 +36,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace tnt {
 namespace protocol {
 
-HttpResponse::HttpResponse(HttpStatusCode code, const HttpHeaders& headers, const std::string& body): version_("HTTP/1.1"), code_(code), headers_(headers), body_(body) {}
+HttpResponse::HttpResponse(HttpStatusCode code, const HttpHeaders& headers, const std::string& body): version_("HTTP/1.1"), code_(code), headers_(headers), body_(std::make_shared<const std::string>(body)) {}
+
+HttpResponse::HttpResponse(HttpStatusCode code, const HttpHeaders& headers, const std::shared_ptr<const std::string>& body): version_("HTTP/1.1"), code_(code), headers_(headers), body_(body)
+{
+	assert(body_);
+}
 
 HttpResponse HttpResponse::bad_request(bool close)
 {
 	auto resp = HttpResponse(HttpStatusCode::BadRequest, { { "Connection", protocol::get_connection(close) }, { "Content-Type", "text/plain" } }, "Bad Request");
-	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_.size()) });
+	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_->size()) });
 
 	return resp;
 }
@@ -47,7 +54,7 @@ HttpResponse HttpResponse::bad_request(bool close)
 HttpResponse HttpResponse::not_found(bool close)
 {
 	auto resp = HttpResponse(HttpStatusCode::NotFound, { { "Connection", protocol::get_connection(close) }, { "Content-Type", "text/plain" } }, "Not Found");
-	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_.size()) });
+	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_->size()) });
 
 	return resp;
 }
@@ -55,7 +62,7 @@ HttpResponse HttpResponse::not_found(bool close)
 HttpResponse HttpResponse::internal_error(bool close)
 {
 	auto resp = HttpResponse(HttpStatusCode::InternalServerError, { { "Connection", protocol::get_connection(close) }, { "Content-Type", "text/plain" } }, "Internal Server Error");
-	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_.size()) });
+	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_->size()) });
 
 	return resp;
 }
@@ -63,7 +70,7 @@ HttpResponse HttpResponse::internal_error(bool close)
 HttpResponse HttpResponse::not_implemented(bool close)
 {
 	auto resp = HttpResponse(HttpStatusCode::NotImplemented, { { "Connection", protocol::get_connection(close) }, { "Content-Type", "text/plain" } }, "Not Implemented");
-	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_.size()) });
+	resp.headers_.insert({ "Content-Length", tnt::to_string(resp.body_->size()) });
 
 	return resp;
 }
@@ -29,6 +29,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define TNT_HTTP_RESPONSE_HPP_
 
 #include <string>
+#include <memory>
 
 #include "protocol/http/http_status_code.hpp"
 #include "protocol/http/http_headers.hpp"
@@ -40,6 +41,8 @@ class HttpResponse
 {
 public:
 	HttpResponse(HttpStatusCode code, const HttpHeaders& headers, const std::string& body = "");
+	//! Shares body, which is not copied until it is written to the connection.
+	HttpResponse(HttpStatusCode code, const HttpHeaders& headers, const std::shared_ptr<const std::string>& body);
 
 	static HttpResponse bad_request(bool close = false);
 	static HttpResponse not_found(bool close = false);
@@ -68,13 +71,13 @@ public:
 
 	const std::string& body() const
 	{
-		return body_;
+		return *body_;
 	}
 private:
 	std::string version_;
 	HttpStatusCode code_;
 	HttpHeaders headers_;
-	std::string body_;
+	std::shared_ptr<const std::string> body_;
 };
 
 } // namespace protocol
@@ -40,6 +40,8 @@ std::string code_to_string(HttpStatusCode code)
 		return "OK";
 	case HttpStatusCode::MovedPermanently:
 		return "Moved Permanently";
+	case HttpStatusCode::NotModified:
+		return "Not Modified";
 	case HttpStatusCode::BadRequest:
 		return "Bad Request";
 	case HttpStatusCode::Unauthorized:
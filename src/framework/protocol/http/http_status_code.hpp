@@ -39,6 +39,7 @@ enum class HttpStatusCode
 	OK = 200,
 
 	MovedPermanently = 301,
+	NotModified = 304,
 
 	BadRequest = 400,
 	Unauthorized = 401,
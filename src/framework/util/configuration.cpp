@@ -27,35 +27,122 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "configuration.hpp"
 
+#include <mutex>
+#include <cassert>
+
 namespace tnt {
 
 namespace pt = boost::property_tree;
 
-std::unique_ptr<Configuration> Configuration::instance_;
+namespace {
+
+struct State
+{
+    std::mutex guard; // Serializes the writers, the readers only load current.
+    std::vector<detail::ConfigResolver> keys;
+    std::shared_ptr<const Configuration::Snapshot> current; // Through std::atomic_load and std::atomic_store.
+};
 
-Configuration::Configuration() {}
-Configuration::Configuration(pt::ptree config): config_{ config } {}
+State& state()
+{
+    // Never destroyed: keys are added by static constructors and the snapshots are read until exit.
+    static auto s = new State;
+
+    return *s;
+}
+
+void publish(State& s, std::shared_ptr<const Configuration::Snapshot> snapshot)
+{
+    // The previous snapshot is freed here, or by the last reader still holding it.
+    std::atomic_store_explicit(&s.current, std::move(snapshot), std::memory_order_release);
+}
+
+} // namespace
 
 void Configuration::default_init()
 {
-    instance_ = std::make_unique<Configuration>();
+    read(pt::ptree());
 }
 
 void Configuration::read(pt::ptree config)
 {
-	instance_ = std::make_unique<Configuration>(config);
+    update([&config] (pt::ptree& tree)
+    {
+        tree = std::move(config);
+
+        return true;
+    });
 }
 
 bool Configuration::exists(const std::string& path)
 {
-    return instance_->config_.get_child_optional(path).is_initialized();
+    return snapshot()->tree().get_child_optional(path).is_initialized();
 }
 
-Configuration::ConfigurationProxy::ConfigurationProxy(pt::ptree config, const std::string& key): config_{ config }, key_{ key } {}
+Configuration::ConfigurationProxy::ConfigurationProxy(std::shared_ptr<const Snapshot> snapshot, const std::string& key): snapshot_(std::move(snapshot)), key_{ key } {}
 
 const Configuration::ConfigurationProxy Configuration::get(const std::string& key)
 {
-    return ConfigurationProxy(instance_->config_, key);
+    return ConfigurationProxy(snapshot(), key);
+}
+
+std::shared_ptr<const Configuration::Snapshot> Configuration::snapshot()
+{
+    auto current = std::atomic_load_explicit(&state().current, std::memory_order_acquire);
+    assert(current);
+
+    return current;
+}
+
+size_t Configuration::add_key(detail::ConfigResolver resolver)
+{
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.guard);
+
+    s.keys.push_back(std::move(resolver));
+
+    // Only changed under the lock.
+    const auto& current = s.current;
+
+    if (current)
+    {
+        // Published again with the new key, the other values are shared.
+        auto snapshot = std::make_shared<Snapshot>(*current);
+        snapshot->version_ = current->version_ + 1;
+        snapshot->values_.push_back(s.keys.back()(snapshot->tree_));
+
+        publish(s, std::move(snapshot));
+    }
+
+    return s.keys.size() - 1;
+}
+
+void Configuration::update(const std::function<bool(pt::ptree&)>& change)
+{
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.guard);
+
+    // Only changed under the lock.
+    const auto& current = s.current;
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->version_ = current ? current->version_ + 1 : 1;
+
+    if (current)
+    {
+        snapshot->tree_ = current->tree_;
+    }
+
+    if (!change(snapshot->tree_))
+    {
+        return;
+    }
+
+    for (const auto& key : s.keys)
+    {
+        snapshot->values_.push_back(key(snapshot->tree_));
+    }
+
+    publish(s, std::move(snapshot));
 }
 
 } // namespace tnt
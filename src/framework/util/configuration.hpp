@@ -30,31 +30,78 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string>
 #include <memory>
-#include <cassert>
+#include <vector>
+#include <functional>
+#include <cstdint>
 
 #include <boost/property_tree/ptree.hpp>
 
 #include "exception/exception.hpp"
 
-#include "memory.hpp"
-
 namespace tnt {
 
 namespace pt = boost::property_tree;
 
+namespace detail {
+
+// The value of a ConfigKey in a snapshot, or the error reading it.
+struct ConfigValue
+{
+    virtual ~ConfigValue() {}
+
+    std::string error;
+};
+
+template <class T> struct TypedConfigValue: ConfigValue
+{
+    T value{};
+};
+
+using ConfigResolver = std::function<std::shared_ptr<const ConfigValue>(const pt::ptree&)>;
+
+} // namespace detail
+
+template <class T> class ConfigKey;
+
+// The configuration is published as immutable snapshots: read, set and set_default build
+// a new one and swap it in, so that every thread keeps reading a consistent one. The
+// ConfigKeys are resolved when a snapshot is built, get(key) looks the key up in the
+// tree of the current snapshot. A snapshot is shared by its readers and freed by the
+// last one once a newer one is published.
 class Configuration
 {
+public:
+    class Snapshot
+    {
+    public:
+        const pt::ptree& tree() const
+        {
+            return tree_;
+        }
+
+        uint64_t version() const
+        {
+            return version_;
+        }
+    private:
+        friend class Configuration;
+        template <class T> friend class ConfigKey;
+
+        pt::ptree tree_;
+        uint64_t version_ = 0;
+        std::vector<std::shared_ptr<const detail::ConfigValue>> values_;
+    };
 private:
     class ConfigurationProxy
     {
     public:
-		ConfigurationProxy(pt::ptree config, const std::string& key);
+        ConfigurationProxy(std::shared_ptr<const Snapshot> snapshot, const std::string& key);
 
         template <class T> T as() const
         {
             try
             {
-                return config_.get<T>(key_);
+                return snapshot_->tree().get<T>(key_);
             }
             catch (std::exception& ex)
             {
@@ -62,20 +109,20 @@ private:
             } 
         }
     private:
-        pt::ptree config_;
+        std::shared_ptr<const Snapshot> snapshot_;
         std::string key_;
     };
 
     template <class T> class ConfigurationProxyWithDefault
     {
     public:
-        ConfigurationProxyWithDefault(pt::ptree config, const std::string& key, T default_value): config_{ config }, key_{ key }, default_value_{ default_value } {}
+        ConfigurationProxyWithDefault(std::shared_ptr<const Snapshot> snapshot, const std::string& key, T default_value): snapshot_(std::move(snapshot)), key_{ key }, default_value_{ default_value } {}
 
         operator T() const
         {
             try
             {
-                return config_.get<T>(key_, default_value_);
+                return snapshot_->tree().get<T>(key_, default_value_);
             }
             catch (std::exception& ex)
             {
@@ -83,25 +130,27 @@ private:
             }
         }
     private:
-        pt::ptree config_;
+        std::shared_ptr<const Snapshot> snapshot_;
         std::string key_;
         T default_value_;
     };
 
-    template <class T> void set_value(const std::string& key, T value, bool overwrite)
+    template <class T> static void set_value(const std::string& key, T value, bool overwrite)
     {
-        if (!overwrite && instance_->config_.get_child_optional(key).is_initialized())
+        update([&] (pt::ptree& config)
         {
-            return;
-        }
+            if (!overwrite && config.get_child_optional(key).is_initialized())
+            {
+                return false;
+            }
 
-        config_.put(key, value);
+            config.put(key, value);
+
+            return true;
+        });
     }
 public:
-    Configuration();
-    explicit Configuration(pt::ptree config);
-    Configuration(const Configuration&) = delete;
-    Configuration& operator=(const Configuration&) = delete;
+    Configuration() = delete;
 
     static void default_init();
     static void read(pt::ptree config);
@@ -110,25 +159,93 @@ public:
 
     template <class T> static const ConfigurationProxyWithDefault<T> get(const std::string& key, T default_value)
     {
-        assert(instance_);
-
-        return ConfigurationProxyWithDefault<T>(instance_->config_, key, default_value);
+        return ConfigurationProxyWithDefault<T>(snapshot(), key, default_value);
     }
 
     template <class T> static void set(const std::string& key, T value)
     {
-        assert(instance_);
-        instance_->set_value(key, value, true);
+        set_value(key, value, true);
     }
 
     template <class T> static void set_default(const std::string& key, T value)
     {
-        assert(instance_);
-        instance_->set_value(key, value, false);
+        set_value(key, value, false);
+    }
+
+    // The current snapshot, kept alive as long as the caller holds it.
+    static std::shared_ptr<const Snapshot> snapshot();
+private:
+    template <class T> friend class ConfigKey;
+
+    // Returns the index of the value of the key in the snapshots.
+    static size_t add_key(detail::ConfigResolver resolver);
+
+    // Publishes a copy of the current tree changed by change, unless it returns false.
+    static void update(const std::function<bool(pt::ptree&)>& change);
+};
+
+// A key resolved once per snapshot, so a read does not parse nor search the tree: it
+// loads the current snapshot, which takes a lock of the shared_ptr atomics, and indexes
+// its values. The value is returned by copy, the snapshot it comes from may be freed by
+// a reload right after.
+// Meant to be declared once, at namespace scope or static, and read many times.
+template <class T> class ConfigKey
+{
+public:
+    explicit ConfigKey(const std::string& key) : index_(Configuration::add_key([key] (const pt::ptree& config)
+    {
+        return resolve(key, [&] ()
+        {
+            return config.get<T>(key);
+        });
+    })) {}
+
+    ConfigKey(const std::string& key, T default_value) : index_(Configuration::add_key([key, default_value] (const pt::ptree& config)
+    {
+        return resolve(key, [&] ()
+        {
+            return config.get<T>(key, default_value);
+        });
+    })) {}
+
+    ConfigKey(const ConfigKey&) = delete;
+    ConfigKey& operator=(const ConfigKey&) = delete;
+
+    T get() const
+    {
+        auto snapshot = Configuration::snapshot();
+        auto& value = *snapshot->values_[index_];
+
+        if (!value.error.empty())
+        {
+            throw ConfigurationError(value.error);
+        }
+
+        return static_cast<const detail::TypedConfigValue<T>&>(value).value;
+    }
+
+    operator T() const
+    {
+        return get();
+    }
+private:
+    template <class F> static std::shared_ptr<const detail::ConfigValue> resolve(const std::string& key, F read)
+    {
+        auto value = std::make_shared<detail::TypedConfigValue<T>>();
+
+        try
+        {
+            value->value = read();
+        }
+        catch (std::exception& ex)
+        {
+            value->error = R"(Error reading key ")" + key + R"(": )" + ex.what();
+        }
+
+        return value;
     }
 private:
-    pt::ptree config_;
-    static std::unique_ptr<Configuration> instance_;
+    size_t index_;
 };
 
 } // namespace tnt
@@ -27,6 +27,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "crc.hpp"
 
+#include <cstring>
+
 namespace tnt {
 
 uint32_t crc32(const uint8_t* data, size_t len)
@@ -57,34 +59,60 @@ uint32_t crc32(const std::string& str)
 
 uint16_t crc16(const uint8_t* packet, size_t len)
 {
-	const uint16_t* ptr;
+	// The one's complement sum is computed on 32 bit words with four independent 64 bit
+	// accumulators, so the additions can be pipelined (or vectorized) and the carries are
+	// folded only once at the end. The result is the same as summing 16 bit words.
+	uint64_t sum[4] = { 0, 0, 0, 0 };
+	uint32_t w[4];
 
-#if defined(__i386__) || defined(__x86_64__) || defined(_WIN32)
-	ptr = reinterpret_cast<const uint16_t*>(packet);
-#elif defined(__mips__)
-	// This is like saying: "Yes, I know what I am doing. Do as I say."
-    ptr = reinterpret_cast<const uint16_t*>(reinterpret_cast<const void*>(packet));
-#endif
+	while (len >= sizeof(w))
+	{
+		std::memcpy(w, packet, sizeof(w));
 
-	uint32_t sum = 0;
+		sum[0] += w[0];
+		sum[1] += w[1];
+		sum[2] += w[2];
+		sum[3] += w[3];
 
-	while (len > 1)
+		packet += sizeof(w);
+		len -= sizeof(w);
+	}
+
+	while (len >= sizeof(w[0]))
 	{
-	    sum += *ptr++;
-	    len -= 2;
+		std::memcpy(w, packet, sizeof(w[0]));
+		sum[0] += w[0];
+
+		packet += sizeof(w[0]);
+		len -= sizeof(w[0]);
+	}
+
+	if (len >= 2)
+	{
+		uint16_t h;
+		std::memcpy(&h, packet, sizeof(h));
+		sum[1] += h;
+
+		packet += 2;
+		len -= 2;
 	}
 
 	if (len == 1)
-    {
-	    sum += *reinterpret_cast<const uint8_t*>(ptr);
-    }
+	{
+		uint16_t h = 0;
+		std::memcpy(&h, packet, 1); // Pad the odd byte with zero, whatever the byte order.
+		sum[2] += h;
+	}
 
-	while (sum >> 16)
-    {
-	    sum = (sum & 0xFFFF) + (sum >> 16);
-    }
+	auto total = (sum[0] & 0xFFFFFFFF) + (sum[0] >> 32) + (sum[1] & 0xFFFFFFFF) + (sum[1] >> 32) +
+		(sum[2] & 0xFFFFFFFF) + (sum[2] >> 32) + (sum[3] & 0xFFFFFFFF) + (sum[3] >> 32);
+
+	while (total >> 16)
+	{
+		total = (total & 0xFFFF) + (total >> 16);
+	}
 
-	return static_cast<uint16_t>(~sum);
+	return static_cast<uint16_t>(~total);
 }
 
 uint16_t crc16(const std::string& str)
@@ -36,6 +36,18 @@ namespace tnt {
 uint16_t crc16(const uint8_t* str, size_t len);
 uint16_t crc16(const std::string& str);
 
+// Updates the checksum crc after a 16 bit word changed from old_value to new_value (RFC 1624, eqn. 3).
+// The values are taken as they are in the packet, the byte order does not matter.
+inline uint16_t crc16_update(uint16_t crc, uint16_t old_value, uint16_t new_value)
+{
+	uint32_t sum = static_cast<uint16_t>(~crc) + static_cast<uint16_t>(~old_value) + new_value;
+
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+
+	return static_cast<uint16_t>(~sum);
+}
+
 uint32_t crc32(const uint8_t* str, size_t len);
 uint32_t crc32(const std::string& str);
 
@@ -63,18 +63,19 @@ tnt::MacAddress hw_from_arp(const std::string& ip)
 
     while (std::getline(file, line))
     {
-        if (line.find(ip) == std::string::npos)
-        {
-            continue;
-        }
-
         std::stringstream ss(line);
-        std::string tmp0;
-        int tmp1;
-        int tmp2;
+        std::string address;
+        std::string tmp1;
+        std::string tmp2;
         std::string hw;
 
-        ss >> tmp0 >> tmp1 >> tmp2 >> hw;
+        ss >> address >> tmp1 >> tmp2 >> hw;
+
+        // Compare the whole address field, a substring match takes 10.0.0.1 for 10.0.0.10.
+        if (address != ip)
+        {
+            continue;
+        }
 
         return tnt::MacAddress(hw);
     }
@@ -0,0 +1,126 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DROP_EVENT_OPENFLOW_STATS_HPP_
+#define DROP_EVENT_OPENFLOW_STATS_HPP_
+
+#include <vector>
+#include <cstdint>
+
+namespace tnt {
+
+struct Protocol;
+
+} // namespace tnt
+
+namespace drop {
+namespace event {
+
+// Rates are per second, computed from the counters of two consecutive stats replies.
+struct PortRate
+{
+    uint32_t port_no;
+    float rx_bps;
+    float tx_bps;
+    float rx_pps;
+    float tx_pps;
+    float dropped_pps; // Rx and tx.
+};
+
+struct FlowRate
+{
+    uint64_t id; // Hash of table, priority, cookie and match: stable for the life of the flow.
+    uint8_t table_id;
+    uint16_t priority;
+    float pps;
+    float bps;
+};
+
+struct TableCounters
+{
+    uint8_t table_id;
+    uint32_t active_count;
+    uint64_t lookup_count;
+    uint64_t matched_count;
+};
+
+class PortRates
+{
+public:
+    PortRates(tnt::Protocol* protocol, std::vector<PortRate>&& rates): protocol_(protocol), rates_(std::move(rates)) { }
+
+    tnt::Protocol* protocol() const { return protocol_; }
+    const std::vector<PortRate>& rates() const { return rates_; }
+private:
+    tnt::Protocol* protocol_;
+    std::vector<PortRate> rates_;
+};
+
+class FlowRates
+{
+public:
+    FlowRates(tnt::Protocol* protocol, std::vector<FlowRate>&& rates): protocol_(protocol), rates_(std::move(rates)) { }
+
+    tnt::Protocol* protocol() const { return protocol_; }
+    const std::vector<FlowRate>& rates() const { return rates_; }
+private:
+    tnt::Protocol* protocol_;
+    std::vector<FlowRate> rates_;
+};
+
+class TableStats
+{
+public:
+    TableStats(tnt::Protocol* protocol, std::vector<TableCounters>&& tables): protocol_(protocol), tables_(std::move(tables)) { }
+
+    tnt::Protocol* protocol() const { return protocol_; }
+    const std::vector<TableCounters>& tables() const { return tables_; }
+private:
+    tnt::Protocol* protocol_;
+    std::vector<TableCounters> tables_;
+};
+
+class AggregateStats
+{
+public:
+    AggregateStats(tnt::Protocol* protocol, uint64_t packets, uint64_t bytes, uint32_t flows): protocol_(protocol), packets_(packets), bytes_(bytes), flows_(flows) { }
+
+    tnt::Protocol* protocol() const { return protocol_; }
+    uint64_t packets() const { return packets_; }
+    uint64_t bytes() const { return bytes_; }
+    uint32_t flows() const { return flows_; }
+private:
+    tnt::Protocol* protocol_;
+    uint64_t packets_;
+    uint64_t bytes_;
+    uint32_t flows_;
+};
+
+} // namespace event
+} // namespace drop
+
+#endif
@@ -74,6 +74,11 @@ struct InvalidMessage: public std::runtime_error
     explicit InvalidMessage(const std::string& msg): std::runtime_error(msg) { }
 };
 
+struct LookupTableFull: public std::runtime_error
+{
+    explicit LookupTableFull(const std::string& msg): std::runtime_error(msg) { }
+};
+
 } // namespace drop
 
 #endif
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string>
 #include <vector>
+#include <utility>
 
 #include "message/message.hpp"
 
@@ -43,6 +44,20 @@ namespace drop {
 namespace message {
 
 struct GetRoutes: public virtual tnt::Message {};
+struct GetNeighbors: public virtual tnt::Message {};
+
+// Asks the kernel to resolve address (in network order) on the port, as if a packet was sent to it.
+class ResolveNeighbor: public virtual tnt::Message
+{
+public:
+    ResolveNeighbor(uint32_t address, uint32_t port_index): address_{ address }, port_index_{ port_index } { }
+
+    uint32_t address() const { return address_; }
+    uint32_t port_index() const { return port_index_; }
+private:
+    uint32_t address_;
+    uint32_t port_index_;
+};
 
 class SetPortUp: public virtual tnt::Message
 {
@@ -101,6 +116,15 @@ private:
     tnt::MacAddress mac_;
 };
 
+class AddUserspaceRoutes: public virtual tnt::Message
+{
+public:
+    explicit AddUserspaceRoutes(const std::vector<std::pair<RouteInfo, tnt::MacAddress>>& routes): routes_(routes) {}
+    const std::vector<std::pair<RouteInfo, tnt::MacAddress>>& routes() const { return routes_; }
+private:
+    std::vector<std::pair<RouteInfo, tnt::MacAddress>> routes_;
+};
+
 class DelRoute: public virtual tnt::Message
 {
 public:
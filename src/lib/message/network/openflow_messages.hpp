@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 #include <memory>
 #include <vector>
+#include <future>
 
 #include "protocol/openflow/flow.hpp"
 
@@ -45,22 +46,31 @@ struct Protocol;
 namespace drop {
 namespace message {
     
-class AddFlow: public virtual tnt::Message
+// The future of confirmed() is set when the switch has applied the flow-mod (its barrier
+// reply arrived), or holds the error the switch replied with.
+class FlowMod: public virtual tnt::Message
 {
 public:
-    explicit AddFlow(const protocol::Flow& flow): flow_(flow) {}
+    explicit FlowMod(const protocol::Flow& flow): flow_(flow) {}
     const protocol::Flow& flow() const { return flow_; }
+
+    std::future<void> confirmed() { return confirmation_.get_future(); }
+    std::promise<void>& confirmation() { return confirmation_; }
 private:
     protocol::Flow flow_;
+    std::promise<void> confirmation_;
 };
 
-class RemoveFlow: public virtual tnt::Message
+class AddFlow: public FlowMod
 {
 public:
-    explicit RemoveFlow(const protocol::Flow& flow): flow_(flow) {}
-    const protocol::Flow& flow() const { return flow_; }
-private:
-    protocol::Flow flow_;
+    explicit AddFlow(const protocol::Flow& flow): FlowMod(flow) {}
+};
+
+class RemoveFlow: public FlowMod
+{
+public:
+    explicit RemoveFlow(const protocol::Flow& flow): FlowMod(flow) {}
 };
 
 class ModifyPort: public virtual tnt::Message
@@ -38,22 +38,22 @@ namespace protocol {
 
 Drop::Drop(const std::shared_ptr<tnt::IO>& io): AsyncProtocol(io) {}
 
-void Drop::invoke_message(const std::string& message)
+void Drop::invoke_message(tnt::BufferView message)
 {
     assert(message.size() >= MessageHeader::hdr_len);
     auto hdr = reinterpret_cast<const MessageHeader*>(message.data());
     assert(message.size() == hdr->total_length());
 
-    invoke(hdr->type(), message.substr(MessageHeader::hdr_len));
+    invoke(hdr->type(), message.substr(MessageHeader::hdr_len).str());
 }
 
-std::vector<std::string> Drop::parse(std::string& raw_input)
+size_t Drop::parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages)
 {
-    std::vector<std::string> messages;
+    size_t pos = 0;
 
     while (true)
     {
-        auto len = raw_input.size();
+        auto len = input.size() - pos;
 
         if (len < MessageHeader::hdr_len)
         {
@@ -61,7 +61,7 @@ std::vector<std::string> Drop::parse(std::string& raw_input)
             break;
         }
 
-        auto hdr = reinterpret_cast<const MessageHeader*>(raw_input.data());
+        auto hdr = reinterpret_cast<const MessageHeader*>(input.data() + pos);
         auto packet_len = hdr->total_length();
 
         if (len < packet_len)
@@ -70,21 +70,11 @@ std::vector<std::string> Drop::parse(std::string& raw_input)
             break;
         }
 
-        if (len == packet_len)
-        {
-            // Got one single message.
-            messages.push_back(raw_input);
-            raw_input.clear();
-
-            break;
-        }
-
-        // Got more than one message.
-        messages.push_back(raw_input.substr(0, packet_len));
-        raw_input = raw_input.substr(packet_len);
+        messages.push_back(input.substr(pos, packet_len));
+        pos += packet_len;
     }
 
-    return messages;
+    return pos;
 }
 
 } // namespace protocol
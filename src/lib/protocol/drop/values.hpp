@@ -128,7 +128,10 @@ enum class DropMessage: uint32_t
     SwitchMgrLeaveResponse,       
     TableStatsIn,                 
     TableStatsInResponse,         
-    StopProtocol
+    StopProtocol,
+
+    // Added later, at the end so that the values above stay the same on the wire
+    AddUserspaceRoutes
 };
 
 } // namespace protocol
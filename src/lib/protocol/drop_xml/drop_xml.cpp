@@ -40,7 +40,7 @@ namespace protocol {
 
 DropXml::DropXml(const std::shared_ptr<tnt::IO>& io): AsyncProtocol(io) {}
 
-void DropXml::invoke_message(const std::string& message)
+void DropXml::invoke_message(tnt::BufferView message)
 {
     pugi::xml_document doc;
 	auto result = doc.load_buffer(message.data(), message.size());
@@ -55,24 +55,25 @@ void DropXml::invoke_message(const std::string& message)
     rx_dispatcher_.inject_object(root.first_child().name(), root);
 }
 
-std::vector<std::string> DropXml::parse(std::string& raw_input)
+size_t DropXml::parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages)
 {
-    std::vector<std::string> messages;
+    const auto start_tag_len = 6;
+    const auto end_tag_len = 7;
 
-    while (true)
-    {
-        const auto end_tag_len = 7;
-        auto len = raw_input.size();
+    size_t pos = 0;
 
-        auto pos_s = raw_input.find("<drop>");
-        auto pos_e = raw_input.find("</drop>");
+    while (input.size() - pos >= start_tag_len)
+    {
+        auto rest = input.substr(pos);
 
-        if (pos_s != 0)
+        if (!rest.starts_with("<drop>"))
         {
             throw InvalidMessage("Start tag missing");
         }
 
-        if (pos_e == std::string::npos)
+        auto pos_e = rest.find("</drop>");
+
+        if (pos_e == tnt::BufferView::npos)
         {
             // Got only a part of a message, wait for other data from IO class.
             break;
@@ -80,21 +81,11 @@ std::vector<std::string> DropXml::parse(std::string& raw_input)
 
         pos_e += end_tag_len;
 
-        if (pos_e == len)
-        {
-            // Got one single message.
-            messages.push_back(std::move(raw_input)); // TODO: Check if the move is valid.
-            raw_input.clear();
-
-            break;
-        }
-
-        // Got more than one message.
-        messages.push_back(raw_input.substr(0, pos_e));
-        raw_input = raw_input.substr(pos_e);
+        messages.push_back(rest.substr(0, pos_e));
+        pos += pos_e;
     }
 
-    return messages;
+    return pos;
 }
 
 } // namespace protocol
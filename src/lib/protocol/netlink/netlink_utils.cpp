@@ -30,8 +30,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/asio.hpp>
 
 #include <sstream>
+#include <array>
+#include <algorithm>
 
 #include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
 #include <sys/socket.h> // for sa_family_t
 #include <net/if_arp.h>
 
@@ -43,6 +46,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "router/port_info.hpp"
 #include "router/route_info.hpp"
 #include "router/address_info.hpp"
+#include "router/neighbor_info.hpp"
 
 #include "log.hpp"
 
@@ -441,6 +445,49 @@ RouteInfo route_parser(const nlmsghdr* nlh, bool filter, bool netlink_debug)
     return nr;
 }
 
+NeighborInfo neighbor_parser(const nlmsghdr* nlh, bool filter, bool netlink_debug)
+{
+    NeighborInfo nn = NeighborInfo();
+    ndmsg* ndm = reinterpret_cast<ndmsg*>(NLMSG_DATA(nlh));
+
+    if (netlink_debug)
+    {
+        tnt::Log::info("ndm_family ", (int) ndm->ndm_family, ", ndm_ifindex ", ndm->ndm_ifindex, ", ndm_state ", ndm->ndm_state, ", ndm_flags ", (int) ndm->ndm_flags, ", ndm_type ", (int) ndm->ndm_type);
+    }
+
+    //			FILTERS			//
+    //	NOTE: only IPv4 neighbors, IPv6 ones are not used by the forwarders
+
+    if (filter && ndm->ndm_family != AF_INET)
+    {
+        throw_filtered(nlh);
+    }
+
+    nn.port_index = ndm->ndm_ifindex;
+    nn.state = ndm->ndm_state;
+
+    int len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ndm));
+
+    for (rtattr* nda_attr = reinterpret_cast<rtattr*>(reinterpret_cast<char*>(ndm) + NLMSG_ALIGN(sizeof(*ndm))); RTA_OK(nda_attr, len); nda_attr = RTA_NEXT(nda_attr, len))
+    {
+        if (nda_attr->rta_type == NDA_DST)
+        {
+            nn.address = *reinterpret_cast<uint32_t*>(RTA_DATA(nda_attr));
+        }
+        else if (nda_attr->rta_type == NDA_LLADDR && RTA_PAYLOAD(nda_attr) == 6)
+        {
+            std::array<uint8_t, 6> raw;
+            std::copy_n(reinterpret_cast<const uint8_t*>(RTA_DATA(nda_attr)), raw.size(), std::begin(raw));
+
+            nn.mac = tnt::MacAddress(raw);
+        }
+    }
+
+    if (netlink_debug) tnt::Log::info("\tneighbor ", addr2string(nn.address), " lladdr ", nn.mac, " on port ", nn.port_index, " state ", nn.state);
+
+    return nn;
+}
+
 
 void addattr_l(nlmsghdr *n, unsigned int max_len, int type, const void *data, int alen)
 {
@@ -46,6 +46,7 @@ class NetworkPort;
 struct PortInfo;
 struct RouteInfo;
 struct AddressInfo;
+struct NeighborInfo;
 
 namespace protocol {
 
@@ -58,6 +59,7 @@ int send_to(int sock, const std::string& data, unsigned int max_size, const sock
 std::shared_ptr<NetworkPort> link_parser(const nlmsghdr* nlh, bool filter, bool netlink_debug);
 RouteInfo route_parser(const nlmsghdr* nlh, bool filter, bool netlink_debug);
 AddressInfo address_parser(const nlmsghdr* nlh, bool filter, bool netlink_debug);
+NeighborInfo neighbor_parser(const nlmsghdr* nlh, bool filter, bool netlink_debug);
 
 // utility functions for adding attributes when building netlink messages
 void addattr_l(nlmsghdr* n, unsigned int maxlen, int type, const void* data, int alen);
@@ -0,0 +1,112 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DROP_PROTOCOL_OPENFLOW_COUNTER_RATES_HPP_
+#define DROP_PROTOCOL_OPENFLOW_COUNTER_RATES_HPP_
+
+#include <unordered_map>
+#include <array>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+
+namespace drop {
+namespace protocol {
+
+// Turns the cumulative counters of the stats replies in per second rates, keeping the
+// previous sample of each key (a port, a flow). The time of a sample is in nanoseconds,
+// from any origin as long as it is the same for all the samples of a key.
+template <size_t N> class CounterRates
+{
+public:
+    using Counters = std::array<uint64_t, N>;
+    using Rates = std::array<float, N>;
+private:
+    struct Sample
+    {
+        uint64_t time;
+        Counters counters;
+        uint32_t generation;
+    };
+public:
+    // Returns false on the first sample of a key, or when the counters went back (the
+    // port or flow was reset): rates is not set and the sample is the new reference.
+    bool update(uint64_t key, uint64_t time, const Counters& counters, Rates& rates)
+    {
+        auto it = samples_.find(key);
+
+        if (it == std::end(samples_))
+        {
+            samples_.emplace(key, Sample{ time, counters, generation_ });
+
+            return false;
+        }
+
+        auto& sample = it->second;
+        auto valid = time > sample.time;
+
+        for (size_t i = 0; valid && i < N; ++i)
+        {
+            valid = counters[i] >= sample.counters[i];
+        }
+
+        if (valid)
+        {
+            auto seconds = static_cast<double>(time - sample.time) / 1e9;
+
+            for (size_t i = 0; i < N; ++i)
+            {
+                rates[i] = static_cast<float>((counters[i] - sample.counters[i]) / seconds);
+            }
+        }
+
+        sample = Sample{ time, counters, generation_ };
+
+        return valid;
+    }
+
+    // Forgets the keys missing from the last reply, the ports and flows that are gone.
+    void sweep()
+    {
+        for (auto it = std::begin(samples_); it != std::end(samples_);)
+        {
+            it = it->second.generation != generation_ ? samples_.erase(it) : std::next(it);
+        }
+
+        ++generation_;
+    }
+
+    size_t size() const { return samples_.size(); }
+private:
+    std::unordered_map<uint64_t, Sample> samples_;
+    uint32_t generation_ = 0;
+};
+
+} // namespace protocol
+} // namespace drop
+
+#endif
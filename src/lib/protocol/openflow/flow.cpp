@@ -27,89 +27,45 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "flow.hpp"
 
-#include "containers.hpp"
+#include <type_traits>
+#include <cstring>
 
 namespace drop {
 namespace protocol {
 
-Flow::Flow(const Flow& other)
-{
-    tnt::for_all(other.flags_, [&] (const auto& flag)
-    {
-        flags_.emplace_back(flag->clone());
-    });
-
-    tnt::for_all(other.filters_, [&] (const auto& filter)
-    {
-        filters_.emplace_back(filter->clone());
-    });
-
-    tnt::for_all(other.actions_, [&] (const auto& action)
-    {
-        actions_.emplace_back(action->clone());
-    });
-}
-
-Flow& Flow::operator=(const Flow& other)
-{
-    Flow tmp(other);
-    swap(tmp);
+// No padding anywhere, the bytes of a flow are all slots.
+static_assert(sizeof(FlowMatch) == 36, "FlowMatch has padding.");
+static_assert(sizeof(FlowActions) == 60, "FlowActions has padding.");
+static_assert(sizeof(FlowFlags) == 24, "FlowFlags has padding.");
+static_assert(sizeof(Flow) == sizeof(FlowMatch) + sizeof(FlowActions) + sizeof(FlowFlags), "Flow has padding.");
+static_assert(sizeof(Flow) % sizeof(uint64_t) == 0, "Flow::hash reads whole words.");
+static_assert(std::is_trivially_copyable<Flow>::value, "Flow must be copied as bytes.");
 
-    return *this;
-}
-
-Flow& Flow::add_flag(std::unique_ptr<FlowFlag>&& flag)
+size_t Flow::hash() const
 {
-    flags_.push_back(std::move(flag));
+    const auto bytes = reinterpret_cast<const char*>(this);
+    uint64_t hash = 0xcbf29ce484222325ull;
 
-    return *this;
-}
-
-Flow& Flow::add_filter(std::unique_ptr<FlowFilter>&& filter)
-{
-    filters_.push_back(std::move(filter));
-
-    return *this;
-}
+    for (size_t i = 0; i < sizeof(Flow); i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
 
-Flow& Flow::add_action(std::unique_ptr<FlowAction>&& action)
-{
-    actions_.push_back(std::move(action));
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
 
-    return *this;
+    return static_cast<size_t>(hash);
 }
 
-void Flow::swap(Flow& other)
+bool operator==(const Flow& f, const Flow& s)
 {
-    using std::swap;
-    swap(flags_, other.flags_);
-    swap(filters_, other.filters_);
-    swap(actions_, other.actions_);
+    return std::memcmp(&f, &s, sizeof(Flow)) == 0;
 }
 
-bool operator==(const Flow& f, const Flow& s)
+bool operator!=(const Flow& f, const Flow& s)
 {
-    return tnt::all_of(f.flags(), [&s] (const auto& ff)
-    {
-        return tnt::any_of(s.flags(), [&ff] (const auto& sf)
-        {
-            return *ff == *sf;
-        });
-    })
-    && tnt::all_of(f.filters(), [&s] (const auto& ff)
-    {
-        return tnt::any_of(s.filters(), [&ff] (const auto& sf)
-        {
-            return *ff == *sf;
-        });
-    })
-    && tnt::all_of(f.actions(), [&s] (const auto& fa)
-    {
-        return tnt::any_of(s.actions(), [&fa] (const auto& sa)
-        {
-            return *fa == *sa;
-        });
-    });
+    return !(f == s);
 }
 
 } // namespace protocol
@@ -28,67 +28,151 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DROP_PROTOCOL_OPENFLOW_FLOW_HPP_
 #define DROP_PROTOCOL_OPENFLOW_FLOW_HPP_
 
-#include <vector>
-#include <memory>
+#include <array>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+#include "protocol/values.hpp"
 
 namespace drop {
 namespace protocol {
 
-struct FlowFlag
-{ 
-    virtual ~FlowFlag() = default;
-    virtual bool operator==(const FlowFlag& other) const = 0;
-    virtual std::unique_ptr<FlowFlag> clone() const = 0;
+// The slots of a flow have a bit telling whether they are set, the slots not set stay
+// zero: copies are plain memory copies, and two flows built in a different order have
+// the same bytes, so equality and hash work on the bytes.
+
+struct FlowMatch
+{
+    enum Field: uint16_t
+    {
+        InPort = 1 << 0,
+        Vlan = 1 << 1,
+        EthType = 1 << 2,
+        IpProto = 1 << 3,
+        HwSrc = 1 << 4,
+        HwDst = 1 << 5,
+        IpSrc = 1 << 6,
+        IpDst = 1 << 7,
+        TpSrc = 1 << 8, // TCP or UDP as ip_proto.
+        TpDst = 1 << 9
+    };
+
+    bool has(Field field) const { return (fields & field) != 0; }
+
+    uint16_t fields = 0;
+    uint16_t in_port = 0;
+    uint16_t vlan = 0;
+    L2Proto eth_type = L2Proto();
+    L3Proto ip_proto = L3Proto();
+    uint8_t ip_src_prefix = 0;
+    uint8_t ip_dst_prefix = 0;
+    uint16_t tp_src = 0;
+    uint16_t tp_dst = 0;
+    uint32_t ip_src = 0; // Network order.
+    uint32_t ip_dst = 0; // Network order.
+    std::array<uint8_t, 6> hw_src{};
+    std::array<uint8_t, 6> hw_dst{};
 };
 
-struct FlowFilter
+// The encoders write the rewrites first, then the outputs.
+struct FlowActions
 {
-    virtual ~FlowFilter() = default;
-    virtual bool operator==(const FlowFilter& other) const = 0;
-    virtual std::unique_ptr<FlowFilter> clone() const = 0;
+    enum Action: uint16_t
+    {
+        Controller = 1 << 0,
+        Loop = 1 << 1,
+        Flood = 1 << 2,
+        SetHwSrc = 1 << 3,
+        SetHwDst = 1 << 4,
+        SetIpSrc = 1 << 5,
+        SetIpDst = 1 << 6,
+        SetVlan = 1 << 7,
+        StripVlan = 1 << 8
+    };
+
+    static constexpr size_t max_ports = 16;
+
+    bool has(Action action) const { return (actions & action) != 0; }
+
+    uint16_t actions = 0;
+    uint16_t controller_len = 0; // Bytes of the packet sent to the controller.
+    uint16_t vlan = 0;
+    uint16_t port_count = 0;
+    std::array<uint16_t, max_ports> ports{}; // Outputs, in order.
+    uint32_t ip_src = 0; // Network order.
+    uint32_t ip_dst = 0; // Network order.
+    std::array<uint8_t, 6> hw_src{};
+    std::array<uint8_t, 6> hw_dst{};
 };
 
-struct FlowAction
-{ 
-    virtual ~FlowAction() = default;
-    virtual bool operator==(const FlowAction& other) const = 0;
-    virtual std::unique_ptr<FlowAction> clone() const = 0;
+// Values in host order, the slots not set keep the defaults of the encoders.
+struct FlowFlags
+{
+    enum Flag: uint16_t
+    {
+        Priority = 1 << 0,
+        Buffer = 1 << 1,
+        Cookie = 1 << 2,
+        IdleTimeout = 1 << 3,
+        HardTimeout = 1 << 4,
+        OutPort = 1 << 5,
+        Flags = 1 << 6
+    };
+
+    bool has(Flag flag) const { return (set & flag) != 0; }
+
+    uint64_t cookie = 0;
+    uint32_t buffer = 0;
+    uint16_t priority = 0;
+    uint16_t idle_timeout = 0;
+    uint16_t hard_timeout = 0;
+    uint16_t out_port = 0;
+    uint16_t flags = 0;
+    uint16_t set = 0;
 };
 
 class Flow
 {
 public:
-    Flow() = default;
-    Flow(const Flow& other);
-    Flow(Flow&& other) noexcept = default;
-    ~Flow() = default;
-
-    Flow& operator=(const Flow& other);
-    Flow& operator=(Flow&& other) = default;
-
     template <class F> Flow& add(F func)
     {
         return func(*this);
     }
 
-    void swap(Flow& other);
+    FlowMatch& match() { return match_; }
+    const FlowMatch& match() const { return match_; }
+    FlowActions& actions() { return actions_; }
+    const FlowActions& actions() const { return actions_; }
+    FlowFlags& flags() { return flags_; }
+    const FlowFlags& flags() const { return flags_; }
 
-    Flow& add_flag(std::unique_ptr<FlowFlag>&& flag);
-    Flow& add_filter(std::unique_ptr<FlowFilter>&& filter);
-    Flow& add_action(std::unique_ptr<FlowAction>&& action);
-
-    const std::vector<std::unique_ptr<FlowFlag>>& flags() const { return flags_; }
-    const std::vector<std::unique_ptr<FlowFilter>>& filters() const { return filters_; }
-    const std::vector<std::unique_ptr<FlowAction>>& actions() const { return actions_; }
+    size_t hash() const;
 private:
-    std::vector<std::unique_ptr<FlowFlag>> flags_;
-    std::vector<std::unique_ptr<FlowFilter>> filters_;
-    std::vector<std::unique_ptr<FlowAction>> actions_;
+    FlowMatch match_;
+    FlowActions actions_;
+    FlowFlags flags_;
 };
 
 bool operator==(const Flow& f, const Flow& s);
+bool operator!=(const Flow& f, const Flow& s);
 
 } // namespace protocol
 } // namespace drop
 
+namespace std {
+
+template<> struct hash<::drop::protocol::Flow>
+{
+    using argument_type = ::drop::protocol::Flow;
+    using result_type = size_t;
+
+    result_type operator()(const argument_type& flow) const
+    {
+        return flow.hash();
+    }
+};
+
+} // namespace std
+
 #endif
@@ -27,25 +27,51 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "flow_factory.hpp"
 
-#include <cassert>
-
-#include "protocol/openflow/flow_flags.hpp"
-#include "protocol/openflow/flow_filters.hpp"
-#include "protocol/openflow/flow_actions.hpp"
+#include <stdexcept>
 
 #include "ip_address.hpp"
-#include "endianness.hpp"
 
 namespace drop {
 
 using protocol::Flow;
+using protocol::FlowMatch;
+using protocol::FlowActions;
+using protocol::FlowFlags;
+
+namespace {
+
+Flow& set(Flow& flow, FlowFlags::Flag flag, uint16_t FlowFlags::* slot, uint16_t value)
+{
+    flow.flags().set |= flag;
+    flow.flags().*slot = value;
+
+    return flow;
+}
+
+Flow& ipv4(Flow& flow)
+{
+    flow.match().fields |= FlowMatch::EthType;
+    flow.match().eth_type = L2Proto::IPv4;
+
+    return flow;
+}
+
+Flow& ip_proto(Flow& flow, L3Proto proto)
+{
+    flow.match().fields |= FlowMatch::IpProto;
+    flow.match().ip_proto = proto;
+
+    return ipv4(flow);
+}
+
+} // namespace
 
 // Flags
 std::function<protocol::Flow&(protocol::Flow&)> priority(uint16_t value)
 {
     return [value] (Flow& flow) -> Flow&
     {
-        return flow.add_flag(std::make_unique<protocol::Priority>(value));
+        return set(flow, FlowFlags::Priority, &FlowFlags::priority, value);
     };
 }
 
@@ -53,7 +79,7 @@ std::function<protocol::Flow&(protocol::Flow&)> idle_timeout(uint16_t value)
 {
     return [value] (Flow& flow) -> Flow&
     {
-        return flow.add_flag(std::make_unique<protocol::IdleTimeout>(value));
+        return set(flow, FlowFlags::IdleTimeout, &FlowFlags::idle_timeout, value);
     };
 }
 
@@ -61,7 +87,7 @@ std::function<protocol::Flow&(protocol::Flow&)> hard_timeout(uint16_t value)
 {
     return [value] (Flow& flow) -> Flow&
     {
-        return flow.add_flag(std::make_unique<protocol::HardTimeout>(value));
+        return set(flow, FlowFlags::HardTimeout, &FlowFlags::hard_timeout, value);
     };
 }
 
@@ -69,7 +95,7 @@ std::function<protocol::Flow&(protocol::Flow&)> out_port(uint16_t value)
 {
     return [value] (Flow& flow) -> Flow&
     {
-        return flow.add_flag(std::make_unique<protocol::OutPort>(value));
+        return set(flow, FlowFlags::OutPort, &FlowFlags::out_port, value);
     };
 }
 
@@ -77,7 +103,18 @@ std::function<protocol::Flow&(protocol::Flow&)> flags(uint16_t value)
 {
     return [value] (Flow& flow) -> Flow&
     {
-        return flow.add_flag(std::make_unique<protocol::Flags>(value));
+        return set(flow, FlowFlags::Flags, &FlowFlags::flags, value);
+    };
+}
+
+std::function<protocol::Flow&(protocol::Flow&)> buffer(uint32_t id)
+{
+    return [id] (Flow& flow) -> Flow&
+    {
+        flow.flags().set |= FlowFlags::Buffer;
+        flow.flags().buffer = id;
+
+        return flow;
     };
 }
 
@@ -86,7 +123,10 @@ std::function<Flow&(Flow&)> from_port(uint16_t src)
 {
     return [src] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromPort>(src));
+        flow.match().fields |= FlowMatch::InPort;
+        flow.match().in_port = src;
+
+        return flow;
     };
 }
 
@@ -94,7 +134,10 @@ std::function<Flow&(Flow&)> from_vlan(uint16_t tag)
 {
     return [tag] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromVlan>(tag));
+        flow.match().fields |= FlowMatch::Vlan;
+        flow.match().vlan = tag;
+
+        return flow;
     };
 }
 
@@ -102,7 +145,10 @@ std::function<Flow&(Flow&)> from_proto(L2Proto proto)
 {
     return [proto] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromL2Proto>(proto));
+        flow.match().fields |= FlowMatch::EthType;
+        flow.match().eth_type = proto;
+
+        return flow;
     };
 }
 
@@ -110,23 +156,29 @@ std::function<Flow&(Flow&)> from_proto(L3Proto proto)
 {
     return [proto] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromL3Proto>(proto));
+        return ip_proto(flow, proto);
     };
 }
 
 std::function<Flow&(Flow&)> from_hw_src(const tnt::MacAddress& mac)
 {
-    return [&] (Flow& flow) -> Flow&
+    return [mac] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromHwSrc>(mac));
+        flow.match().fields |= FlowMatch::HwSrc;
+        flow.match().hw_src = mac.bytes();
+
+        return flow;
     };
 }
 
 std::function<Flow&(Flow&)> from_hw_dst(const tnt::MacAddress& mac)
 {
-    return [&] (Flow& flow) -> Flow&
+    return [mac] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromHwDst>(mac));
+        flow.match().fields |= FlowMatch::HwDst;
+        flow.match().hw_dst = mac.bytes();
+
+        return flow;
     };
 }
 
@@ -137,17 +189,29 @@ std::function<Flow&(Flow&)> from_hw_bcast()
 
 std::function<Flow&(Flow&)> from_ip_src(const tnt::ip::Address& ip, int prefix)
 {
-    return [&ip, prefix] (Flow& flow) -> Flow&
+    auto address = static_cast<uint32_t>(ip.to_net_order_ulong());
+
+    return [address, prefix] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromIpSrc>(ip, prefix));
+        flow.match().fields |= FlowMatch::IpSrc;
+        flow.match().ip_src = address;
+        flow.match().ip_src_prefix = static_cast<uint8_t>(prefix);
+
+        return ipv4(flow);
     };
 }
 
 std::function<Flow&(Flow&)> from_ip_dst(const tnt::ip::Address& ip, int prefix)
 {
-    return [&ip, prefix] (Flow& flow) -> Flow&
+    auto address = static_cast<uint32_t>(ip.to_net_order_ulong());
+
+    return [address, prefix] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromIpDst>(ip, prefix));
+        flow.match().fields |= FlowMatch::IpDst;
+        flow.match().ip_dst = address;
+        flow.match().ip_dst_prefix = static_cast<uint8_t>(prefix);
+
+        return ipv4(flow);
     };
 }
 
@@ -165,7 +229,10 @@ std::function<Flow&(Flow&)> from_transport_port_src(L3Proto proto, uint16_t port
 {
     return [=] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromTransportPortSrc>(proto, port));
+        flow.match().fields |= FlowMatch::TpSrc;
+        flow.match().tp_src = port;
+
+        return ip_proto(flow, proto);
     };
 }
 
@@ -173,7 +240,10 @@ std::function<Flow&(Flow&)> from_transport_port_dst(L3Proto proto, uint16_t port
 {
     return [=] (Flow& flow) -> Flow&
     {
-        return flow.add_filter(std::make_unique<protocol::FromTransportPortDst>(proto, port));
+        flow.match().fields |= FlowMatch::TpDst;
+        flow.match().tp_dst = port;
+
+        return ip_proto(flow, proto);
     };
 }
 
@@ -182,7 +252,10 @@ std::function<Flow&(Flow&)> to_controller(uint16_t size)
 {
     return [size] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::ToController>(size));
+        flow.actions().actions |= FlowActions::Controller;
+        flow.actions().controller_len = size;
+
+        return flow;
     };
 }
 
@@ -190,20 +263,39 @@ std::function<Flow&(Flow&)> loop()
 {
     return [] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::Loop>());
+        flow.actions().actions |= FlowActions::Loop;
+
+        return flow;
     };
 }
 
 std::function<Flow&(Flow&)> to_port(uint16_t dst)
 {
-    return to_ports({ dst });
+    return [dst] (Flow& flow) -> Flow&
+    {
+        auto& actions = flow.actions();
+
+        if (actions.port_count == FlowActions::max_ports)
+        {
+            throw std::length_error("Flow: too many output ports.");
+        }
+
+        actions.ports[actions.port_count++] = dst;
+
+        return flow;
+    };
 }
 
 std::function<Flow&(Flow&)> to_ports(const std::vector<uint16_t>& dst)
 {
     return [dst] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::ToPorts>(dst));
+        for (auto port : dst)
+        {
+            to_port(port)(flow);
+        }
+
+        return flow;
     };
 }
 
@@ -211,31 +303,47 @@ std::function<Flow&(Flow&)> set_hw_src(const tnt::MacAddress& mac)
 {
     return [mac] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::SetHwSrc>(mac));
+        flow.actions().actions |= FlowActions::SetHwSrc;
+        flow.actions().hw_src = mac.bytes();
+
+        return flow;
     };
 }
 
 std::function<Flow&(Flow&)> set_hw_dst(const tnt::MacAddress& mac)
 {
-    return [&] (Flow& flow) -> Flow&
+    return [mac] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::SetHwDst>(mac));
+        flow.actions().actions |= FlowActions::SetHwDst;
+        flow.actions().hw_dst = mac.bytes();
+
+        return flow;
     };
 }
 
 std::function<protocol::Flow&(protocol::Flow&)> set_ip_src(const tnt::ip::Address& ip)
 {
-    return [&] (Flow& flow) -> Flow&
+    auto address = static_cast<uint32_t>(ip.to_net_order_ulong());
+
+    return [address] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::SetIpDst>(ip));
+        flow.actions().actions |= FlowActions::SetIpSrc;
+        flow.actions().ip_src = address;
+
+        return flow;
     };
 }
 
 std::function<protocol::Flow&(protocol::Flow&)> set_ip_dst(const tnt::ip::Address& ip)
 {
-    return [&] (Flow& flow) -> Flow&
+    auto address = static_cast<uint32_t>(ip.to_net_order_ulong());
+
+    return [address] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::SetIpDst>(ip));
+        flow.actions().actions |= FlowActions::SetIpDst;
+        flow.actions().ip_dst = address;
+
+        return flow;
     };
 }
 
@@ -243,7 +351,10 @@ std::function<Flow&(Flow&)> set_vlan(uint16_t tag)
 {
 	return [tag] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::SetVlan>(tag));
+        flow.actions().actions |= FlowActions::SetVlan;
+        flow.actions().vlan = tag;
+
+        return flow;
     };
 }
 
@@ -251,7 +362,9 @@ std::function<Flow&(Flow&)> strip_vlan()
 {
 	return [] (Flow& flow) -> Flow&
     {
-        return flow.add_action(std::make_unique<protocol::StripVlan>());
+        flow.actions().actions |= FlowActions::StripVlan;
+
+        return flow;
     };
 }
 
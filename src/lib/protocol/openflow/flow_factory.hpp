@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <functional>
 #include <string>
+#include <vector>
 #include <limits>
 #include <cstdint>
 
@@ -54,6 +55,8 @@ std::function<protocol::Flow&(protocol::Flow&)> idle_timeout(uint16_t value);
 std::function<protocol::Flow&(protocol::Flow&)> hard_timeout(uint16_t value);
 std::function<protocol::Flow&(protocol::Flow&)> out_port(uint16_t value);
 std::function<protocol::Flow&(protocol::Flow&)> flags(uint16_t value);
+// The switch applies the flow-mod to the packet it buffered with this id too.
+std::function<protocol::Flow&(protocol::Flow&)> buffer(uint32_t id);
 
 // Filters
 std::function<protocol::Flow&(protocol::Flow&)> from_port(uint16_t src);
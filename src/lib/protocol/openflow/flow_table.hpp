@@ -0,0 +1,108 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DROP_PROTOCOL_OPENFLOW_FLOW_TABLE_HPP_
+#define DROP_PROTOCOL_OPENFLOW_FLOW_TABLE_HPP_
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "protocol/openflow/flow.hpp"
+
+namespace drop {
+namespace protocol {
+
+// The flows installed on a switch: a dense vector to iterate them, and an index from
+// the flow to its position, so add, remove and contains are O(1). A remove moves the
+// last flow in the hole, the order of the flows is not kept.
+class FlowTable
+{
+public:
+    // Returns false if the flow was already there.
+    bool add(const Flow& flow)
+    {
+        auto p = index_.emplace(flow, static_cast<uint32_t>(flows_.size()));
+
+        if (!p.second)
+        {
+            return false;
+        }
+
+        flows_.push_back(flow);
+
+        return true;
+    }
+
+    // Returns false if the flow was not there.
+    bool remove(const Flow& flow)
+    {
+        auto it = index_.find(flow);
+
+        if (it == index_.end())
+        {
+            return false;
+        }
+
+        auto pos = it->second;
+        index_.erase(it);
+
+        if (pos != flows_.size() - 1)
+        {
+            flows_[pos] = flows_.back();
+            index_[flows_[pos]] = pos;
+        }
+
+        flows_.pop_back();
+
+        return true;
+    }
+
+    bool contains(const Flow& flow) const
+    {
+        return index_.count(flow) != 0;
+    }
+
+    const std::vector<Flow>& flows() const
+    {
+        return flows_;
+    }
+
+    size_t size() const
+    {
+        return flows_.size();
+    }
+private:
+    std::vector<Flow> flows_;
+    std::unordered_map<Flow, uint32_t> index_;
+};
+
+} // namespace protocol
+} // namespace drop
+
+#endif
@@ -0,0 +1,101 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef DROP_PROTOCOL_OPENFLOW_MESSAGE_BUFFER_HPP_
+#define DROP_PROTOCOL_OPENFLOW_MESSAGE_BUFFER_HPP_
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstddef>
+
+namespace drop {
+namespace protocol {
+
+//! Growable buffer the encoders write the messages in. clear() keeps the capacity, so once
+//! the buffer fits the largest message the encoding does not allocate.
+class MessageBuffer
+{
+public:
+    void clear()
+    {
+        data_.clear();
+    }
+
+    void reserve(size_t size)
+    {
+        data_.reserve(size);
+    }
+
+    //! Appends size zero bytes and returns a pointer to them, valid until the next append.
+    char* extend(size_t size)
+    {
+        auto offset = data_.size();
+        data_.resize(offset + size);
+
+        return data_.data() + offset;
+    }
+
+    void append(const void* data, size_t size)
+    {
+        std::memcpy(extend(size), data, size);
+    }
+
+    template <class T> void append(const T& value)
+    {
+        append(&value, sizeof(value));
+    }
+
+    //! Overwrites bytes already in the buffer, e.g. a length known only at the end.
+    template <class T> void overwrite(size_t offset, const T& value)
+    {
+        std::memcpy(data_.data() + offset, &value, sizeof(value));
+    }
+
+    const char* data() const
+    {
+        return data_.data();
+    }
+
+    size_t size() const
+    {
+        return data_.size();
+    }
+
+    std::string str() const
+    {
+        return std::string(data_.data(), data_.size());
+    }
+private:
+    std::vector<char> data_;
+};
+
+} // namespace protocol
+} // namespace drop
+
+#endif
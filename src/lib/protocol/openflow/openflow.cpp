@@ -28,8 +28,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "openflow.hpp"
 
 #include <iostream>
-#include <thread>
-#include <chrono>
 #include <cstring>
 #include <cstdint>
 #include <cassert>
@@ -41,19 +39,26 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "protocol/openflow/flow.hpp"
 
 #include "util/random.hpp"
+#include "util/configuration.hpp"
 
+#include "exception/exception.hpp"
+
+#include "scheduler.hpp"
 #include "ip_socket_address.hpp"
 #include "endianness.hpp"
 #include "application.hpp"
 #include "log.hpp"
 #include "dump.hpp"
 
-using namespace std::literals;
-
 namespace drop {
 namespace protocol {
 namespace {
 
+const tnt::ConfigKey<int> openflow_window("openflow.window", 1024);
+const tnt::ConfigKey<int> openflow_batch("openflow.batch", 64);
+const tnt::ConfigKey<int> openflow_barrier_timeout("openflow.barrier_timeout", 5000);
+const tnt::ConfigKey<int> openflow_stats_interval("openflow.stats_interval", 1000);
+
 enum class ofp_type: uint8_t
 {
     HELLO
@@ -69,15 +74,34 @@ struct ofp_header
 
 } // namespace
 
-Openflow::Openflow(const std::shared_ptr<tnt::IO>& io): AsyncProtocol(io) {}
-Openflow::~Openflow() {}
+Openflow::Openflow(const std::shared_ptr<tnt::IO>& io):
+    AsyncProtocol(io),
+    transactions_(openflow_window.get(), openflow_batch.get()),
+    barrier_timeout_(openflow_barrier_timeout.get())
+{}
+
+Openflow::~Openflow()
+{
+    std::lock_guard<std::mutex> lock(queued_guard_);
+    fail_queued(std::make_exception_ptr(tnt::ProtocolException("Openflow connection closed before the flow-mod was sent.")));
+}
 
 void Openflow::write(const std::string& data)
 {
     AsyncProtocol::write(data);
 }
 
-void Openflow::invoke_message(const std::string& message)
+void Openflow::write(const char* data, size_t size)
+{
+    AsyncProtocol::write(data, size);
+}
+
+uint32_t Openflow::next_xid()
+{
+    return transactions_.next_xid();
+}
+
+void Openflow::invoke_message(tnt::BufferView message)
 {
     auto pkt = reinterpret_cast<const ofp_header*>(message.data());
 
@@ -101,8 +125,6 @@ void Openflow::invoke_message(const std::string& message)
 
         write(to_mem_buffer(packet));
 
-        std::this_thread::sleep_for(50ms); // Needed to avoid the packets to be sent in the same tcp packet.
-
         /* In caso di supporto di piu versioni  necessario implementare la gestione
         dell'HELLO inviato e ricevuto.
         Se la versione ricevuta  piu piccola di quella del controller e questo la supporta
@@ -117,17 +139,17 @@ void Openflow::invoke_message(const std::string& message)
 	else
 	{
         assert(protocol_);
-        protocol_->packet(message);
+        protocol_->packet(message.str());
 	}
 }
 
-std::vector<std::string> Openflow::parse(std::string& raw_input)
+size_t Openflow::parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages)
 {
-    std::vector<std::string> messages;
+    size_t pos = 0;
 
     while (true)
     {
-		auto len = raw_input.size();
+		auto len = input.size() - pos;
 
 		if (len < sizeof(ofp_header))
 		{
@@ -135,7 +157,7 @@ std::vector<std::string> Openflow::parse(std::string& raw_input)
 			break;
 		}
 
-		auto hdr = reinterpret_cast<const ofp_header*>(raw_input.data());
+		auto hdr = reinterpret_cast<const ofp_header*>(input.data() + pos);
 		auto packet_len = ntohs(hdr->length);
 
 		if (len < packet_len)
@@ -144,44 +166,207 @@ std::vector<std::string> Openflow::parse(std::string& raw_input)
 			break;
 		}
 
-		if (len == packet_len)
-		{
-			// Got one single message.
-			messages.push_back(raw_input);
-			raw_input.clear();
+		messages.push_back(input.substr(pos, packet_len));
+		pos += packet_len;
+    }
 
-			break;
-		}
+    return pos;
+}
+
+void Openflow::add(const Flow& flow, std::promise<void>&& done)
+{
+    flow_mod(flow, std::move(done), true);
+}
+
+void Openflow::remove(const Flow& flow, std::promise<void>&& done)
+{
+    flow_mod(flow, std::move(done), false);
+}
+
+// Never waits for the switch: with the reactor the flow-mods are sent by the notification
+// thread of a loop shared by many connections. The ones beyond the window are queued and
+// sent by barrier_reply. A switch that stopped replying is noticed by barrier_watchdog_.
+void Openflow::flow_mod(const Flow& flow, std::promise<void>&& done, bool add)
+{
+    assert(protocol_);
+
+    std::lock_guard<std::mutex> lock(queued_guard_);
+
+    if (queued_.empty() && transactions_.has_room())
+    {
+        send_flow_mod(flow, std::move(done), add);
+
+        return;
+    }
+
+    if (queued_.empty())
+    {
+        // The window is full: close the batch, its reply makes room.
+        barrier();
+        flush();
+
+        queued_since_ = std::chrono::steady_clock::now();
+        start_barrier_watchdog();
+    }
+
+    queued_.push_back(QueuedFlowMod{ flow, std::move(done), add });
+}
+
+// Called with queued_guard_ held. Started the first time the window fills up, the
+// connections that never fill it do not pay for the thread.
+void Openflow::start_barrier_watchdog()
+{
+    if (barrier_watchdog_ || barrier_timeout_.count() <= 0)
+    {
+        return;
+    }
+
+    barrier_watchdog_ = std::make_unique<tnt::Scheduler>();
+    barrier_watchdog_->schedule(std::chrono::system_clock::now() + barrier_timeout_, barrier_timeout_, [this] ()
+    {
+        check_barrier_timeout();
+    });
+}
+
+// The flow-mods are queued only while the window is full, if it stays full for
+// barrier_timeout_ the switch is not replying: the pending flow-mods are failed.
+void Openflow::check_barrier_timeout()
+{
+    std::lock_guard<std::mutex> lock(queued_guard_);
+
+    if (queued_.empty() || std::chrono::steady_clock::now() - queued_since_ <= barrier_timeout_)
+    {
+        return;
+    }
+
+    tnt::Log::error("Openflow: no barrier reply in ", barrier_timeout_.count(), " ms, failing the pending flow-mods.");
+
+    auto error = std::make_exception_ptr(tnt::ProtocolException("Openflow switch did not reply to the barrier."));
+    transactions_.fail_all(error);
+    fail_queued(error);
+}
+
+void Openflow::send_flow_mod(const Flow& flow, std::promise<void>&& done, bool add)
+{
+    auto xid = transactions_.flow_mod(std::move(done));
+
+    if (add)
+    {
+        protocol_->add(flow, xid);
+    }
+    else
+    {
+        protocol_->remove(flow, xid);
+    }
+
+    if (transactions_.batch_full())
+    {
+        barrier();
+    }
+}
+
+void Openflow::barrier()
+{
+    uint32_t xid;
 
-		// Got more than one message.
-		messages.push_back(raw_input.substr(0, packet_len));
-		raw_input = raw_input.substr(packet_len);
+    if (transactions_.barrier(xid))
+    {
+        protocol_->barrier(xid);
     }
+}
 
-    return messages;
+void Openflow::end_batch()
+{
+    if (protocol_)
+    {
+        barrier();
+    }
 }
 
-void Openflow::add(const Flow& flow)
+void Openflow::barrier_reply(uint32_t xid)
 {
-    std::this_thread::sleep_for(50ms); // Needed to avoid the packets to be sent in the same tcp packet.
-    protocol_->add(flow);
+    transactions_.barrier_reply(xid);
+
+    std::lock_guard<std::mutex> lock(queued_guard_);
+    send_queued();
+}
+
+// Called with queued_guard_ held.
+void Openflow::send_queued()
+{
+    if (queued_.empty())
+    {
+        return;
+    }
+
+    while (!queued_.empty() && transactions_.has_room())
+    {
+        auto& next = queued_.front();
+        send_flow_mod(next.flow, std::move(next.done), next.add);
+        queued_.pop_front();
+    }
+
+    // Sent by the rx side, which has no end_batch: the barrier closes the last batch.
+    // The rx loop flushes the writes after its messages.
+    barrier();
+
+    queued_since_ = std::chrono::steady_clock::now();
+}
+
+// Called with queued_guard_ held.
+void Openflow::fail_queued(std::exception_ptr error)
+{
+    for (auto& queued : queued_)
+    {
+        queued.done.set_exception(error);
+    }
+
+    queued_.clear();
+}
+
+void Openflow::failed(uint32_t xid, uint16_t type, uint16_t code)
+{
+    transactions_.error(xid, std::make_exception_ptr(tnt::ProtocolException("Openflow error type " + std::to_string(type) + " code " + std::to_string(code) + ".")));
+}
+
+void Openflow::start_stats_poller()
+{
+    auto interval = stats_interval();
+
+    if (interval.count() <= 0 || stats_poller_)
+    {
+        return;
+    }
+
+    // A poll costs the same whatever the size of the switch: one request for all the
+    // ports, one for all the flows. The replies are turned in rates by the version.
+    stats_poller_ = std::make_unique<tnt::Scheduler>();
+    stats_poller_->schedule(std::chrono::system_clock::now() + interval, interval, [this] ()
+    {
+        try
+        {
+            protocol_->request_stats(OpenflowStats::Ports);
+            protocol_->request_stats(OpenflowStats::Flows);
+        }
+        catch (std::exception& ex)
+        {
+            tnt::Log::error("Openflow stats request error: ", ex.what());
+        }
+    });
 }
 
-void Openflow::remove(const Flow& flow)
+std::chrono::milliseconds Openflow::stats_interval() const
 {
-    std::this_thread::sleep_for(50ms); // Needed to avoid the packets to be sent in the same tcp packet.
-    protocol_->remove(flow);
+    return std::chrono::milliseconds(openflow_stats_interval.get());
 }
 
 void Openflow::packet_out(const std::string& buffer, uint16_t port)
 {
-    std::this_thread::sleep_for(50ms); // Needed to avoid the packets to be sent in the same tcp packet.
     protocol_->send_packet(buffer, port);
 }
 
 void Openflow::request_port_stats(uint16_t port)
 {
-    std::this_thread::sleep_for(50ms); // Needed to avoid the packets to be sent in the same tcp packet.
     protocol_->request_port_stats(port);
 }
 
@@ -30,38 +30,89 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <memory>
 #include <vector>
+#include <deque>
 #include <string>
+#include <future>
+#include <mutex>
+#include <chrono>
+#include <exception>
 #include <cstdint>
 
 #include "protocol/async_protocol.hpp"
 
+#include "protocol/openflow/transactions.hpp"
+#include "protocol/openflow/flow.hpp"
+
+namespace tnt {
+
+class Scheduler;
+
+} // namespace tnt
+
 namespace drop {
 namespace protocol {
 
-class Flow;
 struct OpenflowProtocol;
 
 class Openflow: public tnt::protocol::AsyncProtocol
 {
+    // A flow-mod that did not fit in the window, sent when a barrier reply makes room.
+    struct QueuedFlowMod
+    {
+        Flow flow;
+        std::promise<void> done;
+        bool add;
+    };
 public:
     explicit Openflow(const std::shared_ptr<tnt::IO>& io);
     virtual ~Openflow();
 
     void write(const std::string& data);
+    void write(const char* data, size_t size);
+    // The xid of a request other than a flow-mod or a barrier, never the one of a pending transaction.
+    uint32_t next_xid();
     void set_features(uint64_t datapath_id);
+    // Requests the port and flow stats every openflow.stats_interval milliseconds.
+    void start_stats_poller();
+    std::chrono::milliseconds stats_interval() const;
+
+    // Replies of the switch to the flow-mods and barriers of the transactions.
+    void barrier_reply(uint32_t xid);
+    void failed(uint32_t xid, uint16_t type, uint16_t code);
+
+    // A frame the switch sent to the controller, defined by each target like set_features.
+    void packet_in(uint32_t buffer_id, uint16_t in_port, const char* frame, size_t size);
 private:
-    virtual std::vector<std::string> parse(std::string& raw_input) override; //! raw_input is passed by non const reference, so parse function can modify it.
-    virtual void invoke_message(const std::string& data) override;
+    virtual size_t parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages) override;
+    virtual void invoke_message(tnt::BufferView data) override;
     virtual void register_messages() override;
-
-    void add(const Flow& flow);
-    void remove(const Flow& flow);
+    virtual void end_batch() override;
+
+    void add(const Flow& flow, std::promise<void>&& done);
+    void remove(const Flow& flow, std::promise<void>&& done);
+    void flow_mod(const Flow& flow, std::promise<void>&& done, bool add);
+    void send_flow_mod(const Flow& flow, std::promise<void>&& done, bool add);
+    void send_queued();
+    void fail_queued(std::exception_ptr error);
+    void start_barrier_watchdog();
+    void check_barrier_timeout();
+    void barrier();
 
     void packet_out(const std::string& buffer, uint16_t port);
 
     void request_port_stats(uint16_t port);
 private:
     std::unique_ptr<OpenflowProtocol> protocol_;
+
+    Transactions transactions_;
+    std::chrono::milliseconds barrier_timeout_;
+
+    std::mutex queued_guard_; // Also keeps the flow-mods in order, taken while sending them.
+    std::deque<QueuedFlowMod> queued_;
+    std::chrono::steady_clock::time_point queued_since_; // When the window filled up.
+    std::unique_ptr<tnt::Scheduler> barrier_watchdog_; // Checks queued_since_, stopped before the queue goes away.
+
+    std::unique_ptr<tnt::Scheduler> stats_poller_; // Last, stopped before the rest goes away.
 };
 
 } // namespace protocol
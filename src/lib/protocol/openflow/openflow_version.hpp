@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <memory>
 #include <string>
 #include <functional>
+#include <cstdint>
 
 namespace drop {
 namespace protocol {
@@ -39,6 +40,14 @@ namespace protocol {
 class Openflow;
 class Flow;
 
+enum class OpenflowStats
+{
+    Ports,
+    Flows,
+    Tables,
+    Aggregate
+};
+
 struct OpenflowProtocol
 {
     virtual ~OpenflowProtocol() = default;
@@ -46,14 +55,18 @@ struct OpenflowProtocol
     virtual void init() = 0;
     virtual void remove_all() = 0;
 
-    virtual void add(const Flow& flow) = 0;
-    virtual void remove(const Flow& flow) = 0;
+    // The flow-mods and the barriers use the xids of the Transactions of the connection.
+    virtual void add(const Flow& flow, uint32_t xid) = 0;
+    virtual void remove(const Flow& flow, uint32_t xid) = 0;
+    virtual void barrier(uint32_t xid) = 0;
 
     virtual void packet(const std::string& message) = 0;
 
     virtual void send_packet(const std::string& buffer, uint16_t port) = 0;
 
     virtual void request_port_stats(uint16_t port) = 0;
+    // One request for all the ports, flows or tables of the switch.
+    virtual void request_stats(OpenflowStats what) = 0;
 };
 
 using OpenflowFactoryMethod = std::function<std::unique_ptr<OpenflowProtocol>(Openflow*)>;
@@ -0,0 +1,151 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "transactions.hpp"
+
+#include <algorithm>
+
+#include "exception/exception.hpp"
+
+#include "lock.hpp"
+
+namespace drop {
+namespace protocol {
+
+Transactions::Transactions(size_t window, size_t batch): window_(std::max<size_t>(window, 1)), batch_(std::max<size_t>(std::min(batch, window_), 1)) {}
+
+Transactions::~Transactions()
+{
+    fail_all(std::make_exception_ptr(tnt::ProtocolException("Openflow connection closed before the flow-mod was confirmed.")));
+}
+
+uint32_t Transactions::flow_mod(std::promise<void>&& done)
+{
+    return tnt::lock(mutex_, [&] ()
+    {
+        auto xid = next_xid_++;
+        sent_.push_back(Entry{ xid, false, std::move(done) });
+        ++outstanding_;
+        ++unbarriered_;
+
+        return xid;
+    });
+}
+
+bool Transactions::barrier(uint32_t& xid)
+{
+    return tnt::lock(mutex_, [&] ()
+    {
+        if (unbarriered_ == 0)
+        {
+            return false;
+        }
+
+        xid = next_xid_++;
+        sent_.push_back(Entry{ xid, true, std::promise<void>() });
+        unbarriered_ = 0;
+
+        return true;
+    });
+}
+
+uint32_t Transactions::next_xid()
+{
+    return tnt::lock(mutex_, [&] () { return next_xid_++; });
+}
+
+bool Transactions::batch_full() const
+{
+    return tnt::lock(mutex_, [&] () { return unbarriered_ >= batch_; });
+}
+
+bool Transactions::has_room() const
+{
+    return tnt::lock(mutex_, [&] () { return outstanding_ < window_; });
+}
+
+void Transactions::barrier_reply(uint32_t xid)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = std::find_if(std::begin(sent_), std::end(sent_), [xid] (const Entry& entry) { return entry.barrier && entry.xid == xid; });
+
+    if (it == std::end(sent_))
+    {
+        return; // Not ours, or its flow-mods were already failed.
+    }
+
+    // The switch processed everything sent before the barrier, whatever failed was already reported.
+    for (auto count = it - std::begin(sent_) + 1; count > 0; --count)
+    {
+        auto& entry = sent_.front();
+
+        if (!entry.barrier)
+        {
+            entry.done.set_value();
+            --outstanding_;
+        }
+
+        sent_.pop_front();
+    }
+}
+
+void Transactions::error(uint32_t xid, std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = std::find_if(std::begin(sent_), std::end(sent_), [xid] (const Entry& entry) { return !entry.barrier && entry.xid == xid; });
+
+    if (it == std::end(sent_))
+    {
+        return;
+    }
+
+    it->done.set_exception(error);
+    sent_.erase(it);
+    --outstanding_;
+}
+
+void Transactions::fail_all(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& entry: sent_)
+    {
+        if (!entry.barrier)
+        {
+            entry.done.set_exception(error);
+        }
+    }
+
+    sent_.clear();
+    outstanding_ = 0;
+    unbarriered_ = 0;
+}
+
+} // namespace protocol
+} // namespace drop
@@ -0,0 +1,93 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DROP_PROTOCOL_OPENFLOW_TRANSACTIONS_HPP_
+#define DROP_PROTOCOL_OPENFLOW_TRANSACTIONS_HPP_
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <exception>
+#include <cstdint>
+
+namespace drop {
+namespace protocol {
+
+// Flow-mods sent to a switch and not confirmed yet.
+// Up to window flow-mods are pipelined, a barrier closes every batch of them: its reply
+// confirms all the flow-mods sent before it, an error with the xid of a flow-mod fails
+// only that one. The xids are sequential, so they never collide within a connection.
+// Called by the tx loop of the connection (flow_mod, barrier) and by the rx loop
+// (barrier_reply, error, and flow_mod and barrier for the flow-mods queued meanwhile).
+class Transactions
+{
+    struct Entry
+    {
+        uint32_t xid;
+        bool barrier;
+        std::promise<void> done; // Unused by the barriers.
+    };
+public:
+    Transactions(size_t window, size_t batch);
+    Transactions(const Transactions&) = delete;
+    ~Transactions();
+    Transactions& operator=(const Transactions&) = delete;
+
+    // Returns the xid of a new flow-mod, done is set when the switch confirms it.
+    uint32_t flow_mod(std::promise<void>&& done);
+
+    // Returns false if no flow-mod was sent since the last barrier, so none is needed.
+    bool barrier(uint32_t& xid);
+
+    // An xid for the other requests of the connection, from the same sequence.
+    uint32_t next_xid();
+
+    // True when the current batch is full and a barrier should be sent.
+    bool batch_full() const;
+    // True when another flow-mod fits in the window.
+    bool has_room() const;
+
+    void barrier_reply(uint32_t xid);
+    void error(uint32_t xid, std::exception_ptr error);
+
+    // Fails all the flow-mods waiting for a confirmation.
+    void fail_all(std::exception_ptr error);
+private:
+    const size_t window_;
+    const size_t batch_;
+
+    mutable std::mutex mutex_;
+    std::deque<Entry> sent_;
+    size_t outstanding_ = 0; // Flow-mods in sent_.
+    size_t unbarriered_ = 0; // Flow-mods sent after the last barrier.
+    uint32_t next_xid_ = 1;
+};
+
+} // namespace protocol
+} // namespace drop
+
+#endif
@@ -35,6 +35,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace drop {
 namespace protocol {
 
+// Only for the switch side: the controller takes its xids from Openflow::next_xid, which
+// keeps them apart from the ones of the flow-mods.
 inline uint32_t create_xid()
 {
     return tnt::random_value<uint32_t>();
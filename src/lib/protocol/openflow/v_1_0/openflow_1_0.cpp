@@ -27,8 +27,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "openflow_1_0.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
+#include <cstddef>
 
 #include "event/network/port_status_change.hpp"
 
@@ -37,18 +40,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "protocol/openflow/utils.hpp"
 #include "protocol/openflow/openflow.hpp"
 #include "protocol/openflow/flow.hpp"
-#include "protocol/openflow/flow_flags.hpp"
-#include "protocol/openflow/flow_filters.hpp"
-#include "protocol/openflow/flow_actions.hpp"
 
-#include "dynamic_pointer_visitor.hpp"
 #include "mac_address.hpp"
 #include "ip_address.hpp"
 #include "endianness.hpp"
 #include "log.hpp"
 
-using namespace std::literals;
-
 namespace drop {
 namespace protocol {
 namespace {
@@ -122,120 +119,99 @@ void set_value(ofp_action_header_1_0& ofp_action, uint8_t value)
     ofp_action.len = htons(8);
 }*/
 
-ofp_action_header_1_0 set_value(ofp_action_header_1_0& ofp_action, const tnt::MacAddress& mac)
+ofp_action_header_1_0 set_value(ofp_action_header_1_0& ofp_action, const std::array<uint8_t, 6>& mac)
 {
-    auto raw = mac.raw();
-    const char* ptr = raw.data();
-    memcpy(ofp_action.pad, ptr, 4);
+    memcpy(ofp_action.pad, mac.data(), 4);
 
     auto action_cont = ofp_action_header_1_0();
-    memcpy(reinterpret_cast<char*>(&action_cont.type), ptr + 4, sizeof(action_cont.type));
+    memcpy(reinterpret_cast<char*>(&action_cont.type), mac.data() + 4, sizeof(action_cont.type));
     ofp_action.len = htons(16);
 
     return action_cont;
 }
 
-// Filters
-ofp_flow_mod_1_0& from_port(ofp_flow_mod_1_0& ofp_flow, uint16_t src)
+void set_value(ofp_action_header_1_0& ofp_action, uint32_t ip)
 {
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::IN_PORT);
-    ofp_flow.match.in_port = htons(src);
-
-    return ofp_flow;
-}
-
-ofp_flow_mod_1_0& from_vlan(ofp_flow_mod_1_0& ofp_flow, uint16_t tag)
-{
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_VLAN);
-    ofp_flow.match.dl_vlan = htons(tag);
-
-    return ofp_flow;
-}
-
-ofp_flow_mod_1_0& from_proto(ofp_flow_mod_1_0& ofp_flow, L2Proto proto)
-{
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_TYPE);
-    ofp_flow.match.dl_type = htons(static_cast<uint16_t>(proto));
-
-    return ofp_flow;
+    memcpy(ofp_action.pad, &ip, 4);
+    ofp_action.len = htons(8);
 }
 
-ofp_flow_mod_1_0& from_proto(ofp_flow_mod_1_0& ofp_flow, L3Proto proto)
+// Filters
+void from_ip(ofp_flow_mod_1_0& ofp_flow, ofp_flow_wildcards_1_0 mask, ofp_flow_wildcards_1_0 shift, int prefix)
 {
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_TYPE);
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::NW_PROTO);
-    ofp_flow.match.dl_type = htons(static_cast<uint16_t>(L2Proto::IPv4));
-	ofp_flow.match.nw_proto = static_cast<uint8_t>(proto);
+    using E = std::underlying_type_t<ofp_flow_wildcards_1_0>;
 
-    return ofp_flow;
+    set_wildcard(ofp_flow, mask);
+    unset_wildcard(ofp_flow, static_cast<ofp_flow_wildcards_1_0>((32 - prefix) << static_cast<E>(shift)));
 }
 
-ofp_flow_mod_1_0& from_hw_src(ofp_flow_mod_1_0& ofp_flow, const tnt::MacAddress& mac)
+void add_filters(const FlowMatch& match, ofp_flow_mod_1_0& ofp_flow)
 {
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_SRC);
-    auto raw_mac = mac.raw();
-    std::copy_n(std::begin(raw_mac), 6, ofp_flow.match.dl_src);
-
-    return ofp_flow;
-}
+    using W = ofp_flow_wildcards_1_0;
 
-ofp_flow_mod_1_0& from_hw_dst(ofp_flow_mod_1_0& ofp_flow, const tnt::MacAddress& mac)
-{
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_DST);
-    auto raw_mac = mac.raw();
-    std::copy_n(std::begin(raw_mac), 6, ofp_flow.match.dl_dst);
+    ofp_flow.match.wildcards = W::ALL;
 
-    return ofp_flow;
-}
+    if (match.has(FlowMatch::InPort))
+    {
+        set_wildcard(ofp_flow, W::IN_PORT);
+        ofp_flow.match.in_port = htons(match.in_port);
+    }
 
-ofp_flow_mod_1_0& from_ip_src(ofp_flow_mod_1_0& ofp_flow, const tnt::ip::Address& ip, int prefix)
-{
-    using E = std::underlying_type_t<ofp_flow_wildcards_1_0>;
+    if (match.has(FlowMatch::Vlan))
+    {
+        set_wildcard(ofp_flow, W::DL_VLAN);
+        ofp_flow.match.dl_vlan = htons(match.vlan);
+    }
 
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_TYPE);
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::NW_SRC_MASK);
-    unset_wildcard(ofp_flow, static_cast<ofp_flow_wildcards_1_0>((32 - prefix) << static_cast<E>(ofp_flow_wildcards_1_0::NW_SRC_SHIFT)));
-    ofp_flow.match.dl_type = htons(static_cast<uint16_t>(L2Proto::IPv4));
-    ofp_flow.match.nw_src = static_cast<uint32_t>(ip.to_net_order_ulong());
+    if (match.has(FlowMatch::EthType))
+    {
+        set_wildcard(ofp_flow, W::DL_TYPE);
+        ofp_flow.match.dl_type = htons(static_cast<uint16_t>(match.eth_type));
+    }
 
-    return ofp_flow;
-}
+    if (match.has(FlowMatch::IpProto))
+    {
+        set_wildcard(ofp_flow, W::NW_PROTO);
+        ofp_flow.match.nw_proto = static_cast<uint8_t>(match.ip_proto);
+    }
 
-ofp_flow_mod_1_0& from_ip_dst(ofp_flow_mod_1_0& ofp_flow, const tnt::ip::Address& ip, int prefix)
-{
-    using E = std::underlying_type_t<ofp_flow_wildcards_1_0>;
+    if (match.has(FlowMatch::HwSrc))
+    {
+        set_wildcard(ofp_flow, W::DL_SRC);
+        std::copy_n(match.hw_src.begin(), 6, ofp_flow.match.dl_src);
+    }
 
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_TYPE);
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::NW_DST_MASK);
-    unset_wildcard(ofp_flow, static_cast<ofp_flow_wildcards_1_0>((32 - prefix) << static_cast<E>(ofp_flow_wildcards_1_0::NW_DST_SHIFT)));
-    ofp_flow.match.dl_type = htons(static_cast<uint16_t>(L2Proto::IPv4));
-    ofp_flow.match.nw_dst = static_cast<uint32_t>(ip.to_net_order_ulong());
+    if (match.has(FlowMatch::HwDst))
+    {
+        set_wildcard(ofp_flow, W::DL_DST);
+        std::copy_n(match.hw_dst.begin(), 6, ofp_flow.match.dl_dst);
+    }
 
-    return ofp_flow;
-}
+    if (match.has(FlowMatch::IpSrc))
+    {
+        from_ip(ofp_flow, W::NW_SRC_MASK, W::NW_SRC_SHIFT, match.ip_src_prefix);
+        ofp_flow.match.nw_src = match.ip_src;
+    }
 
-ofp_flow_mod_1_0& from_transport_port_src(ofp_flow_mod_1_0& ofp_flow, L3Proto proto, uint16_t port)
-{
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_TYPE);
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::NW_PROTO);
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::TP_SRC);
-    ofp_flow.match.dl_type = htons(static_cast<uint16_t>(L2Proto::IPv4));
-    ofp_flow.match.nw_proto = static_cast<uint8_t>(proto);
-    ofp_flow.match.tp_src = htons(port);
+    if (match.has(FlowMatch::IpDst))
+    {
+        from_ip(ofp_flow, W::NW_DST_MASK, W::NW_DST_SHIFT, match.ip_dst_prefix);
+        ofp_flow.match.nw_dst = match.ip_dst;
+    }
 
-        return ofp_flow;
-}
+    if (match.has(FlowMatch::TpSrc))
+    {
+        set_wildcard(ofp_flow, W::TP_SRC);
+        ofp_flow.match.tp_src = htons(match.tp_src);
+    }
 
-ofp_flow_mod_1_0& from_transport_port_dst(ofp_flow_mod_1_0& ofp_flow, L3Proto proto, uint16_t port)
-{
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::DL_TYPE);
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::NW_PROTO);
-    set_wildcard(ofp_flow, ofp_flow_wildcards_1_0::TP_DST);
-    ofp_flow.match.dl_type = htons(static_cast<uint16_t>(L2Proto::IPv4));
-    ofp_flow.match.nw_proto = static_cast<uint8_t>(proto);
-    ofp_flow.match.tp_dst = htons(port);
+    if (match.has(FlowMatch::TpDst))
+    {
+        set_wildcard(ofp_flow, W::TP_DST);
+        ofp_flow.match.tp_dst = htons(match.tp_dst);
+    }
 
-    return ofp_flow;
+    ofp_flow.match.wildcards = host_to_network(ofp_flow.match.wildcards);
 }
 
 // Actions
@@ -249,40 +225,32 @@ ofp_action_header_1_0 to_controller(uint16_t size)
     return action;
 }
 
-std::vector<ofp_action_header_1_0> to_ports(const std::vector<uint16_t>& dst)
+ofp_action_header_1_0 to_port(uint16_t port)
 {
-    std::vector<ofp_action_header_1_0> actions;
-
     auto action = ofp_action_header_1_0();
     set_type(action, ofp_action_type_1_0::OUTPUT);
-    
-    for (auto p : dst)
-    {
-        uint16_t val16 = p;
-        set_value(action, val16);
-
-        actions.push_back(action);
-    }
+    set_value(action, port);
 
-    return actions;
+    return action;
 }
 
-std::pair<ofp_action_header_1_0, ofp_action_header_1_0> set_hw_src(const tnt::MacAddress& mac)
+void set_hw(ofp_action_type_1_0 type, const std::array<uint8_t, 6>& mac, MessageBuffer& buf)
 {
     auto action = ofp_action_header_1_0();
-    set_type(action, ofp_action_type_1_0::SET_DL_SRC);
+    set_type(action, type);
     auto action_cont = set_value(action, mac);
 
-    return { action, action_cont };
+    buf.append(action);
+    buf.append(action_cont);
 }
 
-std::pair<ofp_action_header_1_0, ofp_action_header_1_0> set_hw_dst(const tnt::MacAddress& mac)
+ofp_action_header_1_0 set_ip(ofp_action_type_1_0 type, uint32_t ip)
 {
     auto action = ofp_action_header_1_0();
-    set_type(action, ofp_action_type_1_0::SET_DL_DST);
-    auto action_cont = set_value(action, mac);
+    set_type(action, type);
+    set_value(action, ip);
 
-    return { action, action_cont };
+    return action;
 }
 
 ofp_action_header_1_0 set_vlan(uint16_t tag)
@@ -302,217 +270,100 @@ ofp_action_header_1_0 strip_vlan()
     return action;
 }
 
-std::string actions_to_string(const std::vector<ofp_action_header_1_0>& actions)
+// The actions are written right after the flow-mod, in the same buffer: the rewrites
+// first, then the outputs.
+void add_actions(const FlowActions& actions, MessageBuffer& buf)
 {
-    std::string str;
-
-    for (const auto& a : actions)
+    if (actions.has(FlowActions::StripVlan))
     {
-        str.append(to_mem_buffer(a));
+        buf.append(strip_vlan());
     }
 
-    return str;
-}
-
-void add_flag(FlowFlag* flag, ofp_flow_mod_1_0& ofp_flow)
-{
-    if (tnt::visit<Priority>(flag, [&] (auto f) { ofp_flow.priority = f->value(); }))
+    if (actions.has(FlowActions::SetVlan))
     {
-        return;
+        buf.append(set_vlan(actions.vlan));
     }
 
-    if (tnt::visit<Buffer>(flag, [&] (auto f) { ofp_flow.buffer_id = f->value(); }))
+    if (actions.has(FlowActions::SetHwSrc))
     {
-        return;
+        set_hw(ofp_action_type_1_0::SET_DL_SRC, actions.hw_src, buf);
     }
 
-    if (tnt::visit<Cookie>(flag, [&] (auto f) { ofp_flow.cookie = f->value(); }))
+    if (actions.has(FlowActions::SetHwDst))
     {
-        return;
+        set_hw(ofp_action_type_1_0::SET_DL_DST, actions.hw_dst, buf);
     }
 
-    if (tnt::visit<IdleTimeout>(flag, [&] (auto f) { ofp_flow.idle_timeout = f->value(); }))
+    if (actions.has(FlowActions::SetIpSrc))
     {
-        return;
+        buf.append(set_ip(ofp_action_type_1_0::SET_NW_SRC, actions.ip_src));
     }
 
-    if (tnt::visit<HardTimeout>(flag, [&] (auto f) { ofp_flow.hard_timeout = f->value(); }))
+    if (actions.has(FlowActions::SetIpDst))
     {
-        return;
+        buf.append(set_ip(ofp_action_type_1_0::SET_NW_DST, actions.ip_dst));
     }
 
-    if (tnt::visit<OutPort>(flag, [&] (auto f) { ofp_flow.out_port = f->value(); }))
+    for (size_t i = 0; i < actions.port_count; ++i)
     {
-        return;
+        buf.append(to_port(actions.ports[i]));
     }
 
-    if (tnt::visit<Flags>(flag, [&] (auto f) { ofp_flow.flags = f->value(); }))
+    if (actions.has(FlowActions::Loop))
     {
-        return;
+        buf.append(to_port(static_cast<uint16_t>(ofp_port_1_0::IN_PORT)));
     }
-}
 
-void add_flags(const Flow& flow, ofp_flow_mod_1_0& ofp_flow)
-{
-    for (const auto& f : flow.flags())
+    if (actions.has(FlowActions::Flood))
     {
-        add_flag(f.get(), ofp_flow);
+        buf.append(to_port(static_cast<uint16_t>(ofp_port_1_0::FLOOD)));
     }
-}
 
-void add_filter(ofp_flow_mod_1_0& ofp_flow, FlowFilter* filter)
-{
-    if (tnt::visit<FromPort>(filter, [&] (auto f) { from_port(ofp_flow, f->port()); }))
+    if (actions.has(FlowActions::Controller))
     {
-        return;
+        buf.append(to_controller(actions.controller_len));
     }
-
-    if (tnt::visit<FromVlan>(filter, [&] (auto f) { from_vlan(ofp_flow, f->tag()); }))
-    {
-        return;
-    }
-
-    if (tnt::visit<FromL2Proto>(filter, [&] (auto f) { from_proto(ofp_flow, f->proto()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromL3Proto>(filter, [&] (auto f) { from_proto(ofp_flow, f->proto()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromHwSrc>(filter, [&] (auto f) { from_hw_src(ofp_flow, f->mac()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromHwDst>(filter, [&] (auto f) { from_hw_dst(ofp_flow, f->mac()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromIpSrc>(filter, [&] (auto f) { from_ip_src(ofp_flow, f->ip(), f->prefix()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromIpDst>(filter, [&] (auto f) { from_ip_dst(ofp_flow, f->ip(), f->prefix()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromTransportPortSrc>(filter, [&] (auto f) { from_transport_port_src(ofp_flow, f->proto(), f->port()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromTransportPortDst>(filter, [&] (auto f) { from_transport_port_dst(ofp_flow, f->proto(), f->port()); }))
-    {
-        return;
-    }
-}
-
-void add_filters(const Flow& flow, ofp_flow_mod_1_0& ofp_flow)
-{
-    ofp_flow.match.wildcards = ofp_flow_wildcards_1_0::ALL;
-
-    for (const auto& f : flow.filters())
-    {
-        add_filter(ofp_flow, f.get());
-    }
-
-    ofp_flow.match.wildcards = host_to_network(ofp_flow.match.wildcards);
 }
 
-void get_action(FlowAction* action, std::vector<ofp_action_header_1_0>& actions)
+void add_flags(const FlowFlags& flags, ofp_flow_mod_1_0& ofp_flow)
 {
-    if (tnt::visit<ToController>(action, [&] (auto a)
-    {
-        actions.push_back(to_controller(a->size()));
-    }))
+    if (flags.has(FlowFlags::Priority))
     {
-        return;
+        ofp_flow.priority = htons(flags.priority);
     }
 
-    if (tnt::visit<ToPorts>(action, [&] (auto a)
+    if (flags.has(FlowFlags::Buffer))
     {
-        for (const auto& p : to_ports(a->ports()))
-        {
-            actions.push_back(p);
-        }
-    }))
-    {
-        return;
+        ofp_flow.buffer_id = htonl(flags.buffer);
     }
 
-    if (tnt::visit<Loop>(action, [&] (auto /*a*/)
-    {
-        actions.push_back(to_ports({ static_cast<uint16_t>(ofp_port_1_0::IN_PORT) })[0]);
-    }))
+    if (flags.has(FlowFlags::Cookie))
     {
-        return;
+        ofp_flow.cookie = htonll(flags.cookie);
     }
 
-    if (tnt::visit<Flood>(action, [&] (auto /*a*/)
+    if (flags.has(FlowFlags::IdleTimeout))
     {
-        actions.push_back(to_ports({ static_cast<uint16_t>(ofp_port_1_0::FLOOD) })[0]);
-    }))
-    {
-        return;
+        ofp_flow.idle_timeout = htons(flags.idle_timeout);
     }
 
-    if (tnt::visit<SetHwSrc>(action, [&] (auto a)
-    {
-        auto p = set_hw_src(a->mac());
-        actions.push_back(p.first);
-        actions.push_back(p.second);
-    }))
+    if (flags.has(FlowFlags::HardTimeout))
     {
-        return;
+        ofp_flow.hard_timeout = htons(flags.hard_timeout);
     }
 
-    if (tnt::visit<SetHwDst>(action, [&] (auto a)
+    if (flags.has(FlowFlags::OutPort))
     {
-        auto p = set_hw_dst(a->mac());
-        actions.push_back(p.first);
-        actions.push_back(p.second);
-    }))
-    {
-        return;
+        ofp_flow.out_port = htons(flags.out_port);
     }
 
-    if (tnt::visit<SetVlan>(action, [&] (auto a)
-    {
-        actions.push_back(set_vlan(a->tag()));
-    }))
+    if (flags.has(FlowFlags::Flags))
     {
-        return;
+        ofp_flow.flags = htons(flags.flags);
     }
-
-    if (tnt::is<StripVlan>(action))
-    {
-        actions.push_back(strip_vlan());
-
-        return;
-    }
-
-    tnt::Log::error("Unsupported Action");
-}
-
-std::vector<ofp_action_header_1_0> get_actions(const Flow& flow)
-{
-    std::vector<ofp_action_header_1_0> actions;
-
-    for (const auto& f : flow.actions())
-    {
-        get_action(f.get(), actions);
-    }
-
-    return actions;
 }
 
-std::string get_flow(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_0 command)
+void get_flow(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_0 command, MessageBuffer& buf)
 {
     auto ofp_flow = ofp_flow_mod_1_0();
     
@@ -526,13 +377,15 @@ std::string get_flow(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_0 co
     ofp_flow.flags = host_to_network_underlying(ofp_flow_mod_flags_1_0::SEND_FLOW_REM);
     ofp_flow.priority = htons(OFP_DEFAULT_PRIORITY);
     
-    add_flags(flow, ofp_flow);
-    add_filters(flow, ofp_flow);
+    add_flags(flow.flags(), ofp_flow);
+    add_filters(flow.match(), ofp_flow);
 
-    auto actions = get_actions(flow);
-    ofp_flow.header.length = htons(sizeof(ofp_flow_mod_1_0) + sizeof(ofp_action_header_1_0) * actions.size());
+    buf.clear();
+    buf.append(ofp_flow);
 
-    return to_mem_buffer(ofp_flow) + actions_to_string(actions);
+    add_actions(flow.actions(), buf);
+
+    buf.overwrite(offsetof(ofp_flow_mod_1_0, header) + offsetof(ofp_header_1_0, length), htons(static_cast<uint16_t>(buf.size())));
 }
 
 } // namespace
@@ -549,34 +402,44 @@ void Openflow_1_0::init()
     packet.version = version;
     packet.type = ofp_type_1_0::FEATURES_REQUEST;
     packet.length = htons(sizeof(packet));
-    packet.xid = htonl(create_xid());
+    packet.xid = htonl(parent_->next_xid());
 
     parent_->write(to_mem_buffer(packet));
 
-    std::this_thread::sleep_for(50ms); // Needed to avoid the packets to be sent in the same tcp packet.
-
     auto sw_config = ofp_switch_config_1_0();
 
     sw_config.header.version = version;
     sw_config.header.type = ofp_type_1_0::SET_CONFIG;
     sw_config.header.length = htons(sizeof(sw_config));
-    sw_config.header.xid = htonl(create_xid());
+    sw_config.header.xid = htonl(parent_->next_xid());
     sw_config.flags = ofp_config_flags::FRAG_NORMAL;
     sw_config.miss_send_len = 0x0080;
 
     parent_->write(to_mem_buffer(sw_config));
 }
 
-void Openflow_1_0::add(const Flow& flow)
+void Openflow_1_0::add(const Flow& flow, uint32_t xid)
+{
+    get_flow(flow, xid, ofp_flow_mod_command_1_0::ADD, flow_mod_);
+    parent_->write(flow_mod_.data(), flow_mod_.size());
+}
+
+void Openflow_1_0::remove(const Flow& flow, uint32_t xid)
 {
-    auto xid = create_xid();
-    parent_->write(get_flow(flow, xid, ofp_flow_mod_command_1_0::ADD));
+    get_flow(flow, xid, ofp_flow_mod_command_1_0::DELETE, flow_mod_);
+    parent_->write(flow_mod_.data(), flow_mod_.size());
 }
 
-void Openflow_1_0::remove(const Flow& flow)
+void Openflow_1_0::barrier(uint32_t xid)
 {
-    auto xid = create_xid();
-    parent_->write(get_flow(flow, xid, ofp_flow_mod_command_1_0::DELETE));
+    auto pkt = ofp_header_1_0();
+
+    pkt.type = ofp_type_1_0::BARRIER_REQUEST;
+    pkt.version = version;
+    pkt.xid = htonl(xid);
+    pkt.length = htons(sizeof(pkt));
+
+    parent_->write(to_mem_buffer(pkt));
 }
 
 void Openflow_1_0::remove_all()
@@ -585,7 +448,7 @@ void Openflow_1_0::remove_all()
 
     pkt.header.type = ofp_type_1_0::FLOW_MOD;
     pkt.header.version = version;
-    pkt.header.xid = htonl(create_xid());
+    pkt.header.xid = htonl(parent_->next_xid());
     pkt.header.length = htons(sizeof(pkt));
 
     pkt.match.wildcards = ofp_flow_wildcards_1_0::ALL; // 0xffffffff;
@@ -603,7 +466,7 @@ void Openflow_1_0::send_packet(const std::string& buffer, uint16_t port)
 
     pkt.header.type = ofp_type_1_0::PACKET_OUT;
     pkt.header.version = version;
-    pkt.header.xid = htonl(create_xid());
+    pkt.header.xid = htonl(parent_->next_xid());
     pkt.header.length = htons(sizeof(pkt) + buffer.size());
 
     pkt.in_port = htons(port);
@@ -616,6 +479,11 @@ void Openflow_1_0::request_port_stats(uint16_t /*port*/)
 
 }
 
+void Openflow_1_0::request_stats(OpenflowStats /*what*/)
+{
+
+}
+
 void Openflow_1_0::echo(const std::string& message)
 {
     auto ptr = message.data();
@@ -632,6 +500,13 @@ void Openflow_1_0::echo(const std::string& message)
     parent_->write(to_mem_buffer(reply) + std::string(ptr + sizeof(ofp_header_1_0), payload_len));
 }
 
+void Openflow_1_0::barrier_reply(const std::string& message)
+{
+    auto pkt = reinterpret_cast<const ofp_header_1_0*>(message.data());
+
+    parent_->barrier_reply(ntohl(pkt->xid));
+}
+
 void Openflow_1_0::port_status(const std::string& message)
 {
     auto temp = reinterpret_cast<const ofp_port_status_1_0*>(message.data());
@@ -685,6 +560,13 @@ void Openflow_1_0::error(const std::string& message)
     {
         tnt::Log::error("Error type not defined in the Openflow Protocol version ", static_cast<unsigned int>(version));
     }
+
+    if (message.size() >= sizeof(ofp_error_msg_1_0) + sizeof(ofp_header_1_0))
+    {
+        // The data of the error starts with the header of the failed request.
+        auto request = reinterpret_cast<const ofp_header_1_0*>(ptr + sizeof(ofp_error_msg_1_0));
+        parent_->failed(ntohl(request->xid), ntohs(static_cast<uint16_t>(pkt->type)), ntohs(pkt->code));
+    }
 }
 
 void Openflow_1_0::features(const std::string& message)
@@ -853,6 +735,7 @@ void Openflow_1_0::register_handlers()
     message_dispatcher_.register_listener(ofp_type_1_0::FEATURES_REPLY,    [this] (const std::string& message) { features(message); });
     message_dispatcher_.register_listener(ofp_type_1_0::ERROR,             [this] (const std::string& message) { error(message); });
     message_dispatcher_.register_listener(ofp_type_1_0::ECHO_REQUEST,      [this] (const std::string& message) { echo(message); });
+    message_dispatcher_.register_listener(ofp_type_1_0::BARRIER_REPLY,     [this] (const std::string& message) { barrier_reply(message); });
     message_dispatcher_.register_listener(ofp_type_1_0::PACKET_IN,         [this] (const std::string& message) { packet_in(message); });
     message_dispatcher_.register_listener(ofp_type_1_0::GET_CONFIG_REPLY,  [this] (const std::string& message) { get_config(message); });
     message_dispatcher_.register_listener(ofp_type_1_0::FLOW_REMOVED,      [this] (const std::string& message) { flow_removed(message); });
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "protocol/openflow/openflow_version.hpp"
 #include "protocol/openflow/v_1_0/values.hpp"
+#include "protocol/openflow/message_buffer.hpp"
 
 #include "dispatch.hpp"
 
@@ -80,18 +81,21 @@ public:
     virtual void init() override;
     virtual void remove_all() override;
 
-    virtual void add(const Flow& flow) override;
-    virtual void remove(const Flow& flow) override;
+    virtual void add(const Flow& flow, uint32_t xid) override;
+    virtual void remove(const Flow& flow, uint32_t xid) override;
+    virtual void barrier(uint32_t xid) override;
 
     virtual void packet(const std::string& message) override;
 
     virtual void send_packet(const std::string& buffer, uint16_t port) override;
 
     virtual void request_port_stats(uint16_t port) override;
+    virtual void request_stats(OpenflowStats what) override;
 private:
     void features(const std::string& message);
     void error(const std::string& message);
     void echo(const std::string& message);
+    void barrier_reply(const std::string& message);
     void port_status(const std::string& message);
     void get_config(const std::string& message);
     void stats(const std::string& message);
@@ -111,6 +115,8 @@ private:
 private:
     Openflow* parent_;
 
+    MessageBuffer flow_mod_; // Reused by add() and remove(), only called by the tx loop.
+
     tnt::KeyDispatch<ofp_type_1_0, void, const std::string&> message_dispatcher_;
     tnt::KeyDispatch<ofp_error_type_1_0, void, const ofp_error_msg_1_0*, const std::string&> error_dispatcher_;
 };
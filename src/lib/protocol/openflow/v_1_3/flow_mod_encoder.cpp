@@ -0,0 +1,346 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#include "flow_mod_encoder.hpp"
+
+#include <array>
+#include <limits>
+#include <cstring>
+#include <cassert>
+
+#include "protocol/openflow/message_buffer.hpp"
+#include "protocol/openflow/values.hpp"
+#include "protocol/openflow/flow.hpp"
+
+#include "endianness.hpp"
+
+namespace drop {
+namespace protocol {
+namespace {
+
+static const uint8_t version = 0x04;
+
+uint32_t oxm_header(ofp_oxm_class_1_3 oxm_class, oxm_ofb_match_fields_1_3 field, bool has_mask, uint8_t len)
+{
+    uint32_t header = 0;
+
+    header |= (static_cast<int16_t>(oxm_class) << 16);
+    header |= (static_cast<uint8_t>(field) << 9);
+
+    if (has_mask)
+    {
+        header |= (1 << 8);
+    }
+
+    header |= len;
+
+    return htonl(header);
+}
+
+uint32_t oxm_basic_header(oxm_ofb_match_fields_1_3 field, bool has_mask, uint8_t len)
+{
+    return oxm_header(ofp_oxm_class_1_3::OPENFLOW_BASIC, field, has_mask, len);
+}
+
+// Writes the OXM TLVs and the actions, values are passed in network order.
+class Encode
+{
+public:
+    explicit Encode(MessageBuffer& buf): buf_(buf) {}
+
+    template <class T> void oxm(oxm_ofb_match_fields_1_3 field, const T& value)
+    {
+        buf_.append(oxm_basic_header(field, false, sizeof(T)));
+        buf_.append(value);
+    }
+
+    template <class T> void oxm(oxm_ofb_match_fields_1_3 field, const T& value, const T& mask)
+    {
+        buf_.append(oxm_basic_header(field, true, 2 * sizeof(T)));
+        buf_.append(value);
+        buf_.append(mask);
+    }
+
+    void output(uint32_t port, uint16_t max_len)
+    {
+        auto action = ofp_action_output_1_3();
+        action.type = host_to_network(ofp_action_type_1_3::OUTPUT);
+        action.port = htonl(port);
+        action.len = htons(sizeof(action));
+        action.max_len = max_len;
+
+        buf_.append(action);
+    }
+
+    template <class T> void set_field(oxm_ofb_match_fields_1_3 field, const T& value)
+    {
+        auto len = set_field_size_1_3(sizeof(T));
+
+        auto action = ofp_action_set_field_1_3();
+        action.type = host_to_network(ofp_action_type_1_3::SET_FIELD);
+        action.len = htons(len);
+
+        auto header = oxm_basic_header(field, false, sizeof(T));
+        std::memcpy(action.field, &header, sizeof(header));
+
+        buf_.append(action);
+        buf_.append(value);
+        buf_.extend(len - sizeof(action) - sizeof(T));
+    }
+
+    void action(ofp_action_type_1_3 type)
+    {
+        auto action = ofp_action_header_1_3();
+        action.type = host_to_network(type);
+        action.len = htons(sizeof(action));
+
+        buf_.append(action);
+    }
+private:
+    MessageBuffer& buf_;
+};
+
+void from_ip(Encode& e, oxm_ofb_match_fields_1_3 field, uint32_t ip, int prefix)
+{
+    if (prefix == 32)
+    {
+        e.oxm(field, ip);
+    }
+    else
+    {
+        e.oxm(field, ip, htonl(std::numeric_limits<uint32_t>::max() << (32 - prefix)));
+    }
+}
+
+// One TLV per field, in the order of the OXM fields.
+void add_filters(const FlowMatch& match, Encode& e)
+{
+    using F = oxm_ofb_match_fields_1_3;
+
+    const auto tcp = match.ip_proto == L3Proto::Tcp;
+
+    if (match.has(FlowMatch::InPort))
+    {
+        e.oxm(F::IN_PORT, htonl(static_cast<uint32_t>(match.in_port)));
+    }
+
+    if (match.has(FlowMatch::Vlan))
+    {
+        e.oxm(F::VLAN_VID, htons(static_cast<uint16_t>(match.vlan | ofp_vlan_id_1_3::PRESENT)));
+    }
+
+    if (match.has(FlowMatch::EthType))
+    {
+        e.oxm(F::ETH_TYPE, htons(static_cast<uint16_t>(match.eth_type)));
+    }
+
+    if (match.has(FlowMatch::IpProto))
+    {
+        e.oxm(F::IP_PROTO, static_cast<uint8_t>(match.ip_proto));
+    }
+
+    if (match.has(FlowMatch::HwSrc))
+    {
+        e.oxm(F::ETH_SRC, match.hw_src);
+    }
+
+    if (match.has(FlowMatch::HwDst))
+    {
+        e.oxm(F::ETH_DST, match.hw_dst);
+    }
+
+    if (match.has(FlowMatch::IpSrc))
+    {
+        from_ip(e, F::IPV4_SRC, match.ip_src, match.ip_src_prefix);
+    }
+
+    if (match.has(FlowMatch::IpDst))
+    {
+        from_ip(e, F::IPV4_DST, match.ip_dst, match.ip_dst_prefix);
+    }
+
+    if (match.has(FlowMatch::TpSrc))
+    {
+        e.oxm(tcp ? F::TCP_SRC : F::UDP_SRC, htons(match.tp_src));
+    }
+
+    if (match.has(FlowMatch::TpDst))
+    {
+        e.oxm(tcp ? F::TCP_DST : F::UDP_DST, htons(match.tp_dst));
+    }
+}
+
+// The rewrites go before the outputs, so every output sees the rewritten packet.
+void add_actions(const FlowActions& actions, Encode& e)
+{
+    using F = oxm_ofb_match_fields_1_3;
+
+    if (actions.has(FlowActions::StripVlan))
+    {
+        e.action(ofp_action_type_1_3::SET_FIELD);
+    }
+
+    if (actions.has(FlowActions::SetVlan))
+    {
+        e.set_field(F::VLAN_VID, htons(static_cast<uint16_t>(actions.vlan | ofp_vlan_id_1_3::PRESENT)));
+    }
+
+    if (actions.has(FlowActions::SetHwSrc))
+    {
+        e.set_field(F::ETH_SRC, actions.hw_src);
+    }
+
+    if (actions.has(FlowActions::SetHwDst))
+    {
+        e.set_field(F::ETH_DST, actions.hw_dst);
+    }
+
+    if (actions.has(FlowActions::SetIpSrc))
+    {
+        e.set_field(F::IPV4_SRC, actions.ip_src);
+    }
+
+    if (actions.has(FlowActions::SetIpDst))
+    {
+        e.set_field(F::IPV4_DST, actions.ip_dst);
+    }
+
+    for (size_t i = 0; i < actions.port_count; ++i)
+    {
+        e.output(actions.ports[i], 0);
+    }
+
+    if (actions.has(FlowActions::Loop))
+    {
+        e.output(static_cast<uint32_t>(ofp_port_no_1_3::IN_PORT), 0);
+    }
+
+    if (actions.has(FlowActions::Flood))
+    {
+        e.output(static_cast<uint32_t>(ofp_port_no_1_3::FLOOD), 0);
+    }
+
+    if (actions.has(FlowActions::Controller))
+    {
+        e.output(static_cast<uint32_t>(ofp_port_no_1_3::CONTROLLER), actions.controller_len);
+    }
+}
+
+void add_flags(const FlowFlags& flags, ofp_flow_mod_1_3& ofp_flow)
+{
+    if (flags.has(FlowFlags::Priority))
+    {
+        ofp_flow.priority = htons(flags.priority);
+    }
+
+    if (flags.has(FlowFlags::Buffer))
+    {
+        ofp_flow.buffer_id = htonl(flags.buffer);
+    }
+
+    if (flags.has(FlowFlags::Cookie))
+    {
+        ofp_flow.cookie = htonll(flags.cookie);
+    }
+
+    if (flags.has(FlowFlags::IdleTimeout))
+    {
+        ofp_flow.idle_timeout = htons(flags.idle_timeout);
+    }
+
+    if (flags.has(FlowFlags::HardTimeout))
+    {
+        ofp_flow.hard_timeout = htons(flags.hard_timeout);
+    }
+
+    if (flags.has(FlowFlags::OutPort))
+    {
+        ofp_flow.out_port = htonl(static_cast<uint32_t>(flags.out_port));
+    }
+
+    if (flags.has(FlowFlags::Flags))
+    {
+        ofp_flow.flags = htons(flags.flags);
+    }
+}
+
+} // namespace
+
+void encode_flow_mod_1_3(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_3 command, MessageBuffer& buf)
+{
+    const auto match_offset = offsetof(ofp_flow_mod_1_3, match);
+    const auto oxm_offset = match_offset + offsetof(ofp_match_1_3, oxm_fields);
+
+    auto ofp_flow = ofp_flow_mod_1_3();
+    
+    ofp_flow.header.type = ofp_type_1_3::FLOW_MOD;
+    ofp_flow.header.version = version;
+    ofp_flow.header.xid = htonl(xid);
+    
+    ofp_flow.command = host_to_network(command);
+    ofp_flow.buffer_id = htonl(OFP_NO_BUFFER);
+    ofp_flow.out_port = host_to_network_underlying(ofp_port_no_1_3::ANY);
+    ofp_flow.flags = host_to_network_underlying(ofp_flow_mod_flags_1_3::SEND_FLOW_REM);
+    ofp_flow.priority = htons(OFP_DEFAULT_PRIORITY);
+    ofp_flow.match.type = host_to_network(ofp_match_type_1_3::OXM);
+    
+    add_flags(flow.flags(), ofp_flow);
+
+    auto instructions = ofp_instruction_actions_1_3();
+    instructions.type = host_to_network(ofp_instruction_type_1_3::APPLY_ACTIONS);
+
+    buf.clear();
+
+    Encode encode(buf);
+
+    // The OXM TLVs start in the last 4 bytes of ofp_match_1_3.
+    buf.append(&ofp_flow, oxm_offset);
+
+    add_filters(flow.match(), encode);
+
+    auto oxm_len = buf.size() - oxm_offset;
+    auto match_len = offsetof(ofp_match_1_3, oxm_fields) + oxm_len;
+
+    buf.extend(padded_size_1_3(match_len) - match_len);
+
+    auto instructions_offset = buf.size();
+    buf.append(instructions);
+
+    add_actions(flow.actions(), encode);
+
+    auto actions_len = buf.size() - instructions_offset - sizeof(instructions);
+
+    buf.overwrite(offsetof(ofp_flow_mod_1_3, header) + offsetof(ofp_header_1_3, length), htons(static_cast<uint16_t>(buf.size())));
+    buf.overwrite(match_offset + offsetof(ofp_match_1_3, length), htons(static_cast<uint16_t>(match_len)));
+    buf.overwrite(instructions_offset + offsetof(ofp_instruction_actions_1_3, len), htons(static_cast<uint16_t>(sizeof(instructions) + actions_len)));
+
+    assert(buf.size() == flow_mod_size_1_3(oxm_len, actions_len));
+}
+
+} // namespace protocol
+} // namespace drop
@@ -0,0 +1,77 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef DROP_PROTOCOL_OPENFLOW_FLOW_MOD_ENCODER_1_3_HPP_
+#define DROP_PROTOCOL_OPENFLOW_FLOW_MOD_ENCODER_1_3_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include "protocol/openflow/v_1_3/structs.hpp"
+#include "protocol/openflow/v_1_3/values.hpp"
+
+namespace drop {
+namespace protocol {
+
+class Flow;
+class MessageBuffer;
+
+constexpr size_t padded_size_1_3(size_t len)
+{
+    return (len + 7) / 8 * 8;
+}
+
+constexpr size_t oxm_size_1_3(size_t value_len, bool has_mask = false)
+{
+    return 4 + (has_mask ? 2 : 1) * value_len;
+}
+
+constexpr size_t set_field_size_1_3(size_t value_len)
+{
+    return padded_size_1_3(sizeof(ofp_action_set_field_1_3) + value_len);
+}
+
+//! Size of a FLOW_MOD with oxm_len bytes of OXM TLVs and one APPLY_ACTIONS instruction.
+constexpr size_t flow_mod_size_1_3(size_t oxm_len, size_t actions_len)
+{
+    return offsetof(ofp_flow_mod_1_3, match) + padded_size_1_3(offsetof(ofp_match_1_3, oxm_fields) + oxm_len) +
+        sizeof(ofp_instruction_actions_1_3) + actions_len;
+}
+
+// The common shapes: a route (ETH_TYPE and masked IPV4_DST) and a port (IN_PORT), output to one port.
+constexpr size_t ip_dst_flow_mod_size_1_3 = flow_mod_size_1_3(oxm_size_1_3(2) + oxm_size_1_3(4, true), sizeof(ofp_action_output_1_3));
+constexpr size_t in_port_flow_mod_size_1_3 = flow_mod_size_1_3(oxm_size_1_3(4), sizeof(ofp_action_output_1_3));
+
+//! Encodes flow as a FLOW_MOD in buf, replacing its content. The message is written in a
+//! single pass, the lengths are filled in at the end.
+void encode_flow_mod_1_3(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_3 command, MessageBuffer& buf);
+
+} // namespace protocol
+} // namespace drop
+
+#endif
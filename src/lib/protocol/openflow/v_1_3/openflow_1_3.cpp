@@ -27,707 +27,565 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "openflow_1_3.hpp"
 
+#include <vector>
+#include <chrono>
+#include <algorithm>
 #include <cstring>
+#include <cstddef>
+
+#include "event/network/openflow_stats.hpp"
 
 #include "protocol/openflow/v_1_3/structs.hpp"
 #include "protocol/openflow/v_1_3/values.hpp"
+#include "protocol/openflow/v_1_3/flow_mod_encoder.hpp"
 #include "protocol/openflow/utils.hpp"
 #include "protocol/openflow/openflow.hpp"
-#include "protocol/openflow/flow.hpp"
-#include "protocol/openflow/flow_flags.hpp"
-#include "protocol/openflow/flow_filters.hpp"
-#include "protocol/openflow/flow_actions.hpp"
 
 #include "util/random.hpp"
 
-#include "dynamic_pointer_visitor.hpp"
-#include "mac_address.hpp"
-#include "ip_address.hpp"
+#include "application.hpp"
 #include "endianness.hpp"
+#include "colors.hpp"
 #include "log.hpp"
 #include "dump.hpp"
 
-using namespace std::literals;
-
 namespace drop {
 namespace protocol {
 namespace {
 
 static const uint8_t version = 0x04;
 
-int get_pad_len(int len)
-{
-    return (len + 7) / 8 * 8 - len;
-}
+const uint32_t duration_unsupported = 0xffffffff;
 
-std::string create_pad(int len)
-{
-    return std::string(len, '\0');
-}
+// Bounds of the replies in parts, a switch that never ends them cannot grow the controller.
+const size_t multipart_max_bytes = 16 * 1024 * 1024; // Per reply.
+const size_t multipart_max_open = 16; // Replies in parts at the same time.
 
-uint32_t oxm_header(ofp_oxm_class_1_3 oxm_class, oxm_ofb_match_fields_1_3 field, bool has_mask, uint8_t len)
+// Time of a stats entry in nanoseconds: its duration when the switch fills it, the
+// local clock otherwise.
+uint64_t sample_time(uint32_t duration_sec, uint32_t duration_nsec)
 {
-    uint32_t header = 0;
+    auto seconds = ntohl(duration_sec);
 
-    header |= (static_cast<int16_t>(oxm_class) << 16);
-    header |= (static_cast<uint8_t>(field) << 9);
-
-    if (has_mask)
+    if (seconds == duration_unsupported)
     {
-        header |= (1 << 8);
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
     }
 
-    header |= len;
-
-    return htonl(header);
+    return seconds * 1000000000ull + ntohl(duration_nsec);
 }
 
-uint32_t oxm_basic_header(oxm_ofb_match_fields_1_3 field, bool has_mask, uint8_t len)
+// FNV-1a, folds the fields identifying a flow entry in its id.
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size)
 {
-    return oxm_header(ofp_oxm_class_1_3::OPENFLOW_BASIC, field, has_mask, len);
-}
+    auto bytes = static_cast<const uint8_t*>(data);
 
-std::string tlv_8(oxm_ofb_match_fields_1_3 field, uint8_t value)
-{
-    uint8_t len = sizeof(value);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
 
-    return to_mem_buffer(oxm_basic_header(field, false, len), value);
+    return hash;
 }
 
-std::string tlv_16(oxm_ofb_match_fields_1_3 field, uint16_t value)
+uint64_t flow_id(const ofp_flow_stats_1_3* stats, size_t match_len)
 {
-    value = htons(value);
-    uint8_t len = sizeof(value);
+    auto hash = hash_bytes(0xcbf29ce484222325ull, &stats->table_id, sizeof(stats->table_id));
+    hash = hash_bytes(hash, &stats->priority, sizeof(stats->priority));
+    hash = hash_bytes(hash, &stats->cookie, sizeof(stats->cookie));
 
-    return to_mem_buffer(oxm_basic_header(field, false, len), value);
+    return hash_bytes(hash, &stats->match, match_len);
 }
 
-std::string tlv_32(oxm_ofb_match_fields_1_3 field, uint32_t value)
+// Body of the FLOW and AGGREGATE requests: every table, output and cookie, empty match.
+ofp_flow_stats_request_1_3 all_flows()
 {
-    value = htonl(value);
-    uint8_t len = sizeof(value);
+    auto request = ofp_flow_stats_request_1_3();
 
-    return to_mem_buffer(oxm_basic_header(field, false, len), value);
-}
-
-std::string tlv_ip_mask(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip, int prefix)
-{
-    uint32_t value = ip.to_net_order_ulong();
-    uint32_t mask = htonl(std::numeric_limits<uint32_t>::max() << (32 - prefix));
-    uint8_t len = sizeof(value) + sizeof(mask);
+    request.table_id = static_cast<uint8_t>(ofp_table_1_3::ALL);
+    request.out_port = host_to_network_underlying(ofp_port_no_1_3::ANY);
+    request.out_group = host_to_network_underlying(ofp_group_no_1_3::ANY);
+    request.match.type = host_to_network(ofp_match_type_1_3::OXM);
+    request.match.length = htons(sizeof(request.match) - 4);
 
-    return to_mem_buffer(oxm_basic_header(field, true, len), value, mask);
+    return request;
 }
 
-std::string tlv_ip(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip)
-{
-    uint32_t value = ip.to_net_order_ulong();
-    uint8_t len = sizeof(value);
-
-    return to_mem_buffer(oxm_basic_header(field, false, len), value);
-}
+} // namespace
 
-std::string tlv_ip(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip, int prefix)
+Openflow_1_3::Openflow_1_3(Openflow* parent): parent_(parent)
 {
-    return prefix == 32 ? tlv_ip(field, ip): tlv_ip_mask(field, ip, prefix);
+    assert(parent_);
+    register_handlers();
 }
 
-std::string tlv_mac(oxm_ofb_match_fields_1_3 field, const tnt::MacAddress& value)
+void Openflow_1_3::init()
 {
-    assert(field == oxm_ofb_match_fields_1_3::ETH_SRC || field == oxm_ofb_match_fields_1_3::ETH_DST);
+    auto packet = ofp_header_1_3();
+    packet.version = version;
+    packet.type = ofp_type_1_3::FEATURES_REQUEST;
+    packet.length = htons(sizeof(packet));
+    packet.xid = htonl(parent_->next_xid());
 
-    uint32_t val0 = 0;
-    uint16_t val1 = 0;
-    auto str = value.raw();
-    std::memcpy(&val0, str.data(), 4);
-    std::memcpy(&val1, str.data() + 4, 2);
+    parent_->write(to_mem_buffer(packet));
 
-    uint8_t len = sizeof(val0) + sizeof(val1);
+    auto sw_config = ofp_switch_config_1_3();
 
-    return to_mem_buffer(oxm_basic_header(field, false, len), val0, val1);
-}
+    sw_config.header.version = version;
+    sw_config.header.type = ofp_type_1_3::SET_CONFIG;
+    sw_config.header.length = htons(sizeof(sw_config));
+    sw_config.header.xid = htonl(parent_->next_xid());
+    sw_config.flags = ofp_config_flags::FRAG_NORMAL;
+    sw_config.miss_send_len = 0x0080;
 
-std::string tlv_tcp_src(uint16_t port)
-{
-    return tlv_16(oxm_ofb_match_fields_1_3::TCP_SRC, port);
+    parent_->write(to_mem_buffer(sw_config));
 }
 
-std::string tlv_tcp_dst(uint16_t port)
+void Openflow_1_3::add(const Flow& flow, uint32_t xid)
 {
-    return tlv_16(oxm_ofb_match_fields_1_3::TCP_DST, port);
+    encode_flow_mod_1_3(flow, xid, ofp_flow_mod_command_1_3::ADD, flow_mod_);
+    parent_->write(flow_mod_.data(), flow_mod_.size());
 }
 
-std::string tlv_udp_src(uint16_t port)
+void Openflow_1_3::remove(const Flow& flow, uint32_t xid)
 {
-    return tlv_16(oxm_ofb_match_fields_1_3::UDP_SRC, port);
+    encode_flow_mod_1_3(flow, xid, ofp_flow_mod_command_1_3::DELETE, flow_mod_);
+    parent_->write(flow_mod_.data(), flow_mod_.size());
 }
 
-std::string tlv_udp_dst(uint16_t port)
+void Openflow_1_3::barrier(uint32_t xid)
 {
-    return tlv_16(oxm_ofb_match_fields_1_3::UDP_DST, port);
-}
+    auto pkt = ofp_header_1_3();
 
-std::string tlv_vid(uint16_t tag)
-{
-    return tlv_16(oxm_ofb_match_fields_1_3::VLAN_VID, tag | ofp_vlan_id_1_3::PRESENT);
-}
+    pkt.type = ofp_type_1_3::BARRIER_REQUEST;
+    pkt.version = version;
+    pkt.xid = htonl(xid);
+    pkt.length = htons(sizeof(pkt));
 
-// Filters
-std::string from_port(uint16_t src)
-{
-    return tlv_32(oxm_ofb_match_fields_1_3::IN_PORT, static_cast<uint32_t>(src));
+    parent_->write(to_mem_buffer(pkt));
 }
 
-std::string from_vlan(uint16_t tag)
+void Openflow_1_3::remove_all()
 {
-    return tlv_vid(tag);
-}
+    auto pkt = ofp_flow_mod_1_3();
 
-std::string from_proto(L2Proto proto)
-{
-    return tlv_16(oxm_ofb_match_fields_1_3::ETH_TYPE, static_cast<uint16_t>(proto));
-}
+    pkt.header.type = ofp_type_1_3::FLOW_MOD;
+    pkt.header.version = version;
+    pkt.header.xid = htonl(parent_->next_xid());
+    pkt.header.length = htons(sizeof(pkt));
 
-std::string from_proto(L3Proto proto)
-{
-    return from_proto(L2Proto::IPv4) + tlv_8(oxm_ofb_match_fields_1_3::IP_PROTO, static_cast<uint8_t>(proto));
-}
+    pkt.command = ofp_flow_mod_command_1_3::DELETE;
+    pkt.out_port = host_to_network_underlying(ofp_port_no_1_3::ANY);
+    pkt.out_group = host_to_network_underlying(ofp_group_no_1_3::ANY);
+    pkt.flags = host_to_network_underlying(ofp_flow_mod_flags_1_3::SEND_FLOW_REM);
+    pkt.table_id = static_cast<uint8_t>(ofp_table_1_3::ALL);
 
-std::string from_hw_src(const tnt::MacAddress& mac)
-{
-    return tlv_mac(oxm_ofb_match_fields_1_3::ETH_SRC, mac);
-}
+    pkt.match.type = host_to_network(ofp_match_type_1_3::OXM);
+    pkt.match.length = htons(sizeof(pkt.match) - 4);
 
-std::string from_hw_dst(const tnt::MacAddress& mac)
-{
-    return tlv_mac(oxm_ofb_match_fields_1_3::ETH_DST, mac);
+    parent_->write(to_mem_buffer(pkt));
 }
 
-std::string from_ip_src(const tnt::ip::Address& ip, int prefix)
+void Openflow_1_3::packet(const std::string& message)
 {
-    return from_proto(L2Proto::IPv4) + tlv_ip(oxm_ofb_match_fields_1_3::IPV4_SRC, ip, prefix);
-}
+    auto pkt = reinterpret_cast<const ofp_header_1_3*>(message.data());
 
-std::string from_ip_dst(const tnt::ip::Address& ip, int prefix)
-{
-    return from_proto(L2Proto::IPv4) + tlv_ip(oxm_ofb_match_fields_1_3::IPV4_DST, ip, prefix);
+    try
+    {
+        message_dispatcher_.inject_object(pkt->type, message);
+    }
+    catch (tnt::ListenerNotFound&)
+    {
+        unmanaged_packet(pkt);
+    }
 }
 
-std::string from_transport_port_src(L3Proto proto, uint16_t port)
+void Openflow_1_3::send_packet(const std::string& /*buffer*/, uint16_t /*port*/)
 {
-    return from_proto(proto) + (proto == L3Proto::Tcp ? tlv_tcp_src(port) : tlv_udp_src(port));
-}
 
-std::string from_transport_port_dst(L3Proto proto, uint16_t port)
-{
-    return from_proto(proto) + (proto == L3Proto::Tcp ? tlv_tcp_dst(port) : tlv_udp_dst(port));
 }
 
-// Actions
-std::string to_port(uint32_t port, uint16_t size = 0)
+void Openflow_1_3::request_port_stats(uint16_t port)
 {
-    auto action = ofp_action_output_1_3();
-    action.type = host_to_network(ofp_action_type_1_3::OUTPUT);
-    action.port = htonl(port);
-    action.len = htons(sizeof(action));
-    action.max_len = size;
-
-    return to_mem_buffer(action);
-}
+    auto request = ofp_port_stats_request_1_3();
+    request.port_no = htonl(port);
 
-std::string to_port(ofp_port_no_1_3 port, uint16_t size = 0)
-{
-    return to_port(static_cast<uint32_t>(port), size);
+    multipart_request(ofp_multipart_type_1_3::PORT_STATS, to_mem_buffer(request));
 }
 
-std::string to_ports(const std::vector<uint32_t>& dst, uint16_t size = 0)
+void Openflow_1_3::request_stats(OpenflowStats what)
 {
-    std::ostringstream os;
-
-    for (auto p : dst)
+    switch (what)
     {
-        os << to_port(p, size);
-    }
-
-    return os.str();
-}
+    case OpenflowStats::Ports:
+    {
+        auto request = ofp_port_stats_request_1_3();
+        request.port_no = host_to_network_underlying(ofp_port_no_1_3::ANY);
 
-std::string to_controller(uint16_t size)
-{
-    return to_port(ofp_port_no_1_3::CONTROLLER, size);
+        multipart_request(ofp_multipart_type_1_3::PORT_STATS, to_mem_buffer(request));
+        break;
+    }
+    case OpenflowStats::Flows:
+        multipart_request(ofp_multipart_type_1_3::FLOW, to_mem_buffer(all_flows()));
+        break;
+    case OpenflowStats::Tables:
+        multipart_request(ofp_multipart_type_1_3::TABLE, std::string());
+        break;
+    case OpenflowStats::Aggregate:
+        // Same layout as ofp_flow_stats_request_1_3.
+        multipart_request(ofp_multipart_type_1_3::AGGREGATE, to_mem_buffer(all_flows()));
+        break;
+    default:
+        break;
+    }
 }
 
-std::string set_hw(oxm_ofb_match_fields_1_3 field, const tnt::MacAddress& mac)
+void Openflow_1_3::multipart_request(ofp_multipart_type_1_3 type, const std::string& body)
 {
-    assert(field == oxm_ofb_match_fields_1_3::ETH_SRC || field == oxm_ofb_match_fields_1_3::ETH_DST);
-
-    auto action = ofp_action_set_field_1_3();
-    action.type = host_to_network(ofp_action_type_1_3::SET_FIELD);
+    auto pkt = ofp_multipart_request_1_3();
 
-    auto tlv = tlv_mac(field, mac);
-
-    std::copy_n(std::begin(tlv), 4, action.field);
-    tlv = tlv.substr(4);
-
-    auto len = sizeof(action) + tlv.size();
-    auto pad_len = get_pad_len(len);
-
-    action.len = htons(len + pad_len);
+    pkt.header.version = version;
+    pkt.header.type = ofp_type_1_3::MULTIPART_REQUEST;
+    pkt.header.length = htons(static_cast<uint16_t>(sizeof(pkt) + body.size()));
+    pkt.header.xid = htonl(parent_->next_xid());
+    pkt.type = host_to_network(type);
 
-    return to_mem_buffer(action) + tlv + create_pad(pad_len);
+    parent_->write(to_mem_buffer(pkt) + body);
 }
 
-std::string set_hw_src(const tnt::MacAddress& mac)
+void Openflow_1_3::features(const std::string& message)
 {
-    return set_hw(oxm_ofb_match_fields_1_3::ETH_SRC, mac);
-}
+    auto pkt = reinterpret_cast<const ofp_switch_features_1_3*>(message.data());
 
-std::string set_hw_dst(const tnt::MacAddress& mac)
-{
-    return set_hw(oxm_ofb_match_fields_1_3::ETH_DST, mac);
+    // TODO: Parse the packet, and get the features and the status of the switch.
+    parent_->set_features(pkt->datapath_id);
 }
 
-std::string set_ip(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip)
+void Openflow_1_3::error(const std::string& message)
 {
-    assert(field == oxm_ofb_match_fields_1_3::IPV4_SRC || field == oxm_ofb_match_fields_1_3::IPV4_DST);
+    auto ptr = message.data();
+    auto pkt = reinterpret_cast<const ofp_error_msg_1_3*>(ptr);
 
-    auto action = ofp_action_set_field_1_3();
-    action.type = host_to_network(ofp_action_type_1_3::SET_FIELD);
+    try
+    {
+        error_dispatcher_.inject_object(network_to_host(pkt->type), pkt, ptr);
+    }
+    catch (tnt::ListenerNotFound&)
+    {
+        tnt::Log::error("Error type (", network_to_host(pkt->type), ") not defined in OF version 1.3");
+    }
 
-    auto tlv = tlv_ip(field, ip);
+    if (message.size() >= sizeof(ofp_error_msg_1_3) + sizeof(ofp_header_1_3))
+    {
+        // The data of the error starts with the header of the failed request.
+        auto request = reinterpret_cast<const ofp_header_1_3*>(ptr + sizeof(ofp_error_msg_1_3));
+        parent_->failed(ntohl(request->xid), ntohs(static_cast<uint16_t>(pkt->type)), ntohs(pkt->code));
+    }
+}
 
-    std::copy_n(std::begin(tlv), 4, action.field);
-    tlv = tlv.substr(4);
+void Openflow_1_3::echo(const std::string& message)
+{
+    auto ptr = message.data();
+    auto request = reinterpret_cast<const ofp_header_1_3*>(ptr);
 
-    auto len = sizeof(action) + tlv.size();
-    auto pad_len = get_pad_len(len);
+    auto reply = ofp_header_1_3();
+    reply.length = request->length;
+    reply.type = ofp_type_1_3::ECHO_REPLY;
+    reply.version = version;
+    reply.xid = request->xid;
 
-    action.len = htons(len + pad_len);
+    auto payload_len = ntohs(request->length) - sizeof(ofp_header_1_3);
 
-    return to_mem_buffer(action) + tlv + create_pad(pad_len);
+    parent_->write(to_mem_buffer(reply) + std::string(ptr + sizeof(ofp_header_1_3), payload_len));
 }
 
-std::string set_ip_src(const tnt::ip::Address& ip)
+void Openflow_1_3::barrier_reply(const std::string& message)
 {
-    return set_ip(oxm_ofb_match_fields_1_3::IPV4_SRC, ip);
-}
+    auto pkt = reinterpret_cast<const ofp_header_1_3*>(message.data());
 
-std::string set_ip_dst(const tnt::ip::Address& ip)
-{
-    return set_ip(oxm_ofb_match_fields_1_3::IPV4_DST, ip);
+    parent_->barrier_reply(ntohl(pkt->xid));
 }
 
-std::string set_vlan(uint16_t tag)
+void Openflow_1_3::port_status(const std::string& /*message*/)
 {
-    auto action = ofp_action_set_field_1_3();
-    action.type = host_to_network(ofp_action_type_1_3::SET_FIELD);
-
-    auto tlv = tlv_vid(tag);
-
-    std::copy_n(std::begin(tlv), 4, action.field);
-    tlv = tlv.substr(4);
-
-    auto len = sizeof(action) + tlv.size();
-    auto pad_len = get_pad_len(len);
-
-    action.len = htons(len + pad_len);
-
-    return to_mem_buffer(action) + tlv + create_pad(pad_len);
+    tnt::Log::info(colors::magenta, "port_status");
 }
 
-/*std::string add_vlan(uint16_t tag)
-{
-    auto action = ofp_action_header_1_3();
-    action.type = host_to_network(ofp_action_type_1_3::POP_VLAN);
-    action.len = htons(sizeof(action));
-
-    return to_mem_buffer(action);
-}*/
-
-std::string strip_vlan()
+void Openflow_1_3::get_config(const std::string& /*message*/)
 {
-    auto action = ofp_action_header_1_3();
-    action.type = host_to_network(ofp_action_type_1_3::SET_FIELD);
-    action.len = htons(sizeof(action));
-
-    return to_mem_buffer(action);
+    tnt::Log::info(colors::magenta, "get_config");
 }
 
-void add_flag(FlowFlag* flag, ofp_flow_mod_1_3& ofp_flow)
+void Openflow_1_3::stats(const std::string& message)
 {
-    if (tnt::visit<Priority>(flag, [&] (auto f) { ofp_flow.priority = f->value(); }))
+    if (message.size() < sizeof(ofp_multipart_reply_1_3))
     {
+        tnt::Log::error("Openflow 1.3: truncated MULTIPART_REPLY.");
         return;
     }
 
-    if (tnt::visit<Buffer>(flag, [&] (auto f) { ofp_flow.buffer_id = f->value(); }))
-    {
-        return;
+    auto pkt = reinterpret_cast<const ofp_multipart_reply_1_3*>(message.data());
+    auto xid = ntohl(pkt->header.xid);
+    auto more = (network_to_host_underlying(pkt->flags) & static_cast<uint16_t>(ofp_multipart_reply_flags_1_3::REPLY_MORE)) != 0;
+
+    auto body = message.data() + sizeof(ofp_multipart_reply_1_3);
+    auto size = message.size() - sizeof(ofp_multipart_reply_1_3);
+
+    // The switch splits the long replies (many flows or ports) in parts with the same xid.
+    std::string reply;
+    auto parts = multipart_.find(xid);
+
+    if (more || parts != std::end(multipart_))
+    {
+        if (parts == std::end(multipart_))
+        {
+            parts = open_multipart(xid);
+        }
+
+        auto& partial = parts->second;
+
+        if (!partial.dropped && partial.body.size() + size > multipart_max_bytes)
+        {
+            tnt::Log::error("Openflow 1.3: MULTIPART_REPLY ", xid, " longer than ", multipart_max_bytes, " bytes, dropped.");
+
+            partial.dropped = true;
+            std::string().swap(partial.body);
+        }
+
+        if (!partial.dropped)
+        {
+            partial.body.append(body, size);
+        }
+
+        if (more)
+        {
+            return;
+        }
+
+        auto dropped = partial.dropped;
+        reply = std::move(partial.body);
+        multipart_.erase(parts);
+
+        if (dropped)
+        {
+            return;
+        }
+
+        body = reply.data();
+        size = reply.size();
+    }
+
+    switch (network_to_host(pkt->type))
+    {
+    case ofp_multipart_type_1_3::PORT_STATS:
+        port_stats(body, size);
+        break;
+    case ofp_multipart_type_1_3::FLOW:
+        flow_stats(body, size);
+        break;
+    case ofp_multipart_type_1_3::TABLE:
+        table_stats(body, size);
+        break;
+    case ofp_multipart_type_1_3::AGGREGATE:
+        aggregate_stats(body, size);
+        break;
+    // Not requested by the controller.
+    case ofp_multipart_type_1_3::DESC:
+    case ofp_multipart_type_1_3::QUEUE:
+    case ofp_multipart_type_1_3::GROUP:
+    case ofp_multipart_type_1_3::GROUP_DESC:
+    case ofp_multipart_type_1_3::GROUP_FEATURES:
+    case ofp_multipart_type_1_3::METER:
+    case ofp_multipart_type_1_3::METER_CONFIG:
+    case ofp_multipart_type_1_3::METER_FEATURES:
+    case ofp_multipart_type_1_3::TABLE_FEATURES:
+    case ofp_multipart_type_1_3::PORT_DESC:
+    case ofp_multipart_type_1_3::EXPERIMENTER:
+    default:
+        tnt::Log::info(colors::magenta, "MULTIPART_REPLY: type #", network_to_host_underlying(pkt->type));
+        break;
     }
+}
 
-    if (tnt::visit<Cookie>(flag, [&] (auto f) { ofp_flow.cookie = f->value(); }))
-    {
-        return;
-    }
+// The replies still incomplete after a stats interval are dropped, their last part is not
+// coming and the next poll asks again. Then the oldest one if too many are still open.
+Openflow_1_3::MultipartReplies::iterator Openflow_1_3::open_multipart(uint32_t xid)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto max_age = parent_->stats_interval();
 
-    if (tnt::visit<IdleTimeout>(flag, [&] (auto f) { ofp_flow.idle_timeout = f->value(); }))
+    for (auto it = std::begin(multipart_); it != std::end(multipart_);)
     {
-        return;
+        if (max_age.count() > 0 && now - it->second.started > max_age)
+        {
+            tnt::Log::warning("Openflow 1.3: MULTIPART_REPLY ", it->first, " not completed in ", max_age.count(), " ms, dropped.");
+            it = multipart_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
 
-    if (tnt::visit<HardTimeout>(flag, [&] (auto f) { ofp_flow.hard_timeout = f->value(); }))
+    if (multipart_.size() >= multipart_max_open)
     {
-        return;
-    }
+        auto oldest = std::min_element(std::begin(multipart_), std::end(multipart_), [] (const auto& a, const auto& b)
+        {
+            return a.second.started < b.second.started;
+        });
 
-    if (tnt::visit<OutPort>(flag, [&] (auto f) { ofp_flow.out_port = f->value(); }))
-    {
-        return;
+        tnt::Log::warning("Openflow 1.3: more than ", multipart_max_open, " MULTIPART_REPLY in parts, ", oldest->first, " dropped.");
+        multipart_.erase(oldest);
     }
 
-    if (tnt::visit<Flags>(flag, [&] (auto f) { ofp_flow.flags = f->value(); }))
-    {
-        return;
-    }
+    return multipart_.emplace(xid, MultipartReply{ std::string(), now, false }).first;
 }
 
-void add_flags(const Flow& flow, ofp_flow_mod_1_3& ofp_flow)
+void Openflow_1_3::port_stats(const char* body, size_t size)
 {
-    for (const auto& f : flow.flags())
-    {
-        add_flag(f.get(), ofp_flow);
-    }
-}
+    std::vector<event::PortRate> rates;
+    rates.reserve(size / sizeof(ofp_port_stats_1_3));
 
-void add_filter(FlowFilter* filter, std::ostringstream& os)
-{
-    if (tnt::visit<FromPort>(filter, [&] (auto f) { os << from_port(f->port()); }))
+    for (auto end = body + size; body + sizeof(ofp_port_stats_1_3) <= end; body += sizeof(ofp_port_stats_1_3))
     {
-        return;
-    }
+        auto stats = reinterpret_cast<const ofp_port_stats_1_3*>(body);
+        auto port_no = ntohl(stats->port_no);
 
-    if (tnt::visit<FromVlan>(filter, [&] (auto f) { os << from_vlan(f->tag()); }))
-    {
-        return;
-    }
+        CounterRates<5>::Counters counters = {{ ntohll(stats->rx_bytes), ntohll(stats->tx_bytes), ntohll(stats->rx_packets), ntohll(stats->tx_packets), ntohll(stats->rx_dropped) + ntohll(stats->tx_dropped) }};
+        CounterRates<5>::Rates r;
 
-    if (tnt::visit<FromL2Proto>(filter, [&] (auto f) { os << from_proto(f->proto()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromL3Proto>(filter, [&] (auto f) { os << from_proto(f->proto()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromHwSrc>(filter, [&] (auto f) { os << from_hw_src(f->mac()); }))
-    {
-        return;
+        if (port_rates_.update(port_no, sample_time(stats->duration_sec, stats->duration_nsec), counters, r))
+        {
+            rates.push_back(event::PortRate{ port_no, r[0] * 8, r[1] * 8, r[2], r[3], r[4] });
+        }
     }
-       
-    if (tnt::visit<FromHwDst>(filter, [&] (auto f) { os << from_hw_dst(f->mac()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromIpSrc>(filter, [&] (auto f) { os << from_ip_src(f->ip(), f->prefix()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromIpDst>(filter, [&] (auto f) { os << from_ip_dst(f->ip(), f->prefix()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromTransportPortSrc>(filter, [&] (auto f) { os << from_transport_port_src(f->proto(), f->port()); }))
-    {
-        return;
-    }
-       
-    if (tnt::visit<FromTransportPortDst>(filter, [&] (auto f) { os << from_transport_port_dst(f->proto(), f->port()); }))
-    {
-        return;
-    }
-}
 
-std::string get_filters(const Flow& flow)
-{
-    std::ostringstream os;
-
-    for (const auto& f : flow.filters())
+    // Not swept: a reply can be for a single port, and the ports of a switch are few.
+    if (!rates.empty())
     {
-        add_filter(f.get(), os);
+        tnt::Application::raise(event::PortRates(parent_, std::move(rates)));
     }
-
-    return os.str();
 }
 
-void get_action(FlowAction* action, std::ostringstream& os)
+void Openflow_1_3::flow_stats(const char* body, size_t size)
 {
-    if (tnt::visit<ToController>(action, [&] (auto a) { os << to_controller(a->size()); }))
-    {
-        return;
-    }
+    std::vector<event::FlowRate> rates;
+    rates.reserve(flow_rates_.size());
 
-    if (tnt::visit<ToPorts>(action, [&] (auto a)
+    for (auto end = body + size; body + sizeof(ofp_flow_stats_1_3) <= end;)
     {
-        std::vector<uint32_t> ports;
-        std::copy(std::begin(a->ports()), std::end(a->ports()), std::back_inserter(ports));
-
-        os << to_ports(ports);
-    }))
-    {
-        return;
-    }
-
-    if (tnt::visit<Loop>(action, [&] (auto /*a*/) { os << to_port(ofp_port_no_1_3::IN_PORT); }))
-    {
-        return;
-    }
+        auto stats = reinterpret_cast<const ofp_flow_stats_1_3*>(body);
+        auto length = ntohs(stats->length);
 
-    if (tnt::visit<Flood>(action, [&] (auto /*a*/) { os << to_port(ofp_port_no_1_3::FLOOD); }))
-    {
-        return;
-    }
+        if (length < sizeof(ofp_flow_stats_1_3) || body + length > end)
+        {
+            tnt::Log::error("Openflow 1.3: malformed flow stats entry.");
+            break;
+        }
 
-    if (tnt::visit<SetHwSrc>(action, [&] (auto a) { os << set_hw_src(a->mac()); }))
-    {
-        return;
-    }
+        auto match_len = std::min<size_t>(ntohs(stats->match.length), length - offsetof(ofp_flow_stats_1_3, match));
+        auto id = flow_id(stats, match_len);
 
-    if (tnt::visit<SetHwDst>(action, [&] (auto a) { os << set_hw_dst(a->mac()); }))
-    {
-        return;
-    }
+        CounterRates<2>::Counters counters = {{ ntohll(stats->packet_count), ntohll(stats->byte_count) }};
+        CounterRates<2>::Rates r;
 
-    if (tnt::visit<SetIpSrc>(action, [&] (auto a) { os << set_ip_src(a->ip()); }))
-    {
-        return;
-    }
+        if (flow_rates_.update(id, sample_time(stats->duration_sec, stats->duration_nsec), counters, r))
+        {
+            rates.push_back(event::FlowRate{ id, stats->table_id, ntohs(stats->priority), r[0], r[1] * 8 });
+        }
 
-    if (tnt::visit<SetIpDst>(action, [&] (auto a) { os << set_ip_dst(a->ip()); }))
-    {
-        return;
+        body += length;
     }
 
-    if (tnt::visit<SetVlan>(action, [&] (auto a) { os << set_vlan(a->tag()); }))
-    {
-        return;
-    }
+    flow_rates_.sweep(); // The flow requests are always for all the flows.
 
-    if (tnt::is<StripVlan>(action))
+    if (!rates.empty())
     {
-        os << strip_vlan();
-
-        return;
+        tnt::Application::raise(event::FlowRates(parent_, std::move(rates)));
     }
-
-    tnt::Log::error("Unsupported Action");
 }
 
-std::string get_actions(const Flow& flow)
+void Openflow_1_3::table_stats(const char* body, size_t size)
 {
-    std::ostringstream os;
+    std::vector<event::TableCounters> tables;
+    tables.reserve(size / sizeof(ofp_table_stats_1_3));
 
-    for (const auto& f : flow.actions())
+    for (auto end = body + size; body + sizeof(ofp_table_stats_1_3) <= end; body += sizeof(ofp_table_stats_1_3))
     {
-        get_action(f.get(), os);
-    }
-
-    return os.str();
-}
+        auto stats = reinterpret_cast<const ofp_table_stats_1_3*>(body);
 
-std::string get_flow(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_3 command)
-{
-    auto ofp_flow = ofp_flow_mod_1_3();
-    
-    ofp_flow.header.type = ofp_type_1_3::FLOW_MOD;
-    ofp_flow.header.version = version;
-    ofp_flow.header.xid = htonl(xid);
-    
-    ofp_flow.command = host_to_network(command);
-    ofp_flow.buffer_id = htonl(OFP_NO_BUFFER);
-    ofp_flow.out_port = host_to_network_underlying(ofp_port_no_1_3::ANY);
-    ofp_flow.flags = host_to_network_underlying(ofp_flow_mod_flags_1_3::SEND_FLOW_REM);
-    ofp_flow.priority = htons(OFP_DEFAULT_PRIORITY);
-    
-    add_flags(flow, ofp_flow);
-
-    auto filters = get_filters(flow);
-    auto instructions = ofp_instruction_actions_1_3();
-    instructions.type = host_to_network(ofp_instruction_type_1_3::APPLY_ACTIONS);
-
-    auto actions = get_actions(flow);
-    auto len = sizeof(ofp_flow.match) + filters.size() - 4; // Subtract 4 bytes because the first filter is copied in the last 4 bytes of the ofp_match_1_3 structure
-
-    ofp_flow.match.type = host_to_network(ofp_match_type_1_3::OXM);
-    ofp_flow.match.length = htons(len);
-
-    std::copy_n(std::begin(filters), 4, ofp_flow.match.oxm_fields);
-    filters = filters.substr(4);
-
-    instructions.len = htons(sizeof(instructions) + actions.size());
-
-    auto pad_len = get_pad_len(len);
-
-    ofp_flow.header.length = htons(sizeof(ofp_flow_mod_1_3) + filters.size() + pad_len + sizeof(ofp_instruction_actions_1_3) + actions.size());
-
-    return to_mem_buffer(ofp_flow) + filters + create_pad(pad_len) + to_mem_buffer(instructions) + actions;
-}
-
-} // namespace
-
-Openflow_1_3::Openflow_1_3(Openflow* parent): parent_(parent)
-{
-    assert(parent_);
-    register_handlers();
-}
-
-void Openflow_1_3::init()
-{
-    auto packet = ofp_header_1_3();
-    packet.version = version;
-    packet.type = ofp_type_1_3::FEATURES_REQUEST;
-    packet.length = htons(sizeof(packet));
-    packet.xid = htonl(create_xid());
-
-    parent_->write(to_mem_buffer(packet));
-
-    std::this_thread::sleep_for(50ms); // Needed to avoid the packets to be sent in the same tcp packet.
-
-    auto sw_config = ofp_switch_config_1_3();
-
-    sw_config.header.version = version;
-    sw_config.header.type = ofp_type_1_3::SET_CONFIG;
-    sw_config.header.length = htons(sizeof(sw_config));
-    sw_config.header.xid = htonl(create_xid());
-    sw_config.flags = ofp_config_flags::FRAG_NORMAL;
-    sw_config.miss_send_len = 0x0080;
-
-    parent_->write(to_mem_buffer(sw_config));
-}
-
-void Openflow_1_3::add(const Flow& flow)
-{
-    auto xid = create_xid();
-    parent_->write(get_flow(flow, xid, ofp_flow_mod_command_1_3::ADD));
-}
-
-void Openflow_1_3::remove(const Flow& flow)
-{
-    auto xid = create_xid();
-    parent_->write(get_flow(flow, xid, ofp_flow_mod_command_1_3::DELETE));
-}
-
-void Openflow_1_3::remove_all()
-{
-    auto pkt = ofp_flow_mod_1_3();
-
-    pkt.header.type = ofp_type_1_3::FLOW_MOD;
-    pkt.header.version = version;
-    pkt.header.xid = htonl(create_xid());
-    pkt.header.length = htons(sizeof(pkt));
-
-    pkt.command = ofp_flow_mod_command_1_3::DELETE;
-    pkt.out_port = host_to_network_underlying(ofp_port_no_1_3::ANY);
-    pkt.out_group = host_to_network_underlying(ofp_group_no_1_3::ANY);
-    pkt.flags = host_to_network_underlying(ofp_flow_mod_flags_1_3::SEND_FLOW_REM);
-    pkt.table_id = static_cast<uint8_t>(ofp_table_1_3::ALL);
-
-    pkt.match.type = host_to_network(ofp_match_type_1_3::OXM);
-    pkt.match.length = htons(sizeof(pkt.match) - 4);
+        tables.push_back(event::TableCounters{ stats->table_id, ntohl(stats->active_count), ntohll(stats->lookup_count), ntohll(stats->matched_count) });
+    }
 
-    parent_->write(to_mem_buffer(pkt));
+    tnt::Application::raise(event::TableStats(parent_, std::move(tables)));
 }
 
-void Openflow_1_3::packet(const std::string& message)
+void Openflow_1_3::aggregate_stats(const char* body, size_t size)
 {
-    auto pkt = reinterpret_cast<const ofp_header_1_3*>(message.data());
-
-    try
+    if (size < sizeof(ofp_aggregate_stats_reply_1_3))
     {
-        message_dispatcher_.inject_object(pkt->type, message);
-    }
-    catch (tnt::ListenerNotFound&)
-    {
-        unmanaged_packet(pkt);
+        tnt::Log::error("Openflow 1.3: truncated aggregate stats reply.");
+        return;
     }
-}
-
-void Openflow_1_3::send_packet(const std::string& /*buffer*/, uint16_t /*port*/)
-{
-
-}
 
-void Openflow_1_3::request_port_stats(uint16_t /*port*/)
-{
+    auto stats = reinterpret_cast<const ofp_aggregate_stats_reply_1_3*>(body);
 
+    tnt::Application::raise(event::AggregateStats(parent_, ntohll(stats->packet_count), ntohll(stats->byte_count), ntohl(stats->flow_count)));
 }
 
-void Openflow_1_3::features(const std::string& message)
+void Openflow_1_3::flow_removed(const std::string& /*message*/)
 {
-    auto pkt = reinterpret_cast<const ofp_switch_features_1_3*>(message.data());
-
-    // TODO: Parse the packet, and get the features and the status of the switch.
-    parent_->set_features(pkt->datapath_id);
+    tnt::Log::info(colors::magenta, "flow_removed");
 }
 
-void Openflow_1_3::error(const std::string& message)
+void Openflow_1_3::packet_in(const std::string& message)
 {
-    auto ptr = message.data();
-    auto pkt = reinterpret_cast<const ofp_error_msg_1_3*>(ptr);
+    const auto match_offset = offsetof(ofp_packet_in_1_3, match);
 
-    try
-    {
-        error_dispatcher_.inject_object(network_to_host(pkt->type), pkt, ptr);
-    }
-    catch (tnt::ListenerNotFound&)
+    if (message.size() < sizeof(ofp_packet_in_1_3))
     {
-        tnt::Log::error("Error type (", network_to_host(pkt->type), ") not defined in OF version 1.3");
+        tnt::Log::error("Openflow_1_3: short PACKET_IN (", message.size(), " bytes).");
+
+        return;
     }
-}
 
-void Openflow_1_3::echo(const std::string& message)
-{
-    auto ptr = message.data();
-    auto request = reinterpret_cast<const ofp_header_1_3*>(ptr);
+    auto pkt = reinterpret_cast<const ofp_packet_in_1_3*>(message.data());
+    auto match_len = static_cast<size_t>(ntohs(pkt->match.length));
 
-    auto reply = ofp_header_1_3();
-    reply.length = request->length;
-    reply.type = ofp_type_1_3::ECHO_REPLY;
-    reply.version = version;
-    reply.xid = request->xid;
+    // The frame follows the padded match and 2 bytes of padding.
+    auto frame_offset = match_offset + padded_size_1_3(match_len) + 2;
 
-    auto payload_len = ntohs(request->length) - sizeof(ofp_header_1_3);
+    if (match_len < offsetof(ofp_match_1_3, oxm_fields) || frame_offset > message.size())
+    {
+        tnt::Log::error("Openflow_1_3: bad match in PACKET_IN.");
 
-    parent_->write(to_mem_buffer(reply) + std::string(ptr + sizeof(ofp_header_1_3), payload_len));
-}
+        return;
+    }
 
-void Openflow_1_3::port_status(const std::string& /*message*/)
-{
-    tnt::Log::info(colors::magenta, "port_status");
-}
+    uint16_t in_port = 0;
+    auto oxm = message.data() + match_offset + offsetof(ofp_match_1_3, oxm_fields);
+    auto end = message.data() + match_offset + match_len;
 
-void Openflow_1_3::get_config(const std::string& /*message*/)
-{
-    tnt::Log::info(colors::magenta, "get_config");
-}
+    while (oxm + sizeof(uint32_t) <= end)
+    {
+        uint32_t header;
+        std::memcpy(&header, oxm, sizeof(header));
+        header = ntohl(header);
 
-void Openflow_1_3::stats(const std::string& /*message*/)
-{
-    tnt::Log::info(colors::magenta, "stats");
-}
+        auto len = header & 0xff;
 
-void Openflow_1_3::flow_removed(const std::string& /*message*/)
-{
-    tnt::Log::info(colors::magenta, "flow_removed");
-}
+        if (header >> 16 == static_cast<uint16_t>(ofp_oxm_class_1_3::OPENFLOW_BASIC) &&
+            ((header >> 9) & 0x7f) == static_cast<uint8_t>(oxm_ofb_match_fields_1_3::IN_PORT) && len == sizeof(uint32_t))
+        {
+            uint32_t port;
+            std::memcpy(&port, oxm + sizeof(header), sizeof(port));
+            in_port = static_cast<uint16_t>(ntohl(port));
+        }
 
-void Openflow_1_3::packet_in(const std::string& /*message*/)
-{
+        oxm += sizeof(header) + len;
+    }
 
+    parent_->packet_in(ntohl(pkt->buffer_id), in_port, message.data() + frame_offset, message.size() - frame_offset);
 }
 
 void Openflow_1_3::unmanaged_packet(const ofp_header_1_3* /*pkt*/)
@@ -1032,11 +890,12 @@ void Openflow_1_3::register_handlers()
     message_dispatcher_.register_listener(ofp_type_1_3::FEATURES_REPLY,    [this] (const std::string& message) { features(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::ERROR,             [this] (const std::string& message) { error(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::ECHO_REQUEST,      [this] (const std::string& message) { echo(message); });
+    message_dispatcher_.register_listener(ofp_type_1_3::BARRIER_REPLY,     [this] (const std::string& message) { barrier_reply(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::PACKET_IN,         [this] (const std::string& message) { packet_in(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::GET_CONFIG_REPLY,  [this] (const std::string& message) { get_config(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::FLOW_REMOVED,      [this] (const std::string& message) { flow_removed(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::PORT_STATUS,       [this] (const std::string& message) { port_status(message); });
-    //message_dispatcher_.register_listener(ofp_type_1_3::STATS_REPLY,       [this] (const std::string& message) { stats(message); });
+    message_dispatcher_.register_listener(ofp_type_1_3::MULTIPART_REPLY,   [this] (const std::string& message) { stats(message); });
 
     error_dispatcher_.register_listener(ofp_error_type_1_3::HELLO_FAILED,     [this] (const ofp_error_msg_1_3* pkt, const std::string& message) { error_hello_failed(pkt, message); });
     error_dispatcher_.register_listener(ofp_error_type_1_3::BAD_REQUEST,      [this] (const ofp_error_msg_1_3* pkt, const std::string& message) { error_bad_request(pkt, message); });
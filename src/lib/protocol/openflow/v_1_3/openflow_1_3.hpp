@@ -28,8 +28,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DROP_PROTOCOL_OPENFLOW_1_3_HPP_
 #define DROP_PROTOCOL_OPENFLOW_1_3_HPP_
 
+#include <unordered_map>
+#include <string>
+#include <chrono>
+
 #include "protocol/openflow/openflow_version.hpp"
 #include "protocol/openflow/v_1_3/values.hpp"
+#include "protocol/openflow/message_buffer.hpp"
+#include "protocol/openflow/counter_rates.hpp"
 
 #include "dispatch.hpp"
 
@@ -74,32 +80,51 @@ struct ofp_error_msg_1_3;
 
 class Openflow_1_3: public RegisterOpenflowVersion<Openflow_1_3, 0x4>
 {
+    // A reply with more parts to come.
+    struct MultipartReply
+    {
+        std::string body;
+        std::chrono::steady_clock::time_point started;
+        bool dropped; // Too long, its remaining parts are skipped.
+    };
+
+    using MultipartReplies = std::unordered_map<uint32_t, MultipartReply>;
 public:
     explicit Openflow_1_3(Openflow* parent);
 
     virtual void init() override;
     virtual void remove_all() override;
 
-    virtual void add(const Flow& flow) override;
-    virtual void remove(const Flow& flow) override;
+    virtual void add(const Flow& flow, uint32_t xid) override;
+    virtual void remove(const Flow& flow, uint32_t xid) override;
+    virtual void barrier(uint32_t xid) override;
 
     virtual void packet(const std::string& message) override;
 
     virtual void send_packet(const std::string& buffer, uint16_t port) override;
 
     virtual void request_port_stats(uint16_t port) override;
+    virtual void request_stats(OpenflowStats what) override;
 private:
     void features(const std::string& message);
     void error(const std::string& message);
     void echo(const std::string& message);
+    void barrier_reply(const std::string& message);
     void port_status(const std::string& message);
     void get_config(const std::string& message);
     void stats(const std::string& message);
+    MultipartReplies::iterator open_multipart(uint32_t xid);
+    void port_stats(const char* body, size_t size);
+    void flow_stats(const char* body, size_t size);
+    void table_stats(const char* body, size_t size);
+    void aggregate_stats(const char* body, size_t size);
     void flow_removed(const std::string& message);
     void packet_in(const std::string& message);
 
     void unmanaged_packet(const ofp_header_1_3* pkt);
 
+    void multipart_request(ofp_multipart_type_1_3 type, const std::string& body);
+
     void error_hello_failed(const ofp_error_msg_1_3* pkt, const std::string& message);
     void error_bad_request(const ofp_error_msg_1_3* pkt, const std::string& message);
     void error_bad_action(const ofp_error_msg_1_3* pkt, const std::string& message);
@@ -120,6 +145,13 @@ private:
 private:
     Openflow* parent_;
 
+    MessageBuffer flow_mod_; // Reused by add() and remove(), only called by the tx loop.
+
+    // Used by the rx loop only.
+    MultipartReplies multipart_; // By xid.
+    CounterRates<5> port_rates_; // Rx, tx bytes and packets, dropped packets.
+    CounterRates<2> flow_rates_; // Packets, bytes.
+
     tnt::KeyDispatch<ofp_type_1_3, void, const std::string&> message_dispatcher_;
     tnt::KeyDispatch<ofp_error_type_1_3, void, const ofp_error_msg_1_3*, const std::string&> error_dispatcher_;
 };
@@ -249,6 +249,15 @@ struct ofp_aggregate_stats_request_1_3
 	ofp_match_1_3 match; //Fields to match. Variable size.
 };
 
+// Body of reply to OFPMP_AGGREGATE request.
+struct ofp_aggregate_stats_reply_1_3
+{
+	uint64_t packet_count; // Number of packets in flows.
+	uint64_t byte_count; // Number of bytes in flows.
+	uint32_t flow_count; // Number of flows.
+	uint8_t pad[4]; // Align to 64 bits.
+};
+
 //Body of reply to OFPMP_TABLE request.
 struct ofp_table_stats_1_3
 {
@@ -259,6 +268,14 @@ struct ofp_table_stats_1_3
 	uint64_t matched_count;  // Number of packets that hit table.
 };
 
+// Body for ofp_multipart_request of type OFPMP_PORT.
+struct ofp_port_stats_request_1_3
+{
+	uint32_t port_no; // OFPMP_PORT message must request statistics
+					  // either for a single port (specified in port_no) or for all ports (if port_no == OFPP_ANY).
+	uint8_t pad[4];
+};
+
 struct ofp_port_stats_1_3
 {
 	uint32_t port_no;
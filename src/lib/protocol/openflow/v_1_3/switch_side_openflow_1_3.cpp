@@ -28,22 +28,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //#include "openflow_1_3.hpp"
 #include "switch_side_openflow_1_3.hpp"
 
+#include <cassert>
 #include <cstring>
 
 #include "protocol/openflow/v_1_3/switch_side_structs.hpp"
 #include "protocol/openflow/v_1_3/switch_side_values.hpp"
 #include "protocol/openflow/utils.hpp"
-#include "protocol/openflow/openflow.hpp"
+#include "protocol/openflow/values.hpp"
 #include "protocol/openflow/flow.hpp"
-#include "protocol/openflow/flow_flags.hpp"
-#include "protocol/openflow/flow_filters.hpp"
-#include "protocol/openflow/flow_actions.hpp"
 
 #include "util/random.hpp"
 
-#include "dynamic_pointer_visitor.hpp"
-#include "mac_address.hpp"
-#include "ip_address.hpp"
 #include "endianness.hpp"
 #include "log.hpp"
 #include "dump.hpp"
@@ -111,37 +106,36 @@ std::string tlv_32(oxm_ofb_match_fields_1_3 field, uint32_t value)
     return to_mem_buffer(oxm_basic_header(field, false, len), value);
 }
 
-std::string tlv_ip_mask(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip, int prefix)
+std::string tlv_ip_mask(oxm_ofb_match_fields_1_3 field, uint32_t ip, int prefix)
 {
-    uint32_t value = ip.to_net_order_ulong();
+    uint32_t value = ip;
     uint32_t mask = htonl(std::numeric_limits<uint32_t>::max() << (32 - prefix));
     uint8_t len = sizeof(value) + sizeof(mask);
 
     return to_mem_buffer(oxm_basic_header(field, true, len), value, mask);
 }
 
-std::string tlv_ip(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip)
+std::string tlv_ip(oxm_ofb_match_fields_1_3 field, uint32_t ip)
 {
-    uint32_t value = ip.to_net_order_ulong();
+    uint32_t value = ip;
     uint8_t len = sizeof(value);
 
     return to_mem_buffer(oxm_basic_header(field, false, len), value);
 }
 
-std::string tlv_ip(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip, int prefix)
+std::string tlv_ip(oxm_ofb_match_fields_1_3 field, uint32_t ip, int prefix)
 {
     return prefix == 32 ? tlv_ip(field, ip): tlv_ip_mask(field, ip, prefix);
 }
 
-std::string tlv_mac(oxm_ofb_match_fields_1_3 field, const tnt::MacAddress& value)
+std::string tlv_mac(oxm_ofb_match_fields_1_3 field, const std::array<uint8_t, 6>& value)
 {
     assert(field == oxm_ofb_match_fields_1_3::ETH_SRC || field == oxm_ofb_match_fields_1_3::ETH_DST);
 
     uint32_t val0 = 0;
     uint16_t val1 = 0;
-    auto str = value.raw();
-    std::memcpy(&val0, str.data(), 4);
-    std::memcpy(&val1, str.data() + 4, 2);
+    std::memcpy(&val0, value.data(), 4);
+    std::memcpy(&val1, value.data() + 4, 2);
 
     uint8_t len = sizeof(val0) + sizeof(val1);
 
@@ -173,57 +167,6 @@ std::string tlv_vid(uint16_t tag)
     return tlv_16(oxm_ofb_match_fields_1_3::VLAN_VID, tag | ofp_vlan_id_1_3::PRESENT);
 }
 
-// Filters
-std::string from_port(uint16_t src)
-{
-    return tlv_32(oxm_ofb_match_fields_1_3::IN_PORT, static_cast<uint32_t>(src));
-}
-
-std::string from_vlan(uint16_t tag)
-{
-    return tlv_vid(tag);
-}
-
-std::string from_proto(L2Proto proto)
-{
-    return tlv_16(oxm_ofb_match_fields_1_3::ETH_TYPE, static_cast<uint16_t>(proto));
-}
-
-std::string from_proto(L3Proto proto)
-{
-    return from_proto(L2Proto::IPv4) + tlv_8(oxm_ofb_match_fields_1_3::IP_PROTO, static_cast<uint8_t>(proto));
-}
-
-std::string from_hw_src(const tnt::MacAddress& mac)
-{
-    return tlv_mac(oxm_ofb_match_fields_1_3::ETH_SRC, mac);
-}
-
-std::string from_hw_dst(const tnt::MacAddress& mac)
-{
-    return tlv_mac(oxm_ofb_match_fields_1_3::ETH_DST, mac);
-}
-
-std::string from_ip_src(const tnt::ip::Address& ip, int prefix)
-{
-    return from_proto(L2Proto::IPv4) + tlv_ip(oxm_ofb_match_fields_1_3::IPV4_SRC, ip, prefix);
-}
-
-std::string from_ip_dst(const tnt::ip::Address& ip, int prefix)
-{
-    return from_proto(L2Proto::IPv4) + tlv_ip(oxm_ofb_match_fields_1_3::IPV4_DST, ip, prefix);
-}
-
-std::string from_transport_port_src(L3Proto proto, uint16_t port)
-{
-    return from_proto(proto) + (proto == L3Proto::Tcp ? tlv_tcp_src(port) : tlv_udp_src(port));
-}
-
-std::string from_transport_port_dst(L3Proto proto, uint16_t port)
-{
-    return from_proto(proto) + (proto == L3Proto::Tcp ? tlv_tcp_dst(port) : tlv_udp_dst(port));
-}
-
 // Actions
 std::string to_port(uint32_t port, uint16_t size = 0)
 {
@@ -241,24 +184,12 @@ std::string to_port(ofp_port_no_1_3 port, uint16_t size = 0)
     return to_port(static_cast<uint32_t>(port), size);
 }
 
-std::string to_ports(const std::vector<uint32_t>& dst, uint16_t size = 0)
-{
-    std::ostringstream os;
-
-    for (auto p : dst)
-    {
-        os << to_port(p, size);
-    }
-
-    return os.str();
-}
-
 std::string to_controller(uint16_t size)
 {
     return to_port(ofp_port_no_1_3::CONTROLLER, size);
 }
 
-std::string set_hw(oxm_ofb_match_fields_1_3 field, const tnt::MacAddress& mac)
+std::string set_hw(oxm_ofb_match_fields_1_3 field, const std::array<uint8_t, 6>& mac)
 {
     assert(field == oxm_ofb_match_fields_1_3::ETH_SRC || field == oxm_ofb_match_fields_1_3::ETH_DST);
 
@@ -278,17 +209,7 @@ std::string set_hw(oxm_ofb_match_fields_1_3 field, const tnt::MacAddress& mac)
     return to_mem_buffer(action) + tlv + create_pad(pad_len);
 }
 
-std::string set_hw_src(const tnt::MacAddress& mac)
-{
-    return set_hw(oxm_ofb_match_fields_1_3::ETH_SRC, mac);
-}
-
-std::string set_hw_dst(const tnt::MacAddress& mac)
-{
-    return set_hw(oxm_ofb_match_fields_1_3::ETH_DST, mac);
-}
-
-std::string set_ip(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip)
+std::string set_ip(oxm_ofb_match_fields_1_3 field, uint32_t ip)
 {
     assert(field == oxm_ofb_match_fields_1_3::IPV4_SRC || field == oxm_ofb_match_fields_1_3::IPV4_DST);
 
@@ -308,16 +229,6 @@ std::string set_ip(oxm_ofb_match_fields_1_3 field, const tnt::ip::Address& ip)
     return to_mem_buffer(action) + tlv + create_pad(pad_len);
 }
 
-std::string set_ip_src(const tnt::ip::Address& ip)
-{
-    return set_ip(oxm_ofb_match_fields_1_3::IPV4_SRC, ip);
-}
-
-std::string set_ip_dst(const tnt::ip::Address& ip)
-{
-    return set_ip(oxm_ofb_match_fields_1_3::IPV4_DST, ip);
-}
-
 std::string set_vlan(uint16_t tag)
 {
     auto action = ofp_action_set_field_1_3();
@@ -354,187 +265,159 @@ std::string strip_vlan()
     return to_mem_buffer(action);
 }
 
-void add_flag(FlowFlag* flag, ofp_flow_mod_1_3& ofp_flow)
+void add_flags(const FlowFlags& flags, ofp_flow_mod_1_3& ofp_flow)
 {
-    if (tnt::visit<Priority>(flag, [&] (auto f) { ofp_flow.priority = f->value(); }))
+    if (flags.has(FlowFlags::Priority))
     {
-        return;
+        ofp_flow.priority = htons(flags.priority);
     }
 
-    if (tnt::visit<Buffer>(flag, [&] (auto f) { ofp_flow.buffer_id = f->value(); }))
+    if (flags.has(FlowFlags::Buffer))
     {
-        return;
+        ofp_flow.buffer_id = htonl(flags.buffer);
     }
 
-    if (tnt::visit<Cookie>(flag, [&] (auto f) { ofp_flow.cookie = f->value(); }))
+    if (flags.has(FlowFlags::Cookie))
     {
-        return;
+        ofp_flow.cookie = htonll(flags.cookie);
     }
 
-    if (tnt::visit<IdleTimeout>(flag, [&] (auto f) { ofp_flow.idle_timeout = f->value(); }))
+    if (flags.has(FlowFlags::IdleTimeout))
     {
-        return;
+        ofp_flow.idle_timeout = htons(flags.idle_timeout);
     }
 
-    if (tnt::visit<HardTimeout>(flag, [&] (auto f) { ofp_flow.hard_timeout = f->value(); }))
+    if (flags.has(FlowFlags::HardTimeout))
     {
-        return;
+        ofp_flow.hard_timeout = htons(flags.hard_timeout);
     }
 
-    if (tnt::visit<OutPort>(flag, [&] (auto f) { ofp_flow.out_port = f->value(); }))
+    if (flags.has(FlowFlags::OutPort))
     {
-        return;
+        ofp_flow.out_port = htonl(static_cast<uint32_t>(flags.out_port));
     }
 
-    if (tnt::visit<Flags>(flag, [&] (auto f) { ofp_flow.flags = f->value(); }))
+    if (flags.has(FlowFlags::Flags))
     {
-        return;
+        ofp_flow.flags = htons(flags.flags);
     }
 }
 
-void add_flags(const Flow& flow, ofp_flow_mod_1_3& ofp_flow)
+std::string get_filters(const FlowMatch& match)
 {
-    for (const auto& f : flow.flags())
-    {
-        add_flag(f.get(), ofp_flow);
-    }
-}
+    using F = oxm_ofb_match_fields_1_3;
 
-void add_filter(FlowFilter* filter, std::ostringstream& os)
-{
-    if (tnt::visit<FromPort>(filter, [&] (auto f) { os << from_port(f->port()); }))
-    {
-        return;
-    }
+    const auto tcp = match.ip_proto == L3Proto::Tcp;
+
+    std::ostringstream os;
 
-    if (tnt::visit<FromVlan>(filter, [&] (auto f) { os << from_vlan(f->tag()); }))
+    if (match.has(FlowMatch::InPort))
     {
-        return;
+        os << tlv_32(F::IN_PORT, static_cast<uint32_t>(match.in_port));
     }
 
-    if (tnt::visit<FromL2Proto>(filter, [&] (auto f) { os << from_proto(f->proto()); }))
+    if (match.has(FlowMatch::Vlan))
     {
-        return;
+        os << tlv_vid(match.vlan);
     }
-       
-    if (tnt::visit<FromL3Proto>(filter, [&] (auto f) { os << from_proto(f->proto()); }))
+
+    if (match.has(FlowMatch::EthType))
     {
-        return;
+        os << tlv_16(F::ETH_TYPE, static_cast<uint16_t>(match.eth_type));
     }
-       
-    if (tnt::visit<FromHwSrc>(filter, [&] (auto f) { os << from_hw_src(f->mac()); }))
+
+    if (match.has(FlowMatch::IpProto))
     {
-        return;
+        os << tlv_8(F::IP_PROTO, static_cast<uint8_t>(match.ip_proto));
     }
-       
-    if (tnt::visit<FromHwDst>(filter, [&] (auto f) { os << from_hw_dst(f->mac()); }))
+
+    if (match.has(FlowMatch::HwSrc))
     {
-        return;
+        os << tlv_mac(F::ETH_SRC, match.hw_src);
     }
-       
-    if (tnt::visit<FromIpSrc>(filter, [&] (auto f) { os << from_ip_src(f->ip(), f->prefix()); }))
+
+    if (match.has(FlowMatch::HwDst))
     {
-        return;
+        os << tlv_mac(F::ETH_DST, match.hw_dst);
     }
-       
-    if (tnt::visit<FromIpDst>(filter, [&] (auto f) { os << from_ip_dst(f->ip(), f->prefix()); }))
+
+    if (match.has(FlowMatch::IpSrc))
     {
-        return;
+        os << tlv_ip(F::IPV4_SRC, match.ip_src, match.ip_src_prefix);
     }
-       
-    if (tnt::visit<FromTransportPortSrc>(filter, [&] (auto f) { os << from_transport_port_src(f->proto(), f->port()); }))
+
+    if (match.has(FlowMatch::IpDst))
     {
-        return;
+        os << tlv_ip(F::IPV4_DST, match.ip_dst, match.ip_dst_prefix);
     }
-       
-    if (tnt::visit<FromTransportPortDst>(filter, [&] (auto f) { os << from_transport_port_dst(f->proto(), f->port()); }))
+
+    if (match.has(FlowMatch::TpSrc))
     {
-        return;
+        os << (tcp ? tlv_tcp_src(match.tp_src) : tlv_udp_src(match.tp_src));
     }
-}
 
-std::string get_filters(const Flow& flow)
-{
-    std::ostringstream os;
-
-    for (const auto& f : flow.filters())
+    if (match.has(FlowMatch::TpDst))
     {
-        add_filter(f.get(), os);
+        os << (tcp ? tlv_tcp_dst(match.tp_dst) : tlv_udp_dst(match.tp_dst));
     }
 
     return os.str();
 }
 
-void get_action(FlowAction* action, std::ostringstream& os)
+std::string get_actions(const FlowActions& actions)
 {
-    if (tnt::visit<ToController>(action, [&] (auto a) { os << to_controller(a->size()); }))
-    {
-        return;
-    }
+    using F = oxm_ofb_match_fields_1_3;
 
-    if (tnt::visit<ToPorts>(action, [&] (auto a)
-    {
-        std::vector<uint32_t> ports;
-        std::copy(std::begin(a->ports()), std::end(a->ports()), std::back_inserter(ports));
+    std::ostringstream os;
 
-        os << to_ports(ports);
-    }))
+    if (actions.has(FlowActions::StripVlan))
     {
-        return;
+        os << strip_vlan();
     }
 
-    if (tnt::visit<Loop>(action, [&] (auto /*a*/) { os << to_port(ofp_port_no_1_3::IN_PORT); }))
+    if (actions.has(FlowActions::SetVlan))
     {
-        return;
+        os << set_vlan(actions.vlan);
     }
 
-    if (tnt::visit<Flood>(action, [&] (auto /*a*/) { os << to_port(ofp_port_no_1_3::FLOOD); }))
+    if (actions.has(FlowActions::SetHwSrc))
     {
-        return;
+        os << set_hw(F::ETH_SRC, actions.hw_src);
     }
 
-    if (tnt::visit<SetHwSrc>(action, [&] (auto a) { os << set_hw_src(a->mac()); }))
+    if (actions.has(FlowActions::SetHwDst))
     {
-        return;
+        os << set_hw(F::ETH_DST, actions.hw_dst);
     }
 
-    if (tnt::visit<SetHwDst>(action, [&] (auto a) { os << set_hw_dst(a->mac()); }))
+    if (actions.has(FlowActions::SetIpSrc))
     {
-        return;
+        os << set_ip(F::IPV4_SRC, actions.ip_src);
     }
 
-    if (tnt::visit<SetIpSrc>(action, [&] (auto a) { os << set_ip_src(a->ip()); }))
+    if (actions.has(FlowActions::SetIpDst))
     {
-        return;
+        os << set_ip(F::IPV4_DST, actions.ip_dst);
     }
 
-    if (tnt::visit<SetIpDst>(action, [&] (auto a) { os << set_ip_dst(a->ip()); }))
+    for (size_t i = 0; i < actions.port_count; ++i)
     {
-        return;
+        os << to_port(static_cast<uint32_t>(actions.ports[i]));
     }
 
-    if (tnt::visit<SetVlan>(action, [&] (auto a) { os << set_vlan(a->tag()); }))
+    if (actions.has(FlowActions::Loop))
     {
-        return;
+        os << to_port(ofp_port_no_1_3::IN_PORT);
     }
 
-    if (tnt::is<StripVlan>(action))
+    if (actions.has(FlowActions::Flood))
     {
-        os << strip_vlan();
-
-        return;
+        os << to_port(ofp_port_no_1_3::FLOOD);
     }
 
-    tnt::Log::error("Unsupported Action");
-}
-
-std::string get_actions(const Flow& flow)
-{
-    std::ostringstream os;
-
-    for (const auto& f : flow.actions())
+    if (actions.has(FlowActions::Controller))
     {
-        get_action(f.get(), os);
+        os << to_controller(actions.controller_len);
     }
 
     return os.str();
@@ -554,13 +437,13 @@ std::string get_flow(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_3 co
     ofp_flow.flags = host_to_network_underlying(ofp_flow_mod_flags_1_3::SEND_FLOW_REM);
     ofp_flow.priority = htons(OFP_DEFAULT_PRIORITY);
     
-    add_flags(flow, ofp_flow);
+    add_flags(flow.flags(), ofp_flow);
 
-    auto filters = get_filters(flow);
+    auto filters = get_filters(flow.match());
     auto instructions = ofp_instruction_actions_1_3();
     instructions.type = host_to_network(ofp_instruction_type_1_3::APPLY_ACTIONS);
 
-    auto actions = get_actions(flow);
+    auto actions = get_actions(flow.actions());
     auto len = sizeof(ofp_flow.match) + filters.size() - 4; // Subtract 4 bytes because the first filter is copied in the last 4 bytes of the ofp_match_1_3 structure
 
     ofp_flow.match.type = host_to_network(ofp_match_type_1_3::OXM);
@@ -580,33 +463,46 @@ std::string get_flow(const Flow& flow, uint32_t xid, ofp_flow_mod_command_1_3 co
 
 } // namespace anonymous
 
-SwitchSideOpenflow_1_3::SwitchSideOpenflow_1_3(Openflow* parent): parent_(parent)
+SwitchSideOpenflow_1_3::SwitchSideOpenflow_1_3(SwitchSideConnection* connection, uint64_t datapath_id):
+    connection_(connection), datapath_id_(datapath_id)
 {
-    assert(parent_);
+    assert(connection_);
     register_handlers();
 }
 
+void SwitchSideOpenflow_1_3::init()
+{
+    // The controller answers with its own HELLO, then FEATURES_REQUEST and SET_CONFIG.
+    auto pkt = ofp_header_1_3();
+
+    pkt.type = ofp_type_1_3::HELLO;
+    pkt.version = version;
+    pkt.xid = htonl(create_xid());
+    pkt.length = htons(sizeof(pkt));
 
-// TODO: invoke_message switch side, send/wait HELLO and test if the C version is supported
+    connection_->write(to_mem_buffer(pkt));
+}
 
-//lasciando la invoke_messege e la init uguali a quelle del controller funziona ma non e' gestito l errore nel caso in cui dopo
-//lo scambio di HELLO non ci siano FEATURES_REQUEST e SET_CONFIG, ma volendo si puo' non implementare perche credo fosse solo
-//l'handshake voluto da OVS 
-void SwitchSideOpenflow_1_3::init()
+void SwitchSideOpenflow_1_3::add(const Flow& flow, uint32_t xid)
 {
-   
+    connection_->write(get_flow(flow, xid, ofp_flow_mod_command_1_3::ADD));
 }
 
-void SwitchSideOpenflow_1_3::add(const Flow& flow)
+void SwitchSideOpenflow_1_3::remove(const Flow& flow, uint32_t xid)
 {
-    auto xid = create_xid();
-    parent_->write(get_flow(flow, xid, ofp_flow_mod_command_1_3::ADD));
+    connection_->write(get_flow(flow, xid, ofp_flow_mod_command_1_3::DELETE));
 }
 
-void SwitchSideOpenflow_1_3::remove(const Flow& flow)
+void SwitchSideOpenflow_1_3::barrier(uint32_t xid)
 {
-    auto xid = create_xid();
-    parent_->write(get_flow(flow, xid, ofp_flow_mod_command_1_3::DELETE));
+    auto pkt = ofp_header_1_3();
+
+    pkt.type = ofp_type_1_3::BARRIER_REQUEST;
+    pkt.version = version;
+    pkt.xid = htonl(xid);
+    pkt.length = htons(sizeof(pkt));
+
+    connection_->write(to_mem_buffer(pkt));
 }
 
 void SwitchSideOpenflow_1_3::remove_all()
@@ -627,7 +523,7 @@ void SwitchSideOpenflow_1_3::remove_all()
     pkt.match.type = host_to_network(ofp_match_type_1_3::OXM);
     pkt.match.length = htons(sizeof(pkt.match) - 4);
 
-    parent_->write(to_mem_buffer(pkt));
+    connection_->write(to_mem_buffer(pkt));
 }
 
 void SwitchSideOpenflow_1_3::packet(const std::string& message)
@@ -644,9 +540,55 @@ void SwitchSideOpenflow_1_3::packet(const std::string& message)
     }
 }
 
-void SwitchSideOpenflow_1_3::send_packet(const std::string& /*buffer*/, uint16_t /*port*/)
+void SwitchSideOpenflow_1_3::send_packet(const std::string& buffer, uint16_t port)
+{
+    packet_in(OFP_NO_BUFFER, port, buffer.data(), buffer.size());
+}
+
+void SwitchSideOpenflow_1_3::packet_in(uint32_t buffer_id, uint16_t in_port, const char* frame, size_t size)
+{
+    auto pkt = ofp_packet_in_1_3();
+
+    pkt.header.type = ofp_type_1_3::PACKET_IN;
+    pkt.header.version = version;
+    pkt.header.xid = htonl(create_xid());
+
+    pkt.buffer_id = htonl(buffer_id);
+    pkt.total_len = htons(size);
+    pkt.reason = ofp_packet_in_reason_1_3::NO_MATCH;
+    pkt.table_id = 0;
+
+    // The match carries only IN_PORT: 4 bytes of header and one 8 bytes OXM, padded to 16.
+    uint32_t oxm = oxm_basic_header(oxm_ofb_match_fields_1_3::IN_PORT, false, sizeof(uint32_t));
+    pkt.match.type = host_to_network(ofp_match_type_1_3::OXM);
+    pkt.match.length = htons(4 + sizeof(oxm) + sizeof(uint32_t));
+    std::memcpy(pkt.match.oxm_fields, &oxm, sizeof(oxm));
+
+    uint32_t port = htonl(in_port);
+    auto match_pad = get_pad_len(4 + sizeof(oxm) + sizeof(port));
+
+    auto length = sizeof(pkt) + sizeof(port) + match_pad + 2 + size;
+    pkt.header.length = htons(length);
+
+    std::string message;
+    message.reserve(length);
+    message += to_mem_buffer(pkt, port);
+    message.append(match_pad + 2, '\0');
+    message.append(frame, size);
+
+    connection_->write(message);
+}
+
+void SwitchSideOpenflow_1_3::echo_request(uint32_t xid)
 {
+    auto pkt = ofp_header_1_3();
+
+    pkt.type = ofp_type_1_3::ECHO_REQUEST;
+    pkt.version = version;
+    pkt.xid = htonl(xid);
+    pkt.length = htons(sizeof(pkt));
 
+    connection_->write(to_mem_buffer(pkt));
 }
 
 void SwitchSideOpenflow_1_3::request_port_stats(uint16_t /*port*/)
@@ -654,6 +596,11 @@ void SwitchSideOpenflow_1_3::request_port_stats(uint16_t /*port*/)
 
 }
 
+void SwitchSideOpenflow_1_3::request_stats(OpenflowStats /*what*/)
+{
+
+}
+
 void SwitchSideOpenflow_1_3::features(const std::string& message)
 {
 	auto ptr = message.data();
@@ -665,9 +612,12 @@ void SwitchSideOpenflow_1_3::features(const std::string& message)
 	reply.header.version = version;
 	reply.header.xid = request->xid;
 
-	// TODO: Fill ofp_switch_features_1_3 fields with the real features and the status of the switch.
-	// TODO: parent_->write(to_mem_buffer(reply));
+	reply.datapath_id = htonll(datapath_id_);
+	reply.n_buffers = htonl(256);
+	reply.n_tables = 1;
+	reply.capabilities = host_to_network(ofp_capabilities_1_3::FLOW_STATS);
 
+	connection_->write(to_mem_buffer(reply));
 }
 
 void SwitchSideOpenflow_1_3::setconfig(const std::string& /*message*/)
@@ -706,7 +656,21 @@ void SwitchSideOpenflow_1_3::echo(const std::string& message)
 
     auto payload_len = ntohs(request->length) - sizeof(ofp_header_1_3);
 
-    parent_->write(to_mem_buffer(reply) + std::string(ptr + sizeof(ofp_header_1_3), payload_len));
+    connection_->write(to_mem_buffer(reply) + std::string(ptr + sizeof(ofp_header_1_3), payload_len));
+}
+
+void SwitchSideOpenflow_1_3::barrier_request(const std::string& message)
+{
+    // The messages are processed in order, everything before the barrier is already done.
+    auto request = reinterpret_cast<const ofp_header_1_3*>(message.data());
+
+    auto reply = ofp_header_1_3();
+    reply.length = htons(sizeof(reply));
+    reply.type = ofp_type_1_3::BARRIER_REPLY;
+    reply.version = version;
+    reply.xid = request->xid;
+
+    connection_->write(to_mem_buffer(reply));
 }
 
 void SwitchSideOpenflow_1_3::port_status(const std::string& /*message*/)
@@ -729,11 +693,6 @@ void SwitchSideOpenflow_1_3::flow_removed(const std::string& /*message*/)
     tnt::Log::info(colors::magenta, "flow_removed");
 }
 
-void SwitchSideOpenflow_1_3::packet_in(const std::string& /*message*/)
-{
-
-}
-
 void SwitchSideOpenflow_1_3::unmanaged_packet(const ofp_header_1_3* /*pkt*/)
 {
     tnt::Log::info(colors::magenta, "unmanaged_packet");
@@ -751,7 +710,7 @@ void SwitchSideOpenflow_1_3::error_hello_failed(const ofp_header_1_3* pkt, const
 	reply.type = ofp_error_type_1_3::HELLO_FAILED;
 	reply.code = code;
 	//reply.data can contains an ASCII text string that adds detail on why the error occurred. Now disabled.
-	// TODO: parent_->write(to_mem_buffer(reply));
+	// TODO: connection_->write(to_mem_buffer(reply));
 	
 	if (ntohs(code) == OFPHFC_INCOMPATIBLE)
 	{
@@ -1056,12 +1015,17 @@ void SwitchSideOpenflow_1_3::register_handlers()
 	message_dispatcher_.register_listener(ofp_type_1_3::SET_CONFIG,         [this] (const std::string& message) { setconfig(message); });
 	message_dispatcher_.register_listener(ofp_type_1_3::ERROR,              [this] (const std::string& message) { error(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::ECHO_REQUEST,       [this] (const std::string& message) { echo(message); });
-    message_dispatcher_.register_listener(ofp_type_1_3::PACKET_IN,          [this] (const std::string& message) { packet_in(message); });
+    message_dispatcher_.register_listener(ofp_type_1_3::BARRIER_REQUEST,    [this] (const std::string& message) { barrier_request(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::GET_CONFIG_REPLY,   [this] (const std::string& message) { get_config(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::FLOW_REMOVED,       [this] (const std::string& message) { flow_removed(message); });
     message_dispatcher_.register_listener(ofp_type_1_3::PORT_STATUS,        [this] (const std::string& message) { port_status(message); });
     //message_dispatcher_.register_listener(ofp_type_1_3::STATS_REPLY,       [this] (const std::string& message) { stats(message); });
 
+    for (auto type: { ofp_type_1_3::HELLO, ofp_type_1_3::FLOW_MOD, ofp_type_1_3::PACKET_OUT, ofp_type_1_3::ECHO_REPLY, ofp_type_1_3::MULTIPART_REQUEST })
+    {
+        message_dispatcher_.register_listener(type, [this, type] (const std::string& message) { connection_->received(type, message); });
+    }
+
 	//error_dispatcher_.register_listener(ofp_error_type_1_3::HELLO_FAILED,           [this] (const ofp_header_1_3* pkt, const std::string& message, ofp_hello_failed_code code) { error_hello_failed(pkt, message, code); });
     error_dispatcher_.register_listener(ofp_error_type_1_3::BAD_REQUEST,            [this] (const ofp_error_msg_1_3* pkt, const std::string& message) { error_bad_request(pkt, message); });
     error_dispatcher_.register_listener(ofp_error_type_1_3::BAD_ACTION,             [this] (const ofp_error_msg_1_3* pkt, const std::string& message) { error_bad_action(pkt, message); });
@@ -68,36 +68,53 @@ template<> struct hash<::drop::protocol::ofp_error_type_1_3>
 namespace drop {
 namespace protocol {
 
-class Openflow;
 struct ofp_header_1_3;
 struct ofp_error_msg_1_3;
 
-class SwitchSideOpenflow_1_3 : public RegisterOpenflowVersion<SwitchSideOpenflow_1_3, 0x4>
+// The connection the switch side of OpenFlow runs on: it writes what the switch side
+// sends and gets the messages of the controller a switch has to act on.
+struct SwitchSideConnection
+{
+    virtual ~SwitchSideConnection() = default;
+
+    virtual void write(const std::string& data) = 0;
+    // HELLO, FLOW_MOD, PACKET_OUT, ECHO_REPLY and MULTIPART_REQUEST, the whole message.
+    virtual void received(ofp_type_1_3 type, const std::string& message) = 0;
+};
+
+// Not registered with OpenflowVersion: the version 1.3 there is the controller side.
+class SwitchSideOpenflow_1_3 : public OpenflowProtocol
 {
 public:
-	explicit SwitchSideOpenflow_1_3(Openflow* parent);
+	SwitchSideOpenflow_1_3(SwitchSideConnection* connection, uint64_t datapath_id);
 
     virtual void init() override;
     virtual void remove_all() override;
 
-    virtual void add(const Flow& flow) override;
-    virtual void remove(const Flow& flow) override;
+    virtual void add(const Flow& flow, uint32_t xid) override;
+    virtual void remove(const Flow& flow, uint32_t xid) override;
+    virtual void barrier(uint32_t xid) override;
 
     virtual void packet(const std::string& message) override;
 
     virtual void send_packet(const std::string& buffer, uint16_t port) override;
 
     virtual void request_port_stats(uint16_t port) override;
+    virtual void request_stats(OpenflowStats what) override;
+
+    // A frame for the controller, buffer_id is OFP_NO_BUFFER if the switch keeps no copy.
+    void packet_in(uint32_t buffer_id, uint16_t in_port, const char* frame, size_t size);
+    void echo_request(uint32_t xid);
 private:
     void features(const std::string& message);
 	void setconfig(const std::string& message);
     void error(const std::string& message);
     void echo(const std::string& message);
+    void barrier_request(const std::string& message);
     void port_status(const std::string& message);
     void get_config(const std::string& message);
     void stats(const std::string& message);
     void flow_removed(const std::string& message);
-    void packet_in(const std::string& message);
 
     void unmanaged_packet(const ofp_header_1_3* pkt);
 	//passare code per riferimento?
@@ -119,7 +136,8 @@ private:
 
     void register_handlers();
 private:
-    Openflow* parent_;
+    SwitchSideConnection* connection_;
+    uint64_t datapath_id_;
 
     tnt::KeyDispatch<ofp_type_1_3, void, const std::string&> message_dispatcher_;
     tnt::KeyDispatch<ofp_error_type_1_3, void, const ofp_error_msg_1_3*, const std::string&> error_dispatcher_;
@@ -25,50 +25,31 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
-#include "arp_cache.hpp"
+#ifndef DROP_ROUTER_NEIGHBOR_INFO_HPP_
+#define DROP_ROUTER_NEIGHBOR_INFO_HPP_
 
-#include <fstream>
-
-#include "exception/drop_exception.hpp"
+#include <cstdint>
+#include <iosfwd>
 
 #include "mac_address.hpp"
-#include "log.hpp"
-
-namespace tnt {
 
-const char* arp_cache = "/proc/net/arp";
+namespace drop {
 
-tnt::MacAddress hw_from_arp(const std::string& ip)
+struct NeighborInfo
 {
-    std::ifstream file(arp_cache);
-
-    if (!file)
-    {
-        throw tnt::OpenFileError();
-    }
-
-    std::string line;
-
-    while (std::getline(file, line))
-    {
-        if (line.find(ip) == std::string::npos)
-        {
-            continue;
-        }
-
-        std::stringstream ss(line);
-        std::string tmp0;
-        std::string tmp1;
-        std::string tmp2;
-        std::string hw;
+	NeighborInfo() = default;
 
-        ss >> tmp0 >> tmp1 >> tmp2 >> hw;
+    uint32_t address; // In network order
+    uint32_t port_index;
+    uint16_t state; // NUD_* flags
+    tnt::MacAddress mac;
+};
 
-        return tnt::MacAddress(hw);
-    }
+// True if the kernel has a usable link layer address for the neighbor.
+bool resolved(const NeighborInfo& neighbor);
 
-    throw std::invalid_argument("Error: The ip address does not exists.");
-}
+std::ostream& operator<<(std::ostream& os, const NeighborInfo& neighbor);
 
-} // namespace tnt 
+} // namespace drop
 
+#endif
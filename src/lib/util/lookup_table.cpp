@@ -28,274 +28,476 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "lookup_table.hpp"
 
 #include <algorithm>
-#include <thread>
-#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include "exception/drop_exception.hpp"
 
-#include "range.hpp"
 #include "endianness.hpp"
 #include "mac_address.hpp"
 
 namespace drop {
+namespace {
+
+const uint32_t tbl24_size = 1 << 24;
+const uint32_t tbl8_group_size = 256;
+const uint32_t max_groups = 0x8000;
+const uint32_t max_next_hops = 0x8000;
+const int max_readers = 64;
+
+const uint16_t extended_entry = 0x8000; // The entry is the index of a tbl8 group.
+const uint16_t no_route = 0;
+
+uint32_t netmask(uint32_t prefix)
+{
+	return prefix == 0 ? 0 : std::numeric_limits<uint32_t>::max() << (32 - prefix);
+}
+
+// Sets the entries not covered by a more specific route.
+void set_range(std::atomic<uint16_t>* entries, uint8_t* depths, uint32_t count, uint32_t prefix, uint16_t next_hop)
+{
+	for (auto i = 0u; i < count; ++i)
+	{
+		if (depths[i] <= prefix)
+		{
+			depths[i] = prefix;
+			entries[i].store(next_hop, std::memory_order_release);
+		}
+	}
+}
+
+// Replaces the entries set by the route being removed with the covering route.
+void reset_range(std::atomic<uint16_t>* entries, uint8_t* depths, uint32_t count, uint32_t prefix, uint16_t next_hop, uint32_t depth)
+{
+	for (auto i = 0u; i < count; ++i)
+	{
+		if (depths[i] == prefix)
+		{
+			depths[i] = depth;
+			entries[i].store(next_hop, std::memory_order_release);
+		}
+	}
+}
+
+// The next hops are shared by the routes with the same destination MAC and egress port.
+std::string next_hop_key(const char* dst, uint16_t port)
+{
+	std::string key(dst, 6);
+	key.append(reinterpret_cast<const char*>(&port), sizeof(port));
+
+	return key;
+}
+
+} // namespace
 
-LookupTable::LookupNode::LookupNode(): def(true) {}
+LookupTable::LookupNode::LookupNode(): def(true), port(0) {}
 
-LookupTable::LookupNode::LookupNode(const std::string& d) : def(false)
+LookupTable::LookupNode::LookupNode(const std::string& d, uint16_t p) : def(false), port(p)
 {
 	assert(d.size() == 6);
 
 	std::copy_n(std::begin(d), 6, std::begin(dst));
 }
 
-LookupTable::RouteNode::RouteNode(uint32_t p, const std::string& d) : prefix(p)
+LookupTable::RouteNode::RouteNode(uint32_t p, const std::string& d, uint16_t pt, uint16_t nh) : prefix(p), port(pt), next_hop(nh)
 {
 	assert(d.size() == 6);
 
 	std::copy_n(std::begin(d), 6, std::begin(dst));
 }
 
-LookupTable::LookupTable(int n): table_1_(std::make_unique<TableType>(n)), table_2_(std::make_unique<TableType>(n)), read_(table_1_.get()), write_(table_2_.get()) {}
+LookupTable::LookupTable(int n):
+	tbl24_(std::make_unique<EntryType[]>(tbl24_size)),
+	tbl24_depth_(std::make_unique<uint8_t[]>(tbl24_size)),
+	tbl8_(std::make_unique<EntryType[]>(std::min<uint32_t>(n, max_groups) * tbl8_group_size)),
+	tbl8_depth_(std::make_unique<uint8_t[]>(std::min<uint32_t>(n, max_groups) * tbl8_group_size)),
+	next_hops_(std::make_unique<LookupNode[]>(max_next_hops)),
+	next_hop_refs_(std::make_unique<uint32_t[]>(max_next_hops)),
+	readers_(max_readers),
+	batch_(false)
+{
+	assert(n > 0);
+
+	for (auto g = std::min<uint32_t>(n, max_groups); g > 0; --g)
+	{
+		tbl8_free_.push_back(g - 1);
+	}
+
+	for (auto nh = max_next_hops - 1; nh > no_route; --nh)
+	{
+		next_hop_free_.push_back(nh);
+	}
+}
 
-const LookupTable::LookupNode& LookupTable::lookup(uint32_t address)
+const LookupTable::LookupNode& LookupTable::lookup(uint32_t address) const
 {
-    const auto ptr = read_.load(); // Atomic operation
-    auto it = ptr->find(address);
+	const auto a = ntohl(address);
+	auto entry = tbl24_[a >> 8].load(std::memory_order_acquire);
 
-    return it != std::end(*ptr) ? it->second : default_;
+	if (entry & extended_entry)
+	{
+		entry = tbl8_[(entry & ~extended_entry) * tbl8_group_size + (a & 0xff)].load(std::memory_order_acquire);
+	}
+
+	return next_hops_[entry];
 }
 
-void LookupTable::add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst)
+void LookupTable::prefetch(uint32_t address) const
 {
-	assert(prefix > 1 && prefix <= 32);
-
-	const auto d = std::move(dst.raw());
-	const auto node = LookupNode(d);
-
-    if (add_route(address, prefix, d))
-    {
-	    if (prefix == 32)
-	    {
-		    update([&] ()
-		    {
-			    (*write_)[address] = node;
-		    });
-	    }
-	    else
-	    {
-		    add_net(address, prefix, node);
-	    }
-    }
+	__builtin_prefetch(&tbl24_[ntohl(address) >> 8]);
 }
 
-void LookupTable::del(uint32_t address, uint32_t prefix)
+void LookupTable::add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst, uint16_t port)
 {
-	auto p = route_table_.equal_range(address);
+	assert(prefix <= 32);
 
-	if (p.first == p.second)
-	{
-		// No route for the address/subnet. Nothing to do.
-		return;
-	}
+	const auto a = ntohl(address) & netmask(prefix);
+	const auto d = dst.raw();
 
-	for (auto it = p.first; it != p.second; ++it)
+	auto it = find_route(htonl(a), prefix);
+
+	if (it != std::end(route_table_))
 	{
-		if (it->second.prefix == prefix)
-		{
-			route_table_.erase(it);
+		const auto& rn = it->second;
 
-			break;
+		if (std::equal(std::begin(rn.dst), std::end(rn.dst), std::begin(d)) && rn.port == port)
+		{
+			return;
 		}
-	}
 
-	if (prefix == 32)
-	{
-		del_address(address, prefix);
+		auto old = rn.next_hop;
+		auto nh = next_hop_get(d, port);
+
+		it->second = RouteNode(prefix, d, port, nh);
+		install(a, prefix, nh);
+		next_hop_put(old);
 	}
 	else
 	{
-		del_net(address, prefix);
+		auto nh = next_hop_get(d, port);
+
+		try
+		{
+			install(a, prefix, nh);
+		}
+		catch (...)
+		{
+			next_hop_put(nh);
+
+			throw;
+		}
+
+		route_table_.insert(std::make_pair(htonl(a), RouteNode(prefix, d, port, nh)));
 	}
-}
 
-void LookupTable::for_each(std::function<void(const RouteValue&)> func)
-{
-	for (const auto& r : route_table_)
+	if (!batch_)
 	{
-		func(r);
+		reclaim();
 	}
 }
 
-bool LookupTable::add_route(uint32_t address, uint32_t prefix, const std::string& dst)
+void LookupTable::del(uint32_t address, uint32_t prefix)
 {
-	auto p = route_table_.equal_range(address);
+	const auto a = ntohl(address) & netmask(prefix);
+	auto it = find_route(htonl(a), prefix);
 
-	if (p.first != p.second)
+	if (it == std::end(route_table_))
 	{
-		for (auto it = p.first; it != p.second; ++it)
-		{
-			if (it->second.prefix == prefix)
-			{
-                const auto& rn = it->second;
+		// No route for the address/subnet. Nothing to do.
+		return;
+	}
 
-                if (rn.dst[0] == dst[0] && rn.dst[1] == dst[1] && rn.dst[2] == dst[2] && rn.dst[3] == dst[3] && rn.dst[4] == dst[4] && rn.dst[5] == dst[5])
-                {
-                    return false;
-                }
+	auto nh = it->second.next_hop;
+	route_table_.erase(it);
 
-				it->second = RouteNode(prefix, dst);
-				
-				return true;
-			}
-		}
+	auto cover = covering_route(a, prefix);
+
+	if (cover != nullptr)
+	{
+		uninstall(a, prefix, cover->next_hop, cover->prefix);
+	}
+	else
+	{
+		uninstall(a, prefix, no_route, 0);
 	}
 
-	route_table_.insert(std::make_pair(address, RouteNode(prefix, dst)));
+	next_hop_put(nh);
 
-    return true;
+	if (!batch_)
+	{
+		reclaim();
+	}
 }
 
-void LookupTable::add_net(uint32_t address, uint32_t prefix, const LookupNode& node)
+void LookupTable::begin_batch()
 {
-	address = ntohl(address);
+	assert(!batch_);
 
-	auto net_len = 32 - prefix;
+	batch_ = true;
+}
 
-	auto num = 1 << net_len;
-	auto mask = std::numeric_limits<uint32_t>::max() << net_len;
+void LookupTable::commit()
+{
+	assert(batch_);
 
-	std::vector<uint32_t> addresses;
-	addresses.reserve(num);
+	batch_ = false;
+	reclaim();
+}
 
-	for (int i = 0; i < num; ++i)
+void LookupTable::for_each(std::function<void(const RouteValue&)> func)
+{
+	for (const auto& r : route_table_)
 	{
-		auto dst_address = htonl((address & mask) + i);
-
-		if (prefix > route_prefix(dst_address))
-		{
-			addresses.push_back(dst_address);
-		}
+		func(r);
 	}
+}
+
+tnt::QuiescentState& LookupTable::readers()
+{
+	return readers_;
+}
 
-	update([&] ()
+// The reader ids are only checked by assert on the forwarding path.
+void LookupTable::check_readers(int rings) const
+{
+	if (rings > readers_.max_readers())
 	{
-		for (auto a : addresses)
-		{
-			(*write_)[a] = node;
-		}
-	});
+		throw LookupTableFull(std::to_string(rings) + " rings, the table takes at most " + std::to_string(readers_.max_readers()) + " readers");
+	}
 }
 
-void LookupTable::del_address(uint32_t address, uint32_t prefix)
+LookupTable::RouteTableType::iterator LookupTable::find_route(uint32_t address, uint32_t prefix)
 {
-	auto old_prefix = route_prefix(address);
+	auto p = route_table_.equal_range(address);
 
-	update([&] ()
+	for (auto it = p.first; it != p.second; ++it)
 	{
-		if (old_prefix == 0)
+		if (it->second.prefix == prefix)
 		{
-			write_->erase(address);
+			return it;
 		}
-		else if (old_prefix < prefix)
-		{
-			const auto& node = match(address, old_prefix);
+	}
 
-			(*write_)[address] = LookupNode(std::string(node.dst, 6));
-		}
-	});
+	return std::end(route_table_);
 }
 
-void LookupTable::del_net(uint32_t address, uint32_t prefix)
+// Longest route strictly less specific than address/prefix (address in host byte order).
+const LookupTable::RouteNode* LookupTable::covering_route(uint32_t address, uint32_t prefix)
 {
-	auto net_len = 32 - prefix;
+	for (auto p = prefix; p-- > 0;)
+	{
+		auto it = find_route(htonl(address & netmask(p)), p);
 
-	auto n = static_cast<int>(std::pow(2, net_len));
-	auto mask = std::numeric_limits<uint32_t>::max() << net_len;
+		if (it != std::end(route_table_))
+		{
+			return &it->second;
+		}
+	}
 
-	std::vector<std::pair<uint32_t, LookupNode>> addresses;
-	addresses.reserve(n);
+	return nullptr;
+}
 
-	for (int i = 0; i < n; ++i)
+void LookupTable::install(uint32_t address, uint32_t prefix, uint16_t next_hop)
+{
+	if (prefix <= 24)
 	{
-		auto dst_address = htonl((ntohl(address) & mask) + i);
-		auto old_prefix = route_prefix(dst_address);
+		const auto first = address >> 8;
+		const auto last = first + (1u << (24 - prefix));
 
-		if (old_prefix == 0)
-		{
-			addresses.push_back(std::make_pair(dst_address, LookupNode()));
-		}
-		else if (old_prefix < prefix)
+		for (auto i = first; i < last; ++i)
 		{
-			const auto& node = match(dst_address, old_prefix);
-			addresses.push_back(std::make_pair(dst_address, LookupNode(std::string(node.dst, 6))));
+			auto entry = tbl24_[i].load(std::memory_order_relaxed);
+
+			if (entry & extended_entry)
+			{
+				const auto offset = (entry & ~extended_entry) * tbl8_group_size;
+
+				tbl24_depth_[i] = std::max<uint32_t>(tbl24_depth_[i], prefix);
+				set_range(&tbl8_[offset], &tbl8_depth_[offset], tbl8_group_size, prefix, next_hop);
+			}
+			else
+			{
+				set_range(&tbl24_[i], &tbl24_depth_[i], 1, prefix, next_hop);
+			}
 		}
 	}
+	else
+	{
+		const auto index = address >> 8;
+		auto entry = tbl24_[index].load(std::memory_order_relaxed);
+
+		auto group = entry & extended_entry ? static_cast<uint16_t>(entry & ~extended_entry) : tbl8_alloc(index);
+		const auto offset = group * tbl8_group_size + (address & 0xff);
+
+		set_range(&tbl8_[offset], &tbl8_depth_[offset], 1u << (32 - prefix), prefix, next_hop);
+	}
+}
 
-	update([&] ()
+void LookupTable::uninstall(uint32_t address, uint32_t prefix, uint16_t next_hop, uint32_t depth)
+{
+	if (prefix <= 24)
 	{
-		for (auto p : addresses)
+		const auto first = address >> 8;
+		const auto last = first + (1u << (24 - prefix));
+
+		for (auto i = first; i < last; ++i)
 		{
-			if (p.second.def)
+			auto entry = tbl24_[i].load(std::memory_order_relaxed);
+
+			if (entry & extended_entry)
 			{
-				write_->erase(p.first);
+				const auto offset = (entry & ~extended_entry) * tbl8_group_size;
+
+				if (tbl24_depth_[i] == prefix)
+				{
+					tbl24_depth_[i] = depth;
+				}
+
+				reset_range(&tbl8_[offset], &tbl8_depth_[offset], tbl8_group_size, prefix, next_hop, depth);
 			}
 			else
 			{
-				(*write_)[p.first] = p.second;
+				reset_range(&tbl24_[i], &tbl24_depth_[i], 1, prefix, next_hop, depth);
 			}
 		}
-	});
+	}
+	else
+	{
+		const auto index = address >> 8;
+		auto entry = tbl24_[index].load(std::memory_order_relaxed);
+
+		assert(entry & extended_entry);
+
+		auto group = static_cast<uint16_t>(entry & ~extended_entry);
+		const auto offset = group * tbl8_group_size + (address & 0xff);
+
+		reset_range(&tbl8_[offset], &tbl8_depth_[offset], 1u << (32 - prefix), prefix, next_hop, depth);
+		tbl8_collapse(index, group);
+	}
 }
 
-void LookupTable::update(std::function<void()> func)
+uint16_t LookupTable::tbl8_alloc(uint32_t index)
 {
-	func();
-	swap();
+	if (tbl8_free_.empty())
+	{
+		reclaim_wait();
+	}
+
+	if (tbl8_free_.empty())
+	{
+		throw LookupTableFull("No more tbl8 groups available");
+	}
+
+	auto group = tbl8_free_.back();
+	tbl8_free_.pop_back();
+
+	const auto offset = group * tbl8_group_size;
+	const auto entry = tbl24_[index].load(std::memory_order_relaxed);
+
+	for (auto i = 0u; i < tbl8_group_size; ++i)
+	{
+		tbl8_[offset + i].store(entry, std::memory_order_relaxed);
+		tbl8_depth_[offset + i] = tbl24_depth_[index];
+	}
+
+	// The group must be complete before a reader can reach it.
+	tbl24_[index].store(extended_entry | group, std::memory_order_release);
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(500));
-	func();
+	return group;
 }
 
-void LookupTable::swap()
+void LookupTable::tbl8_collapse(uint32_t index, uint16_t group)
 {
-    TableType* tmp = read_;
-    read_ = write_;  // Atomic operation
-    write_ = tmp;
+	const auto offset = group * tbl8_group_size;
+
+	auto first = &tbl8_depth_[offset];
+	auto last = first + tbl8_group_size;
+
+	if (std::any_of(first, last, [] (uint8_t d) { return d > 24; }))
+	{
+		return;
+	}
+
+	// Every entry now comes from the same route (or none), the group is no longer needed.
+	tbl24_[index].store(tbl8_[offset].load(std::memory_order_relaxed), std::memory_order_release);
+	tbl8_retired_.push_back(group);
 }
 
-uint32_t LookupTable::route_prefix(uint32_t address)
+uint16_t LookupTable::next_hop_get(const std::string& dst, uint16_t port)
 {
-	auto prefix = 0u;
+	auto key = next_hop_key(dst.data(), port);
+	auto it = next_hop_index_.find(key);
 
-	for (const auto& p : route_table_)
+	if (it != std::end(next_hop_index_))
 	{
-		auto net_len = 32 - p.second.prefix;
-		auto mask = std::numeric_limits<uint32_t>::max() << net_len;
+		++next_hop_refs_[it->second];
 
-		if ((ntohl(p.first) & mask) == (ntohl(address) & mask))
-		{
-			prefix = std::max(prefix, p.second.prefix);
-		}
+		return it->second;
+	}
+
+	if (next_hop_free_.empty())
+	{
+		reclaim_wait();
+	}
+
+	if (next_hop_free_.empty())
+	{
+		throw LookupTableFull("No more next hops available");
+	}
+
+	auto nh = next_hop_free_.back();
+	next_hop_free_.pop_back();
+
+	next_hops_[nh] = LookupNode(dst, port);
+	next_hop_refs_[nh] = 1;
+	next_hop_index_.insert(std::make_pair(key, nh));
+
+	return nh;
+}
+
+void LookupTable::next_hop_put(uint16_t next_hop)
+{
+	if (--next_hop_refs_[next_hop] > 0)
+	{
+		return;
 	}
 
-	return prefix;
+	next_hop_index_.erase(next_hop_key(next_hops_[next_hop].dst, next_hops_[next_hop].port));
+	next_hop_retired_.push_back(next_hop);
 }
 
-const LookupTable::RouteNode& LookupTable::match(uint32_t address, uint32_t prefix)
+void LookupTable::reclaim()
 {
-	for (const auto& p : route_table_)
+	if (!tbl8_retired_.empty() || !next_hop_retired_.empty())
 	{
-		if (p.second.prefix == prefix)
-		{
-			auto net_len = 32 - prefix;
-			auto mask = std::numeric_limits<uint32_t>::max() << net_len;
+		pending_.push_back(Retired{ readers_.advance(), std::move(tbl8_retired_), std::move(next_hop_retired_) });
 
-			if ((ntohl(p.first) & mask) == (ntohl(address) & mask))
-			{
-				return p.second;
-			}
-		}
+		tbl8_retired_.clear();
+		next_hop_retired_.clear();
+	}
+
+	// Forwarding threads may still hold a reference to the retired groups and next hops
+	// until they pass a quiescent point.
+	while (!pending_.empty() && readers_.passed(pending_.front().epoch))
+	{
+		const auto& r = pending_.front();
+
+		tbl8_free_.insert(std::end(tbl8_free_), std::begin(r.groups), std::end(r.groups));
+		next_hop_free_.insert(std::end(next_hop_free_), std::begin(r.next_hops), std::end(r.next_hops));
+
+		pending_.pop_front();
+	}
+}
+
+void LookupTable::reclaim_wait()
+{
+	if (pending_.empty())
+	{
+		return;
 	}
 
-	assert(false);
+	readers_.synchronize();
+	reclaim();
 }
 
 } // namespace drop
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <unordered_map>
 #include <map>
+#include <deque>
 #include <vector>
 #include <string>
 #include <memory>
@@ -39,67 +40,117 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cassert>
 
 #include "mac_address_fwd.hpp"
+#include "quiescent_state.hpp"
 
 namespace drop {
 
+// Longest prefix match table based on the DIR-24-8 scheme: the first 24 bits of the
+// address index a flat table, prefixes longer than 24 bits are expanded in 256 entries
+// groups allocated on demand. Each entry is an index in the next-hop table (destination
+// MAC and egress port), so a lookup costs one or two memory accesses, whatever the number
+// of installed routes.
+// Addresses are in network byte order, as they are read from the packets.
+// Updates never block the lookups: entries are changed in place and the memory released
+// by a delete is reused only after every forwarding thread has passed a quiescent point.
 class LookupTable
 {
+public:
     struct LookupNode
     {
 		LookupNode();
-		LookupNode(const std::string& d);
+		LookupNode(const std::string& d, uint16_t p);
 
 		bool def;
 
         char dst[6];
+		uint16_t port; // Egress port of the forwarder.
     };
-
+private:
 	struct RouteNode
 	{
-		RouteNode(uint32_t p, const std::string& d);
+		RouteNode(uint32_t p, const std::string& d, uint16_t pt, uint16_t nh);
 
 		uint32_t prefix;
 
 		char dst[6];
+		uint16_t port;
+
+		uint16_t next_hop;
 	};
 
-    using TableType = std::unordered_map<uint32_t, LookupNode>;
+	struct Retired
+	{
+		uint64_t epoch;
+
+		std::vector<uint16_t> groups;
+		std::vector<uint16_t> next_hops;
+	};
+
+	using EntryType = std::atomic<uint16_t>;
 	using RouteTableType = std::multimap<uint32_t, RouteNode>;
 public:
 	using RouteValue = RouteTableType::value_type;
-	using LookupValue = TableType::value_type;
 
+	// n is the maximum number of 256 entries groups available for prefixes longer than 24 bits.
 	explicit LookupTable(int n);
 
-	const LookupNode& lookup(uint32_t address);
+	const LookupNode& lookup(uint32_t address) const;
+
+	// Brings in cache the first level entry of address, ahead of its lookup.
+	void prefetch(uint32_t address) const;
 
-	void add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst);
+	void add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst, uint16_t port);
 	void del(uint32_t address, uint32_t prefix);
 
+	// The changes between begin_batch and commit share a single grace period: only the
+	// reclamation is deferred to commit. A batch is not atomic for the lookups, each entry
+	// is written in place as add and del run, so a lookup during the batch may see a part
+	// of it.
+	void begin_batch();
+	void commit();
+
 	void for_each(std::function<void(const RouteValue&)> func);
+
+	// The forwarding threads (one reader id per ring) must report their quiescent states.
+	tnt::QuiescentState& readers();
+	// Throws LookupTableFull if there are fewer reader ids than rings.
+	void check_readers(int rings) const;
 private:
-	bool add_route(uint32_t address, uint32_t prefix, const std::string& dst);
-	void add_net(uint32_t address, uint32_t prefix, const LookupNode& node);
+	RouteTableType::iterator find_route(uint32_t address, uint32_t prefix);
+	const RouteNode* covering_route(uint32_t address, uint32_t prefix);
+
+	void install(uint32_t address, uint32_t prefix, uint16_t next_hop);
+	void uninstall(uint32_t address, uint32_t prefix, uint16_t next_hop, uint32_t depth);
 
-	void del_address(uint32_t address, uint32_t prefix);
-	void del_net(uint32_t address, uint32_t prefix);
+	uint16_t tbl8_alloc(uint32_t index);
+	void tbl8_collapse(uint32_t index, uint16_t group);
 
-	void update(std::function<void()> func);
-	void swap();
+	uint16_t next_hop_get(const std::string& dst, uint16_t port);
+	void next_hop_put(uint16_t next_hop);
 
-	uint32_t route_prefix(uint32_t address);
-	const RouteNode& match(uint32_t address, uint32_t prefix);
+	void reclaim();
+	void reclaim_wait();
 private:
 	RouteTableType route_table_;
 
-    std::unique_ptr<TableType> table_1_;
-    std::unique_ptr<TableType> table_2_;
+	std::unique_ptr<EntryType[]> tbl24_;
+	std::unique_ptr<uint8_t[]> tbl24_depth_;
+
+	std::unique_ptr<EntryType[]> tbl8_;
+	std::unique_ptr<uint8_t[]> tbl8_depth_;
+	std::vector<uint16_t> tbl8_free_;
+	std::vector<uint16_t> tbl8_retired_;
 
-    std::atomic<TableType*> read_;
+	std::unique_ptr<LookupNode[]> next_hops_;
+	std::unique_ptr<uint32_t[]> next_hop_refs_;
+	std::unordered_map<std::string, uint16_t> next_hop_index_;
+	std::vector<uint16_t> next_hop_free_;
+	std::vector<uint16_t> next_hop_retired_;
 
-	TableType* write_;
+	std::deque<Retired> pending_;
+	tnt::QuiescentState readers_;
 
-    LookupNode default_;
+	bool batch_;
 };
 
 } // namespace drop
@@ -0,0 +1,110 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "neighbor_table.hpp"
+
+#include "util/configuration.hpp"
+
+#include "lock.hpp"
+
+namespace drop {
+namespace {
+
+const tnt::ConfigKey<int> neighbor_negative_timeout("neighbor.negative_timeout", 1000);
+
+} // namespace
+
+NeighborTable& NeighborTable::instance()
+{
+    static NeighborTable table;
+
+    return table;
+}
+
+NeighborTable::NeighborTable(): negative_timeout_(neighbor_negative_timeout.get()) {}
+
+NeighborTable::Lookup NeighborTable::lookup(uint32_t address, tnt::MacAddress& mac)
+{
+    return tnt::lock(mutex_, [&] ()
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto it = entries_.find(address);
+
+        if (it == std::end(entries_))
+        {
+            entries_.emplace(address, Entry{ tnt::MacAddress(), false, now + negative_timeout_ });
+
+            return Lookup::Unresolved;
+        }
+
+        auto& entry = it->second;
+
+        if (entry.resolved)
+        {
+            mac = entry.mac;
+
+            return Lookup::Resolved;
+        }
+
+        if (now < entry.expiry)
+        {
+            return Lookup::Resolving;
+        }
+
+        entry.expiry = now + negative_timeout_;
+
+        return Lookup::Unresolved;
+    });
+}
+
+bool NeighborTable::update(uint32_t address, const tnt::MacAddress& mac)
+{
+    return tnt::lock(mutex_, [&] ()
+    {
+        auto& entry = entries_[address];
+
+        if (entry.resolved && entry.mac == mac)
+        {
+            return false;
+        }
+
+        entry.mac = mac;
+        entry.resolved = true;
+
+        return true;
+    });
+}
+
+void NeighborTable::remove(uint32_t address)
+{
+    tnt::lock(mutex_, [&] ()
+    {
+        entries_.erase(address);
+    });
+}
+
+} // namespace drop
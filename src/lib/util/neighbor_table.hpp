@@ -0,0 +1,78 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DROP_UTIL_NEIGHBOR_TABLE_HPP_
+#define DROP_UTIL_NEIGHBOR_TABLE_HPP_
+
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+#include "mac_address.hpp"
+
+namespace drop {
+
+// Copy of the kernel neighbor (ARP) table, kept up to date by the netlink notifications.
+// Addresses are in network byte order.
+// A lookup that fails leaves a negative entry for neighbor.negative_timeout milliseconds:
+// until it expires the address is reported as being resolved, so the callers solicit the
+// kernel only once for all the routes through the same gateway.
+class NeighborTable
+{
+    struct Entry
+    {
+        tnt::MacAddress mac;
+        bool resolved;
+        std::chrono::steady_clock::time_point expiry; // Of a negative entry.
+    };
+public:
+    enum class Lookup
+    {
+        Resolved,
+        Resolving,
+        Unresolved // The caller should ask the kernel to resolve the address.
+    };
+
+    static NeighborTable& instance();
+
+    Lookup lookup(uint32_t address, tnt::MacAddress& mac);
+
+    // Returns true if the address was not resolved or its MAC changed.
+    bool update(uint32_t address, const tnt::MacAddress& mac);
+    void remove(uint32_t address);
+private:
+    NeighborTable();
+private:
+    std::mutex mutex_;
+    std::unordered_map<uint32_t, Entry> entries_;
+    std::chrono::milliseconds negative_timeout_;
+};
+
+} // namespace drop
+
+#endif
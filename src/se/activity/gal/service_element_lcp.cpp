@@ -92,7 +92,7 @@ void ServiceElementLCP::operator()()
             });
         }
 
-        auto activity = tnt::async([] ()
+        auto activity = tnt::async_activity([] ()
         {
             if (tnt::Configuration::get("use_userspace_forward", false))
             {
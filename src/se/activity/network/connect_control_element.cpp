@@ -80,7 +80,7 @@ void ConnectControlElement::operator()()
             {
                 auto io = ep->get();
 
-                tnt::async([io] ()
+                tnt::async_activity([io] ()
                 {
                     SetupControlElement(factory::create_drop_protocol(io))();
                 });
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <atomic>
 #include <vector>
 #include <iostream>
+#include <mutex>
 
 #include <cstdlib>
 #include <cerrno>
@@ -53,6 +54,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "event/quit.hpp"
 #include "event/network/arp.hpp"
 #include "event/network/toggle_rate.hpp"
+#include "event/network/statistics_request.hpp"
 #include "event/network/interface_list.hpp"
 #include "event/network/routes_management.hpp"
 #include "event/network/forwarding_started.hpp"
@@ -66,6 +68,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "util/hyperapp_interface_lib.hpp"
 #include "util/netmap_interface_lib.hpp"
 #include "util/interfaces.hpp"
+#include "util/ring_counters.hpp"
 
 #include "ip_address.hpp"
 #include "file_descriptor.hpp"
@@ -74,11 +77,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "memory.hpp"
 #include "application.hpp"
 #include "thread.hpp"
+#include "lock.hpp"
 
 namespace drop {
 namespace activity {
 namespace {
 
+const tnt::ConfigKey<int> netmap_entries("netmap.entries");
+const tnt::ConfigKey<bool> stats_enable("forwarding.stats.enable", false);
+const tnt::ConfigKey<int> stats_interval("forwarding.stats.interval", 500);
+
 void set_affinity(std::thread::native_handle_type id, int cpu)
 {
     cpu_set_t cpumask;
@@ -92,9 +100,25 @@ void set_affinity(std::thread::native_handle_type id, int cpu)
 	}
 }
 
+RingStatistics snapshot(const RingCounters& c)
+{
+	return RingStatistics{ c.rx, c.tx, c.short_frame, c.not_ip, c.no_route, c.ttl_expired, c.tx_full, 0, 0 };
+}
+
+double rate(uint_fast64_t diff, std::chrono::milliseconds interval)
+{
+	return static_cast<double>(diff) / static_cast<double>(interval.count()) * static_cast<double>(1000);
+}
+
 } // namespace
 
-Forward::Forward(): table_{ tnt::Configuration::get("netmap.entries").as<int>() } {}
+Forward::Forward(): table_{ netmap_entries.get() }
+{
+	for (const auto& name : forwarding_interfaces())
+	{
+		ports_.push_back(tnt::name_to_index(name));
+	}
+}
 
 Forward::~Forward()
 {
@@ -116,7 +140,7 @@ void Forward::operator()()
 
 		table_.for_each([&] (const auto& p)
 		{
-			event.os() << tnt::ip::Address::from_net_order_ulong(p.first) << "/" << p.second.prefix << " " << tnt::MacAddress(std::string(p.second.dst, 6)) << std::endl;
+			event.os() << tnt::ip::Address::from_net_order_ulong(p.first) << "/" << p.second.prefix << " " << tnt::MacAddress(std::string(p.second.dst, 6)) << " port " << p.second.port << std::endl;
 			++num;
 		});
 
@@ -128,14 +152,43 @@ void Forward::operator()()
 
 	register_handler([this] (const event::AddUserspaceRoute& event)
 	{
-		auto ri = event.route();
+		const auto& ri = event.route();
         const auto& dst = event.mac();
 
-        ri.port_index = tnt::name_to_index(tnt::Configuration::get("netmap.interface").as<std::string>());
-
 		tnt::Log::info(colors::blue, "event::AddUserspaceRoute: ", ri);
 
-        add(ri.destination, ri.prefix, dst);
+        add(ri.destination, ri.prefix, dst, ri.port_index);
+	});
+
+	register_handler([this] (const event::AddUserspaceRoutes& event)
+	{
+		auto routes = event.routes();
+		tnt::Log::info(colors::blue, "event::AddUserspaceRoutes: ", routes.size(), " routes");
+
+		// Most specific routes first: set_range skips the entries of a longer prefix, so each
+		// entry is written once, by the most specific route covering it.
+		std::stable_sort(std::begin(routes), std::end(routes), [] (const auto& a, const auto& b)
+		{
+			return a.first.prefix > b.first.prefix;
+		});
+
+		table_.begin_batch();
+
+		try
+		{
+			for (const auto& r : routes)
+			{
+				add(r.first.destination, r.first.prefix, r.second, r.first.port_index);
+			}
+		}
+		catch (...)
+		{
+			table_.commit();
+
+			throw;
+		}
+
+		table_.commit();
 	});
 
 	register_handler([this] (const event::DelRoute& event)
@@ -153,10 +206,10 @@ void Forward::operator()()
 #endif
 
 	auto n_tasks = lib.num_tasks();
+	table_.check_readers(n_tasks);
 
-	std::atomic_uint_fast64_t rx_packets{ 0 };
-	std::atomic_uint_fast64_t tx_packets{ 0 };
-	std::atomic_uint_fast64_t drop_packets{ 0 };
+	// One block of counters per ring, each written only by the thread of the ring.
+	auto counters = tnt::make_aligned_array<RingCounters>(n_tasks);
 
     std::vector<tnt::Thread> forward_threads;
     forward_threads.reserve(n_tasks);
@@ -165,9 +218,9 @@ void Forward::operator()()
 
 	for (auto i = 0; i < n_tasks; ++i)
 	{
-        forward_threads.emplace_back([&lib, &running, i, &rx_packets, &tx_packets, &drop_packets] ()
+        forward_threads.emplace_back([&lib, &running, i, &counters] ()
         {
-            lib.forward_loop(running, i, rx_packets, tx_packets, drop_packets);
+            lib.forward_loop(running, i, counters[i]);
         });
 	}
 
@@ -195,32 +248,79 @@ void Forward::operator()()
 		show_rate = !show_rate;
 	});
 
+	// Rates of the rings computed by the statistics thread, if enabled.
+	std::mutex rates_mutex;
+	std::vector<RingStatistics> rates;
+
+	register_handler([&] (const event::StatisticsRequest& event)
+	{
+		auto last = tnt::lock(rates_mutex, [&] () { return rates; });
+
+		for (auto i = 0; i < n_tasks; ++i)
+		{
+			auto r = snapshot(counters[i]);
+
+			event.os() << "Ring #" << i << " rx: " << r.rx << " tx: " << r.tx;
+
+			if (static_cast<size_t>(i) < last.size())
+			{
+				event.os() << " (" << last[i].rx_rate << " / " << last[i].tx_rate << " pkts/s)";
+			}
+
+			event.os() << " dropped: short " << r.short_frame << ", not IP " << r.not_ip << ", no route " << r.no_route << ", TTL expired " << r.ttl_expired << ", tx full " << r.tx_full << std::endl;
+		}
+	});
+
     tnt::Thread stats_job;
 
-	if (tnt::Configuration::get("forwarding.stats.enable", false))
+	if (stats_enable.get())
 	{
 		stats_job.start([&] ()
 		{
-			auto stat_interval = tnt::Configuration::get("forwarding.stats.interval", 500);
+			auto stat_interval = stats_interval.get();
 
 			std::this_thread::sleep_for(std::chrono::seconds(7));
 
 			auto prev = std::chrono::steady_clock::now();
-			uint_fast64_t prev_rx = 0;
-			uint_fast64_t prev_tx = 0;
+			std::vector<RingStatistics> prev_rings(n_tasks, RingStatistics());
 			auto prev_show_rate = false;
 
 			while (running)
 			{
-                auto diff_rx =  rx_packets - prev_rx;
-				auto diff_tx =  tx_packets - prev_tx;
+				auto now = std::chrono::steady_clock::now();
+				auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(now - prev);
+
+				std::vector<RingStatistics> rings;
+				rings.reserve(n_tasks);
+
+				uint_fast64_t rx = 0;
+				uint_fast64_t tx = 0;
+				uint_fast64_t dropped = 0;
+				auto rx_rate = 0.0;
+				auto tx_rate = 0.0;
+
+				for (auto i = 0; i < n_tasks; ++i)
+				{
+					auto r = snapshot(counters[i]);
+
+					r.rx_rate = rate(r.rx - prev_rings[i].rx, diff);
+					r.tx_rate = rate(r.tx - prev_rings[i].tx, diff);
 
-				auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - prev);
+					rx += r.rx;
+					tx += r.tx;
+					dropped += counters[i].dropped();
+					rx_rate += r.rx_rate;
+					tx_rate += r.tx_rate;
+
+					rings.push_back(r);
+				}
 
-				auto rx_rate = static_cast<double>(diff_rx) / static_cast<double>(diff.count()) * static_cast<double>(1000);
-				auto tx_rate = static_cast<double>(diff_tx) / static_cast<double>(diff.count()) * static_cast<double>(1000);
+				prev_rings = rings;
+				prev = now;
 
-                tnt::Application::raise(event::StatisticsUpdate(rx_packets, tx_packets, rx_rate, tx_rate));
+				tnt::lock(rates_mutex, [&] () { rates = rings; });
+
+                tnt::Application::raise(event::StatisticsUpdate(rx, tx, rx_rate, tx_rate, std::move(rings)));
 
 				if (show_rate)
 				{
@@ -231,14 +331,9 @@ void Forward::operator()()
 
 					prev_show_rate = true;
 
-					tnt::Log::output(manip::clear, manip::cr, "Rx: ", rx_rate, " pkts/s", manip::tab, "Tx: ", tx_rate, " pkts/s", manip::tab, "Dropped: ", drop_packets.load(), " pkts");
+					tnt::Log::output(manip::clear, manip::cr, "Rx: ", rx_rate, " pkts/s", manip::tab, "Tx: ", tx_rate, " pkts/s", manip::tab, "Dropped: ", dropped, " pkts");
 				}
 
-                prev_rx = rx_packets;
-				prev_tx = tx_packets;
-
-				prev = std::chrono::steady_clock::now();
-
 				std::this_thread::sleep_for(std::chrono::milliseconds(stat_interval));
 			}
 		});
@@ -252,9 +347,18 @@ void Forward::operator()()
 	}
 }
 
-void Forward::add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst)
+void Forward::add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst, uint32_t port_index)
 {
-	table_.add(address, prefix, dst);
+	auto p = port(port_index);
+
+	if (p < 0)
+	{
+		tnt::Log::error("Forward: route to ", tnt::ip::Address::from_net_order_ulong(address), "/", prefix, " on interface ", port_index, " not forwarded by this SE, dropped.");
+
+		return;
+	}
+
+	table_.add(address, prefix, dst, static_cast<uint16_t>(p));
 }
 
 void Forward::del(uint32_t address, uint32_t prefix)
@@ -262,5 +366,17 @@ void Forward::del(uint32_t address, uint32_t prefix)
 	table_.del(address, prefix);
 }
 
+int Forward::port(uint32_t port_index) const
+{
+	auto it = std::find(std::begin(ports_), std::end(ports_), port_index);
+
+	if (it == std::end(ports_))
+	{
+		return -1;
+	}
+
+	return static_cast<int>(std::distance(std::begin(ports_), it));
+}
+
 } // namespace activity
 } // namespace drop
@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <algorithm>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include <atomic>
 
 #include "activity/concurrent_activity.hpp"
@@ -52,11 +53,16 @@ public:
     ~Forward();
 	void operator()();
 private:
-	void add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst);
+	void add(uint32_t address, uint32_t prefix, const tnt::MacAddress& dst, uint32_t port_index);
 	void del(uint32_t address, uint32_t prefix);
+
+	// Forwarder port of the interface with index port_index, -1 if it is not forwarded.
+	// The CE sends the port of network.xml, for this SE the index of the interface.
+	int port(uint32_t port_index) const;
 private:
 	LookupTable table_;
 	InterfaceTable interfaces_;
+	std::vector<uint32_t> ports_; // Interface index of each port.
 };
 
 } // namespace activity
@@ -29,6 +29,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define DROP_EVENT_STATISTICS_UPDATE_HPP_
 
 #include <cstdint>
+#include <vector>
+#include <utility>
+
+#include "util/ring_counters.hpp"
 
 namespace drop {
 namespace event {
@@ -36,18 +40,23 @@ namespace event {
 class StatisticsUpdate
 {
 public:
-    StatisticsUpdate(uint_fast64_t rx, uint_fast64_t tx, double rx_rate, double tx_rate) : rx_(rx), tx_(tx), rx_rate_(rx_rate), tx_rate_(tx_rate) {}
+    StatisticsUpdate(uint_fast64_t rx, uint_fast64_t tx, double rx_rate, double tx_rate, std::vector<RingStatistics> rings = {}) :
+        rx_(rx), tx_(tx), rx_rate_(rx_rate), tx_rate_(tx_rate), rings_(std::move(rings)) {}
 
     uint_fast64_t rx() const { return rx_; }
     uint_fast64_t tx() const { return tx_; }
 
     const double& rx_rate() const { return rx_rate_; }
     const double& tx_rate() const { return tx_rate_; }
+
+    // Per ring breakdown, empty if the forwarder has no rings.
+    const std::vector<RingStatistics>& rings() const { return rings_; }
 private:
     uint_fast64_t rx_;
     uint_fast64_t tx_;
     double rx_rate_;
     double tx_rate_;
+    std::vector<RingStatistics> rings_;
 };
 
 } // namespace event
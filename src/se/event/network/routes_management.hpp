@@ -30,6 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <cstdint>
 #include <string>
+#include <vector>
+#include <utility>
 #include <iosfwd>
 
 #include "event/drop/drop_event.hpp"
@@ -63,6 +65,15 @@ private:
     tnt::MacAddress mac_;
 };
 
+class AddUserspaceRoutes: public DropEvent<AddUserspaceRoutes, protocol::DropMessage::AddUserspaceRoutes, std::vector<std::pair<RouteInfo, tnt::MacAddress>>>
+{
+public:
+    explicit AddUserspaceRoutes(const std::vector<std::pair<RouteInfo, tnt::MacAddress>>& routes): routes_(routes) {}
+    const std::vector<std::pair<RouteInfo, tnt::MacAddress>>& routes() const { return routes_; }
+private:
+    std::vector<std::pair<RouteInfo, tnt::MacAddress>> routes_;
+};
+
 class DelRoute: public DropEvent<DelRoute, protocol::DropMessage::DelRoute, RouteInfo>
 {
 public:
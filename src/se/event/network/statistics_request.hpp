@@ -25,17 +25,25 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
-#ifndef TNT_ARP_CACHE_HPP_
-#define TNT_ARP_CACHE_HPP_
+#ifndef DROP_EVENT_STATISTICS_REQUEST_HPP_
+#define DROP_EVENT_STATISTICS_REQUEST_HPP_
 
-#include <string>
+#include <iosfwd>
 
-#include "mac_address.hpp"
+namespace drop {
+namespace event {
 
-namespace tnt {
+class StatisticsRequest
+{
+public:
+    explicit StatisticsRequest(std::ostream& os): os_( os ) { }
 
-tnt::MacAddress hw_from_arp(const std::string& ip);
+    std::ostream& os() const { return os_; }
+private:
+    std::ostream& os_;
+};
 
-} // namespace tnt 
+} // namespace event
+} // namespace drop
 
 #endif
@@ -35,6 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "event/quit.hpp"
 #include "event/network/routes_management.hpp"
 #include "event/network/toggle_rate.hpp"
+#include "event/network/statistics_request.hpp"
 
 #include "log.hpp"
 #include "manip.hpp"
@@ -63,6 +64,11 @@ void SeParser::init_grammar()
         tnt::Application::raise(event::RouteListRequest(os));
     }));
 
+    grammar_.insert(std::make_pair("stats", [this] (std::ostream& os, const std::string& /*line*/)
+    {
+        tnt::Application::raise(event::StatisticsRequest(os));
+    }));
+
     grammar_.insert(std::make_pair("togglerate", [this] (std::ostream& /*os*/, const std::string& /*line*/)
     {
         tnt::Application::raise(event::ToggleRate());
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "protocol/openflow/openflow_version.hpp"
 
 #include "application.hpp"
+#include "log.hpp"
 
 namespace drop {
 namespace protocol {
@@ -43,5 +44,11 @@ void Openflow::set_features(uint64_t /*datapath_id*/)
     // TODO:
 }
 
+// The SE does not control the switches, their packet-ins are handled by the CE.
+void Openflow::packet_in(uint32_t buffer_id, uint16_t in_port, const char* /*frame*/, size_t size)
+{
+    tnt::Log::debug("Openflow: packet-in (buffer ", buffer_id, ", port ", in_port, ", ", size, " bytes) ignored by the SE.");
+}
+
 } // namespace protocol
 } // namespace drop
@@ -60,6 +60,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "util/path.hpp"
 #include "util/io_factory.hpp"
 
+#include "io/reactor.hpp"
+
 #include "gal_drop/acpi.hpp"
 
 #include "application.hpp"
@@ -90,30 +92,41 @@ int main(int argc, char* argv[])
 
         tnt::Log::level(tnt::Configuration::get("log.level").as<tnt::LogLevel>());
 
-        tnt::async([] ()
+        if (tnt::Configuration::exists("log.file"))
+        {
+            tnt::Log::file(tnt::Configuration::get("log.file").as<std::string>());
+        }
+
+        // The protocols run on a pool of epoll loops instead of two threads each, 0 loops for the default pool.
+        if (tnt::Configuration::exists("io.reactor_loops"))
+        {
+            tnt::io::Reactor::enable(tnt::Configuration::get("io.reactor_loops").as<size_t>());
+        }
+
+        tnt::async_activity([] ()
         {
             drop::parser::SeParser(std::cin, std::cout)();
         });
 
         std::vector<std::future<void>> activities;
 
-        activities.push_back(tnt::async([] ()
+        activities.push_back(tnt::async_activity([] ()
         {
             drop::activity::ServiceElement()();
         }));
 
-        activities.push_back(tnt::async([] ()
+        activities.push_back(tnt::async_activity([] ()
         {
             tnt::activity::HttpServer server;
             server(factory::create_io_end_point("httpd"), "html");
         }));
 
-        activities.push_back(tnt::async([] ()
+        activities.push_back(tnt::async_activity([] ()
         {
             drop::activity::ServiceElementLCP()();
         }));
 
-        activities.push_back(tnt::async([] ()
+        activities.push_back(tnt::async_activity([] ()
         {
             drop::activity::ConnectControlElement()();
         }));
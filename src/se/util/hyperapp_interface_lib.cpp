@@ -92,6 +92,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace drop {
 namespace {
 
+const tnt::ConfigKey<std::string> netmap_interface("netmap.interface");
+const tnt::ConfigKey<unsigned int> netmap_burst("netmap.burst");
+const tnt::ConfigKey<int> netmap_sleep("netmap.sleep");
+
 netmap_ring* netmap_txring(netmap_if* nifp, int index)
 {
 	return reinterpret_cast<netmap_ring*>(reinterpret_cast<char*>(nifp) + nifp->ring_ofs[index]);
@@ -243,7 +247,7 @@ void HyperAppInterfaceLib::forward_loop(std::shared_ptr<char> mem, int ringid, s
 
 	nmreq req = nmreq();
 	req.nr_version = NETMAP_API;
-	auto name = tnt::Configuration::get("netmap.interface").as<std::string>();
+	auto name = netmap_interface.get();
 
 	std::fill_n(req.nr_name, IFNAMSIZ, 0);
 	strncpy(req.nr_name, name.c_str(), sizeof(req.nr_name));
@@ -263,14 +267,14 @@ void HyperAppInterfaceLib::forward_loop(std::shared_ptr<char> mem, int ringid, s
 
 	std::this_thread::sleep_for(std::chrono::seconds(5));
 
-	auto burst = tnt::Configuration::get("netmap.burst").as<unsigned int>();
+	auto burst = netmap_burst.get();
 
 	auto rxring = netmap_rxring(nifp, ringid);
 	auto txring = netmap_txring(nifp, ringid);
 
 	tnt::Log::info(colors::blue, "Ring #", ringid, " up.\n", colors::green, "Starting forwarding on ring #", ringid, " burst size: ", burst);
 	
-	auto sleep_time = tnt::Configuration::get("netmap.sleep").as<int>();
+	auto sleep_time = netmap_sleep.get();
 
 	while (running_)
 	{
@@ -31,22 +31,32 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 #include <iostream>
 
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <unistd.h>
+
 #include "util/crc.hpp"
 #include "util/lookup_table.hpp"
 #include "util/likely_macro.hpp"
 #include "util/configuration.hpp"
+#include "util/string.hpp"
 
 #include "mac_address.hpp"
+#include "log.hpp"
 
 namespace drop {
+namespace {
 
-InterfaceLib::InterfaceLib(LookupTable& table) : table_(table)
-{
-	auto src_str = tnt::MacAddress(tnt::Configuration::get("forwarding.mac").as<std::string>()).raw();
-	std::copy_n(src_str.c_str(), 6, src_);
-}
+const tnt::ConfigKey<std::string> netmap_interface("netmap.interface");
+const tnt::ConfigKey<std::string> forwarding_mac("forwarding.mac");
 
-bool InterfaceLib::forward_packet(uint8_t* pkt)
+// Offset of the ethertype after the VLAN tags if the packet is IP, 0 otherwise.
+int ip_offset(const uint8_t* pkt)
 {
 	auto offset = 12;
 
@@ -60,22 +70,203 @@ bool InterfaceLib::forward_packet(uint8_t* pkt)
 		}
 	}
 
-	if (LIKELY(pkt[offset] == 0x08 && pkt[offset + 1] == 0x00)) // IP packet
+	return LIKELY(pkt[offset] == 0x08 && pkt[offset + 1] == 0x00) ? offset : 0;
+}
+
+uint32_t ip_destination(const uint8_t* pkt, int offset)
+{
+	return *reinterpret_cast<const uint32_t*>(pkt + offset + 18);
+}
+
+// The hardware address of the interface, empty if it cannot be read.
+tnt::MacAddress hardware_address(const std::string& name)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (fd < 0)
+	{
+		return tnt::MacAddress();
+	}
+
+	ifreq ifr = ifreq();
+	strncpy(ifr.ifr_name, name.c_str(), sizeof(ifr.ifr_name) - 1);
+
+	auto error = ioctl(fd, SIOCGIFHWADDR, &ifr);
+	auto err = errno;
+	close(fd);
+
+	if (error)
+	{
+		tnt::Log::warning("InterfaceLib: cannot get the MAC of ", name, " (", std::strerror(err), "), using forwarding.mac.");
+
+		return tnt::MacAddress();
+	}
+
+	return tnt::MacAddress(std::string(ifr.ifr_hwaddr.sa_data, 6));
+}
+
+// The MAC of each forwarding interface, forwarding.mac for the ones without one.
+std::vector<tnt::MacAddress> interface_macs()
+{
+	std::vector<tnt::MacAddress> macs;
+
+	for (const auto& name : forwarding_interfaces())
+	{
+		auto mac = hardware_address(name);
+		macs.push_back(mac.empty() ? tnt::MacAddress(forwarding_mac.get()) : mac);
+	}
+
+	return macs;
+}
+
+} // namespace
+
+std::vector<std::string> forwarding_interfaces()
+{
+	std::vector<std::string> names;
+
+	for (const auto& name : tnt::split(netmap_interface.get(), ", "))
+	{
+		if (!name.empty())
+		{
+			names.push_back(name);
+		}
+	}
+
+	return names;
+}
+
+const unsigned int InterfaceLib::max_burst;
+const uint16_t InterfaceLib::no_port;
+
+InterfaceLib::InterfaceLib(LookupTable& table) : InterfaceLib(table, interface_macs()) {}
+
+InterfaceLib::InterfaceLib(LookupTable& table, const std::vector<tnt::MacAddress>& src) : table_(table), src_(src.size())
+{
+	for (auto p = 0u; p < src.size(); ++p)
+	{
+		auto raw = src[p].raw();
+		std::copy_n(raw.c_str(), 6, src_[p].data());
+	}
+}
+
+void InterfaceLib::online(int ringid)
+{
+	table_.readers().online(ringid);
+}
+
+void InterfaceLib::offline(int ringid)
+{
+	table_.readers().offline(ringid);
+}
+
+void InterfaceLib::quiescent(int ringid)
+{
+	table_.readers().quiescent(ringid);
+}
+
+bool InterfaceLib::forward_packet(uint8_t* pkt)
+{
+	auto offset = ip_offset(pkt);
+
+	if (LIKELY(offset != 0))
 	{
-		const auto& node = table_.lookup(*reinterpret_cast<uint32_t*>(pkt + offset + 18));
+		const auto& node = table_.lookup(ip_destination(pkt, offset));
 
-		return LIKELY(!node.def && modify_packet(pkt, node.dst, offset));
+		return LIKELY(!node.def && modify_packet(pkt, node.dst, node.port, offset));
 	}
 
 	return false;
 }
 
-bool InterfaceLib::modify_packet(uint8_t* pkt, const char* dst, int offset)
+unsigned int InterfaceLib::forward_burst(uint8_t* const* pkts, unsigned int n, uint16_t* egress, RingCounters& counters)
 {
+	assert(n <= max_burst);
+
+	int offsets[max_burst];
+	const LookupTable::LookupNode* nodes[max_burst];
+
+	for (auto i = 0u; i < n; ++i)
+	{
+		if (LIKELY(pkts[i] != nullptr))
+		{
+			__builtin_prefetch(pkts[i], 1);
+		}
+	}
+
+	for (auto i = 0u; i < n; ++i)
+	{
+		offsets[i] = LIKELY(pkts[i] != nullptr) ? ip_offset(pkts[i]) : 0;
+
+		if (LIKELY(offsets[i] != 0))
+		{
+			table_.prefetch(ip_destination(pkts[i], offsets[i]));
+		}
+	}
+
+	for (auto i = 0u; i < n; ++i)
+	{
+		nodes[i] = nullptr;
+
+		if (LIKELY(offsets[i] != 0))
+		{
+			const auto& node = table_.lookup(ip_destination(pkts[i], offsets[i]));
+
+			if (LIKELY(!node.def))
+			{
+				nodes[i] = &node;
+			}
+		}
+	}
+
+	auto sent = 0u;
+	auto not_ip = 0u;
+	auto no_route = 0u;
+	auto ttl_expired = 0u;
+
+	for (auto i = 0u; i < n; ++i)
+	{
+		egress[i] = no_port;
+
+		if (UNLIKELY(nodes[i] == nullptr))
+		{
+			if (pkts[i] != nullptr)
+			{
+				++(offsets[i] == 0 ? not_ip : no_route);
+			}
+		}
+		else if (LIKELY(modify_packet(pkts[i], nodes[i]->dst, nodes[i]->port, offsets[i])))
+		{
+			egress[i] = nodes[i]->port;
+			++sent;
+		}
+		else
+		{
+			++ttl_expired;
+		}
+	}
+
+	if (UNLIKELY(not_ip + no_route + ttl_expired > 0))
+	{
+		increment(counters.not_ip, not_ip);
+		increment(counters.no_route, no_route);
+		increment(counters.ttl_expired, ttl_expired);
+	}
+
+	return sent;
+}
+
+// Forward only adds routes to the forwarding interfaces, port is always an index of src_.
+bool InterfaceLib::modify_packet(uint8_t* pkt, const char* dst, uint16_t port, int offset)
+{
+	assert(port < src_.size());
+
 	std::copy_n(dst, 6, pkt);
-	std::copy_n(src_, 6, pkt + 6);
+	std::copy_n(src_[port].data(), 6, pkt + 6);
 
 	auto ttl = reinterpret_cast<uint8_t*>(pkt + offset + 10);
+	auto ttl_word = reinterpret_cast<uint16_t*>(pkt + offset + 10); // TTL and protocol
+	auto old_word = *ttl_word;
 
 	--(*ttl); // Decrement TTL
 
@@ -84,11 +275,9 @@ bool InterfaceLib::modify_packet(uint8_t* pkt, const char* dst, int offset)
 		return false;
 	}
 
+	// Only the TTL changed, adjust the checksum instead of computing it again over the whole header.
 	auto cs = reinterpret_cast<uint16_t*>(pkt + offset + 12); // Checksum
-	*cs = 0;
-
-	auto ip_words = *reinterpret_cast<const uint8_t*>(pkt + offset + 2) & 0x0f; // Take the low order 4 bits.
-	*cs = tnt::crc16(pkt + offset + 2, ip_words * 4);
+	*cs = tnt::crc16_update(*cs, old_word, *ttl_word);
 
 	return true;
 }
@@ -29,26 +29,54 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define DROP_INTERFACE_LIB_HPP_
 
 #include <atomic>
+#include <array>
+#include <vector>
+#include <string>
 #include <cstdint>
 
+#include "mac_address_fwd.hpp"
+
+#include "ring_counters.hpp"
+
 namespace drop { 
 
 class LookupTable;
 
+// The interfaces of the forwarder, in port order (netmap.interface, separated by spaces or commas).
+std::vector<std::string> forwarding_interfaces();
+
 class InterfaceLib
 {
 public:
+	// Upper bound of the packets handled by forward_burst (netmap.burst).
+	static const unsigned int max_burst = 256;
+
+	// Egress port of the packets that are not forwarded.
+	static const uint16_t no_port = 0xffff;
+
 	explicit InterfaceLib(LookupTable& table);
+	// src[p] is the source MAC of the packets sent to port p.
+	InterfaceLib(LookupTable& table, const std::vector<tnt::MacAddress>& src);
 	virtual ~InterfaceLib() {}
 
 	virtual int num_tasks() const = 0;
-	virtual void forward_loop(std::atomic_bool& running, int ringid, std::atomic_uint_fast64_t& rx, std::atomic_uint_fast64_t& tx, std::atomic_uint_fast64_t& drop) = 0;
+	virtual void forward_loop(std::atomic_bool& running, int ringid, RingCounters& counters) = 0;
 protected:
+	void online(int ringid);
+	void offline(int ringid);
+	void quiescent(int ringid);
+
 	bool forward_packet(uint8_t* pkt);
-	bool modify_packet(uint8_t* pkt, const char* dst, int offset);
+
+	// Forwards n packets in stages (prefetch the headers, parse them and prefetch the table entries,
+	// lookup, rewrite), so the memory latency of a packet is hidden by the work on the others.
+	// Null packets are skipped. egress[i] is the port pkts[i] must be sent to (no_port if dropped),
+	// the number sent is returned. The packets dropped are counted by cause in counters.
+	unsigned int forward_burst(uint8_t* const* pkts, unsigned int n, uint16_t* egress, RingCounters& counters);
+	bool modify_packet(uint8_t* pkt, const char* dst, uint16_t port, int offset);
 private:
 	LookupTable& table_;
-	char src_[6];
+	std::vector<std::array<char, 6>> src_; // By egress port, as forwarding_interfaces().
 };
 
 } // namespace drop
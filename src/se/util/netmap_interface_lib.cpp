@@ -31,11 +31,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
 #include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <limits>
 
 #include <cstdlib>
 #include <cerrno>
 #include <cstring>
 #include <cstdint>
+#include <cassert>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -73,6 +78,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace drop {
 namespace {
 
+const tnt::ConfigKey<unsigned int> netmap_burst("netmap.burst");
+const tnt::ConfigKey<unsigned int> netmap_init_wait("netmap.init_wait");
+const tnt::ConfigKey<bool> netmap_poll("netmap.poll", false);
+const tnt::ConfigKey<int> netmap_idle_budget("netmap.idle_budget", 1000);
+const tnt::ConfigKey<int> netmap_flush_deadline("netmap.flush_deadline", 50);
+const tnt::ConfigKey<int> netmap_poll_timeout("netmap.poll_timeout", 100);
+
 netmap_ring* netmap_txring(netmap_if* nifp, int index)
 {
 	return reinterpret_cast<netmap_ring*>(reinterpret_cast<char*>(nifp) + nifp->ring_ofs[index]);
@@ -93,6 +105,14 @@ char* netmap_buf(netmap_ring* r, uint32_t i)
 	return reinterpret_cast<char*>(r) + r->buf_ofs + i * r->nr_buf_size;
 }
 
+// Spin wait hint, it lets the sibling hyperthread run and saves power while busy polling.
+void cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#endif
+}
+
 int nm_do_ioctl(const std::string& ifname, uint32_t& if_flags, int what, int subcmd)
 {
 	int fd = socket(AF_INET, SOCK_DGRAM, 0);
@@ -151,14 +171,24 @@ int nm_do_ioctl(const std::string& ifname, uint32_t& if_flags, int what, int sub
 
 } // namespace
 
-NetmapInterfaceLib::NetmapInterfaceLib(LookupTable& table) : InterfaceLib(table), if_flags_(0), num_tasks_(0)
+// The burst is at least 1, with 0 the forwarding loop would never move a packet.
+NetmapInterfaceLib::NetmapInterfaceLib(LookupTable& table) : InterfaceLib(table), num_tasks_(0),
+	burst_(std::max(1u, std::min(netmap_burst.get(), max_burst)))
 {
 	acquire();
 }
 
+NetmapInterfaceLib::NetmapInterfaceLib(LookupTable& table, const std::vector<tnt::MacAddress>& src, unsigned int burst) : InterfaceLib(table, src), num_tasks_(1),
+	burst_(std::max(1u, std::min(burst, max_burst)))
+{
+}
+
 NetmapInterfaceLib::~NetmapInterfaceLib()
 {
-	release();
+	if (mem_)
+	{
+		release();
+	}
 }
 
 int NetmapInterfaceLib::num_tasks() const
@@ -177,25 +207,47 @@ void NetmapInterfaceLib::acquire()
 		throw NetmapException(std::strerror(errno));
 	}
 
-	auto req = nmreq();
-	req.nr_version = NETMAP_API;
-	auto name = tnt::Configuration::get("netmap.interface").as<std::string>();
+	names_ = forwarding_interfaces();
+
+	if (names_.empty() || names_.size() >= no_port)
+	{
+		throw NetmapException("Wrong number of interfaces in netmap.interface");
+	}
+
+	uint32_t memsize = 0;
+	num_tasks_ = std::numeric_limits<int>::max();
+
+	for (const auto& name : names_)
+	{
+		auto req = nmreq();
+		req.nr_version = NETMAP_API;
 
-	std::fill_n(req.nr_name, IFNAMSIZ, 0);
-	strncpy(req.nr_name, name.c_str(), sizeof(req.nr_name));
+		std::fill_n(req.nr_name, IFNAMSIZ, 0);
+		strncpy(req.nr_name, name.c_str(), sizeof(req.nr_name));
 
-	req.nr_ringid = 0;
+		req.nr_ringid = 0;
 	
-	int err = ioctl(*fd, NIOCGINFO, &req);
+		int err = ioctl(*fd, NIOCGINFO, &req);
 
-	if (err != 0)
-	{
-		tnt::Log::error("NetmapInterfaceLib::run: Cannot get info on ", name, " (", std::strerror(errno), ")");
+		if (err != 0)
+		{
+			tnt::Log::error("NetmapInterfaceLib::run: Cannot get info on ", name, " (", std::strerror(errno), ")");
 
-		throw NetmapException(std::strerror(errno));
+			throw NetmapException(std::strerror(errno));
+		}
+
+		// The buffers are swapped between the rings of different ports: they must be in the same region.
+		if (memsize != 0 && req.nr_memsize != memsize)
+		{
+			throw NetmapException(name + " does not share the netmap memory region of " + names_.front());
+		}
+
+		memsize = req.nr_memsize;
+
+		// Ring i of every port is served by the thread i.
+		num_tasks_ = std::min<int>(num_tasks_, std::min(req.nr_rx_rings, req.nr_tx_rings));
 	}
 
-	auto memsize = req.nr_memsize;
 	mem_ = std::shared_ptr<char>(reinterpret_cast<char*>(mmap(0, memsize, PROT_WRITE | PROT_READ, MAP_SHARED, *fd, 0)), [=](char* ptr) { if (ptr && ptr != MAP_FAILED) munmap(ptr, memsize); });
 
 	if (mem_.get() == MAP_FAILED)
@@ -206,124 +258,249 @@ void NetmapInterfaceLib::acquire()
 		throw NetmapException(std::strerror(errno));
 	}
 
-	if_flags_ = 0;
-
-	nm_do_ioctl(name, if_flags_, SIOCGIFFLAGS, 0);
+	if_flags_.assign(names_.size(), 0);
 
-	if ((if_flags_ & IFF_UP) == 0)
+	for (auto p = 0u; p < names_.size(); ++p)
 	{
-		if_flags_ |= IFF_UP;
-	}
+		const auto& name = names_[p];
+		auto& if_flags = if_flags_[p];
 
-	if_flags_ |= IFF_PPROMISC;
-	nm_do_ioctl(name, if_flags_, SIOCSIFFLAGS, 0);
+		nm_do_ioctl(name, if_flags, SIOCGIFFLAGS, 0);
+
+		if ((if_flags & IFF_UP) == 0)
+		{
+			if_flags |= IFF_UP;
+		}
 
-	nm_do_ioctl(name, if_flags_, SIOCETHTOOL, ETHTOOL_SGSO);
-	nm_do_ioctl(name, if_flags_, SIOCETHTOOL, ETHTOOL_STSO);
-	nm_do_ioctl(name, if_flags_, SIOCETHTOOL, ETHTOOL_SRXCSUM);
-	nm_do_ioctl(name, if_flags_, SIOCETHTOOL, ETHTOOL_STXCSUM);
+		if_flags |= IFF_PPROMISC;
+		nm_do_ioctl(name, if_flags, SIOCSIFFLAGS, 0);
 
-	num_tasks_ = req.nr_rx_rings;
+		nm_do_ioctl(name, if_flags, SIOCETHTOOL, ETHTOOL_SGSO);
+		nm_do_ioctl(name, if_flags, SIOCETHTOOL, ETHTOOL_STSO);
+		nm_do_ioctl(name, if_flags, SIOCETHTOOL, ETHTOOL_SRXCSUM);
+		nm_do_ioctl(name, if_flags, SIOCETHTOOL, ETHTOOL_STXCSUM);
+	}
 }
 
 void NetmapInterfaceLib::release()
 {
-	if_flags_ &= ~IFF_PPROMISC;
-	nm_do_ioctl(tnt::Configuration::get("netmap.interface").as<std::string>(), if_flags_, SIOCSIFFLAGS, 0);
+	for (auto p = 0u; p < names_.size(); ++p)
+	{
+		if_flags_[p] &= ~IFF_PPROMISC;
+		nm_do_ioctl(names_[p], if_flags_[p], SIOCSIFFLAGS, 0);
+	}
 }
 
-void NetmapInterfaceLib::forward_loop(std::atomic_bool& running, int ringid, std::atomic_uint_fast64_t& rx, std::atomic_uint_fast64_t& tx, std::atomic_uint_fast64_t& drop)
+void NetmapInterfaceLib::forward_loop(std::atomic_bool& running, int ringid, RingCounters& counters)
 {
-	tnt::FileDescriptor fd("/dev/netmap", O_RDWR);
+	std::vector<tnt::FileDescriptor> fds;
+	std::vector<netmap_ring*> rxrings;
+	std::vector<netmap_ring*> txrings;
+	std::vector<pollfd> pfds;
 
-	if (*fd < 0)
+	// The thread owns the ring ringid of every port, so a packet can be sent to any port without locking.
+	for (const auto& name : names_)
 	{
-		tnt::Log::error("NetmapInterfaceLib::forward_loop: ", std::strerror(errno));
+		tnt::FileDescriptor fd("/dev/netmap", O_RDWR);
 
-		return;
-	}
+		if (*fd < 0)
+		{
+			tnt::Log::error("NetmapInterfaceLib::forward_loop: ", std::strerror(errno));
 
-	auto req = nmreq();
-	req.nr_version = NETMAP_API;
-	auto name = tnt::Configuration::get("netmap.interface").as<std::string>();
+			return;
+		}
 
-	std::fill_n(req.nr_name, IFNAMSIZ, 0);
-	strncpy(req.nr_name, name.c_str(), sizeof(req.nr_name));
+		auto req = nmreq();
+		req.nr_version = NETMAP_API;
 
-	req.nr_ringid = NETMAP_HW_RING + ringid;
+		std::fill_n(req.nr_name, IFNAMSIZ, 0);
+		strncpy(req.nr_name, name.c_str(), sizeof(req.nr_name));
 
-	int err = ioctl(*fd, NIOCREGIF, &req);
+		req.nr_ringid = NETMAP_HW_RING + ringid;
 
-	if (err != 0)
-	{
-		tnt::Log::error("NetmapInterfaceLib::forward_loop (ring id = ", ringid, "): Unable to register ", name, " (", std::strerror(errno), ")");
+		int err = ioctl(*fd, NIOCREGIF, &req);
 
-		return;
-	}
+		if (err != 0)
+		{
+			tnt::Log::error("NetmapInterfaceLib::forward_loop (ring id = ", ringid, "): Unable to register ", name, " (", std::strerror(errno), ")");
+
+			return;
+		}
+
+		auto nifp = reinterpret_cast<netmap_if*>(mem_.get() + req.nr_offset);
 
-	auto nifp = reinterpret_cast<netmap_if*>(mem_.get() + req.nr_offset);
+		rxrings.push_back(netmap_rxring(nifp, ringid));
+		txrings.push_back(netmap_txring(nifp, ringid));
+		pfds.push_back(pollfd{ *fd, POLLIN, 0 });
 
-    std::this_thread::sleep_for(std::chrono::seconds(tnt::Configuration::get("netmap.init_wait").as<unsigned int>()));
+		fds.push_back(std::move(fd));
+	}
 
-	auto burst = tnt::Configuration::get("netmap.burst").as<unsigned int>();
+	auto n_ports = static_cast<int>(fds.size());
 
-	auto rxring = netmap_rxring(nifp, ringid);
-	auto txring = netmap_txring(nifp, ringid);
+    std::this_thread::sleep_for(std::chrono::seconds(netmap_init_wait.get()));
 
     tnt::Log::info(colors::green, "Ring #", ringid, " up.");
+
+	// Busy poll while there is traffic. With netmap.poll, after idle_budget without packets the thread
+	// sleeps in poll() until the next one. A partial burst is forwarded after flush_deadline.
+	auto use_poll = netmap_poll.get();
+	auto idle_budget = std::chrono::microseconds(netmap_idle_budget.get());
+	auto flush_deadline = std::chrono::microseconds(netmap_flush_deadline.get());
+	auto poll_timeout = netmap_poll_timeout.get(); // ms, bounds the time to notice running is false.
+
+	auto last_traffic = std::chrono::steady_clock::now();
+	auto partial_since = last_traffic;
+	auto partial = false;
+
+	online(ringid);
 	
 	while (running)
 	{
-		ioctl(*fd, NIOCRXSYNC, nullptr);
+		auto avail = 0u;
 
-		if (rxring->avail < burst)
+		for (auto p = 0; p < n_ports; ++p)
 		{
-            std::this_thread::sleep_for(std::chrono::nanoseconds(1));
+			ioctl(*fds[p], NIOCRXSYNC, nullptr);
+			avail += rxrings[p]->avail;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+
+		if (avail > 0 && avail < burst_ && !partial)
+		{
+			partial = true;
+			partial_since = now;
+		}
+
+		if (avail >= burst_ || (avail > 0 && now - partial_since >= flush_deadline))
+		{
+			process_rings(rxrings.data(), txrings.data(), n_ports, counters);
+
+			for (auto p = 0; p < n_ports; ++p)
+			{
+				ioctl(*fds[p], NIOCTXSYNC, nullptr);
+			}
+
+			quiescent(ringid); // No reference to the lookup table is held between bursts.
+
+			partial = false;
+			last_traffic = now;
 
 			continue;
 		}
 
-		process_rings(rxring, txring, rx, tx, drop);
-		ioctl(*fd, NIOCTXSYNC, nullptr);
+		quiescent(ringid);
+
+		if (avail > 0 || !use_poll || now - last_traffic < idle_budget)
+		{
+			cpu_relax();
+
+			continue;
+		}
+
+		// Idle: the writers of the lookup table must not wait for this ring while it sleeps.
+		offline(ringid);
+
+		if (poll(pfds.data(), pfds.size(), poll_timeout) > 0)
+		{
+			last_traffic = std::chrono::steady_clock::now();
+		}
+
+		online(ringid);
 	}
 
-	ioctl(*fd, NIOCUNREGIF, nullptr);
+	offline(ringid);
+
+	for (const auto& fd : fds)
+	{
+		ioctl(*fd, NIOCUNREGIF, nullptr);
+	}
 
 	tnt::Log::info(colors::blue, "Interface up: exiting forwarding loop on ring #", ringid);
 }
 
-void NetmapInterfaceLib::process_rings(netmap_ring* rxring, netmap_ring* txring, std::atomic_uint_fast64_t& rx, std::atomic_uint_fast64_t& tx, std::atomic_uint_fast64_t& drop)
+void NetmapInterfaceLib::process_rings(netmap_ring* const* rxrings, netmap_ring* const* txrings, int n_ports, RingCounters& counters)
 {
-	auto j = rxring->cur;
-	auto k = txring->cur;
+	uint8_t* pkts[max_burst];
+	uint16_t egress[max_burst];
+	uint32_t slots[max_burst];
 
-	auto limit = rxring->avail;
-	rx += limit;
+	uint_fast64_t rx = 0;
+	uint_fast64_t tx = 0;
+	auto short_frame = 0u;
+	auto tx_full = 0u;
 
-	if (txring->avail < limit)
+	for (auto p = 0; p < n_ports; ++p)
 	{
-		limit = txring->avail;
-	}
+		auto rxring = rxrings[p];
 
-	auto m = limit;
+		auto j = rxring->cur;
+		auto limit = rxring->avail;
 
-	while (limit-- > 0)
-	{
-		auto& rs = rxring->slot[j];
-		auto& ts = txring->slot[k];
+		rx += limit;
 
-		if (ts.buf_idx < 2 || rs.buf_idx < 2)
+		while (limit > 0)
 		{
-			tnt::Log::info(colors::red, "Wrong index rx[", j, "] = ", rs.buf_idx, " -> tx[", k, "] = ", ts.buf_idx);
-			std::this_thread::sleep_for(std::chrono::seconds(1));
-		}
+			auto n = std::min(limit, burst_);
 
-		if (LIKELY(rs.len > 34 && rs.len < 2048)) // Not an IP packet if rs.len < 34.
-		{
-			auto pkt = reinterpret_cast<uint8_t*>(netmap_buf(rxring, rs.buf_idx));
+			for (auto i = 0u; i < n; ++i)
+			{
+				auto& rs = rxring->slot[j];
+
+				if (rs.buf_idx < 2)
+				{
+					tnt::Log::info(colors::red, "Wrong index rx[", j, "] = ", rs.buf_idx);
+					std::this_thread::sleep_for(std::chrono::seconds(1));
+				}
+
+				slots[i] = j;
+
+				if (LIKELY(rs.len > 34 && rs.len < 2048)) // Not an IP packet if rs.len < 34.
+				{
+					pkts[i] = reinterpret_cast<uint8_t*>(netmap_buf(rxring, rs.buf_idx));
+				}
+				else
+				{
+					pkts[i] = nullptr;
+					++short_frame;
+				}
+
+				j = netmap_ring_next_slot(rxring, j);
+			}
+
+			forward_burst(pkts, n, egress, counters);
 
-			if (LIKELY(forward_packet(pkt)))
+			for (auto i = 0u; i < n; ++i)
 			{
+				if (egress[i] == no_port)
+				{
+					continue;
+				}
+
+				assert(egress[i] < n_ports);
+
+				auto txring = txrings[egress[i]];
+
+				if (UNLIKELY(txring->avail == 0))
+				{
+					++tx_full;
+
+					continue;
+				}
+
+				auto k = txring->cur;
+
+				auto& rs = rxring->slot[slots[i]];
+				auto& ts = txring->slot[k];
+
+				if (ts.buf_idx < 2)
+				{
+					tnt::Log::info(colors::red, "Wrong index rx[", slots[i], "] = ", rs.buf_idx, " -> tx[", k, "] = ", ts.buf_idx);
+					std::this_thread::sleep_for(std::chrono::seconds(1));
+				}
+
+				// All the ports share the netmap memory region, the buffer index is valid on any ring.
 				std::swap(ts.buf_idx, rs.buf_idx);
 
 				ts.len = rs.len;
@@ -331,26 +508,26 @@ void NetmapInterfaceLib::process_rings(netmap_ring* rxring, netmap_ring* txring,
 				ts.flags |= NS_BUF_CHANGED;
 				rs.flags |= NS_BUF_CHANGED;
 
+				txring->cur = netmap_ring_next_slot(txring, k);
+				--txring->avail;
 				++tx;
-				k = netmap_ring_next_slot(txring, k);
-				txring->cur = k;
-				txring->avail--;
-			}
-			else
-			{
-				++drop;
 			}
-		}
-		else
-		{
-			++drop;
+
+			limit -= n;
 		}
 
-		j = netmap_ring_next_slot(rxring, j);
+		rxring->cur = j;
+		rxring->avail = 0;
 	}
 
-	rxring->avail -= m;
-	rxring->cur = j;
+	increment(counters.rx, rx);
+	increment(counters.tx, tx);
+
+	if (UNLIKELY(short_frame + tx_full > 0))
+	{
+		increment(counters.short_frame, short_frame);
+		increment(counters.tx_full, tx_full);
+	}
 }
 
 } // namespace drop
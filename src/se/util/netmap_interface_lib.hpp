@@ -32,6 +32,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <cstdint>
 #include <memory>
+#include <vector>
+#include <string>
 
 #include <stdexcept>
 #include <system_error>
@@ -57,16 +59,22 @@ public:
 	virtual ~NetmapInterfaceLib() override;
 
 	virtual int num_tasks() const override;
-	virtual void forward_loop(std::atomic_bool& running, int ringid, std::atomic_uint_fast64_t& rx, std::atomic_uint_fast64_t& tx, std::atomic_uint_fast64_t& drop) override;
+	virtual void forward_loop(std::atomic_bool& running, int ringid, RingCounters& counters) override;
+protected:
+	// Does not open the netmap device: used to run process_rings on rings in memory, src is the MAC of each port.
+	NetmapInterfaceLib(LookupTable& table, const std::vector<tnt::MacAddress>& src, unsigned int burst);
+
+	// Forwards the packets received on the rx rings to the tx rings of their egress ports (one ring per port).
+	void process_rings(netmap_ring* const* rxrings, netmap_ring* const* txrings, int n_ports, RingCounters& counters);
 private:
 	void acquire();
 	void release();
-
-	void process_rings(netmap_ring* rxring, netmap_ring* txring, std::atomic_uint_fast64_t& rx, std::atomic_uint_fast64_t& tx, std::atomic_uint_fast64_t& drop);
 private:
-	uint32_t if_flags_;
+	std::vector<std::string> names_; // The ports.
+	std::vector<uint32_t> if_flags_;
 	std::shared_ptr<char> mem_;
 	int num_tasks_;
+	unsigned int burst_;
 };
 
 } // namespace drop
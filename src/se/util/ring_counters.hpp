@@ -0,0 +1,82 @@
+
+/*
+
+Copyright (c) 2013, Sergio Mangialardi (sergio@reti.dist.unige.it)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list 
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this 
+list of conditions and the following disclaimer in the documentation and/or 
+other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DROP_RING_COUNTERS_HPP_
+#define DROP_RING_COUNTERS_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace drop {
+
+// Packet counters of a forwarding ring. Each ring has its own cache line, written only by
+// the thread of the ring (no locked instruction) and read by the statistics thread.
+struct alignas(64) RingCounters
+{
+	RingCounters() : rx(0), tx(0), short_frame(0), not_ip(0), no_route(0), ttl_expired(0), tx_full(0) {}
+
+	uint_fast64_t dropped() const
+	{
+		return short_frame + not_ip + no_route + ttl_expired + tx_full;
+	}
+
+	std::atomic_uint_fast64_t rx;
+	std::atomic_uint_fast64_t tx;
+
+	// Drops, by cause.
+	std::atomic_uint_fast64_t short_frame;
+	std::atomic_uint_fast64_t not_ip;
+	std::atomic_uint_fast64_t no_route;
+	std::atomic_uint_fast64_t ttl_expired;
+	std::atomic_uint_fast64_t tx_full;
+};
+
+// Increment of a counter with a single writer: a plain load and store instead of a locked add.
+inline void increment(std::atomic_uint_fast64_t& counter, uint_fast64_t n = 1)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// A copy of the counters of a ring, with the rates since the previous copy.
+struct RingStatistics
+{
+	uint_fast64_t rx;
+	uint_fast64_t tx;
+
+	uint_fast64_t short_frame;
+	uint_fast64_t not_ip;
+	uint_fast64_t no_route;
+	uint_fast64_t ttl_expired;
+	uint_fast64_t tx_full;
+
+	double rx_rate;
+	double tx_rate;
+};
+
+} // namespace drop
+
+#endif
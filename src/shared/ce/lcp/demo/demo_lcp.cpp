@@ -602,7 +602,7 @@ void DemoLCP::run()
 
     tnt::Application::raise(event::LCPTaskStarted());
 
-    auto activity = tnt::async([] ()
+    auto activity = tnt::async_activity([] ()
     {
         if (tnt::Configuration::exists("lcp.sync"))
         {
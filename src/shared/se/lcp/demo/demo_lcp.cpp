@@ -398,7 +398,7 @@ void DemoLCP::run()
         change_slot(event.num());
     });
 
-    auto activity = tnt::async([] ()
+    auto activity = tnt::async_activity([] ()
     {
         if (tnt::Configuration::exists("lcp.sync"))
         {
@@ -0,0 +1,175 @@
+/*
+ * benchmark the Application event dispatchers
+ *
+ * Producer threads raise events, each with its own source, to one subscriber without a
+ * source which checks that the events of every source arrive in order. A second
+ * subscriber unsubscribes itself from its handler. Prints the events per second from
+ * the first raise to the last delivery; an optional busy loop in the handler stands for
+ * a slow subscriber.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib \
+ *       test_application_events.cpp ../framework/common/application.cpp ../framework/common/quiescent_state.cpp \
+ *       ../framework/common/executor.cpp ../framework/common/memory_pool.cpp ../framework/activity/activity_from_event.cpp \
+ *       ../framework/util/system.cpp ../framework/common/log.cpp \
+ *       ../framework/common/colors.cpp ../framework/common/demangle.cpp ../framework/exception/exception.cpp \
+ *       -o test_application_events -lpthread
+ *
+ * Usage: test_application_events [producers] [events per producer] [dispatchers] [handler ns]
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+
+#include "application.hpp"
+
+namespace {
+
+struct Ping
+{
+    uint32_t producer;
+    uint32_t seq;
+};
+
+struct Once {};
+
+// Each on its own cache line, the sources are checked by different dispatchers.
+struct Source
+{
+    uint32_t next = 0;
+    bool ordered = true;
+    char pad[64];
+};
+
+void busy(std::chrono::nanoseconds duration)
+{
+    auto end = std::chrono::steady_clock::now() + duration;
+
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto producers = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 8;
+    auto count = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 200000;
+    auto dispatchers = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 0;
+    auto work = std::chrono::nanoseconds(argc > 4 ? std::atoi(argv[4]) : 0);
+
+    if (dispatchers > 0)
+    {
+        tnt::Application::set_dispatchers(dispatchers);
+    }
+
+    std::vector<Source> sources(producers);
+    std::atomic<uint64_t> delivered{ 0 };
+    std::promise<void> done;
+    uint64_t total = static_cast<uint64_t>(producers) * count;
+
+    tnt::Application::subscribe([&] (const Ping& ping)
+    {
+        auto& source = sources[ping.producer];
+        source.ordered &= ping.seq == source.next++;
+
+        if (work.count() > 0)
+        {
+            busy(work);
+        }
+
+        if (delivered.fetch_add(1) + 1 == total)
+        {
+            done.set_value();
+        }
+    });
+
+    std::atomic<int> once_calls{ 0 };
+    tnt::Application::Token once;
+    std::promise<void> once_done;
+    std::promise<void> again;
+
+    once = tnt::Application::subscribe([&] (const Once& /*event*/)
+    {
+        if (once_calls.fetch_add(1) == 0)
+        {
+            tnt::Application::unsubscribe(once);
+            once_done.set_value();
+        }
+    });
+
+    auto seen = 0;
+
+    tnt::Application::subscribe([&] (const Once& /*event*/)
+    {
+        if (++seen == 2)
+        {
+            again.set_value();
+        }
+    });
+
+    tnt::Application::run_async();
+
+    tnt::Application::raise(Once());
+    once_done.get_future().wait();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+
+    for (uint32_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&sources, p, count] ()
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                tnt::Application::raise(Ping{ p, i }, &sources[p]);
+            }
+        });
+    }
+
+    auto finished = done.get_future().wait_for(std::chrono::seconds(120)) == std::future_status::ready;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    if (!finished)
+    {
+        std::cout << "FAILED: " << delivered << " of " << total << " events delivered" << std::endl;
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    for (auto& source : sources)
+    {
+        if (!source.ordered)
+        {
+            std::cout << "FAILED: events of a source out of order" << std::endl;
+
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    tnt::Application::raise(Once());
+    again.get_future().wait();
+
+    if (once_calls != 1)
+    {
+        std::cout << "FAILED: handler called after it unsubscribed" << std::endl;
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::cout << "OK: " << producers << " producers, " << total << " events, handler " << work.count() << " ns" << std::endl;
+    std::cout << total / elapsed.count() << " events/s" << std::endl;
+
+    std::exit(EXIT_SUCCESS); // The dispatchers do not stop.
+}
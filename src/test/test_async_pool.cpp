@@ -0,0 +1,208 @@
+/*
+ * test the tnt::async executors against a thread per call
+ *
+ * Checks that tnt::async hands back the result, the exception and the moved arguments
+ * of the task through its future, that a worker blocked on the tasks it posted to its
+ * own deque is unblocked by another worker stealing them, and that the elastic pool of
+ * tnt::async_activity runs blocking activities side by side and reuses its idle threads.
+ * Then times short tasks through tnt::async and through a detached std::thread each.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common test_async_pool.cpp \
+ *       ../framework/common/executor.cpp ../framework/common/memory_pool.cpp ../framework/common/log.cpp ../framework/common/colors.cpp \
+ *       -o test_async_pool -lpthread
+ *
+ * Usage: test_async_pool [tasks]
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <stdexcept>
+#include <cstdlib>
+
+#include "async.hpp"
+
+namespace {
+
+bool check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+
+    return condition;
+}
+
+// Busy until the condition holds or the timeout expires.
+template <class F> bool wait_until(F condition, std::chrono::seconds timeout)
+{
+    auto end = std::chrono::steady_clock::now() + timeout;
+
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > end)
+        {
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+bool futures()
+{
+    auto sum = tnt::async([] (int a, int b)
+    {
+        return a + b;
+    }, 20, 22);
+
+    auto ok = check(sum.get() == 42, "result");
+
+    auto failure = tnt::async([] ()
+    {
+        throw std::runtime_error("task");
+    });
+
+    try
+    {
+        failure.get();
+        ok &= check(false, "exception");
+    }
+    catch (std::runtime_error&) {}
+
+    auto moved = tnt::async([] (std::unique_ptr<int> p)
+    {
+        return *p;
+    }, std::make_unique<int>(7));
+
+    ok &= check(moved.get() == 7, "moved argument");
+
+    return ok;
+}
+
+bool stealing()
+{
+    tnt::Executor executor(2);
+    std::atomic<int> done{ 0 };
+    std::promise<bool> result;
+
+    // Posted from a worker, the tasks go to its own deque while it spins on them.
+    executor.post([&] ()
+    {
+        for (auto i = 0; i < 100; ++i)
+        {
+            executor.post([&done] ()
+            {
+                ++done;
+            });
+        }
+
+        result.set_value(wait_until([&done] { return done == 100; }, std::chrono::seconds(10)));
+    });
+
+    return check(result.get_future().get(), "tasks stolen from a busy worker");
+}
+
+bool elastic()
+{
+    const auto activities = 8;
+
+    tnt::ElasticExecutor executor(std::chrono::seconds(10));
+    std::atomic<int> running{ 0 };
+    std::atomic<int> finished{ 0 };
+
+    for (auto round = 0; round < 2; ++round)
+    {
+        for (auto i = 0; i < activities; ++i)
+        {
+            executor.post([&] ()
+            {
+                // Blocks until all the activities of the round run at once.
+                ++running;
+                wait_until([&running, round] { return running >= activities * (round + 1); }, std::chrono::seconds(10));
+                ++finished;
+            });
+        }
+
+        if (!check(wait_until([&] { return finished == activities * (round + 1); }, std::chrono::seconds(20)), "activities side by side"))
+        {
+            return false;
+        }
+
+        // The threads count themselves idle once back in the pool.
+        wait_until([&executor] { return executor.threads() == activities; }, std::chrono::seconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    return check(running == activities * 2, "all activities ran") && check(executor.created() == activities, "idle threads reused");
+}
+
+template <class Spawn> double rate(int tasks, Spawn spawn)
+{
+    std::vector<std::future<int>> results;
+    results.reserve(tasks);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < tasks; ++i)
+    {
+        results.push_back(spawn(i));
+    }
+
+    for (auto& r : results)
+    {
+        r.get();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return tasks / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto tasks = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+    if (!futures() || !stealing() || !elastic())
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK" << std::endl;
+
+    auto square = [] (int i)
+    {
+        return i * i;
+    };
+
+    auto pool = rate(tasks, [&square] (int i)
+    {
+        return tnt::async(square, i);
+    });
+
+    auto threads = rate(tasks, [&square] (int i)
+    {
+        std::packaged_task<int(int)> task(square);
+        auto f = task.get_future();
+        std::thread(std::move(task), i).detach();
+
+        return f;
+    });
+
+    std::cout << tnt::Executor::instance().workers() << " workers" << std::endl;
+    std::cout << "thread per call: " << static_cast<uint64_t>(threads) << " tasks/s" << std::endl;
+    std::cout << "tnt::async:      " << static_cast<uint64_t>(pool) << " tasks/s" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+/*
+ * test the Configuration snapshots and ConfigKey
+ *
+ * Checks that a ConfigKey reads its value or its default, throws ConfigurationError for
+ * a missing or malformed value, follows read and set, that a key declared after the
+ * configuration is read is resolved at once, that readers on other threads always see
+ * a consistent snapshot while it is reloaded, and that a replaced snapshot is freed once
+ * its last reader drops it. Then times reads through a ConfigKey,
+ * through Configuration::get and through a copy of the tree, as Configuration::get
+ * used to do.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common test_configuration.cpp \
+ *       ../framework/util/configuration.cpp ../framework/exception/exception.cpp \
+ *       -o test_configuration -lpthread
+ *
+ * Usage: test_configuration [reads]
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <cstdlib>
+
+#include "util/configuration.hpp"
+
+namespace {
+
+const tnt::ConfigKey<int> burst("netmap.burst");
+const tnt::ConfigKey<int> entries("netmap.entries", 1024);
+const tnt::ConfigKey<std::string> name("netmap.interface");
+const tnt::ConfigKey<bool> poll("netmap.poll", false);
+
+bool check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+
+    return condition;
+}
+
+template <class K> bool throws(const K& key)
+{
+    try
+    {
+        key.get();
+    }
+    catch (tnt::ConfigurationError&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+boost::property_tree::ptree config(int b, const std::string& n)
+{
+    boost::property_tree::ptree tree;
+    tree.put("netmap.burst", b);
+    tree.put("netmap.interface", n);
+    tree.put("netmap.bad", "x");
+
+    return tree;
+}
+
+bool keys()
+{
+    tnt::Configuration::default_init();
+
+    auto ok = check(throws(burst), "missing key throws");
+    ok &= check(entries.get() == 1024 && !poll.get(), "defaults");
+
+    tnt::Configuration::read(config(32, "eth0"));
+    ok &= check(burst.get() == 32 && name.get() == "eth0" && entries.get() == 1024, "values read");
+
+    tnt::Configuration::set("netmap.entries", 10);
+    tnt::Configuration::set_default("netmap.burst", 64);
+    ok &= check(entries.get() == 10 && burst.get() == 32, "set and set_default");
+    ok &= check(tnt::Configuration::get("netmap.entries").as<int>() == 10 && tnt::Configuration::exists("netmap.poll") == false, "get and exists");
+
+    const tnt::ConfigKey<int> bad("netmap.bad");
+    const tnt::ConfigKey<std::string> late("netmap.interface");
+    ok &= check(throws(bad), "malformed value throws");
+    ok &= check(late.get() == "eth0", "key declared after read");
+
+    return ok;
+}
+
+bool reload()
+{
+    std::atomic_bool running{ true };
+    std::atomic_bool consistent{ true };
+    std::vector<std::thread> readers;
+
+    tnt::Configuration::read(config(0, "0"));
+
+    for (auto r = 0; r < 4; ++r)
+    {
+        readers.emplace_back([&] ()
+        {
+            while (running)
+            {
+                // Both values come from the same snapshot.
+                auto snapshot = tnt::Configuration::snapshot();
+                auto b = snapshot->tree().get<int>("netmap.burst");
+                auto n = snapshot->tree().get<std::string>("netmap.interface");
+
+                if (std::to_string(b) != n || burst.get() < 0)
+                {
+                    consistent = false;
+                }
+            }
+        });
+    }
+
+    for (auto i = 1; i <= 2000; ++i)
+    {
+        tnt::Configuration::read(config(i, std::to_string(i)));
+    }
+
+    running = false;
+
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+
+    auto ok = check(consistent, "consistent snapshots during reload") && check(burst.get() == 2000, "last reload");
+
+    auto held = tnt::Configuration::snapshot();
+    std::weak_ptr<const tnt::Configuration::Snapshot> old = held;
+
+    tnt::Configuration::read(config(1, "1"));
+    ok &= check(!old.expired() && held->tree().get<int>("netmap.burst") == 2000, "replaced snapshot kept while held");
+
+    held.reset();
+    ok &= check(old.expired(), "replaced snapshot freed");
+
+    return ok;
+}
+
+template <class F> double rate(int reads, F read)
+{
+    long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < reads; ++i)
+    {
+        sum += read();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return sum != 0 ? reads / elapsed.count() : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto reads = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    if (!keys() || !reload())
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK" << std::endl;
+
+    // A configuration of the size of the SE one.
+    auto tree = config(32, "eth0");
+
+    for (auto i = 0; i < 40; ++i)
+    {
+        tree.put("section" + std::to_string(i % 8) + ".key" + std::to_string(i), i);
+    }
+
+    tnt::Configuration::read(tree);
+
+    auto copy = rate(reads / 10, [] ()
+    {
+        auto config = tnt::Configuration::snapshot()->tree();
+
+        return config.get<int>("netmap.burst");
+    });
+
+    auto lookup = rate(reads, [] ()
+    {
+        return tnt::Configuration::get("netmap.burst").as<int>();
+    });
+
+    auto key = rate(reads, [] ()
+    {
+        return burst.get();
+    });
+
+    std::cout << "copy of the tree:     " << static_cast<long>(copy) << " reads/s" << std::endl;
+    std::cout << "Configuration::get:   " << static_cast<long>(lookup) << " reads/s" << std::endl;
+    std::cout << "ConfigKey:            " << static_cast<long>(key) << " reads/s" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+/*
+ * test the rates computed from the OpenFlow stats counters
+ *
+ * Feeds drop::protocol::CounterRates with the samples of a few ports: checks the
+ * rates of consecutive samples, that a counter going back (a reset port) starts
+ * over instead of reporting a huge rate, and that the keys missing from a reply
+ * are forgotten by sweep().
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../lib test_counter_rates.cpp -o test_counter_rates
+ *
+ * Usage: test_counter_rates
+ */
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+
+#include "protocol/openflow/counter_rates.hpp"
+
+namespace {
+
+using Rates = drop::protocol::CounterRates<2>;
+
+const uint64_t second = 1000000000ull;
+
+bool check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+
+    return condition;
+}
+
+bool near(float value, float expected)
+{
+    return std::fabs(value - expected) <= expected * 1e-6f;
+}
+
+} // namespace
+
+int main()
+{
+    Rates rates;
+    Rates::Rates r;
+    auto ok = true;
+
+    ok &= check(!rates.update(1, 10 * second, {{ 1000, 10 }}, r), "first sample has no rate");
+    ok &= check(rates.update(1, 12 * second, {{ 3000, 30 }}, r) && near(r[0], 1000) && near(r[1], 10), "rate over two seconds");
+    ok &= check(rates.update(1, 12 * second + second / 2, {{ 3500, 30 }}, r) && near(r[0], 1000) && r[1] == 0, "rate over half a second");
+
+    ok &= check(!rates.update(1, 13 * second, {{ 100, 1 }}, r), "reset counters have no rate");
+    ok &= check(rates.update(1, 14 * second, {{ 600, 6 }}, r) && near(r[0], 500) && near(r[1], 5), "rate after the reset");
+    ok &= check(!rates.update(1, 14 * second, {{ 700, 7 }}, r), "no rate without elapsed time");
+
+    rates.update(2, 14 * second, {{ 0, 0 }}, r);
+    rates.sweep();
+    ok &= check(rates.size() == 2, "sweep keeps the updated keys");
+
+    rates.update(2, 15 * second, {{ 0, 0 }}, r);
+    rates.sweep();
+    ok &= check(rates.size() == 1, "sweep forgets the missing keys");
+    ok &= check(!rates.update(1, 16 * second, {{ 800, 8 }}, r), "forgotten key starts over");
+
+    if (!ok)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+/*
+ * test the OpenFlow 1.3 flow-mod encoder
+ *
+ * Encodes the usual flows of the controller (a route, a port, a rewrite towards several
+ * ports) and checks the layout of the messages: lengths, OXM TLVs, padding and actions.
+ * Then checks that once the buffer is warm the encoding does not allocate, counting the
+ * calls to operator new, and times the flow-mods per second on one core.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib \
+ *       test_flow_mod_encoder.cpp ../lib/protocol/openflow/v_1_3/flow_mod_encoder.cpp \
+ *       ../lib/protocol/openflow/flow.cpp ../lib/protocol/openflow/flow_factory.cpp ../framework/common/ip_address.cpp \
+ *       ../framework/common/init_sockets.cpp ../framework/common/log.cpp ../framework/common/colors.cpp \
+ *       ../framework/exception/exception.cpp ../framework/util/configuration.cpp ../framework/util/string.cpp \
+ *       -o test_flow_mod_encoder -lpthread
+ *
+ * Usage: test_flow_mod_encoder [flow-mods]
+ */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <arpa/inet.h>
+
+#include "protocol/openflow/flow.hpp"
+#include "protocol/openflow/flow_factory.hpp"
+#include "protocol/openflow/message_buffer.hpp"
+#include "protocol/openflow/v_1_3/flow_mod_encoder.hpp"
+
+#include "mac_address.hpp"
+#include "ip_address.hpp"
+
+namespace {
+
+std::atomic<uint64_t> allocations{ 0 };
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    ++allocations;
+
+    if (auto p = std::malloc(size))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+using namespace drop;
+using namespace drop::protocol;
+
+static_assert(ip_dst_flow_mod_size_1_3 == 96, "Route flow-mod: 48 + match 24 + instruction 8 + output 16");
+static_assert(in_port_flow_mod_size_1_3 == 88, "Port flow-mod: 48 + match 16 + instruction 8 + output 16");
+
+uint16_t get16(const MessageBuffer& buf, size_t offset)
+{
+    uint16_t value;
+    std::memcpy(&value, buf.data() + offset, sizeof(value));
+
+    return ntohs(value);
+}
+
+uint32_t get32(const MessageBuffer& buf, size_t offset)
+{
+    uint32_t value;
+    std::memcpy(&value, buf.data() + offset, sizeof(value));
+
+    return ntohl(value);
+}
+
+int check_route(MessageBuffer& buf)
+{
+    Flow flow;
+    flow.add(from_ip_dst(tnt::ip::Address::from_string("10.1.2.0"), 24)).add(to_port(3));
+
+    encode_flow_mod_1_3(flow, 42, ofp_flow_mod_command_1_3::ADD, buf);
+
+    auto errors = 0;
+
+    errors += buf.size() != ip_dst_flow_mod_size_1_3;
+    errors += get16(buf, 2) != buf.size();                  // Header length
+    errors += get32(buf, 4) != 42;                          // xid
+    errors += get16(buf, 50) != 4 + 6 + 12;                 // Match length, ETH_TYPE and masked IPV4_DST
+    errors += get32(buf, 52) != 0x80000a02;                 // OXM ETH_TYPE
+    errors += get16(buf, 56) != 0x0800;
+    errors += get32(buf, 58) != 0x80001908;                 // OXM IPV4_DST, masked
+    errors += get32(buf, 62) != 0x0a010200;
+    errors += get32(buf, 66) != 0xffffff00;
+    errors += get16(buf, 70) != 0;                          // Padding to 8 bytes
+    errors += get16(buf, 72) != 4;                          // APPLY_ACTIONS
+    errors += get16(buf, 74) != 8 + 16;
+    errors += get16(buf, 80) != 0;                          // OUTPUT to port 3
+    errors += get16(buf, 82) != 16;
+    errors += get32(buf, 84) != 3;
+
+    return errors;
+}
+
+int check_rewrite(MessageBuffer& buf)
+{
+    Flow flow;
+    flow.add(from_port(1)).add(set_hw_dst(tnt::MacAddress("02:00:00:00:01:02"))).add(to_ports({ 1, 2, 3 }));
+
+    encode_flow_mod_1_3(flow, 7, ofp_flow_mod_command_1_3::DELETE, buf);
+
+    auto errors = 0;
+
+    // ETH_DST set-field: 4 + OXM 4 + 6, padded to 16.
+    errors += buf.size() != flow_mod_size_1_3(oxm_size_1_3(4), set_field_size_1_3(6) + 3 * 16);
+    errors += get16(buf, 2) != buf.size();
+    errors += get16(buf, 50) != 4 + 8;
+    errors += get16(buf, 64 + 2) != 8 + 16 + 3 * 16;
+    errors += get16(buf, 72) != 25;                         // SET_FIELD
+    errors += get16(buf, 74) != 16;
+    errors += get32(buf, 76) != 0x80000606;                 // OXM ETH_DST
+    errors += static_cast<uint8_t>(buf.data()[85]) != 0x02;
+    errors += get32(buf, 88 + 2 * 16 + 4) != 3;             // Last output port
+
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    MessageBuffer buf;
+
+    auto errors = check_route(buf) + check_rewrite(buf);
+
+    if (errors != 0)
+    {
+        std::cout << "FAILED: " << errors << " wrong fields" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Flow> flows(3);
+    flows[0].add(from_ip_dst(tnt::ip::Address::from_string("10.1.2.0"), 24)).add(to_port(3));
+    flows[1].add(from_port(2)).add(to_port(1));
+    flows[2].add(from_port(1)).add(from_ip_src(tnt::ip::Address::from_string("10.1.0.0"), 16)).add(set_hw_dst(tnt::MacAddress("02:00:00:00:01:02")))
+        .add(set_hw_src(tnt::MacAddress("02:00:00:00:01:01"))).add(to_ports({ 1, 2, 3 }));
+
+    for (const auto& f : flows)
+    {
+        encode_flow_mod_1_3(f, 0, ofp_flow_mod_command_1_3::ADD, buf);
+    }
+
+    size_t bytes = 0;
+    auto before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < n; ++i)
+    {
+        encode_flow_mod_1_3(flows[i % flows.size()], i, ofp_flow_mod_command_1_3::ADD, buf);
+        bytes += buf.size();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto allocated = allocations.load() - before;
+
+    if (allocated != 0)
+    {
+        std::cout << "FAILED: " << allocated << " allocations for " << n << " flow-mods" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK: " << n << " flow-mods (" << bytes << " bytes), no allocation" << std::endl;
+    std::cout << n / elapsed.count() / 1e6 << " M flow-mods/s, " << elapsed.count() * 1e9 / n << " ns/flow-mod" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,449 @@
+/*
+ * load the embedded web server with keep-alive connections and pipelined requests
+ *
+ * A wrk-style client: every connection keeps a window of requests in flight, alternating
+ * a page of the Web UI and a JSON endpoint, and sends a new request for every response it
+ * frames with HttpParser. Without a host it starts its own HttpServer on loopback, serving
+ * a page from a temporary directory with WebController and the JSON endpoint with a test
+ * controller, and checks that every response arrives in order with status 200, that the
+ * requests of one write are all answered, that a malformed request gets 400 and closes
+ * the connection and that an HTTP/1.0 request without keep-alive closes it too. Then that
+ * the page comes with an ETag, answered by 304 when it matches, gzipped on request and
+ * served again from memory soon after it is rewritten on disk, and that connections
+ * idle for the keep-alive timeout are closed, so they cannot take every slot. With a
+ * host it only measures, against a running control element or service element
+ * ("json/index_update" is one of the endpoints of JsonController). Prints the requests
+ * per second of all the connections at once.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -DWITH_BOOST -I../framework -I../framework/common -I../lib \
+ *       test_http_load.cpp ../framework/activity/http/http_server.cpp ../framework/activity/http/http_connection.cpp \
+ *       ../framework/activity/http/controller.cpp ../framework/activity/http/web_controller.cpp \
+ *       ../framework/activity/http/asset_cache.cpp \
+ *       ../framework/protocol/http/http_protocol.cpp ../framework/protocol/http/http_parser.cpp \
+ *       ../framework/protocol/http/http_headers.cpp ../framework/protocol/http/http_method.cpp \
+ *       ../framework/protocol/http/http_response.cpp ../framework/protocol/http/http_status_code.cpp \
+ *       ../framework/protocol/http/cpprest/uri.cpp ../framework/protocol/http/cpprest/uri_builder.cpp ../framework/protocol/http/cpprest/uri_parser.cpp \
+ *       ../framework/protocol/async_protocol.cpp ../framework/io/reactor.cpp \
+ *       ../framework/io/tcp_io.cpp ../framework/io/receive_buffer.cpp ../framework/common/application.cpp \
+ *       ../framework/activity/activity_from_event.cpp ../framework/activity/concurrent_activity.cpp \
+ *       ../framework/util/system.cpp ../framework/util/string.cpp \
+ *       ../framework/common/init_sockets.cpp ../framework/common/ip_address.cpp ../framework/common/ip_socket_address.cpp \
+ *       ../framework/common/log.cpp ../framework/common/colors.cpp ../framework/common/demangle.cpp \
+ *       ../framework/exception/exception.cpp ../framework/common/quiescent_state.cpp \
+ *       ../framework/common/executor.cpp ../framework/common/memory_pool.cpp \
+ *       -o test_http_load -lboost_filesystem -lboost_system -lpthread -lz
+ *
+ * Usage: test_http_load [connections] [requests per connection] [pipeline depth] [port] [host] [reactor loops]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+
+#include <zlib.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "activity/http/http_server.hpp"
+#include "activity/http/http_connection.hpp"
+#include "activity/http/controller.hpp"
+#include "protocol/http/http_parser.hpp"
+#include "io/tcp_io.hpp"
+#include "io/reactor.hpp"
+
+#include "ip_socket_address.hpp"
+#include "application.hpp"
+
+namespace {
+
+namespace fs = boost::filesystem;
+
+using Clock = std::chrono::steady_clock;
+
+const char www[] = "test_http_load.www";
+const char json_name[] = "json";
+const std::string json_body = "{\"status\":\"ok\"}";
+const std::chrono::milliseconds keep_alive(500);
+
+class TestJsonController: public tnt::activity::RegisterController<TestJsonController, json_name>
+{
+public:
+    TestJsonController(tnt::activity::HttpConnection* connection, const std::string& /*base_path*/)
+    {
+        connection->ok(json_body, "application/json");
+    }
+};
+
+std::string request(const std::string& host, const std::string& path, const std::string& headers = "")
+{
+    return "GET " + path + " HTTP/1.1\r\nHost: " + host + "\r\n" + headers + "\r\n";
+}
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Reads from io until count responses are framed, appends them to responses; false if the connection closes before.
+bool receive(tnt::IO& io, size_t count, std::vector<std::string>& responses)
+{
+    tnt::protocol::HttpParser parser;
+    std::vector<tnt::BufferView> messages;
+    std::string buffer;
+    char chunk[16 * 1024];
+
+    try
+    {
+        while (count > 0)
+        {
+            buffer.append(chunk, io.read_some(chunk, sizeof(chunk)));
+
+            messages.clear();
+            auto used = parser.parse(buffer, messages);
+
+            for (const auto& m : messages)
+            {
+                responses.push_back(m.str());
+            }
+
+            count -= std::min(count, messages.size());
+            buffer.erase(0, used);
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool closed(tnt::IO& io)
+{
+    char c;
+
+    try
+    {
+        io.read_some(&c, 1);
+    }
+    catch (...)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+std::string status(const std::string& response)
+{
+    return tnt::protocol::HttpMessageView(response).start[1].str();
+}
+
+std::string header(const tnt::protocol::HttpMessageView& view, const char* name)
+{
+    for (const auto& h : view.headers)
+    {
+        if (boost::iequals(h.first.str(), name))
+        {
+            return h.second.str();
+        }
+    }
+
+    return "";
+}
+
+std::string gunzip(const std::string& data)
+{
+    z_stream stream{};
+    inflateInit2(&stream, 16 + MAX_WBITS);
+
+    std::string out(1 << 20, '\0');
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    auto result = inflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+
+    return result == Z_STREAM_END ? out : "";
+}
+
+// One request on its own connection.
+tnt::protocol::HttpMessageView get(const tnt::ip::SocketAddress& address, const std::string& request, std::string& response)
+{
+    auto io = tnt::io::TcpIOClient(address).get();
+    io->write(request);
+
+    std::vector<std::string> responses;
+    check(receive(*io, 1, responses), "request not answered");
+    response = responses[0];
+
+    return tnt::protocol::HttpMessageView(response);
+}
+
+void write_page(const std::string& page)
+{
+    std::ofstream((fs::path(www) / "Home" / "Index.html").string(), std::ios::binary) << page;
+}
+
+// The page from memory, its validators and its gzip copy, and a rewrite of the file.
+void check_assets(const tnt::ip::SocketAddress& address, const std::string& host, const std::string& page)
+{
+    std::string response;
+
+    auto view = get(address, request(host, "/"), response);
+    auto etag = header(view, "ETag");
+
+    check(view.start[1].str() == "200" && view.body.str() == page, "page not served");
+    check(!etag.empty() && header(view, "Cache-Control") == "no-cache", "no ETag or Cache-Control");
+
+    view = get(address, request(host, "/", "If-None-Match: " + etag + "\r\n"), response);
+    check(view.start[1].str() == "304" && view.body.empty() && header(view, "ETag") == etag, "no 304 to a matching ETag");
+
+    view = get(address, request(host, "/", "If-None-Match: \"other\"\r\n"), response);
+    check(view.start[1].str() == "200", "304 to another ETag");
+
+    view = get(address, request(host, "/", "Accept-Encoding: deflate, gzip\r\n"), response);
+    check(header(view, "Content-Encoding") == "gzip" && header(view, "ETag") != etag, "no gzip copy");
+    check(view.body.size() < page.size() && gunzip(view.body.str()) == page, "gzip copy not the page");
+
+    view = get(address, request(host, "/", "Accept-Encoding: gzip;q=0\r\n"), response);
+    check(header(view, "Content-Encoding").empty(), "gzip sent when refused");
+
+    auto changed = std::string(page.size(), 'y');
+    write_page(changed);
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+
+    while (get(address, request(host, "/"), response).body.str() != changed)
+    {
+        check(Clock::now() < deadline, "page rewritten on disk still served from memory");
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    write_page(page);
+
+    while (get(address, request(host, "/"), response).body.str() != page)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+// Pipelining, errors and the end of the connections, against the server started here.
+void check_framing(const tnt::ip::SocketAddress& address, const std::string& host, const std::vector<std::string>& paths, const std::string& page)
+{
+    {
+        auto io = tnt::io::TcpIOClient(address).get();
+        std::string batch;
+
+        for (auto i = 0; i < 10; ++i)
+        {
+            batch += request(host, paths[i % 2]);
+        }
+
+        io->write(batch);
+
+        std::vector<std::string> responses;
+        check(receive(*io, 10, responses), "pipelined requests not answered");
+
+        for (auto i = 0; i < 10; ++i)
+        {
+            auto view = tnt::protocol::HttpMessageView(responses[i]);
+            check(view.start[1].str() == "200" && view.body.str() == (i % 2 == 0 ? page : json_body), "pipelined responses out of order");
+        }
+    }
+
+    {
+        auto io = tnt::io::TcpIOClient(address).get();
+        io->write("GET / HTTP/1.1\r\nContent-Length: x\r\n\r\n");
+
+        std::vector<std::string> responses;
+        check(receive(*io, 1, responses) && status(responses[0]) == "400", "no 400 to a malformed request");
+        check(closed(*io), "connection open after a malformed request");
+    }
+
+    {
+        auto io = tnt::io::TcpIOClient(address).get();
+        io->write("GET / HTTP/1.0\r\n\r\n");
+
+        std::vector<std::string> responses;
+        check(receive(*io, 1, responses) && status(responses[0]) == "200", "HTTP/1.0 request not answered");
+        check(closed(*io), "HTTP/1.0 connection kept open");
+    }
+}
+
+// Every slot of the server taken by a connection without requests.
+void check_idle(const tnt::ip::SocketAddress& address, const std::string& host, size_t slots)
+{
+    std::vector<std::shared_ptr<tnt::IO>> idle;
+
+    for (size_t i = 0; i < slots; ++i)
+    {
+        idle.push_back(tnt::io::TcpIOClient(address).get());
+    }
+
+    auto io = tnt::io::TcpIOClient(address).get();
+    io->write(request(host, "/"));
+
+    std::vector<std::string> responses;
+    check(receive(*io, 1, responses) && status(responses[0]) == "200", "request not served with every slot idle");
+
+    for (const auto& i : idle)
+    {
+        check(closed(*i), "idle connection kept open");
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto connections = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 32;
+    auto requests = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 2000;
+    auto depth = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 8;
+    auto port = argc > 4 ? static_cast<uint16_t>(std::atoi(argv[4])) : 16656;
+    std::string host = argc > 5 ? argv[5] : "";
+    auto loops = argc > 6 ? static_cast<size_t>(std::atoi(argv[6])) : 2;
+
+    const std::vector<std::string> paths = { "/", "/json/index_update" };
+    const std::string page(4096, 'x');
+
+    auto local = host.empty();
+    auto slots = connections + 3;
+
+    if (local)
+    {
+        host = "127.0.0.1";
+
+        if (loops > 0)
+        {
+            tnt::io::Reactor::enable(loops);
+        }
+
+        fs::create_directories(fs::path(www) / "Home");
+        write_page(page);
+
+        tnt::Application::run_async();
+
+        auto server = std::make_shared<tnt::io::TcpIOServer>(tnt::ip::SocketAddress(host, static_cast<short>(port)));
+
+        std::thread([server, slots] ()
+        {
+            tnt::activity::HttpServer http(slots, keep_alive);
+            http(server, www);
+        }).detach();
+    }
+
+    tnt::ip::SocketAddress address(host, static_cast<short>(port));
+
+    if (local)
+    {
+        check_framing(address, host, paths, page);
+        check_assets(address, host, page);
+        check_idle(address, host, slots);
+    }
+
+    std::atomic<uint64_t> answered{ 0 };
+    std::atomic_bool ok{ true };
+    std::vector<std::thread> clients;
+
+    auto start = Clock::now();
+
+    for (auto c = 0u; c < connections; ++c)
+    {
+        clients.emplace_back([&] ()
+        {
+            try
+            {
+                auto io = tnt::io::TcpIOClient(address).get();
+                tnt::protocol::HttpParser parser;
+                std::vector<tnt::BufferView> messages;
+                std::string buffer;
+                std::string batch;
+                char chunk[64 * 1024];
+
+                uint32_t sent = 0;
+                uint32_t received = 0;
+
+                for (; sent < std::min(depth, requests); ++sent)
+                {
+                    batch += request(host, paths[sent % paths.size()]);
+                }
+
+                io->write(batch);
+
+                while (received < requests)
+                {
+                    buffer.append(chunk, io->read_some(chunk, sizeof(chunk)));
+
+                    messages.clear();
+                    auto used = parser.parse(buffer, messages);
+                    batch.clear();
+
+                    for (const auto& m : messages)
+                    {
+                        // The responses come in the order of the requests.
+                        auto view = tnt::protocol::HttpMessageView(m);
+                        ok = ok && view.start[1].str() == "200" && (!local || view.body.size() == (received % 2 == 0 ? page.size() : json_body.size()));
+                        ++received;
+
+                        if (sent < requests)
+                        {
+                            batch += request(host, paths[sent++ % paths.size()]);
+                        }
+                    }
+
+                    buffer.erase(0, used);
+
+                    if (!batch.empty())
+                    {
+                        io->write(batch);
+                    }
+                }
+
+                answered += received;
+            }
+            catch (std::exception& ex)
+            {
+                std::cout << "client error: " << ex.what() << std::endl;
+                ok = false;
+            }
+        });
+    }
+
+    for (auto& t : clients)
+    {
+        t.join();
+    }
+
+    auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (local)
+    {
+        fs::remove_all(www);
+    }
+
+    check(ok && answered == static_cast<uint64_t>(connections) * requests, "responses lost or failed");
+
+    std::cout << "OK: " << connections << " connections, " << requests << " requests each, pipeline depth " << depth << std::endl;
+    std::cout << answered / elapsed << " requests/s" << std::endl;
+
+    std::exit(EXIT_SUCCESS); // The server does not stop.
+}
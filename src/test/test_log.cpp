@@ -0,0 +1,154 @@
+/*
+ * benchmark the asynchronous tnt::Log backend against the synchronous one
+ *
+ * Threads log lines with text, numbers, enums and manipulators to a file, with each
+ * backend. Checks that every line logged by the asynchronous backend is written, in
+ * order for every thread, or counted as dropped, and that Log::debug compiled out by
+ * TNT_LOG_MAX_LEVEL writes nothing. Prints the lines per second seen by the threads
+ * logging, and for the asynchronous backend the time to write them all.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -DTNT_LOG_MAX_LEVEL=3 -I../framework/common test_log.cpp ../framework/common/log.cpp \
+ *       ../framework/common/colors.cpp -o test_log -lpthread
+ *
+ * Usage: test_log [threads] [lines per thread] [log file]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "log.hpp"
+
+namespace {
+
+enum class Kind: uint16_t
+{
+    Packet = 7
+};
+
+double run(uint32_t threads, uint32_t lines)
+{
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([t, lines] ()
+        {
+            std::string name = "ring #" + std::to_string(t);
+
+            for (uint32_t i = 0; i < lines; ++i)
+            {
+                tnt::Log::info(colors::green, name, " line ", i, manip::tab, Kind::Packet, " ", 0.5);
+                tnt::Log::debug("compiled out ", i);
+            }
+        });
+    }
+
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return threads * static_cast<double>(lines) / elapsed.count();
+}
+
+// Returns false if the lines of a thread are out of order, counts lines and dropped records.
+bool read_back(const std::string& path, uint32_t threads, uint64_t& count, uint64_t& dropped)
+{
+    std::ifstream in(path);
+    std::vector<int64_t> next(threads, 0);
+    std::string line;
+    auto ok = true;
+
+    count = 0;
+    dropped = 0;
+
+    while (std::getline(in, line))
+    {
+        if (line.find("compiled out") != std::string::npos)
+        {
+            return false;
+        }
+
+        auto drop = line.find("Log: ");
+
+        if (drop != std::string::npos)
+        {
+            dropped += std::stoull(line.substr(drop + 5));
+            continue;
+        }
+
+        auto ring = line.find("ring #");
+
+        if (ring == std::string::npos)
+        {
+            continue;
+        }
+
+        std::istringstream is(line.substr(ring + 6));
+        uint32_t t;
+        std::string word;
+        int64_t i;
+
+        is >> t >> word >> i;
+        ok &= t < threads && i >= next[t] && line.find("\t7 0.5") != std::string::npos;
+        next[t] = i + 1;
+        ++count;
+    }
+
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto threads = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 4;
+    auto lines = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 100000;
+    std::string path = argc > 3 ? argv[3] : "test_log.txt";
+
+    std::remove(path.c_str());
+    tnt::Log::file(path);
+
+    tnt::Log::backend(tnt::LogBackend::Synchronous);
+    auto sync_rate = run(threads, lines);
+
+    std::remove(path.c_str());
+    tnt::Log::file(path);
+
+    tnt::Log::backend(tnt::LogBackend::Asynchronous);
+    auto start = std::chrono::steady_clock::now();
+    auto async_rate = run(threads, lines);
+    tnt::Log::flush();
+    std::chrono::duration<double> written = std::chrono::steady_clock::now() - start;
+
+    uint64_t count;
+    uint64_t dropped;
+
+    if (!read_back(path, threads, count, dropped) || count + dropped != static_cast<uint64_t>(threads) * lines)
+    {
+        std::cout << "FAILED: " << count << " lines and " << dropped << " dropped of " << static_cast<uint64_t>(threads) * lines << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    std::remove(path.c_str());
+
+    std::cout << "OK" << std::endl;
+    std::cout << "synchronous:  " << static_cast<uint64_t>(sync_rate) << " lines/s" << std::endl;
+    std::cout << "asynchronous: " << static_cast<uint64_t>(async_rate) << " lines/s, " << static_cast<uint64_t>(count / written.count()) << " lines/s written, " << dropped << " dropped" << std::endl;
+
+    return EXIT_SUCCESS;
+}
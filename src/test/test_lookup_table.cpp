@@ -0,0 +1,373 @@
+/*
+ * benchmark the DIR-24-8 LookupTable against the per-host table it replaced
+ *
+ * Loads a table of random prefixes with a BGP-like length distribution (mostly /24, a
+ * few shorter than /16 or longer than /24) over 64 next hops. Checks every lookup of
+ * random addresses against a reference longest prefix match, for the routes added in
+ * random order, longest prefix first and shortest prefix first, and again after half of
+ * them are deleted. Then prints the resident memory taken by the table and its lookups
+ * per second.
+ *
+ * The replaced table stored one hash entry per host address covered by a route, so a
+ * full table does not fit in memory: it is measured with the same hash table loaded
+ * with the hosts of the longest prefixes, up to a limit, and its memory per host is
+ * scaled to the addresses the full table covers.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib \
+ *       test_lookup_table.cpp ../lib/util/lookup_table.cpp ../framework/common/quiescent_state.cpp \
+ *       -o test_lookup_table -lpthread
+ *
+ * Usage: test_lookup_table [prefixes] [lookups] [hosts in the per-host table]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+
+#include <arpa/inet.h>
+
+#include "util/lookup_table.hpp"
+
+#include "mac_address.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const uint16_t next_hops = 64;
+
+struct Route
+{
+    uint32_t address; // Host byte order, masked.
+    uint32_t prefix;
+    uint16_t next_hop;
+};
+
+// The node of the replaced table.
+struct HostNode
+{
+    bool def;
+    char dst[6];
+};
+
+uint32_t netmask(uint32_t prefix)
+{
+    return prefix == 0 ? 0 : ~0u << (32 - prefix);
+}
+
+uint32_t random_prefix(std::mt19937& gen)
+{
+    auto p = std::uniform_int_distribution<int>(0, 999)(gen);
+
+    if (p < 600)
+        return 24;
+    if (p < 800)
+        return std::uniform_int_distribution<uint32_t>(22, 23)(gen);
+    if (p < 985)
+        return std::uniform_int_distribution<uint32_t>(16, 21)(gen);
+    if (p < 990)
+        return std::uniform_int_distribution<uint32_t>(8, 15)(gen);
+
+    return std::uniform_int_distribution<uint32_t>(25, 32)(gen);
+}
+
+std::vector<Route> random_routes(size_t count, std::mt19937& gen)
+{
+    std::unordered_map<uint64_t, size_t> seen;
+    std::vector<Route> routes;
+
+    while (routes.size() < count)
+    {
+        auto prefix = random_prefix(gen);
+        auto address = static_cast<uint32_t>(gen()) & netmask(prefix);
+
+        if (seen.emplace((static_cast<uint64_t>(address) << 8) | prefix, routes.size()).second)
+        {
+            routes.push_back(Route{ address, prefix, static_cast<uint16_t>(gen() % next_hops) });
+        }
+    }
+
+    return routes;
+}
+
+tnt::MacAddress mac(uint16_t next_hop)
+{
+    return tnt::MacAddress({ 0x02, 0, 0, 0, 0, static_cast<uint8_t>(next_hop) });
+}
+
+// Longest prefix match by prefix length, one hash lookup per length.
+class Reference
+{
+public:
+    void add(const Route& r)
+    {
+        table_[r.prefix][r.address] = r.next_hop;
+    }
+
+    void del(const Route& r)
+    {
+        table_[r.prefix].erase(r.address);
+    }
+
+    int lookup(uint32_t address) const
+    {
+        for (auto p = 33; p-- > 0;)
+        {
+            auto it = table_[p].find(address & netmask(p));
+
+            if (it != std::end(table_[p]))
+            {
+                return it->second;
+            }
+        }
+
+        return -1;
+    }
+private:
+    std::unordered_map<uint32_t, uint16_t> table_[33];
+};
+
+size_t rss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string key;
+
+    while (status >> key)
+    {
+        if (key == "VmRSS:")
+        {
+            size_t kb = 0;
+            status >> kb;
+
+            return kb * 1024;
+        }
+    }
+
+    return 0;
+}
+
+bool check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+
+    return condition;
+}
+
+bool matches(const drop::LookupTable& table, const Reference& reference, const std::vector<uint32_t>& addresses)
+{
+    for (auto a : addresses)
+    {
+        const auto& node = table.lookup(htonl(a));
+        auto expected = reference.lookup(a);
+
+        if (expected < 0 ? !node.def : (node.def || node.port != expected || static_cast<uint8_t>(node.dst[5]) != expected))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void load(drop::LookupTable& table, const std::vector<Route>& routes)
+{
+    table.begin_batch();
+
+    for (const auto& r : routes)
+    {
+        table.add(htonl(r.address), r.prefix, mac(r.next_hop), r.next_hop);
+    }
+
+    table.commit();
+}
+
+// Every lookup of random addresses and of the first address of every route.
+bool correct(const std::vector<Route>& routes, std::mt19937& gen)
+{
+    std::vector<uint32_t> addresses;
+
+    for (const auto& r : routes)
+    {
+        addresses.push_back(r.address);
+        addresses.push_back(r.address | (~netmask(r.prefix) & static_cast<uint32_t>(gen())));
+    }
+
+    Reference reference;
+
+    for (const auto& r : routes)
+    {
+        reference.add(r);
+    }
+
+    auto ok = true;
+    auto sorted = routes;
+
+    std::shuffle(std::begin(sorted), std::end(sorted), gen);
+
+    {
+        drop::LookupTable table(0x8000);
+        load(table, sorted);
+        ok &= check(matches(table, reference, addresses), "lookup of routes added in random order");
+
+        for (size_t i = 0; i < sorted.size(); i += 2)
+        {
+            table.del(htonl(sorted[i].address), sorted[i].prefix);
+            reference.del(sorted[i]);
+        }
+
+        ok &= check(matches(table, reference, addresses), "lookup after deleting half of the routes");
+
+        for (size_t i = 0; i < sorted.size(); i += 2)
+        {
+            reference.add(sorted[i]);
+        }
+    }
+
+    for (auto longest_first : { true, false })
+    {
+        std::stable_sort(std::begin(sorted), std::end(sorted), [longest_first] (const Route& a, const Route& b)
+        {
+            return longest_first ? a.prefix > b.prefix : a.prefix < b.prefix;
+        });
+
+        drop::LookupTable table(0x8000);
+        load(table, sorted);
+        ok &= check(matches(table, reference, addresses), longest_first ? "lookup of routes added longest first" : "lookup of routes added shortest first");
+    }
+
+    return ok;
+}
+
+template <class F> double rate(const std::vector<uint32_t>& addresses, F lookup)
+{
+    uint64_t sum = 0;
+    auto start = Clock::now();
+
+    for (auto a : addresses)
+    {
+        sum += lookup(a);
+    }
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    // Keeps the lookups from being optimized away.
+    if (sum == 1)
+    {
+        std::cout << "";
+    }
+
+    return addresses.size() / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 900000;
+    auto lookups = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 20000000;
+    auto host_limit = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 16000000;
+
+    std::mt19937 gen(42);
+
+    if (!correct(random_routes(20000, gen), gen))
+    {
+        return EXIT_FAILURE;
+    }
+
+    auto routes = random_routes(count, gen);
+
+    std::vector<uint32_t> addresses(lookups);
+    std::generate(std::begin(addresses), std::end(addresses), [&gen] () { return htonl(static_cast<uint32_t>(gen())); });
+
+    // DIR-24-8.
+    auto before = rss();
+    auto start = Clock::now();
+
+    auto table = std::make_unique<drop::LookupTable>(0x8000);
+    load(*table, routes);
+
+    std::chrono::duration<double> load_time = Clock::now() - start;
+    auto table_size = rss() - before;
+
+    auto table_rate = rate(addresses, [&table] (uint32_t a) { return table->lookup(a).port; });
+
+    // Covered addresses, from the routes of a prefix not inside a shorter route.
+    uint64_t covered = 0;
+    {
+        Reference shorter;
+        auto sorted = routes;
+
+        std::sort(std::begin(sorted), std::end(sorted), [] (const Route& a, const Route& b) { return a.prefix < b.prefix; });
+
+        for (const auto& r : sorted)
+        {
+            if (shorter.lookup(r.address) < 0)
+            {
+                covered += uint64_t(1) << (32 - r.prefix);
+            }
+
+            shorter.add(r);
+        }
+    }
+
+    table.reset();
+
+    // The replaced per-host table, with the hosts of the longest prefixes up to the limit.
+    std::sort(std::begin(routes), std::end(routes), [] (const Route& a, const Route& b) { return a.prefix > b.prefix; });
+
+    before = rss();
+
+    std::unordered_map<uint32_t, HostNode> hosts;
+    size_t loaded = 0;
+
+    for (const auto& r : routes)
+    {
+        auto n = uint64_t(1) << (32 - r.prefix);
+
+        if (hosts.size() + n > host_limit)
+        {
+            break;
+        }
+
+        HostNode node{ false, { 0x02, 0, 0, 0, 0, static_cast<char>(r.next_hop) } };
+
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            hosts.emplace(htonl(r.address + static_cast<uint32_t>(i)), node);
+        }
+
+        ++loaded;
+    }
+
+    auto hosts_size = rss() - before;
+    auto per_host = static_cast<double>(hosts_size) / std::max<size_t>(hosts.size(), 1);
+
+    HostNode miss{ true, {} };
+    auto hosts_rate = rate(addresses, [&hosts, &miss] (uint32_t a)
+    {
+        auto it = hosts.find(a);
+
+        return static_cast<uint8_t>((it != std::end(hosts) ? it->second : miss).dst[5]);
+    });
+
+    std::cout << "OK" << std::endl;
+    std::cout << "DIR-24-8: " << count << " prefixes loaded in " << load_time.count() << " s, ";
+    std::cout << table_size / (1024 * 1024) << " MiB resident, " << table_rate / 1e6 << " M lookups/s" << std::endl;
+    std::cout << "per-host: " << loaded << " prefixes (" << hosts.size() << " hosts), ";
+    std::cout << hosts_size / (1024 * 1024) << " MiB resident, " << hosts_rate / 1e6 << " M lookups/s" << std::endl;
+    std::cout << "per-host, full table: " << covered << " hosts, about " << static_cast<uint64_t>(covered * per_host / (1024 * 1024 * 1024)) << " GiB" << std::endl;
+
+    std::exit(EXIT_SUCCESS);
+}
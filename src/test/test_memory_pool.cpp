@@ -0,0 +1,347 @@
+/*
+ * benchmark tnt::MemoryPool against malloc
+ *
+ * Checks that live blocks never overlap, that blocks freed by another thread and by
+ * exiting threads are reused, and that PoolAllocator works with the standard containers,
+ * std::allocate_shared and std::promise. Then times, for the pool and for malloc:
+ * allocations and frees of mixed small sizes on one thread, objects allocated by
+ * producer threads and freed by one consumer as the events of Application are, and the
+ * latency of single allocations.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework/common test_memory_pool.cpp ../framework/common/memory_pool.cpp \
+ *       -o test_memory_pool -lpthread
+ *
+ * Usage: test_memory_pool [operations]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <future>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include "memory_pool.hpp"
+#include "mpsc_queue.hpp"
+
+namespace {
+
+struct Pool
+{
+    static void* allocate(std::size_t size)
+    {
+        return tnt::MemoryPool::allocate(size);
+    }
+
+    static void deallocate(void* p, std::size_t size)
+    {
+        tnt::MemoryPool::deallocate(p, size);
+    }
+};
+
+struct Malloc
+{
+    static void* allocate(std::size_t size)
+    {
+        return std::malloc(size);
+    }
+
+    static void deallocate(void* p, std::size_t /*size*/)
+    {
+        std::free(p);
+    }
+};
+
+bool check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+
+    return condition;
+}
+
+// The sizes of the events, handlers and promise states, plus a few beyond max_size.
+std::size_t size_of(uint32_t i)
+{
+    static const std::size_t sizes[] = { 8, 24, 40, 64, 72, 100, 128, 200, 256, 300, 512, 1000, 1500 };
+
+    return sizes[i % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+bool overlap()
+{
+    std::vector<std::pair<unsigned char*, std::size_t>> blocks;
+
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        auto size = size_of(i * 7);
+        auto p = static_cast<unsigned char*>(tnt::MemoryPool::allocate(size));
+        std::memset(p, static_cast<int>(i & 0xff), size);
+        blocks.emplace_back(p, size);
+
+        // Frees a third of the blocks on the way, to reuse them.
+        if (i % 3 == 0)
+        {
+            auto& b = blocks[i / 2];
+
+            if (b.first)
+            {
+                tnt::MemoryPool::deallocate(b.first, b.second);
+                b.first = nullptr;
+            }
+        }
+    }
+
+    auto ok = true;
+
+    for (uint32_t i = 0; i < blocks.size(); ++i)
+    {
+        auto& b = blocks[i];
+
+        if (b.first)
+        {
+            ok &= std::count(b.first, b.first + b.second, static_cast<unsigned char>(i & 0xff)) == static_cast<long>(b.second);
+            ok &= reinterpret_cast<std::uintptr_t>(b.first) % tnt::MemoryPool::alignment == 0;
+            tnt::MemoryPool::deallocate(b.first, b.second);
+        }
+    }
+
+    return check(ok, "live blocks overlap or are misaligned");
+}
+
+bool reuse()
+{
+    // A size class no other check uses.
+    const auto count = 4096;
+
+    std::vector<void*> blocks(count);
+
+    // Allocated by an exiting thread, freed by another exiting thread.
+    std::thread([&blocks] ()
+    {
+        for (auto& b : blocks)
+        {
+            b = tnt::MemoryPool::allocate(176);
+        }
+    }).join();
+
+    std::thread([&blocks] ()
+    {
+        for (auto b : blocks)
+        {
+            tnt::MemoryPool::deallocate(b, 176);
+        }
+    }).join();
+
+    auto reused = 0;
+    std::vector<void*> again(count);
+
+    for (auto& b : again)
+    {
+        b = tnt::MemoryPool::allocate(176);
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+
+    for (auto b : again)
+    {
+        reused += std::binary_search(blocks.begin(), blocks.end(), b);
+        tnt::MemoryPool::deallocate(b, 176);
+    }
+
+    // All but the rest of the last batch of the first thread.
+    return check(reused >= count - 64, "blocks of exited threads reused");
+}
+
+bool allocators()
+{
+    std::vector<int, tnt::PoolAllocator<int>> v;
+    std::list<std::string, tnt::PoolAllocator<std::string>> l;
+    std::map<int, int, std::less<int>, tnt::PoolAllocator<std::pair<const int, int>>> m;
+
+    for (auto i = 0; i < 1000; ++i)
+    {
+        v.push_back(i);
+        l.push_back(std::to_string(i));
+        m[i] = i;
+    }
+
+    auto ok = check(v[999] == 999 && l.back() == "999" && m[500] == 500, "containers");
+
+    auto shared = std::allocate_shared<std::pair<int, double>>(tnt::PoolAllocator<char>(), 1, 2.0);
+    ok &= check(shared->first == 1, "allocate_shared");
+
+    std::promise<int> promise(std::allocator_arg, tnt::PoolAllocator<char>());
+    auto future = promise.get_future();
+
+    std::thread([&promise] ()
+    {
+        promise.set_value(42);
+    }).join();
+
+    ok &= check(future.get() == 42, "promise");
+
+#if defined(TNT_HAS_MEMORY_RESOURCE)
+    std::pmr::vector<int> pv(tnt::PoolResource::instance());
+
+    for (auto i = 0; i < 1000; ++i)
+    {
+        pv.push_back(i);
+    }
+
+    ok &= check(pv[999] == 999, "memory resource");
+#endif
+
+    return ok;
+}
+
+template <class A> double same_thread(uint32_t operations)
+{
+    std::vector<std::pair<void*, std::size_t>> live(64, std::make_pair(nullptr, 0));
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+        auto& slot = live[(i * 13) % live.size()];
+
+        if (slot.first)
+        {
+            A::deallocate(slot.first, slot.second);
+        }
+
+        slot.second = size_of(i) % 512;
+        slot.first = A::allocate(slot.second);
+        *static_cast<char*>(slot.first) = 0;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto& slot : live)
+    {
+        A::deallocate(slot.first, slot.second);
+    }
+
+    return operations / elapsed.count();
+}
+
+template <class A> double cross_thread(uint32_t producers, uint32_t operations)
+{
+    tnt::MPSCQueue<void*> queue(1 << 12);
+    std::vector<std::thread> threads;
+    auto count = operations / producers;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, count] ()
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                auto e = A::allocate(64);
+                *static_cast<char*>(e) = 0;
+                queue.push(e);
+            }
+        });
+    }
+
+    std::vector<void*> batch;
+
+    for (uint64_t left = static_cast<uint64_t>(count) * producers; left > 0; left -= batch.size())
+    {
+        batch.clear();
+        queue.pop_some(batch, 256);
+
+        for (auto e : batch)
+        {
+            A::deallocate(e, 64);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    return static_cast<double>(count) * producers / elapsed.count();
+}
+
+// Percentiles of single allocations in ns, timing included.
+template <class A> std::vector<double> latency(uint32_t operations)
+{
+    std::vector<double> samples;
+    std::vector<void*> blocks;
+    samples.reserve(operations);
+    blocks.reserve(1024);
+
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        blocks.push_back(A::allocate(96));
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+
+        if (blocks.size() == 1024)
+        {
+            for (auto b : blocks)
+            {
+                A::deallocate(b, 96);
+            }
+
+            blocks.clear();
+        }
+    }
+
+    for (auto b : blocks)
+    {
+        A::deallocate(b, 96);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    return { samples[samples.size() / 2], samples[samples.size() * 99 / 100], samples[samples.size() * 999 / 1000], samples.back() };
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto operations = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 2000000;
+
+    if (!overlap() || !reuse() || !allocators())
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "same thread:  malloc " << same_thread<Malloc>(operations) << " ops/s, pool " << same_thread<Pool>(operations) << " ops/s" << std::endl;
+
+    for (uint32_t producers = 1; producers <= 8; producers *= 2)
+    {
+        std::cout << producers << " producers: malloc " << cross_thread<Malloc>(producers, operations) << " objects/s, pool " << cross_thread<Pool>(producers, operations) << " objects/s" << std::endl;
+    }
+
+    std::cout << std::setprecision(1);
+
+    for (auto& l : { std::make_pair("malloc", latency<Malloc>(operations / 4)), std::make_pair("pool  ", latency<Pool>(operations / 4)) })
+    {
+        std::cout << "latency " << l.first << ": p50 " << l.second[0] << " ns, p99 " << l.second[1] << " ns, p99.9 " << l.second[2] << " ns, max " << l.second[3] << " ns" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*
+ * test the lock-free MPSCQueue against ThreadSafeFIFO
+ *
+ * Checks that no element is lost and that the elements of every producer come out in
+ * order, with a ring large enough and with one so small that most pushes go to the
+ * overflow list, that the consumer can push to its own full queue and that pop_for
+ * times out. Then times 1 to 32 producer threads pushing to one consumer draining
+ * batches, for both queues.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -pthread -I../framework/common test_mpsc_queue.cpp -o test_mpsc_queue
+ *
+ * Usage: test_mpsc_queue [elements per producer]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+
+#include "mpsc_queue.hpp"
+#include "thread_safe_fifo.hpp"
+
+namespace {
+
+using Element = std::pair<uint32_t, uint32_t>; // Producer, sequence number.
+
+bool check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+
+    return condition;
+}
+
+template <class Q> void pop_batch(Q& queue, std::vector<Element>& batch)
+{
+    queue.pop_some(batch, 256);
+}
+
+void pop_batch(tnt::ThreadSafeFIFO<Element>& queue, std::vector<Element>& batch)
+{
+    batch.push_back(queue.pop());
+}
+
+// Returns the elements per second through the queue, ok is false if one is lost or out of order.
+template <class Q> double run(Q& queue, uint32_t producers, uint32_t count, bool& ok)
+{
+    std::vector<uint32_t> next(producers, 0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, p, count] ()
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                queue.push(Element(p, i));
+            }
+        });
+    }
+
+    std::vector<Element> batch;
+    uint64_t left = static_cast<uint64_t>(producers) * count;
+
+    while (left > 0)
+    {
+        batch.clear();
+        pop_batch(queue, batch);
+
+        for (auto& e : batch)
+        {
+            ok &= e.second == next[e.first]++;
+        }
+
+        left -= batch.size();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    return producers * static_cast<double>(count) / elapsed.count();
+}
+
+bool order()
+{
+    auto ok = true;
+
+    {
+        tnt::MPSCQueue<Element> queue(1 << 16);
+        run(queue, 8, 100000, ok);
+        ok &= check(ok && queue.empty(), "elements lost or out of order");
+    }
+
+    {
+        tnt::MPSCQueue<Element> queue(4);
+        run(queue, 8, 100000, ok);
+        ok &= check(ok && queue.empty(), "elements lost or out of order through the overflow");
+    }
+
+    return ok;
+}
+
+bool own_queue()
+{
+    tnt::MPSCQueue<uint32_t> queue(4);
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        queue.push(i);
+    }
+
+    auto ok = check(queue.size() == 16, "size with the overflow");
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        ok &= check(queue.pop() == i, "pop in order");
+    }
+
+    uint32_t elem;
+    auto start = std::chrono::steady_clock::now();
+    ok &= check(!queue.pop_for(elem, std::chrono::milliseconds(20)), "pop_for on an empty queue");
+    ok &= check(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20), "pop_for waits");
+
+    std::thread producer([&queue] ()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.push(42);
+    });
+
+    ok &= check(queue.pop_for(elem, std::chrono::seconds(5)) && elem == 42, "pop_for woken by a push");
+    producer.join();
+
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto count = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 200000;
+
+    if (!order() || !own_queue())
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK" << std::endl;
+    std::cout << "producers  ThreadSafeFIFO  MPSCQueue (elements/s)" << std::endl;
+
+    auto ok = true;
+
+    for (uint32_t producers = 1; producers <= 32; producers *= 2)
+    {
+        tnt::ThreadSafeFIFO<Element> locked;
+        tnt::MPSCQueue<Element> lock_free(1 << 16);
+
+        auto locked_rate = run(locked, producers, count / producers, ok);
+        auto lock_free_rate = run(lock_free, producers, count / producers, ok);
+
+        std::cout << std::setw(9) << producers << std::setw(16) << static_cast<uint64_t>(locked_rate) << std::setw(11) << static_cast<uint64_t>(lock_free_rate) << std::endl;
+    }
+
+    return check(ok, "elements lost or out of order") ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,283 @@
+/*
+ * test the netmap forwarding pipeline
+ *
+ * Runs NetmapInterfaceLib::process_rings on netmap rings laid out in memory, so
+ * it does not need the netmap module nor a NIC. Two ports are simulated: their rx
+ * rings are filled with 64 bytes IPv4 frames towards random routed and unrouted
+ * destinations, the routes send them to either port. The forwarded frames are
+ * checked (tx ring of the egress port, next hop MAC, source MAC of the egress
+ * port, TTL, checksum) and the pipeline is then timed in packets per second on
+ * one core.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib -I../se \
+ *       test_netmap_pipeline.cpp ../se/util/netmap_interface_lib.cpp ../se/util/interface_lib.cpp \
+ *       ../lib/util/lookup_table.cpp ../framework/common/quiescent_state.cpp ../framework/util/crc.cpp \
+ *       ../framework/util/configuration.cpp ../framework/common/log.cpp ../framework/common/colors.cpp \
+ *       ../framework/common/file_descriptor.cpp ../framework/exception/exception.cpp ../framework/util/string.cpp \
+ *       -o test_netmap_pipeline -lpthread -latomic
+ *
+ * Usage: test_netmap_pipeline [burst] [slots] [rounds]
+ *
+ * slots is the size of each ring.
+ */
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <arpa/inet.h>
+
+#include "util/netmap.h"
+#include "util/netmap_interface_lib.hpp"
+#include "util/lookup_table.hpp"
+#include "util/crc.hpp"
+
+#include "mac_address.hpp"
+
+namespace {
+
+const uint16_t buf_size = 2048;
+const uint16_t frame_len = 64;
+
+// Source MAC of each port.
+const std::vector<tnt::MacAddress> src_macs = { tnt::MacAddress("02:00:00:00:00:01"), tnt::MacAddress("02:00:00:00:00:02") };
+
+// One rx and one tx ring per port, sharing a buffer pool as the netmap rings do (netmap
+// reserves the buffer indices 0 and 1). The tx rings are large enough to take the frames
+// of all the rx rings, so the check does not depend on how the routes split the traffic.
+class MockRings
+{
+public:
+    MockRings(int ports, uint32_t slots): ports_(ports), slots_(slots)
+    {
+        auto rx_size = ring_size(slots);
+        auto tx_size = ring_size(ports * slots);
+        auto rings = ports * (rx_size + tx_size);
+
+        mem_.reset(new char[rings + (ports * slots + ports * ports * slots + 2) * buf_size + 64]);
+
+        auto pool = (reinterpret_cast<uintptr_t>(mem_.get()) + rings + 63) & ~uintptr_t(63);
+
+        for (auto p = 0; p < ports; ++p)
+        {
+            rx_.push_back(init(mem_.get() + p * (rx_size + tx_size), slots, pool));
+            tx_.push_back(init(mem_.get() + p * (rx_size + tx_size) + rx_size, ports * slots, pool));
+        }
+    }
+
+    netmap_ring* const* rx() const { return rx_.data(); }
+    netmap_ring* const* tx() const { return tx_.data(); }
+
+    uint8_t* buf(netmap_ring* r, uint32_t idx)
+    {
+        return reinterpret_cast<uint8_t*>(r) + r->buf_ofs + idx * r->nr_buf_size;
+    }
+
+    // Gives the slots their original buffers, fills the rx rings with frames (slots frames
+    // per port) and makes the whole tx rings available.
+    void refill(const std::vector<std::vector<uint8_t>>& frames)
+    {
+        auto tx_slots = ports_ * slots_;
+
+        for (auto p = 0; p < ports_; ++p)
+        {
+            auto rx_first = 2 + p * slots_;
+            auto tx_first = 2 + tx_slots + p * tx_slots;
+
+            for (auto i = 0u; i < slots_; ++i)
+            {
+                rx_[p]->slot[i].buf_idx = rx_first + i;
+                rx_[p]->slot[i].len = frame_len;
+                rx_[p]->slot[i].flags = 0;
+
+                std::memcpy(buf(rx_[p], rx_first + i), frames[p * slots_ + i].data(), frame_len);
+            }
+
+            for (auto i = 0u; i < tx_slots; ++i)
+            {
+                tx_[p]->slot[i].buf_idx = tx_first + i;
+                tx_[p]->slot[i].len = 0;
+                tx_[p]->slot[i].flags = 0;
+            }
+
+            rx_[p]->cur = tx_[p]->cur = 0;
+            rx_[p]->avail = slots_;
+            tx_[p]->avail = tx_slots;
+        }
+    }
+private:
+    static size_t ring_size(uint32_t slots)
+    {
+        return (sizeof(netmap_ring) + slots * sizeof(netmap_slot) + 63) & ~size_t(63);
+    }
+
+    netmap_ring* init(char* ring, uint32_t slots, uintptr_t pool)
+    {
+        netmap_ring r = {
+            static_cast<ssize_t>(pool - reinterpret_cast<uintptr_t>(ring)),
+            slots, 0, 0, 0, buf_size, 0, timeval()
+        };
+
+        std::memcpy(ring, &r, sizeof(r));
+
+        return reinterpret_cast<netmap_ring*>(ring);
+    }
+private:
+    int ports_;
+    uint32_t slots_;
+    std::unique_ptr<char[]> mem_;
+    std::vector<netmap_ring*> rx_;
+    std::vector<netmap_ring*> tx_;
+};
+
+class MockInterfaceLib: public drop::NetmapInterfaceLib
+{
+public:
+    MockInterfaceLib(drop::LookupTable& table, unsigned int burst): NetmapInterfaceLib(table, src_macs, burst) {}
+
+    using NetmapInterfaceLib::process_rings;
+};
+
+std::vector<uint8_t> frame(uint32_t dst)
+{
+    std::vector<uint8_t> f(frame_len, 0);
+
+    f[12] = 0x08;
+    f[13] = 0x00;
+
+    auto ip = &f[14];
+
+    ip[0] = 0x45;
+    ip[3] = frame_len - 14;
+    ip[8] = 64;  // TTL
+    ip[9] = 17;  // UDP
+    ip[12] = 10; // Source 10.0.0.1
+    ip[15] = 1;
+
+    std::memcpy(&ip[16], &dst, sizeof(dst));
+
+    auto cs = tnt::crc16(ip, 20);
+    std::memcpy(&ip[10], &cs, sizeof(cs));
+
+    return f;
+}
+
+tnt::MacAddress next_hop(int i)
+{
+    return tnt::MacAddress({ 0x02, 0x00, 0x00, 0x00, 0x01, static_cast<uint8_t>(i) });
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto burst = argc > 1 ? std::atoi(argv[1]) : 32;
+    auto slots = argc > 2 ? std::atoi(argv[2]) : 1024;
+    auto rounds = argc > 3 ? std::atoi(argv[3]) : 20000;
+
+    std::mt19937 gen(5);
+
+    const auto ports = 2;
+
+    // A few thousand /24 and /16 routes in 10.0.0.0/8 and 172.16.0.0/12, a handful of /32s, 8 next hops on two ports.
+    drop::LookupTable table(64);
+    std::uniform_int_distribution<uint32_t> any;
+
+    table.add(htonl(0x0a000000), 9, next_hop(0), 0);
+    table.add(htonl(0x0a800000), 9, next_hop(0), 1);
+
+    for (auto i = 0; i < 4000; ++i)
+    {
+        table.add(htonl(0x0a000000 | (any(gen) & 0x00ffff00)), 24, next_hop(1 + i % 7), i % ports);
+        table.add(htonl(0xac100000 | (any(gen) & 0x000f0000)), 16, next_hop(1 + i % 7), i % ports);
+    }
+
+    for (auto i = 0; i < 32; ++i)
+    {
+        table.add(htonl(0x0a000000 | (any(gen) & 0x00ffffff)), 32, next_hop(i % 8), i % ports);
+    }
+
+    // 10.0.0.0/8 is routed, 192.168.0.0/16 is not.
+    std::vector<std::vector<uint8_t>> frames;
+
+    for (auto i = 0; i < ports * slots; ++i)
+    {
+        auto dst = i % 16 == 15 ? 0xc0a80000 | (any(gen) & 0xffff) : 0x0a000000 | (any(gen) & 0xffffff);
+        frames.push_back(frame(htonl(dst)));
+    }
+
+    MockRings rings(ports, slots);
+    MockInterfaceLib lib(table, burst);
+
+    drop::RingCounters counters;
+
+    rings.refill(frames);
+    lib.process_rings(rings.rx(), rings.tx(), ports, counters);
+
+    auto errors = 0;
+    uint32_t k[ports] = { 0, 0 };
+    auto unrouted = 0u;
+
+    // The rx rings are served in port order, the frames are in the same order.
+    for (auto i = 0; i < ports * slots; ++i)
+    {
+        uint32_t dst;
+        std::memcpy(&dst, &frames[i][30], sizeof(dst));
+
+        const auto& node = table.lookup(dst);
+
+        if (node.def)
+        {
+            ++unrouted;
+
+            continue;
+        }
+
+        auto tx = rings.tx()[node.port];
+        auto pkt = rings.buf(tx, tx->slot[k[node.port]++].buf_idx);
+
+        if (std::memcmp(pkt, node.dst, 6) != 0 || std::memcmp(pkt + 6, src_macs[node.port].raw().data(), 6) != 0 || pkt[22] != 63 || tnt::crc16(pkt + 14, 20) != 0)
+        {
+            ++errors;
+        }
+    }
+
+    auto sent = k[0] + k[1];
+
+    if (errors != 0 || counters.tx != sent || counters.rx != static_cast<uint_fast64_t>(ports * slots) || counters.no_route != unrouted ||
+        counters.dropped() != unrouted || rings.tx()[0]->cur != k[0] || rings.tx()[1]->cur != k[1] || rings.rx()[0]->avail != 0 || rings.rx()[1]->avail != 0)
+    {
+        std::cout << "FAILED: " << errors << " wrong frames, rx " << counters.rx << " tx " << counters.tx << " (expected " << sent << ")"
+            << " no route " << counters.no_route << " (expected " << unrouted << ") dropped " << counters.dropped() << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK: " << counters.tx << " forwarded (" << k[0] << " to port 0, " << k[1] << " to port 1), " << counters.dropped() << " dropped" << std::endl;
+
+    std::chrono::nanoseconds elapsed{ 0 };
+    counters.rx = 0;
+
+    for (auto r = 0; r < rounds; ++r)
+    {
+        rings.refill(frames);
+
+        auto start = std::chrono::steady_clock::now();
+        lib.process_rings(rings.rx(), rings.tx(), ports, counters);
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    auto rx = static_cast<double>(counters.rx);
+    auto mpps = rx / static_cast<double>(elapsed.count()) * 1000;
+
+    std::cout << "burst " << burst << ": " << mpps << " Mpps, " << static_cast<double>(elapsed.count()) / rx << " ns/packet" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * test the coalescing send path of AsyncProtocol
+ *
+ * A controller side AsyncProtocol on a loopback TcpIO sends flow-mod sized OpenFlow
+ * messages to a mock switch, which frames them on the length of their header and
+ * checks their order through the xid. The flow-mods are sent the way the controller
+ * does it, queued to the tx loop which coalesces them in one send per batch, and then
+ * written one by one from another thread, one send per message.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib \
+ *       test_openflow_send.cpp ../framework/protocol/async_protocol.cpp ../framework/io/tcp_io.cpp ../framework/io/reactor.cpp \
+ *       ../framework/io/receive_buffer.cpp ../framework/common/application.cpp ../framework/activity/activity_from_event.cpp \
+ *       ../framework/util/system.cpp ../framework/common/init_sockets.cpp ../framework/common/ip_address.cpp \
+ *       ../framework/common/ip_socket_address.cpp ../framework/common/log.cpp ../framework/common/colors.cpp \
+ *       ../framework/common/demangle.cpp ../framework/exception/exception.cpp ../framework/util/configuration.cpp \
+ *       ../framework/util/string.cpp ../framework/common/quiescent_state.cpp ../framework/common/executor.cpp ../framework/common/memory_pool.cpp \
+ *       -o test_openflow_send -lpthread
+ *
+ * Usage: test_openflow_send [flows] [port]
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <arpa/inet.h>
+
+#include "protocol/async_protocol.hpp"
+#include "message/message.hpp"
+#include "io/tcp_io.hpp"
+
+#include "ip_socket_address.hpp"
+
+namespace {
+
+// ofp_flow_mod_1_3 with an IPv4 destination match and an output action.
+const size_t flow_mod_len = 88;
+
+struct FlowMod: public tnt::Message
+{
+    explicit FlowMod(uint32_t x): xid(x) {}
+
+    uint32_t xid;
+};
+
+std::string flow_mod(uint32_t xid)
+{
+    std::string m(flow_mod_len, '\0');
+
+    m[0] = 0x04;
+    m[1] = 14; // OFPT_FLOW_MOD
+
+    uint16_t len = htons(flow_mod_len);
+    std::memcpy(&m[2], &len, sizeof(len));
+
+    xid = htonl(xid);
+    std::memcpy(&m[4], &xid, sizeof(xid));
+
+    return m;
+}
+
+class Controller: public tnt::protocol::AsyncProtocol
+{
+public:
+    explicit Controller(const std::shared_ptr<tnt::IO>& io): AsyncProtocol(io) {}
+
+    using AsyncProtocol::write;
+private:
+    virtual size_t parse(tnt::BufferView input, std::vector<tnt::BufferView>& /*messages*/) override
+    {
+        return input.size();
+    }
+
+    virtual void invoke_message(tnt::BufferView /*data*/) override {}
+
+    virtual void register_messages() override
+    {
+        register_message<FlowMod>([this] (auto message)
+        {
+            write(flow_mod(message->xid));
+        });
+    }
+};
+
+// Frames the flow-mods and counts the ones in order, as a switch would.
+class MockSwitch
+{
+public:
+    explicit MockSwitch(const std::shared_ptr<tnt::IO>& io): io_(io), errors_{ 0 } {}
+
+    void expect(uint32_t first, uint32_t count)
+    {
+        std::vector<char> buf(256 * 1024);
+        size_t have = 0;
+        auto next = first;
+
+        while (next != first + count)
+        {
+            have += io_->read_some(buf.data() + have, buf.size() - have);
+
+            size_t pos = 0;
+
+            while (have - pos >= 8)
+            {
+                uint16_t len;
+                std::memcpy(&len, &buf[pos + 2], sizeof(len));
+                len = ntohs(len);
+
+                if (have - pos < len)
+                {
+                    break;
+                }
+
+                uint32_t xid;
+                std::memcpy(&xid, &buf[pos + 4], sizeof(xid));
+
+                if (ntohl(xid) != next || len != flow_mod_len)
+                {
+                    ++errors_;
+                }
+
+                ++next;
+                pos += len;
+            }
+
+            std::memmove(buf.data(), buf.data() + pos, have - pos);
+            have -= pos;
+        }
+    }
+
+    uint32_t errors() const { return errors_; }
+private:
+    std::shared_ptr<tnt::IO> io_;
+    std::atomic<uint32_t> errors_;
+};
+
+template <class F> double flows_per_second(MockSwitch& sw, uint32_t first, uint32_t count, F send)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::thread rx([&] () { sw.expect(first, count); });
+
+    send();
+
+    rx.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return count / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto n = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 100000;
+    auto port = argc > 2 ? static_cast<uint16_t>(std::atoi(argv[2])) : 16653;
+
+    tnt::ip::SocketAddress address("127.0.0.1", static_cast<short>(port));
+
+    tnt::io::TcpIOServer server(address);
+    std::shared_ptr<tnt::IO> switch_io;
+
+    std::thread acceptor([&] () { switch_io = server.get(); });
+
+    auto controller = std::make_shared<Controller>(tnt::io::TcpIOClient(address).get());
+    acceptor.join();
+
+    MockSwitch sw(switch_io);
+
+    controller->start();
+
+    auto queued = flows_per_second(sw, 0, n, [&] ()
+    {
+        for (auto i = 0u; i < n; ++i)
+        {
+            controller->send(std::make_unique<FlowMod>(i));
+        }
+    });
+
+    auto unbatched = flows_per_second(sw, n, n, [&] ()
+    {
+        for (auto i = n; i < 2 * n; ++i)
+        {
+            controller->write(flow_mod(i));
+        }
+    });
+
+    if (sw.errors() != 0)
+    {
+        std::cout << "FAILED: " << sw.errors() << " flow-mods out of order" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK: " << 2 * n << " flow-mods" << std::endl;
+    std::cout << "tx loop, coalesced: " << queued << " flow-mods/s" << std::endl;
+    std::cout << "one send each:      " << unbatched << " flow-mods/s" << std::endl;
+    std::cout << "50 ms sleep:        20 flow-mods/s" << std::endl;
+
+    std::exit(EXIT_SUCCESS); // The protocol threads block in their IO, do not wait for them.
+}
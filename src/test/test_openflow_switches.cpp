@@ -0,0 +1,459 @@
+/*
+ * benchmark the controller side of OpenFlow against emulated switches
+ *
+ * Emulates OpenFlow 1.3 switches with SwitchSideOpenflow_1_3 over loopback TCP, against
+ * the Openflow connections of the controller running in the same process. Each switch
+ * does the HELLO/FEATURES handshake, ends it when the controller removes all its flows,
+ * then measures:
+ *
+ *   - the handshake latency, from the connect to the first flow-mod;
+ *   - the echo round trip;
+ *   - the flow-mods per second, sent by the controller and confirmed by barriers;
+ *   - the packet-in to flow-mod round trip, with a window of packet-ins in flight per
+ *     switch, the way cbench floods a controller. The controller answers every
+ *     packet-in with a flow-mod for its buffer.
+ *
+ * Openflow::register_messages, set_features and packet_in are defined here, as each
+ * target does: the controller only sends the flow-mods, without the services of the CE.
+ *
+ * With reactor loops, both sides run on the io::Reactor instead of two threads per
+ * connection; the flow-mods beyond the window of a connection are then queued and
+ * sent as its barrier replies come in, without holding the notification thread of
+ * its loop.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib \
+ *       test_openflow_switches.cpp ../lib/protocol/openflow/openflow.cpp ../lib/protocol/openflow/openflow_version.cpp \
+ *       ../lib/protocol/openflow/transactions.cpp ../lib/protocol/openflow/flow.cpp ../lib/protocol/openflow/flow_factory.cpp \
+ *       ../lib/protocol/openflow/v_1_3/openflow_1_3.cpp ../lib/protocol/openflow/v_1_3/flow_mod_encoder.cpp \
+ *       ../lib/protocol/openflow/v_1_3/switch_side_openflow_1_3.cpp ../framework/protocol/async_protocol.cpp \
+ *       ../framework/io/reactor.cpp ../framework/io/tcp_io.cpp ../framework/io/receive_buffer.cpp ../framework/common/application.cpp \
+ *       ../framework/activity/activity_from_event.cpp ../framework/util/system.cpp ../framework/common/scheduler.cpp \
+ *       ../framework/common/init_sockets.cpp ../framework/common/ip_address.cpp ../framework/common/ip_socket_address.cpp \
+ *       ../framework/common/log.cpp ../framework/common/colors.cpp ../framework/common/demangle.cpp \
+ *       ../framework/exception/exception.cpp ../framework/util/configuration.cpp ../framework/util/string.cpp \
+ *       ../framework/common/quiescent_state.cpp ../framework/common/executor.cpp ../framework/common/memory_pool.cpp \
+ *       -o test_openflow_switches -lpthread
+ *
+ * Usage: test_openflow_switches [switches] [packet-ins per switch] [flow-mods per switch] [port] [reactor loops]
+ */
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#include "protocol/async_protocol.hpp"
+#include "protocol/openflow/openflow.hpp"
+#include "protocol/openflow/openflow_version.hpp"
+#include "protocol/openflow/flow.hpp"
+#include "protocol/openflow/flow_factory.hpp"
+#include "protocol/openflow/values.hpp"
+#include "protocol/openflow/v_1_3/switch_side_openflow_1_3.hpp"
+#include "protocol/openflow/v_1_3/switch_side_structs.hpp"
+#include "message/network/openflow_messages.hpp"
+#include "io/tcp_io.hpp"
+#include "io/reactor.hpp"
+#include "util/configuration.hpp"
+
+#include "ip_socket_address.hpp"
+#include "mac_address.hpp"
+#include "endianness.hpp"
+
+namespace drop {
+namespace protocol {
+
+void Openflow::register_messages()
+{
+    register_message<message::AddFlow>([this] (auto message)
+    {
+        add(message->flow(), std::move(message->confirmation()));
+    });
+
+    register_message<message::RemoveFlow>([this] (auto message)
+    {
+        remove(message->flow(), std::move(message->confirmation()));
+    });
+}
+
+void Openflow::set_features(uint64_t /*datapath_id*/)
+{
+    protocol_->remove_all();
+}
+
+void Openflow::packet_in(uint32_t buffer_id, uint16_t in_port, const char* frame, size_t size)
+{
+    if (size < 6)
+    {
+        return;
+    }
+
+    std::array<uint8_t, 6> dst;
+    std::memcpy(dst.data(), frame, dst.size());
+
+    auto flow = Flow().add(from_port(in_port)).add(from_hw_dst(tnt::MacAddress(dst))).add(to_port(in_port % 4 + 1)).add(buffer(buffer_id));
+    send(std::make_unique<message::AddFlow>(flow));
+}
+
+} // namespace protocol
+} // namespace drop
+
+namespace {
+
+using namespace drop;
+using namespace drop::protocol;
+
+using Clock = std::chrono::steady_clock;
+
+double microseconds(Clock::duration d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+// A frame from the switch, to a different destination for every sequence number.
+std::string frame(uint64_t datapath_id, uint32_t seq)
+{
+    std::string f(64, '\0');
+
+    f[0] = 0x02;
+    std::memcpy(&f[2], &seq, sizeof(seq));
+    f[6] = 0x02;
+    std::memcpy(&f[8], &datapath_id, 4);
+    f[12] = 0x08; // IPv4.
+
+    return f;
+}
+
+class EmulatedSwitch: public tnt::protocol::AsyncProtocol, public SwitchSideConnection
+{
+public:
+    EmulatedSwitch(const std::shared_ptr<tnt::IO>& io, uint64_t datapath_id): AsyncProtocol(io), datapath_id_(datapath_id), protocol_(this, datapath_id) {}
+
+    void connect(Clock::time_point start)
+    {
+        start_ = start;
+        protocol_.init();
+    }
+
+    bool wait_handshake(std::chrono::seconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        return cv_.wait_for(lock, timeout, [this] () { return connected_; });
+    }
+
+    double handshake() const { return microseconds(connected_at_ - start_); }
+
+    // Returns the round trip of an echo request in microseconds, a negative value on timeout.
+    double echo(uint32_t xid)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        echo_xid_ = xid;
+        echo_replied_ = false;
+
+        auto sent = Clock::now();
+        protocol_.echo_request(xid);
+
+        if (!cv_.wait_for(lock, std::chrono::seconds(5), [this] () { return echo_replied_; }))
+        {
+            return -1;
+        }
+
+        return microseconds(Clock::now() - sent);
+    }
+
+    // Sends window packet-ins, every flow-mod for one of them sends the next.
+    void flood(uint32_t count, uint32_t window)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sent_.assign(count, Clock::time_point());
+        rtts_.clear();
+        rtts_.reserve(count);
+        next_ = 0;
+
+        while (next_ < std::min(count, window))
+        {
+            packet_in();
+        }
+    }
+
+    bool wait_flood(std::chrono::seconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        return cv_.wait_for(lock, timeout, [this] () { return rtts_.size() == sent_.size(); });
+    }
+
+    const std::vector<double>& round_trips() const { return rtts_; }
+
+    bool wait_flow_mods(size_t count, std::chrono::seconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        return cv_.wait_for(lock, timeout, [this, count] () { return flow_mods_ >= count; });
+    }
+
+    virtual void write(const std::string& data) override
+    {
+        AsyncProtocol::write(data);
+    }
+
+    virtual void received(ofp_type_1_3 type, const std::string& message) override
+    {
+        auto now = Clock::now();
+        auto header = reinterpret_cast<const ofp_header_1_3*>(message.data());
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (type == ofp_type_1_3::ECHO_REPLY && ntohl(header->xid) == echo_xid_)
+        {
+            echo_replied_ = true;
+        }
+        else if (type == ofp_type_1_3::FLOW_MOD && message.size() >= sizeof(ofp_flow_mod_1_3))
+        {
+            auto pkt = reinterpret_cast<const ofp_flow_mod_1_3*>(message.data());
+            auto buffer_id = ntohl(pkt->buffer_id);
+
+            if (!connected_)
+            {
+                // The controller removes the flows of a switch at the end of the handshake.
+                connected_ = true;
+                connected_at_ = now;
+            }
+            else if (buffer_id != OFP_NO_BUFFER && buffer_id < sent_.size())
+            {
+                rtts_.push_back(microseconds(now - sent_[buffer_id]));
+
+                if (next_ < sent_.size())
+                {
+                    packet_in();
+                }
+            }
+            else if (pkt->command == ofp_flow_mod_command_1_3::ADD)
+            {
+                ++flow_mods_;
+            }
+        }
+        else
+        {
+            return;
+        }
+
+        cv_.notify_all();
+    }
+private:
+    void packet_in()
+    {
+        auto f = frame(datapath_id_, next_);
+        sent_[next_] = Clock::now();
+        protocol_.packet_in(next_, static_cast<uint16_t>(next_ % 4 + 1), f.data(), f.size());
+        ++next_;
+    }
+
+    virtual size_t parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages) override
+    {
+        size_t pos = 0;
+
+        while (input.size() - pos >= sizeof(ofp_header_1_3))
+        {
+            auto len = ntohs(reinterpret_cast<const ofp_header_1_3*>(input.data() + pos)->length);
+
+            if (input.size() - pos < len)
+            {
+                break;
+            }
+
+            messages.push_back(input.substr(pos, len));
+            pos += len;
+        }
+
+        return pos;
+    }
+
+    virtual void invoke_message(tnt::BufferView data) override
+    {
+        protocol_.packet(data.str());
+    }
+
+    virtual void register_messages() override {}
+private:
+    uint64_t datapath_id_;
+    SwitchSideOpenflow_1_3 protocol_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    Clock::time_point start_;
+    Clock::time_point connected_at_;
+    bool connected_ = false;
+
+    uint32_t echo_xid_ = 0;
+    bool echo_replied_ = false;
+
+    std::vector<Clock::time_point> sent_;
+    std::vector<double> rtts_;
+    uint32_t next_ = 0;
+
+    size_t flow_mods_ = 0;
+};
+
+void print(const char* what, std::vector<double> values)
+{
+    if (values.empty())
+    {
+        return;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    auto at = [&values] (double p) { return values[static_cast<size_t>(p * (values.size() - 1))]; };
+
+    std::cout << what << ": p50 " << at(0.5) << " us, p90 " << at(0.9) << " us, p99 " << at(0.99) << " us, max " << values.back() << " us" << std::endl;
+}
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto switches = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 16;
+    auto packet_ins = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 10000;
+    auto flow_mods = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 10000;
+    auto port = argc > 4 ? static_cast<uint16_t>(std::atoi(argv[4])) : 16654;
+    auto loops = argc > 5 ? static_cast<size_t>(std::atoi(argv[5])) : 0;
+
+    const uint32_t window = 64;
+    const uint32_t echoes = 100;
+    const auto timeout = std::chrono::seconds(30);
+
+    tnt::Configuration::default_init();
+
+    if (loops > 0)
+    {
+        tnt::io::Reactor::enable(loops);
+    }
+
+    tnt::ip::SocketAddress address("127.0.0.1", static_cast<short>(port));
+    tnt::io::TcpIOServer server(address);
+
+    std::vector<std::shared_ptr<Openflow>> controllers;
+    std::thread acceptor([&] ()
+    {
+        for (auto i = 0u; i < switches; ++i)
+        {
+            auto controller = std::make_shared<Openflow>(server.get());
+            controller->start();
+            controllers.push_back(controller);
+        }
+    });
+
+    // Handshakes, one switch after the other.
+    std::vector<std::shared_ptr<EmulatedSwitch>> sws;
+    std::vector<double> handshakes;
+
+    for (auto i = 0u; i < switches; ++i)
+    {
+        auto start = Clock::now();
+        auto sw = std::make_shared<EmulatedSwitch>(tnt::io::TcpIOClient(address).get(), i + 1);
+        sw->start();
+        sw->connect(start);
+
+        check(sw->wait_handshake(timeout), "no flow-mod at the end of the handshake");
+        handshakes.push_back(sw->handshake());
+        sws.push_back(sw);
+    }
+
+    acceptor.join();
+
+    // Echo round trips.
+    std::vector<double> echo_rtts;
+
+    for (auto& sw: sws)
+    {
+        for (auto i = 0u; i < echoes; ++i)
+        {
+            auto rtt = sw->echo(i + 1);
+            check(rtt >= 0, "no echo reply");
+            echo_rtts.push_back(rtt);
+        }
+    }
+
+    // Flow-mods from all the controller connections at once, done when the barriers confirm them.
+    std::vector<std::future<void>> confirmations;
+    confirmations.reserve(switches * flow_mods);
+
+    auto start = Clock::now();
+
+    for (auto i = 0u; i < flow_mods; ++i)
+    {
+        tnt::MacAddress dst{ 0x02, 0, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i), 0x01 };
+        auto flow = Flow().add(from_port(1)).add(from_hw_dst(dst)).add(to_port(2));
+
+        for (auto& controller: controllers)
+        {
+            auto message = std::make_unique<drop::message::AddFlow>(flow);
+            confirmations.push_back(message->confirmed());
+            controller->send(std::move(message));
+        }
+    }
+
+    for (auto& confirmation: confirmations)
+    {
+        check(confirmation.wait_for(timeout) == std::future_status::ready, "flow-mods not confirmed");
+        confirmation.get();
+    }
+
+    auto flow_mod_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (auto& sw: sws)
+    {
+        check(sw->wait_flow_mods(flow_mods, timeout), "flow-mods not received by the switch");
+    }
+
+    // Packet-in flood of all the switches at once.
+    start = Clock::now();
+
+    for (auto& sw: sws)
+    {
+        sw->flood(packet_ins, window);
+    }
+
+    std::vector<double> packet_in_rtts;
+
+    for (auto& sw: sws)
+    {
+        check(sw->wait_flood(timeout), "packet-ins without flow-mod");
+        packet_in_rtts.insert(packet_in_rtts.end(), sw->round_trips().begin(), sw->round_trips().end());
+    }
+
+    auto flood_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "OK: " << switches << " switches, " << packet_ins << " packet-ins and " << flow_mods << " flow-mods each, ";
+    std::cout << (loops > 0 ? std::to_string(loops) + " reactor loops" : std::string("rx/tx threads")) << std::endl;
+    print("handshake", handshakes);
+    print("echo", echo_rtts);
+    std::cout << "flow-mods: " << switches * flow_mods / flow_mod_time << " flow-mods/s confirmed" << std::endl;
+    print("packet-in to flow-mod", packet_in_rtts);
+    std::cout << "packet-ins: " << switches * packet_ins / flood_time << " packet-ins/s, window of " << window << " per switch" << std::endl;
+
+    std::exit(EXIT_SUCCESS); // The protocol threads block in their IO, do not wait for them.
+}
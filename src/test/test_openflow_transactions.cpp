@@ -0,0 +1,281 @@
+/*
+ * test the OpenFlow flow-mod transactions
+ *
+ * Checks that a barrier reply confirms the flow-mods sent before it, that an error
+ * fails only the flow-mod with its xid and that fail_all empties a full window.
+ * It then pipelines flow-mods to a simulated switch with a fixed latency and times
+ * stop-and-wait (window of one, a barrier after every flow-mod) against a window
+ * with batched barriers.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -pthread -I../framework -I../framework/common -I../lib \
+ *       test_openflow_transactions.cpp ../lib/protocol/openflow/transactions.cpp -o test_openflow_transactions
+ *
+ * Usage: test_openflow_transactions [flow-mods] [latency us]
+ */
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+
+#include "protocol/openflow/transactions.hpp"
+
+namespace {
+
+using drop::protocol::Transactions;
+
+bool ready(std::future<void>& future)
+{
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+bool failed(std::future<void>& future)
+{
+    try
+    {
+        future.get();
+    }
+    catch (std::exception&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+bool check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+
+    return condition;
+}
+
+bool confirmations()
+{
+    Transactions transactions(16, 16);
+    std::vector<std::future<void>> futures;
+    std::vector<uint32_t> xids;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        std::promise<void> done;
+        futures.push_back(done.get_future());
+        xids.push_back(transactions.flow_mod(std::move(done)));
+    }
+
+    uint32_t barrier = 0;
+    auto ok = check(transactions.barrier(barrier), "barrier after flow-mods");
+    ok &= check(!transactions.barrier(barrier), "no barrier without new flow-mods");
+
+    transactions.error(xids[1], std::make_exception_ptr(std::runtime_error("BAD_MATCH")));
+    ok &= check(ready(futures[1]) && !ready(futures[0]) && !ready(futures[2]), "an error fails only its flow-mod");
+
+    transactions.barrier_reply(barrier + 100);
+    ok &= check(!ready(futures[0]), "unknown barrier reply ignored");
+
+    transactions.barrier_reply(barrier);
+    ok &= check(ready(futures[0]) && ready(futures[2]), "barrier reply confirms the batch");
+    ok &= check(!failed(futures[0]) && failed(futures[1]) && !failed(futures[2]), "futures values");
+
+    return ok;
+}
+
+bool window()
+{
+    std::future<void> pending;
+    auto ok = true;
+
+    {
+        Transactions transactions(2, 2);
+
+        std::promise<void> first;
+        std::promise<void> second;
+        auto f1 = first.get_future();
+        pending = second.get_future();
+
+        transactions.flow_mod(std::move(first));
+        ok &= check(transactions.has_room() && !transactions.batch_full(), "room for the second flow-mod");
+        transactions.flow_mod(std::move(second));
+        ok &= check(!transactions.has_room() && transactions.batch_full(), "window full");
+
+        transactions.fail_all(std::make_exception_ptr(std::runtime_error("timeout")));
+        ok &= check(transactions.has_room() && failed(f1), "fail_all empties the window");
+
+        std::promise<void> third;
+        pending = third.get_future();
+        transactions.flow_mod(std::move(third));
+    }
+
+    ok &= check(ready(pending) && failed(pending), "destructor fails the pending flow-mods");
+
+    return ok;
+}
+
+// Delivers the messages after a fixed latency and replies to the barriers.
+class Switch
+{
+    struct Packet
+    {
+        std::chrono::steady_clock::time_point arrival;
+        uint32_t xid;
+        bool barrier;
+    };
+public:
+    Switch(Transactions& transactions, std::chrono::microseconds latency): transactions_(transactions), latency_(latency), thread_([this] () { run(); }) {}
+
+    ~Switch()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void send(uint32_t xid, bool barrier)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            packets_.push_back(Packet{ std::chrono::steady_clock::now() + latency_, xid, barrier });
+        }
+
+        cv_.notify_one();
+    }
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (running_)
+        {
+            if (packets_.empty())
+            {
+                cv_.wait(lock);
+                continue;
+            }
+
+            auto packet = packets_.front();
+
+            if (cv_.wait_until(lock, packet.arrival) != std::cv_status::timeout && std::chrono::steady_clock::now() < packet.arrival)
+            {
+                continue;
+            }
+
+            packets_.pop_front();
+
+            if (packet.barrier)
+            {
+                lock.unlock();
+                transactions_.barrier_reply(packet.xid);
+                lock.lock();
+            }
+        }
+    }
+private:
+    Transactions& transactions_;
+    std::chrono::microseconds latency_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Packet> packets_;
+    bool running_ = true;
+    std::thread thread_;
+};
+
+// Sends the flow-mods the way Openflow::flow_mod does, returns the time until all are confirmed.
+double pipeline(size_t count, size_t window, size_t batch, std::chrono::microseconds latency, bool& ok)
+{
+    Transactions transactions(window, batch);
+    Switch sw(transactions, latency);
+    std::vector<std::future<void>> futures;
+    futures.reserve(count);
+
+    auto barrier = [&] ()
+    {
+        uint32_t xid;
+
+        if (transactions.barrier(xid))
+        {
+            sw.send(xid, true);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!transactions.has_room())
+        {
+            barrier();
+
+            // Openflow queues the flow-mods until the barrier reply makes room, here it is polled for.
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+            while (!transactions.has_room() && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        std::promise<void> done;
+        futures.push_back(done.get_future());
+        sw.send(transactions.flow_mod(std::move(done)), false);
+
+        if (transactions.batch_full())
+        {
+            barrier();
+        }
+    }
+
+    barrier();
+
+    for (auto& future: futures)
+    {
+        ok &= future.wait_for(std::chrono::seconds(5)) == std::future_status::ready && !failed(future);
+    }
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    auto latency = std::chrono::microseconds(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100);
+
+    if (!confirmations() || !window())
+    {
+        return EXIT_FAILURE;
+    }
+
+    auto ok = true;
+    auto stop_and_wait = pipeline(count, 1, 1, latency, ok);
+    auto pipelined = pipeline(count, 1024, 64, latency, ok);
+
+    if (!ok)
+    {
+        std::cout << "FAILED: flow-mods not confirmed by the simulated switch" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK: " << count << " flow-mods, " << latency.count() << " us latency" << std::endl;
+    std::cout << "stop-and-wait: " << stop_and_wait << " ms, " << count / stop_and_wait * 1000 << " flow-mods/s" << std::endl;
+    std::cout << "pipelined:     " << pipelined << " ms, " << count / pipelined * 1000 << " flow-mods/s" << std::endl;
+
+    return EXIT_SUCCESS;
+}
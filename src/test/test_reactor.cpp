@@ -0,0 +1,239 @@
+/*
+ * benchmark AsyncProtocol sessions on the epoll reactor against the rx/tx threads
+ *
+ * Opens pairs of AsyncProtocol sessions over loopback TCP, a client and the server
+ * connection it talks to, in reactor mode or with the two threads of each protocol.
+ * Every client gets a Ping message through send(), which writes the first frame, and
+ * then plays its round trips with the server echoing every frame. Checks that every
+ * session finishes, that the reactor does not add threads with the sessions and that
+ * closing the clients resets every server connection. Prints the threads of the
+ * process, the time to open the sessions and the round trips per second of all of
+ * them at once.
+ *
+ * Every session takes two descriptors, raise the limit (ulimit -n) for many sessions.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib \
+ *       test_reactor.cpp ../framework/protocol/async_protocol.cpp ../framework/io/reactor.cpp \
+ *       ../framework/io/tcp_io.cpp ../framework/io/receive_buffer.cpp ../framework/common/application.cpp \
+ *       ../framework/activity/activity_from_event.cpp ../framework/util/system.cpp \
+ *       ../framework/common/init_sockets.cpp ../framework/common/ip_address.cpp ../framework/common/ip_socket_address.cpp \
+ *       ../framework/common/log.cpp ../framework/common/colors.cpp ../framework/common/demangle.cpp \
+ *       ../framework/exception/exception.cpp ../framework/common/quiescent_state.cpp \
+ *       ../framework/common/executor.cpp ../framework/common/memory_pool.cpp \
+ *       -o test_reactor -lpthread
+ *
+ * Usage: test_reactor [sessions] [round trips per session] [loops, 0 for the threads] [port]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+
+#include "protocol/async_protocol.hpp"
+#include "io/tcp_io.hpp"
+#include "io/reactor.hpp"
+#include "event/network/connection_reset.hpp"
+
+#include "ip_socket_address.hpp"
+#include "application.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t frame_size = 16;
+
+struct Ping: public virtual tnt::Message {};
+
+struct Counter
+{
+    explicit Counter(uint32_t total): total(total), count{ 0 } {}
+
+    void arrive()
+    {
+        if (count.fetch_add(1) + 1 == total)
+        {
+            done.set_value();
+        }
+    }
+
+    uint32_t total;
+    std::atomic<uint32_t> count;
+    std::promise<void> done;
+};
+
+class Session: public tnt::protocol::AsyncProtocol
+{
+public:
+    // A client without a counter is the server side, which echoes the frames.
+    Session(const std::shared_ptr<tnt::IO>& io, uint32_t rounds, Counter* finished):
+        AsyncProtocol(io), rounds_(rounds), replies_(0), finished_(finished), frame_(frame_size, 'x') {}
+protected:
+    virtual size_t parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages) override
+    {
+        size_t used = 0;
+
+        while (input.size() - used >= frame_size)
+        {
+            messages.emplace_back(input.data() + used, frame_size);
+            used += frame_size;
+        }
+
+        return used;
+    }
+
+    virtual void invoke_message(tnt::BufferView data) override
+    {
+        if (finished_ == nullptr)
+        {
+            write(data.data(), data.size());
+        }
+        else if (++replies_ == rounds_)
+        {
+            finished_->arrive();
+        }
+        else
+        {
+            write(frame_);
+        }
+    }
+
+    virtual void register_messages() override
+    {
+        register_message<Ping>([this] (auto /*message*/)
+        {
+            write(frame_);
+        });
+    }
+private:
+    uint32_t rounds_;
+    uint32_t replies_;
+    Counter* finished_;
+    std::string frame_;
+};
+
+size_t threads()
+{
+    std::ifstream status("/proc/self/status");
+    std::string key;
+
+    while (status >> key)
+    {
+        if (key == "Threads:")
+        {
+            size_t count = 0;
+            status >> count;
+
+            return count;
+        }
+    }
+
+    return 0;
+}
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto sessions = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 5000;
+    auto rounds = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 100;
+    auto loops = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 4;
+    auto port = argc > 4 ? static_cast<uint16_t>(std::atoi(argv[4])) : 16655;
+
+    const auto timeout = std::chrono::seconds(120);
+
+    if (loops > 0)
+    {
+        tnt::io::Reactor::enable(loops);
+        tnt::io::Reactor::instance();
+    }
+
+    tnt::ip::SocketAddress address("127.0.0.1", static_cast<short>(port));
+    tnt::io::TcpIOServer server(address);
+
+    Counter finished(sessions);
+    Counter resets(sessions);
+
+    tnt::Application::subscribe([&resets] (const tnt::event::ConnectionReset& /*event*/)
+    {
+        resets.arrive();
+    });
+
+    tnt::Application::run_async();
+
+    auto before = threads();
+    auto start = Clock::now();
+
+    std::vector<std::shared_ptr<Session>> servers;
+    std::thread acceptor([&] ()
+    {
+        for (auto i = 0u; i < sessions; ++i)
+        {
+            auto session = std::make_shared<Session>(server.get(), rounds, nullptr);
+            session->start();
+            servers.push_back(session);
+        }
+    });
+
+    std::vector<std::shared_ptr<Session>> clients;
+
+    for (auto i = 0u; i < sessions; ++i)
+    {
+        auto session = std::make_shared<Session>(tnt::io::TcpIOClient(address).get(), rounds, &finished);
+        session->start();
+        clients.push_back(session);
+    }
+
+    acceptor.join();
+
+    auto open_time = std::chrono::duration<double>(Clock::now() - start).count();
+    auto during = threads();
+
+    start = Clock::now();
+
+    for (auto& client : clients)
+    {
+        client->send(std::make_unique<Ping>());
+    }
+
+    check(finished.done.get_future().wait_for(timeout) == std::future_status::ready, "sessions not finished");
+
+    auto run_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    clients.clear();
+    check(resets.done.get_future().wait_for(timeout) == std::future_status::ready, "server connections not reset");
+    servers.clear();
+
+    if (loops > 0)
+    {
+        // Only the acceptor thread came and went.
+        check(during <= before + 1, "the reactor added threads with the sessions");
+    }
+
+    std::cout << "OK: " << sessions << " sessions, " << rounds << " round trips each, ";
+    std::cout << (loops > 0 ? std::to_string(loops) + " reactor loops" : std::string("rx/tx threads")) << std::endl;
+    std::cout << "threads: " << during << " (" << before << " before the sessions)" << std::endl;
+    std::cout << "open: " << sessions / open_time << " sessions/s" << std::endl;
+    std::cout << "round trips: " << static_cast<double>(sessions) * rounds / run_time << " round trips/s" << std::endl;
+
+    std::exit(EXIT_SUCCESS); // The protocol threads block in their IO, do not wait for them.
+}
@@ -0,0 +1,265 @@
+/*
+ * test the framed receive path of AsyncProtocol
+ *
+ * Replays a burst of DROP messages (header plus payload of random length) through
+ * the rx path, delivered in chunks as a TCP socket would, and checks every message
+ * is framed exactly once and unchanged. It then times the previous scheme (append
+ * the read to a string, split it with substr) against tnt::ReceiveBuffer with
+ * in-place framing.
+ *
+ * Build from this directory with:
+ *
+ *   clang++ -std=c++1y -O3 -I../framework -I../framework/common -I../lib \
+ *       test_receive_buffer.cpp ../framework/io/receive_buffer.cpp -o test_receive_buffer
+ *
+ * Usage: test_receive_buffer [messages] [chunk]
+ */
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <arpa/inet.h>
+
+#include "io/receive_buffer.hpp"
+
+#include "buffer_view.hpp"
+
+namespace {
+
+// Same layout as drop_message_hdr_t: type and total length, in network order.
+const size_t hdr_len = 8;
+
+uint32_t total_length(const char* hdr)
+{
+    uint32_t len;
+    std::memcpy(&len, hdr + 4, sizeof(len));
+
+    return ntohl(len);
+}
+
+// The socket: hands out the stream in chunks of at most chunk bytes.
+class MockStream
+{
+public:
+    MockStream(const std::string& data, size_t chunk): data_(data), chunk_(chunk), pos_(0) {}
+
+    bool done() const { return pos_ == data_.size(); }
+
+    // The previous TcpIO::read: a new string of SO_RCVBUF bytes per call.
+    std::string read()
+    {
+        std::string buf;
+        buf.resize(rcvbuf);
+
+        auto n = read_some(&buf[0], buf.size());
+        buf.resize(n);
+
+        return buf;
+    }
+
+    size_t read_some(char* data, size_t size)
+    {
+        auto n = std::min(std::min(size, chunk_), data_.size() - pos_);
+        std::memcpy(data, data_.data() + pos_, n);
+        pos_ += n;
+
+        return n;
+    }
+private:
+    static const size_t rcvbuf = 212992;
+
+    const std::string& data_;
+    size_t chunk_;
+    size_t pos_;
+};
+
+struct Digest
+{
+    size_t messages = 0;
+    size_t bytes = 0;
+    uint32_t sum = 0;
+
+    void add(const char* data, size_t size)
+    {
+        ++messages;
+        bytes += size;
+        sum = sum * 31 + static_cast<uint8_t>(data[size - 1]) + static_cast<uint32_t>(size);
+    }
+
+    bool operator==(const Digest& other) const
+    {
+        return messages == other.messages && bytes == other.bytes && sum == other.sum;
+    }
+};
+
+// The previous Drop::parse and rx_loop.
+std::vector<std::string> legacy_parse(std::string& raw_input)
+{
+    std::vector<std::string> messages;
+
+    while (true)
+    {
+        auto len = raw_input.size();
+
+        if (len < hdr_len)
+        {
+            break;
+        }
+
+        auto packet_len = total_length(raw_input.data());
+
+        if (len < packet_len)
+        {
+            break;
+        }
+
+        if (len == packet_len)
+        {
+            messages.push_back(raw_input);
+            raw_input.clear();
+
+            break;
+        }
+
+        messages.push_back(raw_input.substr(0, packet_len));
+        raw_input = raw_input.substr(packet_len);
+    }
+
+    return messages;
+}
+
+Digest legacy(MockStream stream)
+{
+    Digest digest;
+    std::string raw_input;
+
+    while (!stream.done())
+    {
+        raw_input.append(stream.read());
+
+        for (const auto& m : legacy_parse(raw_input))
+        {
+            digest.add(m.data(), m.size());
+        }
+    }
+
+    return digest;
+}
+
+// The current Drop::parse and rx_loop.
+size_t parse(tnt::BufferView input, std::vector<tnt::BufferView>& messages)
+{
+    size_t pos = 0;
+
+    while (true)
+    {
+        auto len = input.size() - pos;
+
+        if (len < hdr_len)
+        {
+            break;
+        }
+
+        auto packet_len = total_length(input.data() + pos);
+
+        if (len < packet_len)
+        {
+            break;
+        }
+
+        messages.push_back(input.substr(pos, packet_len));
+        pos += packet_len;
+    }
+
+    return pos;
+}
+
+Digest framed(MockStream stream)
+{
+    const size_t rx_chunk = 64 * 1024;
+
+    Digest digest;
+    tnt::ReceiveBuffer buffer(4 * rx_chunk);
+    std::vector<tnt::BufferView> messages;
+
+    while (!stream.done())
+    {
+        auto data = buffer.prepare(rx_chunk);
+        buffer.commit(stream.read_some(data, buffer.space()));
+
+        messages.clear();
+        auto consumed = parse(buffer.data(), messages);
+
+        for (const auto& m : messages)
+        {
+            digest.add(m.data(), m.size());
+        }
+
+        buffer.consume(consumed);
+    }
+
+    return digest;
+}
+
+template <class F> double time_ms(F func, Digest& digest)
+{
+    auto start = std::chrono::steady_clock::now();
+    digest = func();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto n = argc > 1 ? std::atoi(argv[1]) : 100000;
+    auto chunk = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 65536;
+
+    std::mt19937 gen(10);
+    std::uniform_int_distribution<uint32_t> payload(0, 504);
+
+    std::string stream;
+    Digest expected;
+
+    for (auto i = 0; i < n; ++i)
+    {
+        auto len = static_cast<uint32_t>(hdr_len) + payload(gen);
+
+        std::string m(len, static_cast<char>(i));
+        auto type = htonl(static_cast<uint32_t>(i % 40));
+        auto total = htonl(len);
+        std::memcpy(&m[0], &type, sizeof(type));
+        std::memcpy(&m[4], &total, sizeof(total));
+
+        expected.add(m.data(), m.size());
+        stream += m;
+    }
+
+    Digest old_digest;
+    Digest new_digest;
+
+    auto old_ms = time_ms([&] () { return legacy(MockStream(stream, chunk)); }, old_digest);
+    auto new_ms = time_ms([&] () { return framed(MockStream(stream, chunk)); }, new_digest);
+
+    if (!(old_digest == expected) || !(new_digest == expected))
+    {
+        std::cout << "FAILED: framed " << new_digest.messages << " messages, " << new_digest.bytes << " bytes (expected " << expected.messages << ", " << expected.bytes << ")" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OK: " << expected.messages << " messages, " << expected.bytes << " bytes in " << chunk << " bytes reads" << std::endl;
+    std::cout << "substr:         " << old_ms << " ms, " << expected.messages / old_ms / 1000 << " M messages/s" << std::endl;
+    std::cout << "receive buffer: " << new_ms << " ms, " << expected.messages / new_ms / 1000 << " M messages/s" << std::endl;
+
+    return EXIT_SUCCESS;
+}